@@ -0,0 +1,200 @@
+/**
+ * @file fuzz_decode.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Fuzz target of the decoders of the protocol layer and of the trace reader.
+ * @details The first byte of the input selects a protocol, NEC, SIRC, RC5, or the Mitsubishi split unit, and whether
+ * the rest is a list of intervals or the records of a binary trace.  An interval is 2 bytes, a duration of up to
+ * 32767 usec or, with the top bit set, up to 8 s, alternating from a MARK or, with a flag, from a SPACE.  A trace is
+ * the rest of the input after a valid header, each record read is decoded into rx buffer elements.
+ *
+ * The elements are decoded with the protocol and with the protocol proposed by the analyzer from them.  Every call of
+ * embx_ir_protocol_decode must move past the elements it used and a frame must fit EMBX_IR_PROTOCOL_MAX_BYTES.  A
+ * Mitsubishi frame decoded is parsed by the codec, and so are the first bytes of the input as a frame that skipped
+ * the integrity checks.  A record read must lie within the trace and the reader must move past it.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "embx/embx_ir/embx_ir_analyzer.h"
+#include "embx/embx_ir/embx_ir_trace.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+
+/** The flags of the first byte of the input */
+#define FUZZ_PROTOCOL_MASK			(0x03)
+#define FUZZ_TRACE					(0x04)
+#define FUZZ_SPACE_FIRST			(0x08)
+/** A duration with the top bit set is in units of 256 usec */
+#define FUZZ_LONG					(0x8000)
+/** The most bytes of a trace */
+#define FUZZ_TRACE_SZ				(EMBX_IR_TRACE_HEADER_SZ + 4096)
+
+static const embx_ir_protocol_t fuzz_nec = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1690,
+	.trailer_mark_usec = 560,
+	.gap_usec = 40000,
+	.nbits = 32,
+};
+
+static const embx_ir_protocol_t fuzz_sirc = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 600,
+	.header_mark_usec = 2400,
+	.header_space_usec = 600,
+	.zero_mark_usec = 600,
+	.zero_space_usec = 600,
+	.one_mark_usec = 1200,
+	.one_space_usec = 600,
+	.gap_usec = 45000,
+	.nbits = 12,
+};
+
+static const embx_ir_protocol_t fuzz_rc5 = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER,
+	.bit_order = EMBX_IR_BIG_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 889,
+	.gap_usec = 89000,
+	.nbits = 14,
+};
+
+static const embx_ir_protocol_t *const fuzz_protocols[FUZZ_PROTOCOL_MASK + 1] = {
+	&fuzz_nec, &fuzz_sirc, &fuzz_rc5, &embx_split_unit_mitsubishi_protocol,
+};
+
+static embx_ir_rx_buf_elem_t fuzz_elem[EMBX_IR_RX_BUF_SZ];
+static embx_ir_analyzer_t fuzz_analyzer;
+
+static void fuzz_fail(const char *what, uint32_t value)
+{
+	fprintf(stderr, "fuzz_decode: %s %lu\n", what, (unsigned long)value);
+	abort();
+}
+
+/**
+* @brief Decodes every frame of the elements with a protocol.
+*/
+static void fuzz_decode(const embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	embx_ir_protocol_frame_t frame;
+	embx_split_unit_state_t state;
+	enum status_code status;
+	uint16_t idx = 0, prev;
+
+	do {
+		prev = idx;
+		status = embx_ir_protocol_decode(protocol, elem, size, &idx, &frame);
+		if( status == STATUS_ERR_BAD_DATA ) {
+			break;
+		}
+		if( idx <= prev ) {
+			fuzz_fail("decode did not move past element", prev);
+		}
+		if( (status == STATUS_OK) && (frame.nbits > (EMBX_IR_PROTOCOL_MAX_BYTES * 8)) ) {
+			fuzz_fail("frame of bits", frame.nbits);
+		}
+		if( (status == STATUS_OK) && (protocol == &embx_split_unit_mitsubishi_protocol) ) {
+			embx_split_unit_mitsubishi_codec.decode(&frame, &state);
+		}
+	} while( idx < size );
+}
+
+/**
+* @brief Decodes the elements with the protocol of the input and with the protocol proposed by the analyzer.
+*/
+static void fuzz_elems(const embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	embx_ir_protocol_t proposed;
+
+	fuzz_decode(protocol, elem, size);
+	embx_ir_analyzer_init(&fuzz_analyzer);
+	if( (embx_ir_analyzer_add_frame(&fuzz_analyzer, elem, size) == STATUS_OK) &&
+		(embx_ir_analyzer_propose(&fuzz_analyzer, elem, size, &proposed) == STATUS_OK) ) {
+		fuzz_decode(&proposed, elem, size);
+	}
+}
+
+/**
+* @brief Reads the records of a trace and decodes each.
+*/
+static void fuzz_trace(const embx_ir_protocol_t *protocol, const uint8_t *data, size_t size)
+{
+	static uint8_t trace[FUZZ_TRACE_SZ];
+	embx_ir_trace_writer_t writer;
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	size_t len, offset;
+
+	len = (size < (FUZZ_TRACE_SZ - EMBX_IR_TRACE_HEADER_SZ)) ? size : (FUZZ_TRACE_SZ - EMBX_IR_TRACE_HEADER_SZ);
+	embx_ir_trace_write_header(&writer, trace);
+	memcpy(&trace[EMBX_IR_TRACE_HEADER_SZ], data, len);
+	len += EMBX_IR_TRACE_HEADER_SZ;
+	if( embx_ir_trace_reader_init(&reader, trace, len) != STATUS_OK ) {
+		fuzz_fail("header not read", 0);
+	}
+	offset = reader.offset;
+	while( embx_ir_trace_read(&reader, &record) == STATUS_OK ) {
+		if( (reader.offset <= offset) || (reader.offset > len) ) {
+			fuzz_fail("reader at offset", (uint32_t)reader.offset);
+		}
+		if( (record.intervals < trace) || ((record.intervals + record.intervals_len) > (trace + len)) ) {
+			fuzz_fail("intervals of record outside the trace", (uint32_t)offset);
+		}
+		if( embx_ir_trace_get_elems(&record, fuzz_elem, EMBX_IR_RX_BUF_SZ) == STATUS_OK ) {
+			fuzz_elems(protocol, fuzz_elem, record.size);
+		}
+		offset = reader.offset;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	const embx_ir_protocol_t *protocol;
+	embx_ir_protocol_frame_t frame;
+	embx_split_unit_state_t state;
+	uint16_t n = 0, usec;
+	uint8_t flags;
+
+	if( size == 0 ) {
+		return 0;
+	}
+	flags = data[0];
+	protocol = fuzz_protocols[flags & FUZZ_PROTOCOL_MASK];
+	data++;
+	size--;
+
+	/** The codec parses any frame */
+	memset(&frame, 0, sizeof(frame));
+	frame.nbits = EMBX_SPLIT_UNIT_MITSUBISHI_BYTES * 8;
+	memcpy(frame.data, data, (size < EMBX_SPLIT_UNIT_MITSUBISHI_BYTES) ? size : EMBX_SPLIT_UNIT_MITSUBISHI_BYTES);
+	embx_split_unit_mitsubishi_codec.decode(&frame, &state);
+
+	if( (flags & FUZZ_TRACE) != 0 ) {
+		fuzz_trace(protocol, data, size);
+		return 0;
+	}
+	while( ((2 * (size_t)n) + 1 < size) && (n < EMBX_IR_RX_BUF_SZ) ) {
+		usec = (uint16_t)(data[2 * n] | (data[(2 * n) + 1] << 8));
+		fuzz_elem[n].time_us = ((usec & FUZZ_LONG) != 0) ? ((uint32_t)(usec & ~FUZZ_LONG) << 8) : usec;
+		fuzz_elem[n].gpio_state = (((n & 1) == 0) == ((flags & FUZZ_SPACE_FIRST) == 0)) ? EMBX_IR_RX_GPIO_STATE_MARK :
+																						   EMBX_IR_RX_GPIO_STATE_SPACE;
+		fuzz_elem[n].ticks = 0;
+		n++;
+	}
+	fuzz_elems(protocol, fuzz_elem, n);
+	return 0;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file fuzz_main.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief A coverage guided driver of the fuzz targets for a host without libFuzzer.
+ * @details usage: fuzz_target [-n runs] [-t seconds] [-s seed] [-l max_len] [-c corpus_dir] [input...]
+ *
+ * A target is a LLVMFuzzerTestOneInput function, the same source builds with clang -fsanitize=fuzzer.  With input
+ * files, each is run once, e.g. to reproduce a failure.  Otherwise inputs are mutated from the corpus: the seeds of
+ * corpus_dir and the inputs kept so far.  The code under test is compiled with -fsanitize-coverage=trace-pc, an
+ * input that reaches a new edge is kept, and written to corpus_dir if one is given.
+ *
+ * A failure is an abort of the target or a report of the sanitizers, the input is written to crash-<target>-<run>
+ * before the process dies.
+ */
+#include <signal.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sanitizer/common_interface_defs.h>
+
+/** The edges are hashed into a map of this many counters */
+#define FUZZ_MAP_SZ					(1 << 16)
+#define FUZZ_MAX_LEN				(1024)
+#define FUZZ_CORPUS_MAX				(4096)
+#define FUZZ_RUNS					(100000)
+
+extern int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint8_t fuzz_map[FUZZ_MAP_SZ];
+static uint8_t fuzz_seen[FUZZ_MAP_SZ];
+static uintptr_t fuzz_prev_pc;
+
+static uint8_t *fuzz_corpus[FUZZ_CORPUS_MAX];
+static size_t fuzz_corpus_len[FUZZ_CORPUS_MAX];
+static uint32_t fuzz_corpus_n;
+static uint32_t fuzz_edges;
+
+/** The input under test, written out if it fails */
+static const uint8_t *fuzz_input;
+static size_t fuzz_input_len;
+static const char *fuzz_name;
+static uint64_t fuzz_run;
+static uint64_t fuzz_seed;
+
+/**
+* @brief Called by the code compiled with -fsanitize-coverage=trace-pc at each basic block.
+*/
+__attribute__((no_sanitize_coverage)) void __sanitizer_cov_trace_pc(void)
+{
+	uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+
+	fuzz_map[(pc ^ fuzz_prev_pc) & (FUZZ_MAP_SZ - 1)]++;
+	fuzz_prev_pc = pc >> 1;
+}
+
+static uint32_t fuzz_random(void)
+{
+	fuzz_seed = (fuzz_seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+	return (uint32_t)(fuzz_seed >> 33);
+}
+
+/**
+* @brief Writes the input under test, called when the target aborts or a sanitizer reports an error.
+*/
+static void fuzz_dump(void)
+{
+	char path[256];
+	FILE *f;
+
+	if( fuzz_input == NULL ) {
+		return;
+	}
+	snprintf(path, sizeof(path), "crash-%s-%llu", fuzz_name, (unsigned long long)fuzz_run);
+	if( (f = fopen(path, "wb")) != NULL ) {
+		fwrite(fuzz_input, 1, fuzz_input_len, f);
+		fclose(f);
+		fprintf(stderr, "%s: input of run %llu written to %s\n", fuzz_name, (unsigned long long)fuzz_run, path);
+	}
+	fuzz_input = NULL;
+}
+
+static void fuzz_signal(int sig)
+{
+	fuzz_dump();
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+/**
+* @brief Runs an input.
+* @returns true if it reached an edge that no input reached before.
+*/
+static bool fuzz_test(const uint8_t *data, size_t len)
+{
+	bool found = false;
+	uint32_t i;
+
+	memset(fuzz_map, 0, sizeof(fuzz_map));
+	fuzz_prev_pc = 0;
+	fuzz_input = data;
+	fuzz_input_len = len;
+	LLVMFuzzerTestOneInput(data, len);
+	fuzz_input = NULL;
+	fuzz_run++;
+
+	for( i = 0; i < FUZZ_MAP_SZ; i++ ) {
+		if( (fuzz_map[i] != 0) && (fuzz_seen[i] == 0) ) {
+			fuzz_seen[i] = 1;
+			fuzz_edges++;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static void fuzz_keep(const uint8_t *data, size_t len, const char *dir)
+{
+	char path[512];
+	FILE *f;
+
+	if( fuzz_corpus_n == FUZZ_CORPUS_MAX ) {
+		return;
+	}
+	fuzz_corpus[fuzz_corpus_n] = malloc((len != 0) ? len : 1);
+	memcpy(fuzz_corpus[fuzz_corpus_n], data, len);
+	fuzz_corpus_len[fuzz_corpus_n] = len;
+	fuzz_corpus_n++;
+	if( dir != NULL ) {
+		snprintf(path, sizeof(path), "%s/%s-%llu", dir, fuzz_name, (unsigned long long)fuzz_run);
+		if( (f = fopen(path, "wb")) != NULL ) {
+			fwrite(data, 1, len, f);
+			fclose(f);
+		}
+	}
+}
+
+/**
+* @brief Reads a file into buf, returns the length or -1.
+*/
+static long fuzz_read(const char *path, uint8_t *buf, size_t max)
+{
+	FILE *f = fopen(path, "rb");
+	size_t len;
+
+	if( f == NULL ) {
+		perror(path);
+		return -1;
+	}
+	len = fread(buf, 1, max, f);
+	fclose(f);
+	return (long)len;
+}
+
+/**
+* @brief Mutates an input in place, a few random byte flips, insertions, deletions, and splices with the corpus.
+* @returns the new length.
+*/
+static size_t fuzz_mutate(uint8_t *data, size_t len, size_t max)
+{
+	uint32_t n = 1 + (fuzz_random() % 8);
+	const uint8_t *other;
+	size_t pos, span, other_len;
+	uint32_t other_n;
+
+	while( n-- > 0 ) {
+		pos = (len != 0) ? (fuzz_random() % len) : 0;
+		switch( fuzz_random() % 6 ) {
+			case 0: /** Flip a bit */
+				if( len != 0 ) {
+					data[pos] ^= (uint8_t)(1 << (fuzz_random() % 8));
+				}
+			break;
+			case 1: /** A random byte */
+				if( len != 0 ) {
+					data[pos] = (uint8_t)fuzz_random();
+				}
+			break;
+			case 2: /** Insert random bytes */
+				span = 1 + (fuzz_random() % 8);
+				if( (len + span) <= max ) {
+					memmove(&data[pos + span], &data[pos], len - pos);
+					while( span-- > 0 ) {
+						data[pos + span] = (uint8_t)fuzz_random();
+						len++;
+					}
+				}
+			break;
+			case 3: /** Delete bytes */
+				span = 1 + (fuzz_random() % 8);
+				if( (pos + span) <= len ) {
+					memmove(&data[pos], &data[pos + span], len - pos - span);
+					len -= span;
+				}
+			break;
+			case 4: /** Duplicate a span, repeats a sequence of operations */
+				span = 1 + (fuzz_random() % 16);
+				if( ((pos + span) <= len) && ((len + span) <= max) ) {
+					memmove(&data[pos + span], &data[pos], len - pos);
+					len += span;
+				}
+			break;
+			default: /** Splice the tail of another input of the corpus */
+				if( fuzz_corpus_n != 0 ) {
+					other_n = fuzz_random() % fuzz_corpus_n;
+					other = fuzz_corpus[other_n];
+					other_len = fuzz_corpus_len[other_n];
+					span = fuzz_random() % (other_len + 1);
+					span = (span < (max - pos)) ? span : (max - pos);
+					memcpy(&data[pos], &other[other_len - span], span);
+					len = ((pos + span) > len) ? (pos + span) : len;
+				}
+			break;
+		}
+	}
+	return len;
+}
+
+int main(int argc, char *argv[])
+{
+	static uint8_t data[FUZZ_MAX_LEN];
+	uint64_t runs = FUZZ_RUNS;
+	uint32_t seconds = 0, base;
+	size_t max_len = FUZZ_MAX_LEN, len;
+	const char *dir = NULL;
+	struct dirent *entry;
+	char path[512];
+	time_t start;
+	DIR *d;
+	long n;
+	int opt;
+
+	fuzz_name = strrchr(argv[0], '/') ? (strrchr(argv[0], '/') + 1) : argv[0];
+	fuzz_seed = (uint64_t)time(NULL);
+	while( (opt = getopt(argc, argv, "n:t:s:l:c:")) != -1 ) {
+		switch( opt ) {
+			case 'n': runs = strtoull(optarg, NULL, 0); break;
+			case 't': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 's': fuzz_seed = strtoull(optarg, NULL, 0); break;
+			case 'l': max_len = strtoul(optarg, NULL, 0); break;
+			case 'c': dir = optarg; break;
+			default:
+				fprintf(stderr, "usage: %s [-n runs] [-t seconds] [-s seed] [-l max_len] [-c corpus_dir] [input...]\n", argv[0]);
+				return 2;
+		}
+	}
+	max_len = ((max_len != 0) && (max_len < FUZZ_MAX_LEN)) ? max_len : FUZZ_MAX_LEN;
+
+	__sanitizer_set_death_callback(fuzz_dump);
+	signal(SIGABRT, fuzz_signal);
+	signal(SIGSEGV, fuzz_signal);
+
+	if( optind < argc ) { /** Reproduce */
+		for( ; optind < argc; optind++ ) {
+			if( (n = fuzz_read(argv[optind], data, FUZZ_MAX_LEN)) < 0 ) {
+				return 2;
+			}
+			fuzz_test(data, (size_t)n);
+			printf("%s: %s passed\n", fuzz_name, argv[optind]);
+		}
+		return 0;
+	}
+
+	printf("%s: seed %llu\n", fuzz_name, (unsigned long long)fuzz_seed);
+	fuzz_keep(data, 0, NULL);
+	fuzz_test(data, 0);
+	if( (dir != NULL) && ((d = opendir(dir)) != NULL) ) {
+		while( (entry = readdir(d)) != NULL ) {
+			if( entry->d_name[0] == '.' ) {
+				continue;
+			}
+			snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+			if( (n = fuzz_read(path, data, max_len)) >= 0 ) {
+				fuzz_test(data, (size_t)n);
+				fuzz_keep(data, (size_t)n, NULL);
+			}
+		}
+		closedir(d);
+	}
+
+	start = time(NULL);
+	while( (fuzz_run < runs) && ((seconds == 0) || ((uint32_t)(time(NULL) - start) < seconds)) ) {
+		base = fuzz_random() % fuzz_corpus_n;
+		len = fuzz_corpus_len[base];
+		memcpy(data, fuzz_corpus[base], len);
+		len = fuzz_mutate(data, len, max_len);
+		if( fuzz_test(data, len) == true ) {
+			fuzz_keep(data, len, dir);
+		}
+	}
+	printf("%s: %llu runs, %lu edges, %lu inputs kept\n", fuzz_name, (unsigned long long)fuzz_run,
+		   (unsigned long)fuzz_edges, (unsigned long)fuzz_corpus_n);
+	return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file fuzz_rx_phy.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Fuzz target of the IR Rx PHY state machine and the rx buffers, on the host backend of the HAL.
+ * @details The input is the interrupt latency and the EIC filter, then a program of operations of 3 bytes: edges
+ * on the EIC pin held for any time from a glitch shorter than the filter to 25 s, events injected into
+ * embx_rx_ir_phy_state_machine out of turn, the background loop releasing some or all of the full buffers, or not,
+ * and the Rx PHY disabled and enabled again.
+ *
+ * Every buffer released by the background loop must hold at most EMBX_IR_RX_BUF_SZ intervals alternating from a
+ * MARK, with the status of a completed reception.  After the program, the line is left idle until every state of
+ * the machine has timed out and a reference frame is sent: it must be captured once and intact, so a sequence of
+ * events that leaves the machine, the buffer indices, or the overflow counters in a wrong state fails.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+
+#define FUZZ_TICKS_PER_USEC			(EMBX_HAL_HOST_GCLK_HZ / 1000000UL)
+/** Every state of the machine times out, see ir_rx_sim */
+#define FUZZ_IDLE_MS				((EMBX_IR_RX_PHY_SPACE_DELAY * EMBX_IR_RX_PHY_USEC_PER_TICK / 1000) * (EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE + 2))
+/** A tick of the Rx PHY each side */
+#define FUZZ_TOLERANCE_USEC			(2 * EMBX_IR_RX_PHY_USEC_PER_TICK)
+/** The operations of an input */
+#define FUZZ_MAX_OPS				(512)
+
+/** @brief Reads the input, 0 past its end */
+typedef struct {
+	const uint8_t *data;
+	size_t size;
+	size_t offset;
+} fuzz_input_t;
+
+/** A NEC frame without the data bits */
+static const uint32_t fuzz_reference_usec[] = { 9000, 4500, 560, 560, 560, 1690, 560 };
+
+static bool fuzz_level;
+static bool fuzz_enabled;
+
+static void fuzz_fail(const char *what, uint32_t value)
+{
+	fprintf(stderr, "fuzz_rx_phy: %s %lu\n", what, (unsigned long)value);
+	abort();
+}
+
+static uint8_t fuzz_byte(fuzz_input_t *in)
+{
+	return (in->offset < in->size) ? in->data[in->offset++] : 0;
+}
+
+/**
+* @brief Checks a full buffer.
+*/
+static void fuzz_check(const embx_ir_rx_buf_t *buf)
+{
+	uint16_t i;
+
+	if( buf->size > EMBX_IR_RX_BUF_SZ ) {
+		fuzz_fail("buffer size", buf->size);
+	}
+	if( (buf->status != STATUS_OK) && (buf->status != STATUS_ERR_TIMEOUT) && (buf->status != STATUS_ERR_OVERFLOW) ) {
+		fuzz_fail("buffer status", (uint32_t)buf->status);
+	}
+	for( i = 0; i < buf->size; i++ ) {
+		if( buf->elem[i].gpio_state != (((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			fuzz_fail("interval out of turn", i);
+		}
+	}
+}
+
+/**
+* @brief Releases at most n full buffers as the background loop does.
+* @returns the number released.
+*/
+static uint32_t fuzz_release(uint32_t n)
+{
+	embx_ir_rx_buf_t *buf;
+	uint32_t released = 0;
+
+	while( (released < n) && (embx_ir_rx_buf_get_full(&buf) == STATUS_OK) ) {
+		fuzz_check(buf);
+		embx_ir_rx_buf_release();
+		released++;
+	}
+	return released;
+}
+
+static void fuzz_drive(bool level, uint64_t ticks)
+{
+	fuzz_level = level;
+	embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, level);
+	embx_hal_host_run(ticks);
+}
+
+/**
+* @brief Sends the reference frame on an idle line and checks that it is captured once and intact.
+*/
+static void fuzz_reference(void)
+{
+	embx_ir_rx_buf_t *buf;
+	uint32_t error;
+	uint16_t i;
+
+	for( i = 0; i < (sizeof(fuzz_reference_usec) / sizeof(fuzz_reference_usec[0])); i++ ) {
+		fuzz_drive((i & 1) != 0, (uint64_t)fuzz_reference_usec[i] * FUZZ_TICKS_PER_USEC);
+	}
+	fuzz_drive(true, 0);
+	embx_hal_delay_ms(FUZZ_IDLE_MS);
+
+	if( embx_ir_rx_buf_get_full(&buf) != STATUS_OK ) {
+		fuzz_fail("reference frame not captured", 0);
+	}
+	fuzz_check(buf);
+	if( (buf->status != STATUS_OK) || (buf->size != (sizeof(fuzz_reference_usec) / sizeof(fuzz_reference_usec[0]))) ) {
+		fuzz_fail("reference frame captured with intervals", buf->size);
+	}
+	for( i = 0; i < buf->size; i++ ) {
+		error = (buf->elem[i].time_us > fuzz_reference_usec[i]) ? (buf->elem[i].time_us - fuzz_reference_usec[i]) :
+																  (fuzz_reference_usec[i] - buf->elem[i].time_us);
+		if( error > FUZZ_TOLERANCE_USEC ) {
+			fuzz_fail("reference interval off by usec", error);
+		}
+	}
+	embx_ir_rx_buf_release();
+	if( fuzz_release(UINT32_MAX) != 0 ) {
+		fuzz_fail("reference frame captured more than once", 0);
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	fuzz_input_t in = { data, size, 0 };
+	uint32_t ops = 0, arg;
+	uint8_t op;
+
+	embx_hal_host_reset();
+	embx_hal_host_set_isr_latency(fuzz_byte(&in)); /** Up to 32 usec */
+	embx_hal_host_set_extint_filter(fuzz_byte(&in) & 0x3F);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	fuzz_enabled = true;
+	fuzz_level = true;
+	embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, true);
+
+	while( (in.offset < in.size) && (ops++ < FUZZ_MAX_OPS) ) {
+		op = fuzz_byte(&in);
+		arg = fuzz_byte(&in);
+		arg |= (uint32_t)fuzz_byte(&in) << 8;
+		switch( op & 0x07 ) {
+			case 0: /** An edge held up to 8 ms, down to a glitch */
+				fuzz_drive(!fuzz_level, arg);
+			break;
+			case 1: /** An edge held up to 0.5 s */
+				fuzz_drive(!fuzz_level, (uint64_t)arg * 64);
+			break;
+			case 2: /** An edge held up to 25 s, beyond every timeout */
+				fuzz_drive(!fuzz_level, (uint64_t)(arg & 0xFF) * 100 * 1000 * FUZZ_TICKS_PER_USEC);
+			break;
+			case 3: /** The line holds its level */
+				embx_hal_host_run((uint64_t)arg * 64);
+			break;
+			case 4: /** The background loop releases some of the full buffers */
+				fuzz_release(arg % (EMBX_IR_RX_NUMBER_OF_BUFFERS + 1));
+			break;
+			case 5: /** An event out of turn, e.g. a spurious interrupt */
+				embx_hal_enter_critical_section();
+				embx_rx_ir_phy_state_machine((embx_ir_rx_event_t)(arg % (EMBX_IR_RX_TIMER_EVENT_TIMEOUT + 1)));
+				embx_hal_leave_critical_section();
+			break;
+			case 6: /** The Rx PHY is disabled or enabled */
+				if( (arg & 1) != 0 ) {
+					embx_ir_rx_phy_disable();
+					fuzz_enabled = false;
+				} else {
+					embx_ir_rx_phy_enable();
+					fuzz_enabled = true;
+				}
+			break;
+			default: /** The line held for a number of Rx PHY ticks, near the boundaries of the timeouts */
+				fuzz_drive(!fuzz_level, (uint64_t)arg * EMBX_IR_RX_PHY_USEC_PER_TICK * FUZZ_TICKS_PER_USEC);
+			break;
+		}
+	}
+
+	/** Every state times out on an idle line and the background loop catches up */
+	fuzz_drive(true, 0);
+	if( fuzz_enabled == false ) {
+		embx_ir_rx_phy_enable();
+	}
+	embx_hal_delay_ms(FUZZ_IDLE_MS);
+	fuzz_release(UINT32_MAX);
+	embx_hal_delay_ms(FUZZ_IDLE_MS);
+	fuzz_release(UINT32_MAX);
+	fuzz_reference();
+	return 0;
+}
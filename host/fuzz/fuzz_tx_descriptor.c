@@ -0,0 +1,172 @@
+/**
+ * @file fuzz_tx_descriptor.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Fuzz target of the descriptor ring of the IR Tx PHY.
+ * @details The input is a descriptor program of operations of 3 bytes: fills with any repeat count and decrement,
+ * a reset of the ring, the PHY taking the next interval, and embx_ir_tx_phy_decrement_tx_index, interleaved in any
+ * order as the main loop and the interrupt of the PHY interleave them.
+ *
+ * Each descriptor is filled with a duration that identifies it.  The interval returned by the ring must be the one
+ * filled at the tx index, so a descriptor overwritten while a repeat may still go back to it is found.  The indices
+ * must keep release <= tx <= fill, and a program without REPEAT_FOREVER must end: the ring may return no more
+ * intervals than the descriptors filled, their repeats, and the external decrements add up to.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+
+/** The operations of an input */
+#define FUZZ_MAX_OPS				(512)
+/** The largest number of timer periods of an interval */
+#define FUZZ_MAX_PERIODS			(UINT8_MAX + 1)
+
+/** @brief Reads the input, 0 past its end */
+typedef struct {
+	const uint8_t *data;
+	size_t size;
+	size_t offset;
+} fuzz_input_t;
+
+/** The durations of the classes of intervals: the shortest, a carrier burst, and intervals of 1, 2, and 256 timer periods */
+static const uint32_t fuzz_usec[8] = { 0, 1, 560, 9000, 100000, 600000, 1200000, 80000000 };
+
+/** The duration filled at each free running fill index */
+static uint32_t fuzz_filled[256];
+/** The intervals the ring may still return */
+static uint64_t fuzz_budget;
+static uint32_t fuzz_seq;
+
+/** The IR Tx PHY is not linked, the ring can always be reset */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+static void fuzz_fail(const char *what, uint32_t value)
+{
+	fprintf(stderr, "fuzz_tx_descriptor: %s %lu\n", what, (unsigned long)value);
+	abort();
+}
+
+static uint8_t fuzz_byte(fuzz_input_t *in)
+{
+	return (in->offset < in->size) ? in->data[in->offset++] : 0;
+}
+
+/**
+* @brief Checks the indices of the ring.
+*/
+static void fuzz_check_indices(void)
+{
+	uint8_t fill = embx_ir_tx_phy_descriptor_get_fill_index();
+	uint8_t tx = embx_ir_tx_phy_descriptor_get_tx_index();
+
+	if( (uint8_t)(fill - tx) > EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ ) {
+		fuzz_fail("tx index past the fill index by", (uint8_t)(tx - fill));
+	}
+	if( embx_ir_tx_phy_descriptor_get_free() > EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ ) {
+		fuzz_fail("free descriptors", embx_ir_tx_phy_descriptor_get_free());
+	}
+}
+
+/**
+* @brief The PHY takes the next period.
+* @returns the status of embx_ir_tx_phy_descriptor_next.
+*/
+static enum status_code fuzz_next(void)
+{
+	uint8_t tx = embx_ir_tx_phy_descriptor_get_tx_index();
+	const embx_ir_tx_phy_descriptor_t *pd = NULL;
+	enum status_code status;
+
+	status = embx_ir_tx_phy_descriptor_next(&pd);
+	if( status == STATUS_OK ) {
+		if( pd->usec != fuzz_filled[tx] ) {
+			fuzz_fail("interval overwritten at tx index", tx);
+		}
+		if( (pd->max_repeat_cnt >= 0) && (pd->repeat_cnt > pd->max_repeat_cnt) ) {
+			fuzz_fail("repeat count", (uint32_t)pd->repeat_cnt);
+		}
+		if( fuzz_budget-- == 0 ) {
+			fuzz_fail("more intervals than filled and repeated at tx index", tx);
+		}
+	} else if( (status != STATUS_NO_CHANGE) && (status != STATUS_ERR_BAD_DATA) ) {
+		fuzz_fail("next status", (uint32_t)status);
+	}
+	fuzz_check_indices();
+	return status;
+}
+
+/**
+* @brief Fills a descriptor, the duration is made unique by the sequence number.
+*/
+static void fuzz_fill(bool reset, uint8_t a, uint8_t decrement)
+{
+	uint8_t free_n = embx_ir_tx_phy_descriptor_get_free();
+	uint8_t index = (reset == true) ? 0 : embx_ir_tx_phy_descriptor_get_fill_index();
+	uint32_t usec = fuzz_usec[a >> 5] + (++fuzz_seq * 2) + ((a >> 4) & 1);
+	int16_t repeat = a & 0x0F;
+	enum status_code status;
+
+	status = embx_ir_tx_phy_descriptor_fill(reset, ((a >> 4) & 1) ? mark : space, usec, repeat, decrement);
+	if( status == STATUS_OK ) {
+		fuzz_filled[index] = usec;
+		fuzz_budget += 1 + ((uint64_t)repeat * ((decrement < EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ) ? decrement : EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ));
+	} else if( (status != STATUS_ERR_OVERFLOW) || (reset == true) || (free_n != 0) ) {
+		fuzz_fail("fill status", (uint32_t)status);
+	}
+	fuzz_check_indices();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	fuzz_input_t in = { data, size, 0 };
+	uint64_t calls, limit;
+	uint32_t ops = 0;
+	uint8_t op, a, b;
+
+	fuzz_budget = 0;
+	fuzz_seq = 0;
+	embx_ir_tx_phy_descriptor_reset();
+	embx_ir_tx_phy_descriptor_set_correction(0);
+
+	while( (in.offset < in.size) && (ops++ < FUZZ_MAX_OPS) ) {
+		op = fuzz_byte(&in);
+		a = fuzz_byte(&in);
+		b = fuzz_byte(&in);
+		switch( op & 0x03 ) {
+			case 0: /** The main loop fills a descriptor, and resets the ring first */
+				fuzz_fill((op & 0x80) != 0, a, b);
+			break;
+			case 1: /** The interrupt of the PHY takes a few periods */
+				for( b = (b & 0x07) + 1; b > 0; b-- ) {
+					fuzz_next();
+				}
+			break;
+			case 2: /** A repeat requested from outside the ring */
+				embx_ir_tx_phy_decrement_tx_index(a);
+				fuzz_budget += a;
+				fuzz_check_indices();
+			break;
+			default: /** The main loop fills a descriptor without a repeat */
+				fuzz_fill(false, a & 0xF0, 0);
+			break;
+		}
+	}
+
+	/** The transmission must end */
+	limit = (fuzz_budget + 1) * FUZZ_MAX_PERIODS;
+	for( calls = 0; fuzz_next() != STATUS_ERR_BAD_DATA; calls++ ) {
+		if( calls > limit ) {
+			fuzz_fail("the transmission does not end, budget left", (uint32_t)fuzz_budget);
+		}
+	}
+	if( fuzz_next() != STATUS_ERR_BAD_DATA ) {
+		fuzz_fail("an interval after the end", 0);
+	}
+	return 0;
+}
@@ -0,0 +1,664 @@
+/**
+ * @file embx_hal_host.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The host backend of the hardware abstraction layer, a discrete time model of the TCs, the pins, and the EIC.
+ * @details Each running TC knows the number of ticks to its next event.  The model advances every TC to the earliest
+ * event of any TC or interrupt, applies the events due at that time, and serves the interrupts that are due.  An
+ * interrupt is a flag per source, it is raised once until it is served like the interrupt flags of the board.
+ */ 
+#include <string.h>
+#include "embx/embx_hal/embx_hal.h"
+
+/** The most interrupts waiting to be served */
+#define EMBX_HAL_HOST_IRQ_SZ		(16)
+/** The number of external interrupt channels */
+#define EMBX_HAL_HOST_EXTINT_N		(16)
+/** The counter of a TC is 16-bit */
+#define EMBX_HAL_HOST_TC_MAX		(0xFFFFUL)
+
+/** A modelled TC */
+typedef struct {
+	bool enabled;
+	bool running;
+	embx_hal_tc_wave_t wave;
+	uint16_t prescaler;
+	uint32_t phase; /** The GCLK ticks counted towards the next tick of the counter, the prescaler runs freely */
+	uint16_t count;
+	uint16_t cc[2];
+	bool wo1; /** The PWM output of channel 1 */
+	uint8_t match; /** A bit per channel, see embx_hal_tc_get_match */
+	embx_hal_tc_callback_t callback[EMBX_HAL_TC_CALLBACK_N];
+	uint8_t enabled_callbacks; /** A bit per callback type */
+} embx_hal_host_tc_t;
+
+/** A modelled pin */
+typedef struct {
+	bool output; /** A GPIO output */
+	bool out; /** The output register */
+	bool input; /** The level driven by embx_hal_host_set_input or the pull-up */
+	bool pmuxen;
+	uint8_t mux;
+} embx_hal_host_pin_t;
+
+/** A modelled external interrupt channel */
+typedef struct {
+	bool configured;
+	bool enabled;
+	uint8_t pin;
+	bool level; /** The level after the filter */
+	bool filtering; /** An edge waits for the filter */
+	uint64_t due; /** When the filter samples the pin */
+	embx_hal_extint_callback_t callback;
+} embx_hal_host_extint_t;
+
+/** An interrupt waiting to be served, source is a TC and a callback type or an external interrupt channel */
+typedef struct {
+	uint64_t due;
+	bool extint;
+	uint8_t source;
+	uint8_t type;
+} embx_hal_host_irq_t;
+
+static embx_hal_host_tc_t tc_model[EMBX_HAL_TC_N];
+static embx_hal_host_pin_t pin_model[EMBX_HAL_HOST_PINS];
+static embx_hal_host_extint_t extint_model[EMBX_HAL_HOST_EXTINT_N];
+static embx_hal_host_irq_t irq[EMBX_HAL_HOST_IRQ_SZ];
+static uint8_t irq_size;
+static uint64_t now;
+static uint32_t isr_latency;
+static uint32_t extint_filter;
+static embx_hal_host_pin_callback_t pin_callback;
+static embx_hal_host_probe_t probe;
+/** The critical sections entered and not left */
+static uint8_t critical_depth;
+
+/** The TC outputs that can be routed to a pin */
+static const struct {
+	uint8_t pin;
+	uint8_t mux;
+	embx_hal_tc_t tc;
+	uint8_t wo;
+} pin_function[] = {
+	{ PIN_PA22E_TC4_WO0, MUX_PA22E_TC4_WO0, EMBX_HAL_TC4, 0 },
+	{ PIN_PA23E_TC4_WO1, MUX_PA23E_TC4_WO1, EMBX_HAL_TC4, 1 },
+	{ PIN_PB08E_TC4_WO0, MUX_PB08E_TC4_WO0, EMBX_HAL_TC4, 0 },
+	{ PIN_PB09E_TC4_WO1, MUX_PB09E_TC4_WO1, EMBX_HAL_TC4, 1 },
+};
+
+/**
+* @brief Raises an interrupt unless the same source is already waiting.
+*/
+static void embx_hal_host_raise(bool extint, uint8_t source, uint8_t type)
+{
+	uint8_t i;
+
+	for( i = 0; i < irq_size; i++ ) {
+		if( (irq[i].extint == extint) && (irq[i].source == source) && (irq[i].type == type) ) {
+			return;
+		}
+	}
+	if( irq_size < EMBX_HAL_HOST_IRQ_SZ ) {
+		irq[irq_size].due = now + isr_latency;
+		irq[irq_size].extint = extint;
+		irq[irq_size].source = source;
+		irq[irq_size].type = type;
+		irq_size++;
+	}
+}
+
+/**
+* @brief An event of a TC, the interrupt is raised if its callback is enabled.
+*/
+static void embx_hal_host_tc_event(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type)
+{
+	if( (tc_model[tc].enabled_callbacks & (1 << type)) != 0 ) {
+		embx_hal_host_raise(false, (uint8_t)tc, (uint8_t)type);
+	}
+}
+
+/** @brief Returns the top value of a TC */
+static inline uint32_t embx_hal_host_top(const embx_hal_host_tc_t *t)
+{
+	if( (t->wave == EMBX_HAL_TC_WAVE_NORMAL_FREQ) || (t->count > t->cc[0]) ) {
+		return EMBX_HAL_HOST_TC_MAX; /** A count past the top runs to the maximum */
+	}
+	return t->cc[0];
+}
+
+/**
+* @brief Returns the ticks of the counter until it reaches a value, a full period if it is already there.
+*/
+static uint32_t embx_hal_host_ticks_to(const embx_hal_host_tc_t *t, uint32_t value)
+{
+	uint32_t top = embx_hal_host_top(t);
+
+	if( value > top ) {
+		return UINT32_MAX;
+	}
+	return (value > t->count) ? (value - t->count) : (top + 1 - t->count + value);
+}
+
+/**
+* @brief Returns the GCLK ticks until the next event of a TC, UINT64_MAX if it has none.
+*/
+static uint64_t embx_hal_host_tc_next(const embx_hal_host_tc_t *t)
+{
+	uint32_t ticks = embx_hal_host_ticks_to(t, 0); /** The wrap */
+	uint32_t match;
+	uint8_t ch;
+
+	if( (t->enabled == false) || (t->running == false) ) {
+		return UINT64_MAX;
+	}
+	for( ch = 0; ch < 2; ch++ ) {
+		match = embx_hal_host_ticks_to(t, t->cc[ch]);
+		if( match < ticks ) {
+			ticks = match;
+		}
+	}
+	return ((uint64_t)ticks * t->prescaler) - t->phase;
+}
+
+/**
+* @brief Advances a TC by GCLK ticks that do not reach its next event.
+*/
+static void embx_hal_host_tc_advance(embx_hal_host_tc_t *t, uint64_t ticks)
+{
+	uint64_t total;
+
+	if( (t->enabled == false) || (t->running == false) ) {
+		return;
+	}
+	total = t->phase + ticks;
+	t->count = (uint16_t)(t->count + (total / t->prescaler));
+	t->phase = (uint32_t)(total % t->prescaler);
+}
+
+/**
+* @brief Applies the events of a TC whose counter is about to tick into an event, i.e. its next event is due now.
+*/
+static void embx_hal_host_tc_tick(embx_hal_tc_t tc)
+{
+	embx_hal_host_tc_t *t = &tc_model[tc];
+	bool wo1 = t->wo1;
+
+	t->phase = 0;
+	if( t->count >= embx_hal_host_top(t) ) {
+		t->count = 0;
+		switch( t->wave ) {
+			case EMBX_HAL_TC_WAVE_MATCH_FREQ:
+				t->match |= 1;
+				embx_hal_host_tc_event(tc, EMBX_HAL_TC_CALLBACK_CC0);
+			break;
+			case EMBX_HAL_TC_WAVE_MATCH_PWM:
+				t->wo1 = true; /** The update at the wrap */
+			break;
+			default:
+			break;
+		}
+		embx_hal_host_tc_event(tc, EMBX_HAL_TC_CALLBACK_OVERFLOW);
+	} else {
+		t->count++;
+	}
+	if( (t->wave == EMBX_HAL_TC_WAVE_NORMAL_FREQ) && (t->count == t->cc[0]) ) {
+		t->match |= 1;
+		embx_hal_host_tc_event(tc, EMBX_HAL_TC_CALLBACK_CC0);
+	}
+	if( t->count == t->cc[1] ) {
+		t->wo1 = false;
+		t->match |= 2;
+		embx_hal_host_tc_event(tc, EMBX_HAL_TC_CALLBACK_CC1);
+	}
+	if( (t->wo1 != wo1) && (probe != NULL) ) {
+		probe();
+	}
+}
+
+/**
+* @brief Serves the interrupt that is due first, returns false if none is due.
+*/
+static bool embx_hal_host_serve(void)
+{
+	embx_hal_host_irq_t served;
+	uint8_t i, first = 0;
+
+	if( irq_size == 0 ) {
+		return false;
+	}
+	for( i = 1; i < irq_size; i++ ) {
+		if( irq[i].due < irq[first].due ) {
+			first = i;
+		}
+	}
+	if( irq[first].due > now ) {
+		return false;
+	}
+	served = irq[first];
+	for( i = first; (i + 1) < irq_size; i++ ) {
+		irq[i] = irq[i + 1];
+	}
+	irq_size--;
+
+	if( served.extint == true ) {
+		if( (extint_model[served.source].enabled == true) && (extint_model[served.source].callback != NULL) ) {
+			extint_model[served.source].callback(served.source);
+		}
+	} else if( ((tc_model[served.source].enabled_callbacks & (1 << served.type)) != 0) && 
+			   (tc_model[served.source].callback[served.type] != NULL) ) {
+		if( served.type == EMBX_HAL_TC_CALLBACK_CC0 ) { /** The handler clears the flag it serves */
+			tc_model[served.source].match &= (uint8_t)~1;
+		} else if( served.type == EMBX_HAL_TC_CALLBACK_CC1 ) {
+			tc_model[served.source].match &= (uint8_t)~2;
+		}
+		tc_model[served.source].callback[served.type]((embx_hal_tc_t)served.source);
+	}
+	if( probe != NULL ) {
+		probe();
+	}
+	return true;
+}
+
+/**
+* @brief Detects the edges that have passed the filter, a level that did not hold for the filter time is ignored.
+*/
+static void embx_hal_host_detect(void)
+{
+	embx_hal_host_extint_t *e;
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_HAL_HOST_EXTINT_N; channel++ ) {
+		e = &extint_model[channel];
+		if( (e->filtering == false) || (e->due > now) ) {
+			continue;
+		}
+		e->filtering = false;
+		if( e->level != pin_model[e->pin].input ) {
+			e->level = pin_model[e->pin].input;
+			if( e->enabled == true ) {
+				embx_hal_host_raise(true, channel, 0);
+			}
+		}
+	}
+}
+
+/**
+* @brief Notifies the pin callback if the level of a pin changed.
+*/
+static void embx_hal_host_pin_changed(uint8_t pin, bool before)
+{
+	bool level = embx_hal_host_get_pin(pin);
+
+	if( (level != before) && (pin_callback != NULL) ) {
+		pin_callback(pin, level);
+	}
+}
+
+void embx_hal_host_reset(void)
+{
+	memset(tc_model, 0, sizeof(tc_model));
+	memset(pin_model, 0, sizeof(pin_model));
+	memset(extint_model, 0, sizeof(extint_model));
+	irq_size = 0;
+	now = 0;
+	isr_latency = 0;
+	extint_filter = 0;
+	pin_callback = NULL;
+	probe = NULL;
+}
+
+/**
+* @brief Advances the time by a number of GCLK ticks, the events and the interrupts in between are served in order.
+*/
+void embx_hal_host_run(uint64_t ticks)
+{
+	uint64_t end = now + ticks;
+	uint64_t next, step, due[EMBX_HAL_TC_N];
+	uint8_t tc, i;
+
+	while( 1 ) {
+		embx_hal_host_detect();
+		while( embx_hal_host_serve() == true ) ;
+
+		next = UINT64_MAX;
+		for( tc = 0; tc < EMBX_HAL_TC_N; tc++ ) {
+			step = embx_hal_host_tc_next(&tc_model[tc]);
+			if( (step != UINT64_MAX) && ((now + step) < next) ) {
+				next = now + step;
+			}
+		}
+		for( i = 0; i < irq_size; i++ ) {
+			if( irq[i].due < next ) {
+				next = irq[i].due;
+			}
+		}
+		for( i = 0; i < EMBX_HAL_HOST_EXTINT_N; i++ ) {
+			if( (extint_model[i].filtering == true) && (extint_model[i].due < next) ) {
+				next = extint_model[i].due;
+			}
+		}
+		if( next > end ) {
+			for( tc = 0; tc < EMBX_HAL_TC_N; tc++ ) {
+				embx_hal_host_tc_advance(&tc_model[tc], end - now);
+			}
+			now = end;
+			break;
+		}
+		/** Advance to one GCLK tick before the event, then apply the tick of every TC due now */
+		for( tc = 0; tc < EMBX_HAL_TC_N; tc++ ) {
+			due[tc] = embx_hal_host_tc_next(&tc_model[tc]);
+			if( (due[tc] != UINT64_MAX) && ((now + due[tc]) == next) ) {
+				embx_hal_host_tc_advance(&tc_model[tc], due[tc] - 1);
+			} else {
+				embx_hal_host_tc_advance(&tc_model[tc], next - now);
+				due[tc] = UINT64_MAX;
+			}
+		}
+		now = next;
+		for( tc = 0; tc < EMBX_HAL_TC_N; tc++ ) {
+			if( due[tc] != UINT64_MAX ) {
+				embx_hal_host_tc_tick((embx_hal_tc_t)tc);
+			}
+		}
+	}
+}
+
+uint64_t embx_hal_host_get_time(void)
+{
+	return now;
+}
+
+void embx_hal_host_set_isr_latency(uint32_t ticks)
+{
+	isr_latency = ticks;
+}
+
+void embx_hal_host_set_extint_filter(uint32_t ticks)
+{
+	extint_filter = ticks;
+}
+
+/**
+* @brief Returns the level of a pin.
+*/
+bool embx_hal_host_get_pin(uint8_t pin)
+{
+	const embx_hal_host_pin_t *p = &pin_model[pin];
+	uint8_t i;
+
+	if( p->pmuxen == true ) {
+		for( i = 0; i < (sizeof(pin_function) / sizeof(pin_function[0])); i++ ) {
+			if( (pin_function[i].pin == pin) && (pin_function[i].mux == p->mux) ) {
+				return (pin_function[i].wo == 1) && tc_model[pin_function[i].tc].wo1;
+			}
+		}
+		return p->input;
+	}
+	return (p->output == true) ? p->out : p->input;
+}
+
+/**
+* @brief Drives an input pin, an edge is detected by the external interrupt channel of the pin after the filter.
+*/
+void embx_hal_host_set_input(uint8_t pin, bool level)
+{
+	embx_hal_host_extint_t *e;
+	uint8_t channel;
+
+	if( pin_model[pin].input == level ) {
+		return;
+	}
+	pin_model[pin].input = level;
+	for( channel = 0; channel < EMBX_HAL_HOST_EXTINT_N; channel++ ) {
+		e = &extint_model[channel];
+		if( (e->configured == true) && (e->pin == pin) && (e->filtering == false) ) {
+			e->filtering = true;
+			e->due = now + extint_filter;
+		}
+	}
+	embx_hal_host_detect();
+	if( probe != NULL ) {
+		probe();
+	}
+}
+
+void embx_hal_host_set_pin_callback(embx_hal_host_pin_callback_t callback)
+{
+	pin_callback = callback;
+}
+
+void embx_hal_host_set_probe(embx_hal_host_probe_t callback)
+{
+	probe = callback;
+}
+
+bool embx_hal_host_tc_running(uint8_t tc)
+{
+	return tc_model[tc].enabled && tc_model[tc].running;
+}
+
+void embx_hal_enter_critical_section(void)
+{
+	critical_depth++;
+}
+
+void embx_hal_leave_critical_section(void)
+{
+	critical_depth--;
+}
+
+uint8_t embx_hal_host_get_critical_depth(void)
+{
+	return critical_depth;
+}
+
+/** @brief Runs the model for the time instead of waiting */
+void embx_hal_delay_ms(uint32_t ms)
+{
+	embx_hal_host_run((uint64_t)ms * (EMBX_HAL_HOST_GCLK_HZ / 1000));
+}
+
+void embx_hal_cycles_init(void)
+{
+}
+
+uint32_t embx_hal_get_cycles(void)
+{
+	return (uint32_t)(now * (EMBX_HAL_HOST_CPU_HZ / EMBX_HAL_HOST_GCLK_HZ)) & EMBX_HAL_CYCLES_MASK;
+}
+
+uint32_t embx_hal_get_cpu_hz(void)
+{
+	return EMBX_HAL_HOST_CPU_HZ;
+}
+
+void embx_hal_tc_get_config_defaults(embx_hal_tc_config_t *config)
+{
+	config->gclk = GCLK_GENERATOR_0;
+	config->prescaler = 1;
+	config->wave = EMBX_HAL_TC_WAVE_NORMAL_FREQ;
+	config->cc[0] = 0;
+	config->cc[1] = 0;
+}
+
+/**
+* @brief Initializes a TC with a configuration, the TC is enabled and its counter stopped.
+*/
+enum status_code embx_hal_tc_init(embx_hal_tc_t tc, const embx_hal_tc_config_t *config)
+{
+	embx_hal_host_tc_t *t = &tc_model[tc];
+
+	switch( config->prescaler ) {
+		case 1: case 2: case 4: case 8: case 16: case 64: case 256: case 1024:
+		break;
+		default:
+			return STATUS_ERR_INVALID_ARG;
+	}
+	memset(t, 0, sizeof(*t));
+	t->wave = config->wave;
+	t->prescaler = config->prescaler;
+	t->cc[0] = config->cc[0];
+	t->cc[1] = config->cc[1];
+	t->enabled = true;
+	return STATUS_OK;
+}
+
+void embx_hal_tc_enable(embx_hal_tc_t tc)
+{
+	tc_model[tc].enabled = true;
+}
+
+void embx_hal_tc_disable(embx_hal_tc_t tc)
+{
+	tc_model[tc].enabled = false;
+}
+
+void embx_hal_tc_reset(embx_hal_tc_t tc)
+{
+	memset(&tc_model[tc], 0, sizeof(tc_model[tc]));
+	tc_model[tc].prescaler = 1;
+}
+
+/** @brief Resumes a stopped counter from its count, restarts a running one from 0 */
+void embx_hal_tc_start(embx_hal_tc_t tc)
+{
+	if( tc_model[tc].running == true ) {
+		tc_model[tc].count = 0;
+	}
+	tc_model[tc].phase = (uint32_t)(now % tc_model[tc].prescaler);
+	tc_model[tc].running = true;
+}
+
+/** @brief Stops the counter and resets the count to 0, the outputs keep their levels */
+void embx_hal_tc_stop(embx_hal_tc_t tc)
+{
+	tc_model[tc].running = false;
+	tc_model[tc].count = 0;
+}
+
+uint32_t embx_hal_tc_get_count(embx_hal_tc_t tc)
+{
+	return tc_model[tc].count;
+}
+
+void embx_hal_tc_set_count(embx_hal_tc_t tc, uint32_t count)
+{
+	tc_model[tc].count = (uint16_t)count;
+}
+
+void embx_hal_tc_set_top(embx_hal_tc_t tc, uint32_t top)
+{
+	tc_model[tc].cc[0] = (uint16_t)top;
+}
+
+void embx_hal_tc_set_compare(embx_hal_tc_t tc, uint8_t channel, uint32_t compare)
+{
+	tc_model[tc].cc[channel] = (uint16_t)compare;
+}
+
+bool embx_hal_tc_get_match(embx_hal_tc_t tc, uint8_t channel)
+{
+	bool match = (tc_model[tc].match & (1 << channel)) != 0;
+
+	embx_hal_tc_clear_match(tc, channel);
+	return match;
+}
+
+/** @brief Clears the match flag, it is the interrupt flag so an interrupt of the channel that is waiting is not served */
+void embx_hal_tc_clear_match(embx_hal_tc_t tc, uint8_t channel)
+{
+	embx_hal_tc_callback_type_t type = (channel == 0) ? EMBX_HAL_TC_CALLBACK_CC0 : EMBX_HAL_TC_CALLBACK_CC1;
+	uint8_t i, n = 0;
+
+	tc_model[tc].match &= (uint8_t)~(1 << channel);
+	for( i = 0; i < irq_size; i++ ) {
+		if( (irq[i].extint == true) || (irq[i].source != (uint8_t)tc) || (irq[i].type != (uint8_t)type) ) {
+			irq[n++] = irq[i];
+		}
+	}
+	irq_size = n;
+}
+
+void embx_hal_tc_register_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type, embx_hal_tc_callback_t callback)
+{
+	tc_model[tc].callback[type] = callback;
+}
+
+void embx_hal_tc_enable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type)
+{
+	tc_model[tc].enabled_callbacks |= (uint8_t)(1 << type);
+}
+
+void embx_hal_tc_disable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type)
+{
+	tc_model[tc].enabled_callbacks &= (uint8_t)~(1 << type);
+}
+
+void embx_hal_pin_config_output(uint8_t pin, bool level)
+{
+	bool before = embx_hal_host_get_pin(pin);
+
+	pin_model[pin].output = true;
+	pin_model[pin].pmuxen = false;
+	pin_model[pin].out = level;
+	embx_hal_host_pin_changed(pin, before);
+}
+
+void embx_hal_pin_set_level(uint8_t pin, bool level)
+{
+	bool before = embx_hal_host_get_pin(pin);
+
+	pin_model[pin].out = level;
+	embx_hal_host_pin_changed(pin, before);
+}
+
+bool embx_hal_pin_get_level(uint8_t pin)
+{
+	return embx_hal_host_get_pin(pin);
+}
+
+void embx_hal_pin_select_mux(uint8_t pin, uint32_t mux)
+{
+	bool before = embx_hal_host_get_pin(pin);
+
+	pin_model[pin].mux = (uint8_t)mux;
+	pin_model[pin].pmuxen = false;
+	embx_hal_host_pin_changed(pin, before);
+}
+
+void embx_hal_pin_enable_mux(uint8_t pin, bool enable)
+{
+	bool before = embx_hal_host_get_pin(pin);
+
+	pin_model[pin].pmuxen = enable;
+	embx_hal_host_pin_changed(pin, before);
+}
+
+/**
+* @brief Configures an external interrupt channel on a pin, the pull-up makes the input high.
+*/
+void embx_hal_extint_init(uint8_t channel, uint8_t pin, uint32_t mux, embx_hal_extint_callback_t callback)
+{
+	extint_model[channel].configured = true;
+	extint_model[channel].enabled = false;
+	extint_model[channel].pin = pin;
+	extint_model[channel].level = true;
+	extint_model[channel].filtering = false;
+	extint_model[channel].callback = callback;
+	pin_model[pin].output = false;
+	pin_model[pin].mux = (uint8_t)mux;
+	pin_model[pin].pmuxen = true;
+	pin_model[pin].input = true;
+}
+
+void embx_hal_extint_enable_callback(uint8_t channel)
+{
+	extint_model[channel].enabled = true;
+}
+
+void embx_hal_extint_disable_callback(uint8_t channel)
+{
+	extint_model[channel].enabled = false;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file embx_hal_host.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The host backend of the hardware abstraction layer, included by embx_hal.h when EMBX_HAL_HOST is defined.
+ * @details The backend is a discrete time model of the peripherals.  Time is counted in ticks of the GCLK, every 
+ * generator runs at EMBX_HAL_HOST_GCLK_HZ like GCLK 3 of the board.  embx_hal_host_run advances the TCs from one 
+ * event to the next, it does not step through the ticks in between, so long transmissions run fast.  
+ * An event whose callback is enabled raises an interrupt that is served after the interrupt latency, the counters
+ * keep running meanwhile.  The prescaler of a TC runs freely, the first tick after a start comes within a prescaler
+ * period.  An edge on an external interrupt pin is detected once the level has held for the filter time.  The interrupts are only served by embx_hal_host_run and embx_hal_delay_ms, so the 
+ * critical sections have nothing to do.
+ *
+ * A pin is driven by the TC output it is routed to while its multiplexer is enabled, by its output register while 
+ * it is a GPIO output, and otherwise by embx_hal_host_set_input.  An input with the pull-up of an external interrupt
+ * is high until it is driven.
+ */ 
+#ifndef EMBX_HAL_HOST_H_
+#define EMBX_HAL_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "status_codes.h"
+
+/** The frequency of every GCLK generator */
+#define EMBX_HAL_HOST_GCLK_HZ		(8000000UL)
+/** The frequency of the CPU clock, the DFLL of the board */
+#define EMBX_HAL_HOST_CPU_HZ		(48000000UL)
+/** The number of pins modelled, PORT A and PORT B */
+#define EMBX_HAL_HOST_PINS			(64)
+
+/** The pins and the multiplexer settings of the board used by the embx modules, see samd21g18a.h */
+#define PIN_PA18A_EIC_EXTINT2		(18L)
+#define MUX_PA18A_EIC_EXTINT2		(0L)
+#define PIN_PA21					(21L)
+#define PIN_PA22E_TC4_WO0			(22L)
+#define MUX_PA22E_TC4_WO0			(4L)
+#define PIN_PA23E_TC4_WO1			(23L)
+#define MUX_PA23E_TC4_WO1			(4L)
+#define PIN_PB08E_TC4_WO0			(40L)
+#define MUX_PB08E_TC4_WO0			(4L)
+#define PIN_PB09E_TC4_WO1			(41L)
+#define MUX_PB09E_TC4_WO1			(4L)
+
+enum gclk_generator {
+	GCLK_GENERATOR_0,
+	GCLK_GENERATOR_1,
+	GCLK_GENERATOR_2,
+	GCLK_GENERATOR_3,
+};
+
+/** @brief Called when the level of a pin changes by its output register or its multiplexer, see embx_hal_host_set_pin_callback */
+typedef void (*embx_hal_host_pin_callback_t)(uint8_t pin, bool level);
+
+/** @brief Called after the model changed what a module can observe, see embx_hal_host_set_probe */
+typedef void (*embx_hal_host_probe_t)(void);
+
+/**
+* @brief Returns every peripheral to its reset state, the time to 0, and the interrupt latency and the filter to 0.
+*/
+extern void embx_hal_host_reset(void);
+
+/**
+* @brief Advances the time by a number of GCLK ticks, the events and the interrupts in between are served in order.
+*/
+extern void embx_hal_host_run(uint64_t ticks);
+
+/** @brief Returns the time in GCLK ticks since the reset */
+extern uint64_t embx_hal_host_get_time(void);
+
+/** @brief Sets the time in GCLK ticks from an event to the call of its callback */
+extern void embx_hal_host_set_isr_latency(uint32_t ticks);
+
+/** 
+* @brief Sets the time in GCLK ticks that an external interrupt input has to hold a new level before its edge is 
+* detected, like the majority filter of the EIC.  A shorter pulse is not detected.
+*/
+extern void embx_hal_host_set_extint_filter(uint32_t ticks);
+
+/** @brief Returns the level of a pin */
+extern bool embx_hal_host_get_pin(uint8_t pin);
+
+/** @brief Drives an input pin, an edge raises the interrupt of the external interrupt channel of the pin */
+extern void embx_hal_host_set_input(uint8_t pin, bool level);
+
+/**
+* @brief Sets a function called when the level of a pin changes by its output register or its multiplexer, e.g. to 
+* connect an output to an input.  The edges of a TC output on a connected pin are not reported.  NULL removes it.
+*/
+extern void embx_hal_host_set_pin_callback(embx_hal_host_pin_callback_t callback);
+
+/**
+* @brief Sets a function called after every interrupt served, every edge of a TC output, and every change of an input
+* driven by embx_hal_host_set_input, e.g. to sample the pins and the state of the modules into a waveform.  The edges of 
+* a carrier call it twice a period.  NULL removes it.
+*/
+extern void embx_hal_host_set_probe(embx_hal_host_probe_t probe);
+/** @brief Returns true while the counter of a TC runs */
+extern bool embx_hal_host_tc_running(uint8_t tc);
+/** @brief Returns the number of critical sections that have been entered and not left */
+extern uint8_t embx_hal_host_get_critical_depth(void);
+
+#endif /* EMBX_HAL_HOST_H_ */
@@ -0,0 +1,136 @@
+/**
+ * @file test_analyzer.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Proposes the protocols of NEC, SIRC, and RC5 captures with the analyzer.
+ * @details The captures of a protocol are frames of random data with a different jitter on every edge.  The proposal
+ * must have the encoding, the number of bits, and a unit within 10 percent of the nominal one.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_analyzer.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+#define CAPTURES		(8)
+#define JITTER_USEC		(40)
+
+static embx_ir_analyzer_t analyzer;
+static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+static uint16_t elem_n;
+static uint32_t seed = 1;
+static uint16_t failures;
+
+/** The protocol layer is linked for the decoder, nothing is transmitted */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+static uint32_t random32(void)
+{
+	seed = (seed * 1103515245UL) + 12345UL;
+	return seed >> 8;
+}
+
+/**
+* @brief Appends an interval off by -JITTER_USEC to JITTER_USEC, an interval of the same type is merged into the previous one.
+*/
+static void add(bool is_mark, uint32_t usec)
+{
+	const uint8_t state = (is_mark == true) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+
+	usec = usec + (random32() % ((2 * JITTER_USEC) + 1)) - JITTER_USEC;
+	if( (elem_n != 0) && (elem[elem_n - 1].gpio_state == state) ) {
+		elem[elem_n - 1].time_us += usec;
+		return;
+	}
+	elem[elem_n].gpio_state = state;
+	elem[elem_n].time_us = usec;
+	elem[elem_n].ticks = 0;
+	elem_n++;
+}
+
+/** NEC, pulse distance with a header and a trailer */
+static void capture_nec(void)
+{
+	uint32_t data = random32();
+	uint8_t b;
+
+	add(true, 9000);
+	add(false, 4500);
+	for( b = 0; b < 32; b++ ) {
+		add(true, 560);
+		add(false, (((data >> b) & 1) != 0) ? 1690 : 560);
+	}
+	add(true, 560);
+}
+
+/** SIRC, pulse width with a header, the last MARK is the last bit */
+static void capture_sirc(void)
+{
+	uint32_t data = random32();
+	uint8_t b;
+
+	add(true, 2400);
+	add(false, 600);
+	for( b = 0; b < 12; b++ ) {
+		add(true, (((data >> b) & 1) != 0) ? 1200 : 600);
+		if( b < 11 ) {
+			add(false, 600);
+		}
+	}
+}
+
+/** RC5, Manchester without a header, the start bit is a 1 so the frame starts with a MARK */
+static void capture_rc5(void)
+{
+	uint32_t data = random32() | (1UL << 13);
+	uint8_t b;
+	bool one;
+
+	for( b = 0; b < 14; b++ ) {
+		one = ((data >> (13 - b)) & 1) != 0;
+		add(one, 889);
+		add(!one, 889);
+	}
+	if( elem[elem_n - 1].gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE ) {
+		elem_n--; /** A trailing SPACE merges with the idle line */
+	}
+}
+
+static void propose(const char *name, void (*capture)(void), embx_ir_protocol_encoding_t encoding, uint16_t unit_usec,
+					uint16_t nbits)
+{
+	embx_ir_protocol_t protocol;
+	enum status_code status;
+	uint8_t k;
+
+	embx_ir_analyzer_init(&analyzer);
+	for( k = 0; k < CAPTURES; k++ ) {
+		elem_n = 0;
+		capture();
+		embx_ir_analyzer_add_frame(&analyzer, elem, elem_n);
+	}
+	status = embx_ir_analyzer_propose(&analyzer, elem, elem_n, &protocol);
+	if( (status != STATUS_OK) || (protocol.encoding != encoding) || (protocol.nbits != nbits) ||
+		((protocol.unit_usec * 10) < (unit_usec * 9)) || ((protocol.unit_usec * 10) > (unit_usec * 11)) ) {
+		printf("FAIL %s: status %d, encoding %d, unit %u usec, %u bits, expected encoding %d, unit %u usec, %u bits\n",
+			   name, status, protocol.encoding, protocol.unit_usec, protocol.nbits, encoding, unit_usec, nbits);
+		failures++;
+	}
+}
+
+int main(void)
+{
+	propose("nec", capture_nec, EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE, 560, 32);
+	propose("sirc", capture_sirc, EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH, 600, 12);
+	propose("rc5", capture_rc5, EMBX_IR_PROTOCOL_ENCODING_MANCHESTER, 889, 14);
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_analyzer passed\n");
+	return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_bench_isr.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Checks the bookkeeping of the interrupt handler harness, and that the handlers of the PHYs are measured.
+ * @details Built with EMBX_BENCH_ISR.  The durations are recorded by hand: the min, the max, the mean, the bins, the
+ * last bin, and the wrap of the counter.  Then a frame is looped back from the Tx PHY to the Rx PHY as in
+ * test_hal_loopback, every interrupt of the PHYs is counted once.  The handlers take no modelled time on the host, their
+ * durations are 0.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_digital_io/digital_output.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+#include "embx/embx_bench/embx_bench_isr.h"
+
+/** The header of a NEC frame, 6 bits, and the stop mark */
+static const uint32_t frame[] = { 9000, 4500, 560, 560, 560, 1690, 560, 560, 560, 1690, 560, 1690, 560, 560, 560 };
+#define FRAME_SZ			(sizeof(frame) / sizeof(frame[0]))
+
+static uint16_t failures;
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief The IR receiver, its output is low while the debug pin of the Tx PHY is high.
+*/
+static void receiver(uint8_t pin, bool level)
+{
+	if( pin == DEBUG_IR_TX_PHY_PIN ) {
+		embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, !level);
+	}
+}
+
+static void test_bookkeeping(void)
+{
+	embx_bench_isr_stats_t stats;
+	uint32_t bins = 0;
+	uint8_t i;
+
+	embx_bench_isr_init();
+	check("overhead", (embx_bench_isr_get_overhead() == 0) && (embx_bench_isr_get_cost() == 0));
+	embx_bench_isr_get(EMBX_BENCH_ISR_RX_GPIO, &stats);
+	check("calibration cleared", (stats.count == 0) && (stats.min == UINT32_MAX) && (stats.max == 0) && (stats.sum == 0));
+	check("mean of none", embx_bench_isr_get_mean(&stats) == 0);
+
+	embx_bench_isr_record(EMBX_BENCH_ISR_TX_PHY, 100);
+	embx_bench_isr_record(EMBX_BENCH_ISR_TX_PHY, 15);
+	embx_bench_isr_record(EMBX_BENCH_ISR_TX_PHY, 16);
+	embx_bench_isr_record(EMBX_BENCH_ISR_TX_PHY, 100000); /** Past the last bin */
+	embx_bench_isr_record(EMBX_BENCH_ISR_TX_PHY, (uint32_t)(5 - (EMBX_HAL_CYCLES_MASK - 2))); /** The counter wrapped */
+	embx_bench_isr_get(EMBX_BENCH_ISR_TX_PHY, &stats);
+	check("count", stats.count == 5);
+	check("min", stats.min == 8);
+	check("max", stats.max == 100000);
+	check("sum", stats.sum == (100 + 15 + 16 + 100000 + 8));
+	check("mean", embx_bench_isr_get_mean(&stats) == ((100 + 15 + 16 + 100000 + 8) / 5));
+	check("bins", (stats.hist[0] == 2) && (stats.hist[1] == 1) && (stats.hist[100 >> EMBX_BENCH_ISR_BIN_SHIFT] == 1) &&
+				  (stats.hist[EMBX_BENCH_ISR_BINS - 1] == 1));
+	for( i = 0; i < EMBX_BENCH_ISR_BINS; i++ ) {
+		bins += stats.hist[i];
+	}
+	check("bins sum", bins == stats.count);
+	embx_bench_isr_get(EMBX_BENCH_ISR_RX_PHY, &stats);
+	check("other handler", stats.count == 0);
+
+	embx_bench_isr_reset();
+	embx_bench_isr_get(EMBX_BENCH_ISR_TX_PHY, &stats);
+	check("reset", (stats.count == 0) && (stats.min == UINT32_MAX) && (stats.sum == 0) && (stats.hist[0] == 0));
+}
+
+static void test_handlers(void)
+{
+	embx_bench_isr_stats_t stats[EMBX_BENCH_ISR_N];
+	embx_ir_rx_buf_t *buf;
+	uint8_t h, i;
+
+	embx_hal_host_reset();
+	embx_hal_host_set_pin_callback(receiver);
+	embx_ir_tx_phy_init(KHz_38);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	embx_hal_delay_ms(50); /** The line is idle for longer than the sync delay */
+	embx_bench_isr_init();
+
+	for( i = 0; i < FRAME_SZ; i++ ) {
+		embx_ir_tx_phy_descriptor_fill((i == 0), ((i & 1) == 0) ? mark : space, frame[i], 0, 0);
+	}
+	check("send", embx_ir_tx_phy_send() == STATUS_OK);
+	embx_hal_delay_ms(100 + (EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE * 110));
+	check("received", (embx_ir_rx_buf_get_full(&buf) == STATUS_OK) && (buf->size == FRAME_SZ));
+	embx_ir_rx_buf_release();
+
+	for( h = 0; h < EMBX_BENCH_ISR_N; h++ ) {
+		embx_bench_isr_get(h, &stats[h]);
+		if( stats[h].count != 0 ) {
+			check(embx_bench_isr_names[h], (stats[h].max == 0) && (stats[h].hist[0] == stats[h].count));
+		}
+	}
+	/** An interrupt at the end of each interval, the last one stops the Tx PHY */
+	check("tx_phy count", stats[EMBX_BENCH_ISR_TX_PHY].count == FRAME_SZ);
+	/** An edge at the start and at the end of each MARK */
+	check("rx_gpio count", stats[EMBX_BENCH_ISR_RX_GPIO].count == (FRAME_SZ + 1));
+	check("rx_phy count", stats[EMBX_BENCH_ISR_RX_PHY].count >= EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE);
+}
+
+int main(void)
+{
+	embx_hal_host_reset();
+	test_bookkeeping();
+	test_handlers();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_bench_isr passed\n");
+	return 0;
+}
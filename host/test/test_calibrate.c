@@ -0,0 +1,214 @@
+/**
+ * @file test_calibrate.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Runs a calibration session on the host against a model of the loopback and checks the derived corrections.
+ * @details The test plays the role of both PHYs.  A send replays the descriptor queue, lengthens every interval by 
+ * the interrupt latency of the Tx PHY, stretches the marks of the receiver, and quantizes the edges to the ticks of
+ * the Rx PHY with a phase that changes from capture to capture.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_calibrate.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+
+/** The interrupt latency of the Tx PHY in usec added to every interval */
+#define MODEL_LATENCY_USEC		(13)
+/** The time in usec that the receiver stretches a mark */
+#define MODEL_STRETCH_USEC		(45)
+
+static embx_ir_rx_buf_t capture;
+static bool capture_full;
+static uint32_t sends;
+static int16_t mark_stretch;
+static uint16_t failures;
+
+/** The test bench of the module initializes the PHYs, the models need no initialization */
+void embx_ir_tx_phy_init(uint32_t carrier_hz)
+{
+	(void)carrier_hz;
+}
+
+void embx_ir_rx_phy_init(void)
+{
+}
+
+void embx_ir_rx_phy_enable(void)
+{
+}
+
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+/**
+* @brief Transmits the descriptor queue into the model of the loopback, the capture is complete at once.
+*/
+enum status_code embx_ir_tx_phy_send(void)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint32_t t = 1000 + ((sends * 3) % EMBX_IR_RX_PHY_USEC_PER_TICK); /** The time of the leading edge */
+	uint32_t edge, last = 0, period_usec = 0;
+	int16_t n = -1;
+
+	capture.size = 0;
+	status = embx_ir_tx_phy_descriptor_next(&pd);
+	while( status != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_OK ) {
+			if( n >= 0 ) {
+				t += MODEL_LATENCY_USEC;
+			}
+			/** The receiver output changes at the end of the previous interval, late by the stretch after a mark */
+			edge = ((n >= 0) && (capture.elem[n].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK)) ? (t + MODEL_STRETCH_USEC) : t;
+			if( n >= 0 ) {
+				capture.elem[n].ticks = (edge / EMBX_IR_RX_PHY_USEC_PER_TICK) - last;
+			}
+			last = edge / EMBX_IR_RX_PHY_USEC_PER_TICK;
+			n++;
+			capture.elem[n].gpio_state = (pd->phy_interval_type == mark) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+			period_usec = (pd->period + 1UL) * EMBX_IR_TX_PHY_USEC_PER_TICK;
+		}
+		t += period_usec;
+		status = embx_ir_tx_phy_descriptor_next(&pd);
+	}
+	/** The last mark ends when the interrupt stops the carrier, the space that follows ends with a timeout and is not recorded */
+	t += MODEL_LATENCY_USEC + MODEL_STRETCH_USEC;
+	capture.elem[n].ticks = (t / EMBX_IR_RX_PHY_USEC_PER_TICK) - last;
+	capture.size = (uint16_t)(n + 1);
+	capture.status = STATUS_OK;
+	capture_full = true;
+	sends++;
+	return STATUS_OK;
+}
+
+enum status_code embx_ir_rx_buf_get_full(embx_ir_rx_buf_t **buf)
+{
+	if( capture_full == false ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	*buf = &capture;
+	return STATUS_OK;
+}
+
+void embx_ir_rx_buf_release(void)
+{
+	capture_full = false;
+}
+
+void embx_ir_rx_phy_set_mark_stretch(int16_t usec)
+{
+	mark_stretch = usec;
+}
+
+/**
+* @brief Checks that a value is within tolerance of the expected value.
+*/
+static void expect(const char *name, int32_t value, int32_t expected, int32_t tolerance)
+{
+	if( (value < (expected - tolerance)) || (value > (expected + tolerance)) ) {
+		printf("FAIL %s: %ld, expected %ld +- %ld\n", name, (long)value, (long)expected, (long)tolerance);
+		failures++;
+	}
+}
+
+/**
+* @brief A session with 8 captures recovers the latency and the stretch, the corrections are applied.
+*/
+static void test_session(void)
+{
+	static embx_ir_calibrate_t cal;
+	const embx_ir_tx_phy_descriptor_t *pd;
+	int32_t mean, min, max;
+	uint16_t i, polls = 0;
+
+	/** A capture that completes before the pattern is sent is not from the pattern */
+	capture.size = 3;
+	capture_full = true;
+	sends = 0;
+
+	embx_ir_tx_phy_descriptor_set_correction(100);
+	embx_ir_calibrate_init(&cal, 8);
+	expect("correction cleared", embx_ir_tx_phy_descriptor_get_correction(), 0, 0);
+	while( (embx_ir_calibrate_poll(&cal) == false) && (polls < 100) ) {
+		polls++;
+	}
+	expect("captures", cal.captures, 8, 0);
+	expect("rejects", cal.rejects, 0, 0);
+	expect("sends", sends, 8, 0);
+
+	for( i = 0; i < EMBX_IR_CALIBRATE_PATTERN_SZ; i++ ) {
+		embx_ir_calibrate_get_error(&cal, i, &mean, &min, &max);
+		/** A mark is longer by the latency and the stretch, a space by the latency and shorter by the stretch */
+		expect("interval error", mean, MODEL_LATENCY_USEC + (((i & 1) == 0) ? MODEL_STRETCH_USEC : -MODEL_STRETCH_USEC), 
+			   EMBX_IR_RX_PHY_USEC_PER_TICK);
+		expect("interval spread", max - min, 0, EMBX_IR_RX_PHY_USEC_PER_TICK);
+	}
+
+	if( embx_ir_calibrate_finish(&cal) != STATUS_OK ) {
+		printf("FAIL finish\n");
+		failures++;
+	}
+	expect("latency", cal.tx_latency_usec, MODEL_LATENCY_USEC, 2);
+	expect("stretch", cal.rx_stretch_usec, MODEL_STRETCH_USEC, 2);
+	expect("rx correction", mark_stretch, cal.rx_stretch_usec, 0);
+	expect("tx correction", embx_ir_tx_phy_descriptor_get_correction(), -cal.tx_latency_usec, 0);
+
+	/** Intervals filled from now on are shortened by the latency */
+	embx_ir_tx_phy_descriptor_fill(true, mark, 1600, 0, 0);
+	embx_ir_tx_phy_descriptor_next(&pd);
+	expect("corrected interval", pd->period, EMBX_IR_TX_PHY_PERIOD(1600 - cal.tx_latency_usec), 0);
+	while( embx_ir_tx_phy_descriptor_next(&pd) != STATUS_ERR_BAD_DATA ) ;
+	embx_ir_tx_phy_descriptor_set_correction(0);
+}
+
+/**
+* @brief Captures that do not match the pattern are rejected and leave the statistics unchanged, the session gives up.
+*/
+static void test_rejects(void)
+{
+	static embx_ir_calibrate_t cal;
+	embx_ir_rx_buf_elem_t elem[EMBX_IR_CALIBRATE_PATTERN_SZ];
+	int32_t mean, min, max;
+	uint16_t i;
+
+	embx_ir_calibrate_init(&cal, 2);
+	for( i = 0; i < EMBX_IR_CALIBRATE_PATTERN_SZ; i++ ) {
+		elem[i].gpio_state = ((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+		elem[i].ticks = EMBX_IR_TX_PHY_TICKS(embx_ir_calibrate_get_pattern(i));
+	}
+	expect("exact capture", embx_ir_calibrate_add(&cal, elem, EMBX_IR_CALIBRATE_PATTERN_SZ), STATUS_OK, 0);
+	expect("short capture", embx_ir_calibrate_add(&cal, elem, EMBX_IR_CALIBRATE_PATTERN_SZ - 2), STATUS_ERR_BAD_FORMAT, 0);
+	elem[5].ticks *= 2;
+	expect("long interval", embx_ir_calibrate_add(&cal, elem, EMBX_IR_CALIBRATE_PATTERN_SZ), STATUS_ERR_BAD_FORMAT, 0);
+	embx_ir_calibrate_get_error(&cal, 5, &mean, &min, &max);
+	expect("unchanged", max, 0, 0);
+	expect("rejects", cal.rejects, 2, 0);
+
+	while( embx_ir_calibrate_done(&cal) == false ) {
+		embx_ir_calibrate_add(&cal, elem, 1);
+	}
+	expect("gave up", cal.rejects, EMBX_IR_CALIBRATE_MAX_REJECTS, 0);
+	expect("no change", embx_ir_calibrate_finish(&cal), STATUS_OK, 0);
+	expect("exact latency", cal.tx_latency_usec, 0, 0);
+	expect("exact stretch", cal.rx_stretch_usec, 0, 0);
+
+	embx_ir_calibrate_init(&cal, 2);
+	expect("no capture", embx_ir_calibrate_finish(&cal), STATUS_ERR_NOT_INITIALIZED, 0);
+}
+
+int main(void)
+{
+	test_session();
+	test_rejects();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_calibrate passed\n");
+	return 0;
+}
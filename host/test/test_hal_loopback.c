@@ -0,0 +1,124 @@
+/**
+ * @file test_hal_loopback.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Transmits with the Tx PHY and receives with the Rx PHY, both running unchanged on the host backend of the HAL.
+ * @details The debug pin of the Tx PHY follows the MARKs, it is looped back to the EIC pin of the Rx PHY through a
+ * model of an IR receiver whose output is low during a MARK.  The intervals captured by the Rx PHY are checked 
+ * against those transmitted.  Both PHYs see the same interrupt latency.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_digital_io/digital_output.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+
+/** The GCLK ticks per usec */
+#define TICKS_PER_USEC			(EMBX_HAL_HOST_GCLK_HZ / 1000000UL)
+/** The interrupt latency in usec, shorter than a tick of the Rx PHY timer as on the target */
+#define LATENCY_USEC			(3)
+/** An edge may be late by a tick of each PHY */
+#define TOLERANCE_USEC			(EMBX_IR_TX_PHY_USEC_PER_TICK + EMBX_IR_RX_PHY_USEC_PER_TICK)
+
+/** The header of a NEC frame, 14 bits, and the stop mark, as many intervals as the descriptor ring holds */
+static const uint32_t frame[] = {
+	9000, 4500,
+	560, 560, 560, 560, 560, 1690, 560, 560, 560, 560, 560, 560, 560, 560,
+	560, 1690, 560, 1690, 560, 560, 560, 1690, 560, 1690, 560, 1690, 560, 1690,
+	560,
+};
+#define FRAME_SZ			(sizeof(frame) / sizeof(frame[0]))
+
+static uint16_t failures;
+
+/**
+* @brief The IR receiver, its output is low while the debug pin of the Tx PHY is high.
+*/
+static void receiver(uint8_t pin, bool level)
+{
+	if( pin == DEBUG_IR_TX_PHY_PIN ) {
+		embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, !level);
+	}
+}
+
+/**
+* @brief Transmits the frame and checks the capture, every interval is corrected by the same correction.
+*/
+static void test_frame(const char *name, int16_t tx_correction_usec)
+{
+	embx_ir_rx_buf_t *buf;
+	uint16_t i;
+	int32_t error;
+
+	embx_ir_tx_phy_descriptor_set_correction(tx_correction_usec);
+	for( i = 0; i < FRAME_SZ; i++ ) {
+		if( embx_ir_tx_phy_descriptor_fill((i == 0), ((i & 1) == 0) ? mark : space, frame[i], 0, 0) != STATUS_OK ) {
+			printf("FAIL %s: interval %u does not fit in the descriptor ring\n", name, i);
+			failures++;
+		}
+	}
+	if( embx_ir_tx_phy_send() != STATUS_OK ) {
+		printf("FAIL %s: the send was refused\n", name);
+		failures++;
+		return;
+	}
+	embx_hal_delay_ms(200);
+	if( embx_ir_tx_phy_get_state() == true ) {
+		printf("FAIL %s: the transmission has not completed\n", name);
+		failures++;
+	}
+
+	/** The reception completes after the space timeouts */
+	embx_hal_delay_ms(EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE * 110);
+	if( embx_ir_rx_buf_get_full(&buf) != STATUS_OK ) {
+		printf("FAIL %s: nothing was received\n", name);
+		failures++;
+		return;
+	}
+	if( (buf->status != STATUS_OK) || (buf->size != FRAME_SZ) ) {
+		printf("FAIL %s: %u intervals received with status %d, expected %u\n", name, buf->size, buf->status, (unsigned)FRAME_SZ);
+		failures++;
+	}
+	for( i = 0; (i < buf->size) && (i < FRAME_SZ); i++ ) {
+		error = (int32_t)buf->elem[i].time_us - (int32_t)(frame[i] + tx_correction_usec);
+		if( buf->elem[i].gpio_state != (((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			printf("FAIL %s: interval %u has the wrong state\n", name, i);
+			failures++;
+		}
+		/** The first edge is sent without the latency of the Tx PHY interrupt */
+		if( i == 0 ) {
+			error -= LATENCY_USEC;
+		}
+		if( (error > TOLERANCE_USEC) || (error < -TOLERANCE_USEC) ) {
+			printf("FAIL %s: interval %u is %lu usec, sent %lu usec\n", name, i, (unsigned long)buf->elem[i].time_us, 
+				(unsigned long)frame[i]);
+			failures++;
+		}
+	}
+	embx_ir_rx_buf_release();
+}
+
+int main(void)
+{
+	embx_hal_host_reset();
+	embx_hal_host_set_isr_latency(LATENCY_USEC * TICKS_PER_USEC);
+	embx_hal_host_set_pin_callback(receiver);
+
+	embx_ir_tx_phy_init(KHz_38);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	embx_hal_delay_ms(50); /** The line is idle for longer than the sync delay */
+
+	test_frame("nec", 0);
+	test_frame("corrected", 120);
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_hal_loopback passed\n");
+	return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test_integrity.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Checks the integrity schemes against known vectors.
+ * @details The CRCs are the catalogued CRC-8 of "123456789", the normal CRC-8 (poly 0x07, check 0xF4), CRC-8/MAXIM
+ * (poly 0x31 reflected, check 0xA1), and CRC-8/ROHC (poly 0x07 reflected with init 0xFF, check 0xD0), computed a bit
+ * at a time and from the tables.  Each scheme fills its check byte, passes its frame, and rejects a corrupt frame at
+ * the byte that fails the check.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include "embx/embx_ir/embx_ir_integrity.h"
+
+#define CHECK_SZ		(9) /** "123456789" */
+
+static uint16_t failures;
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief Returns the index of the byte a frame is rejected at, or len if it passes.
+*/
+static uint8_t rejected_at(const embx_ir_integrity_cfg_t *cfg, uint8_t n, const uint8_t *data, uint8_t len)
+{
+	embx_ir_integrity_t integrity;
+	uint8_t i;
+
+	embx_ir_integrity_init(&integrity, cfg, n);
+	for( i = 0; i < len; i++ ) {
+		if( embx_ir_integrity_update(&integrity, data[i]) != STATUS_OK ) {
+			break;
+		}
+	}
+	return i;
+}
+
+/**
+* @brief The CRC of "123456789" with the check byte appended, computed by fill, passes, and a flipped bit fails.
+*/
+static void test_crc(const char *name, uint8_t poly, bool reflect, uint8_t init, uint8_t xor_out, uint8_t expected)
+{
+	static uint8_t table[EMBX_IR_INTEGRITY_CRC8_TABLE_SZ];
+	embx_ir_integrity_cfg_t cfg = {
+		.scheme = EMBX_IR_INTEGRITY_CRC8,
+		.start = 0,
+		.length = CHECK_SZ + 1,
+		.init = init,
+		.poly = poly,
+		.xor_out = xor_out,
+		.reflect = reflect,
+		.crc_table = table,
+	};
+	uint8_t data[CHECK_SZ + 1];
+	bool ok = true;
+
+	embx_ir_integrity_crc8_table(poly, reflect, table);
+	for( ; ok && (cfg.scheme <= EMBX_IR_INTEGRITY_CRC8_TABLE); cfg.scheme++ ) {
+		memcpy(data, "123456789", CHECK_SZ);
+		data[CHECK_SZ] = (uint8_t)~expected;
+		embx_ir_integrity_fill(&cfg, 1, data, sizeof(data));
+		ok = ok && (data[CHECK_SZ] == expected);
+		ok = ok && (embx_ir_integrity_check(&cfg, 1, data, sizeof(data)) == STATUS_OK);
+		data[4] ^= 0x10;
+		ok = ok && (rejected_at(&cfg, 1, data, sizeof(data)) == CHECK_SZ);
+		ok = ok && (embx_ir_integrity_check(&cfg, 1, data, CHECK_SZ) == STATUS_ERR_BAD_DATA); /** Too short */
+	}
+	check(name, ok);
+}
+
+static void test_byte_sum(void)
+{
+	static const embx_ir_integrity_cfg_t cfg = { .scheme = EMBX_IR_INTEGRITY_BYTE_SUM, .start = 1, .length = 4, .init = 0x10 };
+	uint8_t data[6] = { 0xFF, 0x80, 0x90, 0x07, 0x00, 0xEE };
+
+	embx_ir_integrity_fill(&cfg, 1, data, sizeof(data));
+	check("byte sum fill", (data[4] == 0x27) && (data[0] == 0xFF) && (data[5] == 0xEE));
+	check("byte sum", embx_ir_integrity_check(&cfg, 1, data, sizeof(data)) == STATUS_OK);
+	data[2]++;
+	check("byte sum corrupt", rejected_at(&cfg, 1, data, sizeof(data)) == 4);
+}
+
+/**
+* @brief Only the low nibble of the check byte is checked, the high nibble is data.
+*/
+static void test_nibble_sum(void)
+{
+	static const embx_ir_integrity_cfg_t cfg = { .scheme = EMBX_IR_INTEGRITY_NIBBLE_SUM, .start = 0, .length = 4, .init = 0x0A };
+	uint8_t data[4] = { 0x12, 0x34, 0x56, 0xA0 };
+
+	embx_ir_integrity_fill(&cfg, 1, data, sizeof(data));
+	check("nibble sum fill", data[3] == 0xAF); /** 0x0A + 1 + 2 + 3 + 4 + 5 + 6 = 0x1F */
+	check("nibble sum", embx_ir_integrity_check(&cfg, 1, data, sizeof(data)) == STATUS_OK);
+	data[3] = 0x3F;
+	check("nibble sum high nibble", embx_ir_integrity_check(&cfg, 1, data, sizeof(data)) == STATUS_OK);
+	data[3] = 0xAE;
+	check("nibble sum corrupt", rejected_at(&cfg, 1, data, sizeof(data)) == 3);
+}
+
+/**
+* @brief Every second byte is the complement of the one before it, a bad pair is rejected at its second byte.
+*/
+static void test_inverted_pairs(void)
+{
+	static const embx_ir_integrity_cfg_t cfg = { .scheme = EMBX_IR_INTEGRITY_INVERTED_PAIRS, .start = 2, .length = 6 };
+	static const uint8_t expected[8] = { 0x23, 0xCB, 0x26, 0xD9, 0x01, 0xFE, 0x00, 0xFF };
+	uint8_t data[8] = { 0x23, 0xCB, 0x26, 0x00, 0x01, 0x00, 0x00, 0x00 };
+
+	embx_ir_integrity_fill(&cfg, 1, data, sizeof(data));
+	check("inverted pairs fill", memcmp(data, expected, sizeof(data)) == 0);
+	check("inverted pairs", embx_ir_integrity_check(&cfg, 1, data, sizeof(data)) == STATUS_OK);
+	check("inverted pairs short", embx_ir_integrity_check(&cfg, 1, data, 7) == STATUS_ERR_BAD_DATA);
+	data[4] ^= 0x01;
+	check("inverted pairs corrupt", rejected_at(&cfg, 1, data, sizeof(data)) == 5);
+}
+
+/**
+* @brief A sum per section and a CRC over both sections, the CRC covers the check byte of the first section.
+*/
+static void test_sections(void)
+{
+	static uint8_t table[EMBX_IR_INTEGRITY_CRC8_TABLE_SZ];
+	const embx_ir_integrity_cfg_t cfg[3] = {
+		{ .scheme = EMBX_IR_INTEGRITY_BYTE_SUM, .start = 0, .length = 3 },
+		{ .scheme = EMBX_IR_INTEGRITY_BYTE_SUM, .start = 3, .length = 3 },
+		{ .scheme = EMBX_IR_INTEGRITY_CRC8_TABLE, .start = 0, .length = 7, .poly = 0x31, .reflect = true, .crc_table = table },
+	};
+	uint8_t data[7] = { 0x01, 0x02, 0x00, 0x10, 0x20, 0x00, 0x00 };
+	embx_ir_integrity_t integrity;
+
+	embx_ir_integrity_crc8_table(0x31, true, table);
+	embx_ir_integrity_fill(cfg, 3, data, sizeof(data));
+	check("sections fill", (data[2] == 0x03) && (data[5] == 0x30));
+	check("sections", embx_ir_integrity_check(cfg, 3, data, sizeof(data)) == STATUS_OK);
+	embx_ir_integrity_init(&integrity, cfg, 3);
+	embx_ir_integrity_update(&integrity, data[0]);
+	embx_ir_integrity_update(&integrity, data[1]);
+	embx_ir_integrity_update(&integrity, data[2]);
+	check("sections incomplete", embx_ir_integrity_complete(&integrity) == false);
+	data[6] ^= 0x80;
+	check("sections corrupt crc", rejected_at(cfg, 3, data, sizeof(data)) == 6);
+}
+
+int main(void)
+{
+	test_crc("crc8", 0x07, false, 0x00, 0x00, 0xF4);
+	test_crc("crc8 maxim", 0x31, true, 0x00, 0x00, 0xA1);
+	test_crc("crc8 rohc", 0x07, true, 0xFF, 0x00, 0xD0);
+	test_crc("crc8 itu", 0x07, false, 0x00, 0x55, 0xA1);
+	test_byte_sum();
+	test_nibble_sum();
+	test_inverted_pairs();
+	test_sections();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_integrity passed\n");
+	return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_learn.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Runs learning sessions on captures with jitter and replays the learned frames from the descriptor queue.
+ * @details The captures of a session are a nominal frame with a different jitter on every edge.  The test checks the
+ * means and the variances, that a capture that does not align is rejected without changing the session, and that a
+ * frame with more edges than the descriptor queue, NEC and the Mitsubishi split unit, is transmitted whole.  The test
+ * plays the role of the IR Tx PHY and advances the queue until the transmission is complete.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_learn.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+#define CAPTURES		(5)
+
+static embx_ir_learn_t learn;
+static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+static uint32_t nominal[EMBX_IR_RX_BUF_SZ];
+static uint16_t failures;
+
+/** The descriptor queue is advanced by the test, never by the PHY */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief Builds a pulse distance frame of nbits with a header and a trailer, returns the number of edges.
+*/
+static uint16_t frame(uint16_t nbits, uint32_t header_mark, uint32_t header_space, uint32_t unit)
+{
+	uint16_t n = 0, b;
+
+	nominal[n++] = header_mark;
+	nominal[n++] = header_space;
+	for( b = 0; b < nbits; b++ ) {
+		nominal[n++] = unit;
+		nominal[n++] = (((b * 7) % 3) == 0) ? (3 * unit) : unit;
+	}
+	nominal[n++] = unit;
+	return n;
+}
+
+/**
+* @brief Fills a capture of the nominal frame, every edge is off by -2 * jitter to 2 * jitter usec.
+*/
+static void capture(uint16_t size, uint8_t k, uint32_t jitter)
+{
+	uint16_t i;
+
+	for( i = 0; i < size; i++ ) {
+		elem[i].gpio_state = ((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+		elem[i].time_us = nominal[i] + (((i + k) % 5) * jitter) - (2 * jitter);
+		elem[i].ticks = 0;
+	}
+}
+
+/**
+* @brief Advances the descriptor queue to the end of the transmission, every interval must be the learned mean.
+* @returns the number of intervals transmitted.
+*/
+static uint16_t replay(bool *same)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint16_t n = 0;
+	uint32_t usec;
+
+	*same = true;
+	while( (status = embx_ir_tx_phy_descriptor_next(&pd)) != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_NO_CHANGE ) {
+			continue;
+		}
+		if( (embx_ir_learn_get(&learn, n, &usec, NULL) != STATUS_OK) || (pd->usec != usec) ||
+			(pd->phy_interval_type != (((n & 1) == 0) ? mark : space)) ) {
+			*same = false;
+		}
+		n++;
+	}
+	return n;
+}
+
+static void test_session(const char *name, uint16_t size)
+{
+	uint32_t usec, variance, underruns = embx_ir_tx_phy_descriptor_get_underruns();
+	bool means = true, variances = true, same;
+	uint8_t k;
+	uint16_t i;
+
+	embx_ir_learn_init(&learn, CAPTURES);
+	check(name, embx_ir_learn_fill_tx(&learn) == STATUS_ERR_NOT_INITIALIZED);
+	for( k = 0; k < CAPTURES; k++ ) {
+		capture(size, k, 10);
+		check(name, embx_ir_learn_add(&learn, elem, size) == STATUS_OK);
+		check(name, embx_ir_learn_done(&learn) == (k == (CAPTURES - 1)));
+	}
+	check(name, embx_ir_learn_add(&learn, elem, size) == STATUS_NO_CHANGE);
+	for( i = 0; i < size; i++ ) { /** The jitters of an edge are -20, -10, 0, 10, and 20 usec */
+		embx_ir_learn_get(&learn, i, &usec, &variance);
+		means = means && (usec >= (nominal[i] - 1)) && (usec <= (nominal[i] + 1));
+		variances = variances && (variance >= 240) && (variance <= 260);
+	}
+	check(name, means);
+	check(name, variances);
+	check(name, embx_ir_learn_get(&learn, size, &usec, NULL) == STATUS_ERR_INVALID_ARG);
+
+	check(name, embx_ir_learn_fill_tx(&learn) == STATUS_OK);
+	check(name, (replay(&same) == size) && (same == true));
+	check(name, embx_ir_tx_phy_descriptor_get_underruns() == underruns);
+}
+
+/**
+* @brief A capture of another shape or with an edge out of tolerance is counted and leaves the means as they are.
+*/
+static void test_rejects(void)
+{
+	uint16_t size = frame(32, 9000, 4500, 560);
+	uint32_t before, after;
+
+	embx_ir_learn_init(&learn, CAPTURES);
+	capture(size, 0, 0);
+	check("first", embx_ir_learn_add(&learn, elem, size) == STATUS_OK);
+	embx_ir_learn_get(&learn, 3, &before, NULL);
+	check("shorter", embx_ir_learn_add(&learn, elem, size - 2) == STATUS_ERR_BAD_FORMAT);
+	elem[3].time_us = 3 * nominal[3];
+	check("out of tolerance", embx_ir_learn_add(&learn, elem, size) == STATUS_ERR_BAD_FORMAT);
+	capture(size, 0, 0);
+	elem[0].gpio_state = EMBX_IR_RX_GPIO_STATE_SPACE;
+	check("starts with a space", embx_ir_learn_add(&learn, elem, size) == STATUS_ERR_BAD_FORMAT);
+	check("empty", embx_ir_learn_add(&learn, elem, 0) == STATUS_ERR_BAD_FORMAT);
+	embx_ir_learn_get(&learn, 3, &after, NULL);
+	check("rejects", (learn.rejects == 4) && (learn.captures == 1) && (before == after));
+}
+
+int main(void)
+{
+	test_rejects();
+	test_session("short", frame(8, 3000, 1500, 500)); /** Fits the queue */
+	test_session("nec", frame(32, 9000, 4500, 560));
+	test_session("mitsubishi", frame(144, 3400, 1750, 450));
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_learn passed\n");
+	return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_quant.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Checks the ranges of the quantizer against embx_ir_protocol_match, and the vector implementations against
+ * the scalar one.
+ * @details The durations are the edges of every range and every multiple, random ones, and the extremes, quantized at
+ * every length and alignment up to two vectors past the end so the leftover durations are covered.  The vector
+ * implementations the CPU does not run are skipped.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include "../tools/ir_quant.h"
+
+#define DURATIONS		(4096)
+
+static const embx_ir_protocol_t nec = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1690,
+	.trailer_mark_usec = 560,
+};
+
+static const embx_ir_protocol_t rc5 = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 889,
+};
+
+/** A tolerance over 100 percent, the ranges start at 0 */
+static const embx_ir_protocol_t loose = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH,
+	.tolerance_pct = 150,
+	.unit_usec = 333,
+	.header_mark_usec = 65535,
+	.zero_mark_usec = 333,
+	.one_mark_usec = 999,
+	.zero_space_usec = 333,
+	.one_space_usec = 333,
+};
+
+/** No unit, the multiples are 0 */
+static const embx_ir_protocol_t exact = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.tolerance_pct = 0,
+	.header_mark_usec = 3000,
+	.zero_mark_usec = 500,
+	.one_space_usec = 1500,
+};
+
+static const embx_ir_protocol_t *const protocols[] = { &nec, &rc5, &loose, &exact };
+
+static uint32_t usec[DURATIONS];
+static uint16_t symbols[2][DURATIONS];
+static uint8_t units[2][DURATIONS];
+static uint16_t failures;
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief Returns the duration of a symbol in the descriptor.
+*/
+static uint32_t expected(const embx_ir_protocol_t *protocol, uint8_t symbol)
+{
+	switch( symbol ) {
+		case IR_QUANT_HEADER_MARK: return protocol->header_mark_usec;
+		case IR_QUANT_ZERO_MARK: return protocol->zero_mark_usec;
+		case IR_QUANT_ONE_MARK: return protocol->one_mark_usec;
+		case IR_QUANT_TRAILER_MARK: return protocol->trailer_mark_usec;
+		case IR_QUANT_HEADER_SPACE: return protocol->header_space_usec;
+		case IR_QUANT_ZERO_SPACE: return protocol->zero_space_usec;
+		case IR_QUANT_ONE_SPACE: return protocol->one_space_usec;
+		case IR_QUANT_UNIT: return protocol->unit_usec;
+		default: return 2 * (uint32_t)protocol->unit_usec;
+	}
+}
+
+/**
+* @brief Every duration up to three times the symbol matches the range as the decoder matches it.
+*/
+static void test_ranges(const embx_ir_protocol_t *protocol)
+{
+	ir_quant_table_t table;
+	uint32_t e, u;
+	uint8_t s;
+	bool ok = true;
+
+	ir_quant_table_init(&table, protocol);
+	for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+		if( (e = expected(protocol, s)) == 0 ) {
+			ok = ok && (table.lo[s] > table.hi[s]);
+			continue;
+		}
+		for( u = 0; u <= (3 * e); u++ ) {
+			ok = ok && (((u >= table.lo[s]) && (u <= table.hi[s])) == embx_ir_protocol_match(u, e, protocol->tolerance_pct));
+		}
+	}
+	check("ranges", ok);
+}
+
+/**
+* @brief Fills the durations with the edges of the ranges and the multiples, then random ones.
+*/
+static uint16_t fill(const ir_quant_table_t *table)
+{
+	uint32_t seed = 1, k;
+	uint16_t n = 0;
+	uint8_t s;
+
+	usec[n++] = 0;
+	usec[n++] = 1;
+	usec[n++] = UINT32_MAX;
+	usec[n++] = UINT32_MAX - 1;
+	usec[n++] = 0x80000000UL;
+	for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+		usec[n++] = table->lo[s] - 1;
+		usec[n++] = table->lo[s];
+		usec[n++] = table->hi[s];
+		usec[n++] = table->hi[s] + 1;
+	}
+	for( k = 0; (k <= (IR_QUANT_MAX_UNITS + 2)) && (table->unit != 0); k++ ) {
+		usec[n++] = (k * table->unit) + (table->unit / 2) - 1;
+		usec[n++] = (k * table->unit) + (table->unit / 2);
+		usec[n++] = (k * table->unit) + (table->unit / 2) + 1;
+	}
+	while( n < DURATIONS ) {
+		seed = (seed * 1103515245UL) + 12345UL;
+		usec[n] = ((n & 3) == 0) ? seed : ((seed >> 8) % 20000); /** Mostly durations of a frame */
+		n++;
+	}
+	return n;
+}
+
+/**
+* @brief Every implementation the CPU runs writes the bits of the scalar one, at every length and alignment.
+*/
+static void test_impls(const embx_ir_protocol_t *protocol)
+{
+	ir_quant_table_t table;
+	ir_quant_impl_t impl;
+	uint16_t n, len, start;
+	bool ok = true;
+
+	ir_quant_table_init(&table, protocol);
+	n = fill(&table);
+	check("scalar", ir_quant_run(&table, IR_QUANT_SCALAR, usec, n, symbols[0], units[0]) == true);
+	for( impl = IR_QUANT_SCALAR + 1; impl < IR_QUANT_IMPLS; impl++ ) {
+		if( ir_quant_supported(impl) == false ) {
+			printf("test_quant: %s not supported, skipped\n", ir_quant_impl_names[impl]);
+			continue;
+		}
+		check("whole", ir_quant_run(&table, impl, usec, n, symbols[1], units[1]) == true);
+		ok = ok && (memcmp(symbols[0], symbols[1], n * sizeof(symbols[0][0])) == 0) && (memcmp(units[0], units[1], n) == 0);
+		for( start = 0; start < 8; start++ ) {
+			for( len = 0; len <= 17; len++ ) {
+				memset(symbols[1], 0xA5, sizeof(symbols[1]));
+				memset(units[1], 0xA5, sizeof(units[1]));
+				ir_quant_run(&table, impl, &usec[start], len, &symbols[1][start], &units[1][start]);
+				ok = ok && (memcmp(&symbols[0][start], &symbols[1][start], len * sizeof(symbols[0][0])) == 0) &&
+					 (memcmp(&units[0][start], &units[1][start], len) == 0) && (symbols[1][start + len] == 0xA5A5) &&
+					 (units[1][start + len] == 0xA5);
+			}
+		}
+	}
+	check("impls", ok);
+}
+
+/**
+* @brief A few durations of NEC by hand.
+*/
+static void test_nec(void)
+{
+	static const uint32_t d[] = { 9000, 4500, 560, 1690, 839, 840, 420, 419, 200000 };
+	ir_quant_table_t table;
+	uint16_t sym[9];
+	uint8_t mult[9];
+
+	ir_quant_table_init(&table, &nec);
+	ir_quant_run(&table, IR_QUANT_SCALAR, d, 9, sym, mult);
+	check("header", ((sym[0] & IR_QUANT_MARKS) == (1 << IR_QUANT_HEADER_MARK)) && ((sym[1] & IR_QUANT_SPACES) == (1 << IR_QUANT_HEADER_SPACE)));
+	check("bit", (sym[2] & (1 << IR_QUANT_ZERO_MARK)) && (sym[2] & (1 << IR_QUANT_ONE_MARK)) && (sym[2] & (1 << IR_QUANT_TRAILER_MARK)) &&
+				 (sym[2] & (1 << IR_QUANT_ZERO_SPACE)) && ((sym[3] & IR_QUANT_SPACES) == (1 << IR_QUANT_ONE_SPACE)));
+	check("tolerance", (sym[6] & (1 << IR_QUANT_ZERO_MARK)) && ((sym[7] & (1 << IR_QUANT_ZERO_MARK)) == 0));
+	check("units", (mult[0] == 16) && (mult[1] == 8) && (mult[2] == 1) && (mult[3] == 3) && (mult[4] == 1) && (mult[5] == 2) &&
+				   (mult[8] == IR_QUANT_MAX_UNITS));
+	check("gap", sym[8] == 0);
+}
+
+int main(void)
+{
+	uint8_t p;
+
+	test_nec();
+	for( p = 0; p < (sizeof(protocols) / sizeof(protocols[0])); p++ ) {
+		test_ranges(protocols[p]);
+		test_impls(protocols[p]);
+	}
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_quant passed (%s)\n", ir_quant_impl_names[ir_quant_best()]);
+	return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file test_split_unit.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Runs a split unit model and its monitor against the frames of the unit and of another remote.
+ * @details The test plays the IR Tx PHY, the air, and the IR Rx PHY.  A send replays the descriptor queue into an Rx
+ * buffer, so every frame the unit transmits is captured again by the monitor as it is on the device.  The echo of a
+ * transmission must not drop a change scheduled after it, the frame of another remote must.  A frame that fails to
+ * send is sent on the next poll.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+#include "embx/embx_split_unit/embx_split_unit_monitor.h"
+
+static embx_split_unit_t unit;
+static embx_split_unit_monitor_t monitor;
+static uint32_t sends;
+static enum status_code send_error = STATUS_OK;
+static uint16_t failures;
+
+/** The descriptor queue is replayed at once, the PHY is never busy */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+/**
+* @brief Replays the descriptor queue into the next Rx buffer.
+*/
+enum status_code embx_ir_tx_phy_send(void)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	embx_ir_rx_buf_elem_t *elem;
+	enum status_code status;
+
+	if( send_error != STATUS_OK ) {
+		status = send_error; /** The send fails once */
+		send_error = STATUS_OK;
+		return status;
+	}
+	while( (status = embx_ir_tx_phy_descriptor_next(&pd)) != STATUS_ERR_BAD_DATA ) {
+		if( (status == STATUS_OK) && (embx_ir_rx_buf_isr_get_elem(&elem) == STATUS_OK) ) {
+			elem->gpio_state = (pd->phy_interval_type == mark) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+			elem->time_us = pd->usec;
+			elem->ticks = 0;
+		}
+	}
+	sends++;
+	return embx_ir_rx_buf_complete(STATUS_OK);
+}
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief Another remote sends a state.
+*/
+static void remote(const embx_split_unit_state_t *state)
+{
+	static embx_ir_protocol_stream_t stream;
+
+	embx_split_unit_encode(&embx_split_unit_mitsubishi_codec, state, &stream);
+	embx_ir_tx_phy_send();
+}
+
+static void init(void)
+{
+	const embx_split_unit_state_t state = { .power = true, .mode = EMBX_SPLIT_UNIT_MODE_COOL, .setpoint = 21 };
+
+	embx_ir_rx_phy_buf_init();
+	embx_split_unit_init(&unit, &embx_split_unit_mitsubishi_codec, &state);
+	embx_split_unit_monitor_init(&monitor, &embx_split_unit_mitsubishi_codec, &unit);
+	sends = 0;
+}
+
+/**
+* @brief 22 is sent, 23 is held for coalescing, and the echo of 22 arrives.  23 is still sent.
+*/
+static void test_echo(void)
+{
+	init();
+	embx_split_unit_set_setpoint(&unit, 22, 0);
+	check("send 22", (embx_split_unit_poll(&unit, 1000) == STATUS_OK) && (unit.sent.setpoint == 22));
+	embx_split_unit_set_setpoint(&unit, 23, 1100);
+	check("echo of 22", (embx_split_unit_monitor_poll(&monitor, 1150) == true) && (monitor.state.setpoint == 22));
+	check("23 held", (unit.pending == true) && (unit.desired.setpoint == 23));
+	check("send 23", (embx_split_unit_poll(&unit, 2100) == STATUS_OK) && (unit.sent.setpoint == 23) && (sends == 2));
+	check("echo of 23", (embx_split_unit_monitor_poll(&monitor, 2150) == true) && (monitor.state.setpoint == 23));
+	check("nothing to send", (embx_split_unit_poll(&unit, 5000) == STATUS_NO_CHANGE) && (unit.stats.transmissions == 2));
+}
+
+/**
+* @brief The echo of a transmission arrives when nothing is scheduled, the unit model is left as it is.
+*/
+static void test_late_echo(void)
+{
+	init();
+	embx_split_unit_set_fan(&unit, 3, 0);
+	check("send fan", embx_split_unit_poll(&unit, 0) == STATUS_OK);
+	check("echo", embx_split_unit_sync(&unit, &unit.sent, EMBX_SPLIT_UNIT_ECHO_MS - 1) == STATUS_NO_CHANGE);
+	check("same state later", embx_split_unit_sync(&unit, &unit.sent, EMBX_SPLIT_UNIT_ECHO_MS) == STATUS_OK);
+}
+
+/**
+* @brief The frame of another remote replaces the state and drops the scheduled transmission.
+*/
+static void test_remote(void)
+{
+	embx_split_unit_state_t state;
+
+	init();
+	embx_split_unit_set_setpoint(&unit, 22, 0);
+	check("send 22", embx_split_unit_poll(&unit, 1000) == STATUS_OK);
+	check("echo of 22", embx_split_unit_monitor_poll(&monitor, 1100) == true);
+	embx_split_unit_set_swing(&unit, 2, 1200);
+	state = unit.sent;
+	state.setpoint = 25;
+	remote(&state);
+	check("remote 25", (embx_split_unit_monitor_poll(&monitor, 1300) == true) && (monitor.state.setpoint == 25));
+	check("swing dropped", (unit.pending == false) && (unit.desired.setpoint == 25) && (unit.desired.swing == 0));
+	check("nothing to send", (embx_split_unit_poll(&unit, 1400) == STATUS_NO_CHANGE) && (unit.stats.transmissions == 1));
+	check("frames", (monitor.stats.frames == 2) && (monitor.stats.rejected == 0));
+}
+
+/**
+* @brief The first send of 24 fails, 24 stays scheduled and is sent on the next poll.
+*/
+static void test_retry(void)
+{
+	init();
+	embx_split_unit_set_setpoint(&unit, 24, 0);
+	send_error = STATUS_ERR_NO_MEMORY;
+	check("send fails", (embx_split_unit_poll(&unit, 1000) == STATUS_ERR_NO_MEMORY) && (unit.pending == true) &&
+		  (unit.stats.errors == 1) && (sends == 0));
+	check("send 24", (embx_split_unit_poll(&unit, 1010) == STATUS_OK) && (unit.sent.setpoint == 24) && (sends == 1));
+	check("echo of 24", (embx_split_unit_monitor_poll(&monitor, 1100) == true) && (monitor.state.setpoint == 24));
+	check("nothing to send", (embx_split_unit_poll(&unit, 2000) == STATUS_NO_CHANGE) && (unit.stats.transmissions == 1));
+}
+
+int main(void)
+{
+	test_echo();
+	test_late_echo();
+	test_remote();
+	test_retry();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_split_unit passed\n");
+	return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_trace.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Writes captures into a binary trace and reads them back.
+ * @details Checks the fields of the records, the size of the varints, that a reader skips the fields appended by a
+ * later writer of the same version, and that a truncated record, a later version, and a timestamp that goes back
+ * are refused.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include "embx/embx_ir/embx_ir_trace.h"
+
+#define TRACE_SZ		(4096)
+
+static uint8_t trace[TRACE_SZ];
+static size_t trace_len;
+static embx_ir_trace_writer_t writer;
+static uint16_t failures;
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+/**
+* @brief Fills a capture of size intervals that alternate from a MARK.
+*/
+static void capture(embx_ir_rx_buf_elem_t *elem, uint16_t size, uint32_t usec)
+{
+	uint16_t i;
+
+	for( i = 0; i < size; i++ ) {
+		elem[i].gpio_state = ((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+		elem[i].time_us = usec + (i * 7);
+		elem[i].ticks = 0;
+	}
+}
+
+static enum status_code append(uint64_t timestamp_us, uint8_t status, uint32_t carrier_hz, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	embx_ir_trace_record_t record;
+	enum status_code rc;
+	size_t len;
+
+	record.timestamp_us = timestamp_us;
+	record.status = status;
+	record.quality = 90;
+	record.carrier_hz = carrier_hz;
+	rc = embx_ir_trace_write(&writer, &record, elem, size, &trace[trace_len], TRACE_SZ - trace_len, &len);
+	if( rc == STATUS_OK ) {
+		trace_len += len;
+	}
+	return rc;
+}
+
+static void test_round_trip(void)
+{
+	static embx_ir_rx_buf_elem_t elem[3][EMBX_IR_RX_BUF_SZ], got[EMBX_IR_RX_BUF_SZ];
+	static const uint16_t size[3] = { 67, 1, EMBX_IR_RX_BUF_SZ };
+	static const uint64_t timestamp[3] = { 1000, 1000, 5000000000ULL };
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	uint16_t n, i;
+	bool same;
+
+	embx_ir_trace_write_header(&writer, trace);
+	trace_len = EMBX_IR_TRACE_HEADER_SZ;
+	capture(elem[0], size[0], 560);
+	capture(elem[1], size[1], 9000);
+	capture(elem[2], size[2], 100000); /** Every interval takes 3 bytes */
+	check("write", append(timestamp[0], STATUS_OK, 38000, elem[0], size[0]) == STATUS_OK);
+	check("write at the same time", append(timestamp[1], STATUS_ERR_OVERFLOW, 0, elem[1], size[1]) == STATUS_OK);
+	check("write after an hour", append(timestamp[2], STATUS_OK, 36000, elem[2], size[2]) == STATUS_OK);
+	check("write earlier", append(timestamp[1], STATUS_OK, 0, elem[1], size[1]) == STATUS_ERR_INVALID_ARG);
+	check("size", trace_len <= (EMBX_IR_TRACE_HEADER_SZ + (3 * 8) + (67 * 2) + 3 + (EMBX_IR_RX_BUF_SZ * 3) + 13));
+
+	check("reader", embx_ir_trace_reader_init(&reader, trace, trace_len) == STATUS_OK);
+	for( n = 0; n < 3; n++ ) {
+		check("read", embx_ir_trace_read(&reader, &record) == STATUS_OK);
+		check("timestamp", record.timestamp_us == timestamp[n]);
+		check("status", record.status == ((n == 1) ? STATUS_ERR_OVERFLOW : STATUS_OK));
+		check("quality", record.quality == 90);
+		check("carrier", record.carrier_hz == ((n == 0) ? 38000 : ((n == 1) ? 0 : 36000)));
+		check("record size", record.size == size[n]);
+		check("elems", embx_ir_trace_get_elems(&record, got, EMBX_IR_RX_BUF_SZ) == STATUS_OK);
+		same = true;
+		for( i = 0; i < record.size; i++ ) {
+			same &= (got[i].gpio_state == elem[n][i].gpio_state) && (got[i].time_us == elem[n][i].time_us);
+		}
+		check("intervals", same);
+		check("elems overflow", (record.size < 2) || (embx_ir_trace_get_elems(&record, got, 1) == STATUS_ERR_OVERFLOW));
+	}
+	check("end", embx_ir_trace_read(&reader, &record) == STATUS_NO_CHANGE);
+}
+
+static void test_refused(void)
+{
+	static uint8_t copy[TRACE_SZ];
+	static embx_ir_rx_buf_elem_t elem[4];
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	size_t len;
+
+	embx_ir_trace_write_header(&writer, trace);
+	trace_len = EMBX_IR_TRACE_HEADER_SZ;
+	capture(elem, 4, 300);
+	append(0, STATUS_OK, 0, elem, 4);
+
+	check("no room", embx_ir_trace_write(&writer, &(embx_ir_trace_record_t){ .timestamp_us = 2 }, elem, 4, copy, 3, &len) == STATUS_ERR_NO_MEMORY);
+
+	memcpy(copy, trace, trace_len);
+	copy[4] = EMBX_IR_TRACE_VERSION + 1;
+	check("later version", embx_ir_trace_reader_init(&reader, copy, trace_len) == STATUS_ERR_UNSUPPORTED_DEV);
+	copy[0] = 'X';
+	check("magic", embx_ir_trace_reader_init(&reader, copy, trace_len) == STATUS_ERR_BAD_FORMAT);
+
+	embx_ir_trace_reader_init(&reader, trace, trace_len - 1);
+	check("truncated", embx_ir_trace_read(&reader, &record) == STATUS_ERR_BAD_FORMAT);
+	check("stays", reader.offset == EMBX_IR_TRACE_HEADER_SZ);
+
+	/** A later writer appends a byte to the header and to the record, the length of the record covers it */
+	memcpy(copy, trace, EMBX_IR_TRACE_HEADER_SZ);
+	copy[5] = EMBX_IR_TRACE_HEADER_SZ + 1;
+	copy[EMBX_IR_TRACE_HEADER_SZ] = 0xA5;
+	copy[EMBX_IR_TRACE_HEADER_SZ + 1] = trace[EMBX_IR_TRACE_HEADER_SZ] + 1;
+	memcpy(&copy[EMBX_IR_TRACE_HEADER_SZ + 2], &trace[EMBX_IR_TRACE_HEADER_SZ + 1], trace_len - EMBX_IR_TRACE_HEADER_SZ - 1);
+	copy[trace_len + 1] = 0xA5;
+	check("later header", embx_ir_trace_reader_init(&reader, copy, trace_len + 2) == STATUS_OK);
+	check("later record", embx_ir_trace_read(&reader, &record) == STATUS_OK);
+	check("later elems", (record.size == 4) && (embx_ir_trace_get_elems(&record, elem, 4) == STATUS_OK) && (elem[3].time_us == 321));
+	check("later end", embx_ir_trace_read(&reader, &record) == STATUS_NO_CHANGE);
+}
+
+int main(void)
+{
+	test_round_trip();
+	test_refused();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_trace passed\n");
+	return 0;
+}
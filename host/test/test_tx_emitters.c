@@ -0,0 +1,124 @@
+/**
+ * @file test_tx_emitters.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Transmits on two IR emitters with the emitters module running unchanged on the host backend of the HAL.
+ * @details The time at which each emitter ends its transmission is compared with the sum of its intervals.  An
+ * emitter that joins while the other one transmits must not delay it, and two emitters whose intervals end a tick
+ * apart must not leave the timer running past its top value when the interrupt is late.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_emitters.h"
+
+/** The GCLK ticks per usec */
+#define TICKS_PER_USEC			(EMBX_HAL_HOST_GCLK_HZ / 1000000UL)
+/** The longest transmission of a test in usec */
+#define TIMEOUT_USEC			(1000000UL)
+
+static uint16_t failures;
+
+/** The descriptor queues are played by the emitters module, not by the Tx PHY */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+/** Returns the time in usec since the reset */
+static uint32_t now_usec(void)
+{
+	return (uint32_t)(embx_hal_host_get_time() / TICKS_PER_USEC);
+}
+
+/**
+* @brief Runs the model until both emitters have ended and records the time each one ended.
+*/
+static void run(uint32_t *end_usec)
+{
+	uint32_t start = now_usec();
+	uint8_t channel;
+
+	end_usec[0] = end_usec[1] = 0;
+	while( (now_usec() - start) < TIMEOUT_USEC ) {
+		embx_hal_host_run(TICKS_PER_USEC);
+		for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+			if( (end_usec[channel] == 0) && (embx_ir_tx_emitters_get_state(channel) == false) ) {
+				end_usec[channel] = now_usec();
+			}
+		}
+		if( (end_usec[0] != 0) && (end_usec[1] != 0) ) {
+			return;
+		}
+	}
+}
+
+/**
+* @brief Checks the end of a transmission, it may be late by the latency and a tick.
+*/
+static void expect(const char *name, uint8_t channel, uint32_t end_usec, uint32_t expected_usec, uint32_t latency_usec)
+{
+	if( (end_usec < expected_usec) || (end_usec > (expected_usec + latency_usec + EMBX_IR_TX_PHY_USEC_PER_TICK)) ) {
+		printf("FAIL %s: emitter %u ended at %lu usec, expected %lu usec\n", name, channel, (unsigned long)end_usec,
+			   (unsigned long)expected_usec);
+		failures++;
+	}
+}
+
+/**
+* @brief Emitter 1 joins 2 ms into the 8 ms transmission of emitter 0, emitter 0 ends on time.
+*/
+static void test_join(void)
+{
+	uint32_t start, end[EMBX_IR_TX_CHANNELS];
+
+	embx_hal_host_set_isr_latency(0);
+	start = now_usec();
+	embx_ir_tx_phy_descriptor_fill_ch(0, true, mark, 4000, 0, 0);
+	embx_ir_tx_phy_descriptor_fill_ch(0, false, space, 4000, 0, 0);
+	embx_ir_tx_emitters_send(0);
+	embx_hal_host_run(2000 * TICKS_PER_USEC);
+	embx_ir_tx_phy_descriptor_fill_ch(1, true, mark, 1000, 0, 0);
+	embx_ir_tx_emitters_send(1);
+	run(end);
+	expect("join", 0, end[0], start + 8000, 0);
+	expect("join", 1, end[1], start + 3000, 0);
+}
+
+/**
+* @brief The intervals of the emitters end a tick apart and the interrupt is late by 3 ticks, the counter has passed
+* the top value of the last tick when it is written.
+*/
+static void test_close(void)
+{
+	const uint32_t latency_usec = 3 * EMBX_IR_TX_PHY_USEC_PER_TICK;
+	uint32_t start, end[EMBX_IR_TX_CHANNELS];
+
+	embx_hal_host_set_isr_latency(latency_usec * TICKS_PER_USEC);
+	start = now_usec();
+	embx_ir_tx_phy_descriptor_fill_ch(0, true, mark, 800, 0, 0);
+	embx_ir_tx_phy_descriptor_fill_ch(1, true, mark, 800 + EMBX_IR_TX_PHY_USEC_PER_TICK, 0, 0);
+	embx_ir_tx_emitters_send(0);
+	embx_ir_tx_emitters_send(1);
+	run(end);
+	expect("close", 0, end[0], start + 800, latency_usec);
+	expect("close", 1, end[1], start + 800, latency_usec);
+}
+
+int main(void)
+{
+	embx_hal_host_reset();
+	embx_ir_tx_emitters_init(KHz_38);
+
+	test_join();
+	test_close();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_emitters passed\n");
+	return 0;
+}
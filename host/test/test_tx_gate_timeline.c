@@ -0,0 +1,304 @@
+/**
+ * @file test_tx_gate_timeline.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Compares the mark/space edges of the software gated and the event gated IR transmission on a simulated timeline.
+ * @details Each timer interrupt is delayed by a pseudo random latency, standing in for whatever other interrupt is
+ * running.  The software gated PHY (embx_ir_tx_phy) lets TC3 run on while a long interval continues, but when an
+ * interval ends its interrupt switches the carrier and restarts TC3, so that edge is late by the latency and the
+ * latencies of the edges add up.  The event gated PHY (embx_ir_tx_evsys) switches the carrier with the overflow event,
+ * every edge is late by the event path, and TC3 runs freely.  Its interrupt has to write the top value of the period
+ * that has started before the counter passes it.  A queue with a shorter period is refused, and a period of a stream
+ * programmed late is switched by the interrupt.  The edges of both are compared with the ideal edges of the
+ * descriptor queue, in nanoseconds.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_gate.h"
+
+/** The longest latency of the simulated interrupt in usec */
+#define LATENCY_MAX_USEC	(EMBX_IR_TX_GATE_LATENCY_USEC)
+/** The delay from the overflow to the carrier in nsec: the asynchronous EVSYS path and two GCLK cycles of TCC1 */
+#define EVSYS_LATENCY_NS	(250)
+/** A tick of TC3 in nsec */
+#define TICK_NS				(EMBX_IR_TX_PHY_USEC_PER_TICK * 1000UL)
+/** The number of edges recorded */
+#define EDGES_SZ			(128)
+
+/** The edges of a transmission: time in nsec and the state of the carrier after the edge */
+typedef struct {
+	uint32_t ns[EDGES_SZ];
+	bool on[EDGES_SZ];
+	uint16_t size;
+} edges_t;
+
+static uint16_t failures;
+static uint32_t lcg = 12345;
+static uint32_t latency_min_usec = 0;
+
+/** The descriptor module checks the state of the PHY before a reset */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+/** Returns the latency of the next interrupt in nsec */
+static uint32_t latency(void)
+{
+	lcg = (lcg * 1103515245UL) + 12345UL;
+	return (latency_min_usec + ((lcg >> 16) % (LATENCY_MAX_USEC - latency_min_usec + 1))) * 1000UL;
+}
+
+/** Records an edge if the carrier changes */
+static void edge(edges_t *edges, uint32_t ns, bool on)
+{
+	if( ((edges->size == 0) || (edges->on[edges->size - 1] != on)) && (edges->size < EDGES_SZ) ) {
+		edges->ns[edges->size] = ns;
+		edges->on[edges->size] = on;
+		edges->size++;
+	}
+}
+
+/** Period length in nsec of a top value */
+static uint32_t period_ns(uint32_t top)
+{
+	return (top + 1UL) * EMBX_IR_TX_PHY_USEC_PER_TICK * 1000UL;
+}
+
+/**
+* @brief Loads a frame like the Mitsubishi header, 12 bits, and the trailer, a gap longer than a timer period, and a
+* short second frame.  It fits into the descriptor ring.
+*/
+static void fill(void)
+{
+	uint8_t n;
+
+	embx_ir_tx_phy_descriptor_fill(true, mark, 3400, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 1750, 0, 0);
+	for( n = 0; n < 12; n++ ) {
+		embx_ir_tx_phy_descriptor_fill(false, mark, 450, 0, 0);
+		embx_ir_tx_phy_descriptor_fill(false, space, ((n % 3) == 0) ? 1300 : 420, 0, 0);
+	}
+	embx_ir_tx_phy_descriptor_fill(false, mark, 440, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 600000, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 3400, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 1750, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 440, 0, 0);
+}
+
+/**
+* @brief Loads a MARK, a SPACE of 3 ticks, shorter than the longest latency, and a MARK.
+*/
+static void fill_short(void)
+{
+	embx_ir_tx_phy_descriptor_fill(true, mark, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 24, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 560, 0, 0);
+}
+
+/** The stream of stream_short, the SPACE of 3 ticks and the MARK are filled once the first MARK has been consumed */
+static void refill_short(void *context)
+{
+	bool *filled = (bool *)context;
+
+	if( *filled == false ) {
+		*filled = true;
+		embx_ir_tx_phy_descriptor_fill(false, space, 24, 0, 0);
+		embx_ir_tx_phy_descriptor_fill(false, mark, 560, 0, 0);
+		embx_ir_tx_phy_descriptor_stream_close();
+	}
+}
+
+/**
+* @brief Loads the intervals of fill_short, the short SPACE is streamed after the transmission has started.
+*/
+static void stream_short(void)
+{
+	static bool filled;
+
+	filled = false;
+	embx_ir_tx_phy_descriptor_fill(true, mark, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_stream_open(refill_short, &filled, 0);
+}
+
+/**
+* @brief The ideal edges: every period is exactly top + 1 ticks.
+*/
+static void replay_ideal(void (*load)(void), edges_t *edges)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint32_t t = 0;
+	uint32_t period = 0;
+
+	load();
+	edges->size = 0;
+	while( (status = embx_ir_tx_phy_descriptor_next(&pd)) != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_OK ) {
+			edge(edges, t, pd->phy_interval_type == mark);
+			period = period_ns(pd->period);
+		}
+		t += period;
+	}
+	edge(edges, t, false);
+}
+
+/**
+* @brief The software gated PHY: a long interval continues with the running timer, a new interval is switched and the
+* timer is restarted by the interrupt after its latency.
+*/
+static void replay_software(void (*load)(void), edges_t *edges)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint32_t t = 0;
+	uint32_t period = 0;
+
+	load();
+	edges->size = 0;
+	status = embx_ir_tx_phy_descriptor_next(&pd); /* The send function */
+	while( status != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_OK ) {
+			edge(edges, t, pd->phy_interval_type == mark);
+			period = period_ns(pd->period);
+		}
+		t += period; /* The compare match */
+		status = embx_ir_tx_phy_descriptor_next(&pd);
+		if( status != STATUS_NO_CHANGE ) {
+			t += latency(); /* The interrupt switches the carrier and restarts the timer */
+		}
+	}
+	edge(edges, t, false);
+}
+
+/**
+* @brief The event gated PHY: the overflow switches the carrier, the interrupt programs the period that has started.
+* @details The counter has counted for the latency of the interrupt when the top value is written.  If it has passed
+* the top value, the interrupt switches the carrier, moves the counter back by the period, and programs the next one.
+* @returns the number of periods whose top value was written too late, or UINT16_MAX if the queue was refused.
+*/
+static uint16_t replay_event(void (*load)(void), edges_t *edges)
+{
+	embx_ir_tx_gate_t gate;
+	embx_ir_tx_phy_interval_t type;
+	embx_ir_tx_gate_action_t action;
+	uint16_t top;
+	uint16_t late = 0;
+	uint32_t t = 0;
+	uint32_t isr;
+	uint32_t period;
+
+	load();
+	edges->size = 0;
+	if( embx_ir_tx_gate_first(&gate, &type, &top, &action) != STATUS_OK ) { /* The send function */
+		return UINT16_MAX;
+	}
+	edge(edges, t, type == mark);
+	period = period_ns(top);
+	while( 1 ) {
+		t += period; /* The overflow */
+		if( action == EMBX_IR_TX_GATE_START ) {
+			edge(edges, t + EVSYS_LATENCY_NS, true);
+		} else if( (action == EMBX_IR_TX_GATE_STOP) || (action == EMBX_IR_TX_GATE_END) ) {
+			edge(edges, t + EVSYS_LATENCY_NS, false);
+		}
+		isr = t + latency(); /* The top value is written by the interrupt */
+		while( 1 ) {
+			if( embx_ir_tx_gate_next(&gate, &top, &action) != STATUS_OK ) {
+				return late;
+			}
+			if( ((isr - t) / TICK_NS) <= top ) {
+				period = period_ns(top);
+				break;
+			}
+			late++; /* The overflow at the end of the period has been missed */
+			t += period_ns(top);
+			if( action == EMBX_IR_TX_GATE_START ) {
+				edge(edges, isr, true);
+			} else if( (action == EMBX_IR_TX_GATE_STOP) || (action == EMBX_IR_TX_GATE_END) ) {
+				edge(edges, isr, false);
+			}
+		}
+	}
+}
+
+/**
+* @brief Compares edges with the ideal edges.
+* @returns the largest error in nsec.
+*/
+static uint32_t compare(const char *name, const edges_t *ideal, const edges_t *edges)
+{
+	uint32_t max = 0, error;
+	uint64_t sum = 0;
+	uint16_t n;
+
+	if( edges->size != ideal->size ) {
+		printf("FAIL %s: %u edges, expected %u\n", name, edges->size, ideal->size);
+		failures++;
+		return UINT32_MAX;
+	}
+	for( n = 0; n < ideal->size; n++ ) {
+		if( edges->on[n] != ideal->on[n] ) {
+			printf("FAIL %s: edge %u has the wrong direction\n", name, n);
+			failures++;
+		}
+		error = (edges->ns[n] > ideal->ns[n]) ? (edges->ns[n] - ideal->ns[n]) : (ideal->ns[n] - edges->ns[n]);
+		max = (error > max) ? error : max;
+		sum += error;
+	}
+	printf("%-8s %3u edges, edge error max %9lu nsec, mean %9lu nsec\n", name, ideal->size, (unsigned long)max, (unsigned long)(sum / ideal->size));
+	return max;
+}
+
+int main(void)
+{
+	static edges_t ideal, software, event;
+	uint32_t software_max, event_max;
+	uint16_t late;
+
+	replay_ideal(fill, &ideal);
+	replay_software(fill, &software);
+	late = replay_event(fill, &event);
+
+	software_max = compare("software", &ideal, &software);
+	event_max = compare("event", &ideal, &event);
+
+	if( late != 0 ) {
+		printf("FAIL event: %u periods were programmed after they ended\n", late);
+		failures++;
+	}
+	if( event_max > EVSYS_LATENCY_NS ) {
+		printf("FAIL event: the edges are later than the event path\n");
+		failures++;
+	}
+	if( software_max <= (LATENCY_MAX_USEC * 1000UL) ) {
+		printf("FAIL software: the latencies did not accumulate\n");
+		failures++;
+	}
+
+	/* An interval shorter than the latency of the interrupt is refused, the queue is left for the software PHY */
+	latency_min_usec = LATENCY_MAX_USEC;
+	if( (replay_event(fill_short, &event) != UINT16_MAX) || (embx_ir_tx_phy_descriptor_get_tx_index() != 0) ) {
+		printf("FAIL short: the queue with a SPACE shorter than the latency was not refused\n");
+		failures++;
+	}
+	/* A streamed one is recovered by the interrupt, its edge is late by the latency */
+	replay_ideal(stream_short, &ideal);
+	late = replay_event(stream_short, &event);
+	event_max = compare("short", &ideal, &event);
+	if( (late != 1) || (event_max > (LATENCY_MAX_USEC * 1000UL)) ) {
+		printf("FAIL short: the period programmed late was not recovered\n");
+		failures++;
+	}
+
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_gate_timeline passed\n");
+	return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_tx_modulator.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Checks the carrier bursts of the IR modulator against a GCLK tick model of the TC.
+ * @details The modulator runs on the host backend of the HAL, see host/hal.  Marks of lengths that stop the carrier at
+ * any phase are played and the pin is sampled on every tick: each MARK has to start with a full pulse, all the pulses
+ * but the last have the duty cycle, and the pin has to be low during every SPACE.  Two emitters share the carrier.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_modulator.h"
+
+static uint16_t failures;
+
+/**
+* @brief Plays a MARK and the following SPACE, both in GCLK ticks, and checks the pin.
+*/
+static void burst(const char *name, uint32_t mark_ticks, uint32_t space_ticks, uint32_t period, uint32_t high)
+{
+	uint32_t t, run = 0, pulses = 0, last_rise = 0;
+	bool level, previous = false;
+
+	embx_ir_tx_modulator_start();
+	for( t = 0; t < mark_ticks; t++ ) {
+		embx_hal_host_run(1);
+		level = embx_hal_host_get_pin(TC_IR_MODULATOR_PIN);
+		if( (t == 0) && (level == false) ) {
+			printf("FAIL %s: the mark of %lu ticks does not start high\n", name, (unsigned long)mark_ticks);
+			failures++;
+		}
+		if( (level == true) && (previous == false) ) {
+			if( (pulses != 0) && ((t - last_rise) != period) ) {
+				printf("FAIL %s: rising edges %lu ticks apart, expected %lu\n", name, (unsigned long)(t - last_rise), (unsigned long)period);
+				failures++;
+			}
+			last_rise = t;
+			pulses++;
+			run = 0;
+		}
+		if( level == true ) {
+			run++;
+		} else if( (previous == true) && (run != high) ) {
+			printf("FAIL %s: pulse %lu is %lu ticks, expected %lu\n", name, (unsigned long)pulses, (unsigned long)run, (unsigned long)high);
+			failures++;
+		}
+		previous = level;
+	}
+	if( pulses != ((mark_ticks + period - 1) / period) ) {
+		printf("FAIL %s: %lu pulses in a mark of %lu ticks\n", name, (unsigned long)pulses, (unsigned long)mark_ticks);
+		failures++;
+	}
+
+	embx_ir_tx_modulator_stop();
+	for( t = 0; t < space_ticks; t++ ) {
+		if( embx_hal_host_get_pin(TC_IR_MODULATOR_PIN) == true ) {
+			printf("FAIL %s: the pin is high %lu ticks into a space\n", name, (unsigned long)t);
+			failures++;
+			break;
+		}
+		embx_hal_host_run(1);
+	}
+}
+
+/**
+* @brief Marks that end at every phase of the carrier, including in the middle of a pulse.
+*/
+static void test_phase(void)
+{
+	uint32_t period = EMBX_IR_TX_MODULATOR_TICKS(KHz_38);
+	uint32_t high = ((period * EMBX_IR_TX_MODULATOR_DUTY_PCT) + 50) / 100;
+	uint32_t mark;
+
+	embx_hal_host_reset();
+	embx_ir_tx_modulator_init(EMBX_IR_MODULATOR_GCLK, KHz_38, false);
+	if( embx_hal_host_get_pin(TC_IR_MODULATOR_PIN) == true ) {
+		printf("FAIL phase: the pin is high after init\n");
+		failures++;
+	}
+	for( mark = 1; mark <= (3 * period); mark += 7 ) {
+		burst("phase", mark, 100 + mark, period, high);
+	}
+	/* A NEC header, 9 ms of carrier */
+	burst("phase", 9000 * (EMBX_IR_MODULATOR_GCLK_FREQ / 1000000), 4500 * (EMBX_IR_MODULATOR_GCLK_FREQ / 1000000), period, high);
+}
+
+/**
+* @brief The frequency and the duty cycle are computed from the GCLK and checked against their ranges.
+*/
+static void test_settings(void)
+{
+	uint32_t period;
+
+	embx_hal_host_reset();
+	embx_ir_tx_modulator_init(EMBX_IR_MODULATOR_GCLK, KHz_38, false);
+	if( (embx_ir_tx_modulator_set_freq(EMBX_IR_TX_MODULATOR_MIN_HZ - 1) != STATUS_ERR_BAD_FRQ) ||
+		(embx_ir_tx_modulator_set_freq(EMBX_IR_TX_MODULATOR_MAX_HZ + 1) != STATUS_ERR_BAD_FRQ) ||
+		(embx_ir_tx_modulator_set_duty(EMBX_IR_TX_MODULATOR_MAX_DUTY_PCT + 1) != STATUS_ERR_INVALID_ARG) ) {
+		printf("FAIL settings: an out of range setting was accepted\n");
+		failures++;
+	}
+
+	if( (embx_ir_tx_modulator_set_freq(KHz_30) != STATUS_OK) || (embx_ir_tx_modulator_set_duty(25) != STATUS_OK) ) {
+		printf("FAIL settings: 30 kHz at 25%% was refused\n");
+		failures++;
+	}
+	period = EMBX_IR_TX_MODULATOR_TICKS(KHz_30);
+	burst("settings", 5 * period + 11, 300, period, ((period * 25) + 50) / 100);
+
+	/* A carrier measured from a remote */
+	embx_ir_tx_modulator_set_freq(37200);
+	period = EMBX_IR_TX_MODULATOR_TICKS(37200);
+	burst("settings", 4 * period, 300, period, ((period * 25) + 50) / 100);
+	if( embx_ir_tx_modulator_get_freq() != (EMBX_IR_MODULATOR_GCLK_FREQ / period) ) {
+		printf("FAIL settings: %lu Hz generated\n", (unsigned long)embx_ir_tx_modulator_get_freq());
+		failures++;
+	}
+}
+
+/**
+* @brief An emitter that starts during a MARK of another one waits for the low part of the shared carrier, its first
+* pulse is full and in phase with the other emitter.
+*/
+static void test_emitters(void)
+{
+	static const uint8_t pin[EMBX_IR_TX_CHANNELS] = TC_IR_MODULATOR_PINS;
+	uint32_t period = EMBX_IR_TX_MODULATOR_TICKS(KHz_38);
+	uint32_t high = ((period * EMBX_IR_TX_MODULATOR_DUTY_PCT) + 50) / 100;
+	uint32_t start, t, run = 0, first = 0;
+	bool level[EMBX_IR_TX_CHANNELS], previous = false;
+
+	embx_hal_host_reset();
+	embx_ir_tx_modulator_init(EMBX_IR_MODULATOR_GCLK, KHz_38, false);
+
+	for( start = 1; start < (2 * period); start += 13 ) {
+		embx_ir_tx_modulator_start_ch(0);
+		for( t = 0; t < start; t++ ) {
+			embx_hal_host_run(1);
+		}
+		embx_ir_tx_modulator_start_ch(1);
+		run = 0;
+		first = 0;
+		previous = false;
+		for( t = 0; t < (3 * period); t++ ) {
+			embx_hal_host_run(1);
+			level[0] = embx_hal_host_get_pin(pin[0]);
+			level[1] = embx_hal_host_get_pin(pin[1]);
+			if( (level[1] == true) && (level[0] == false) ) {
+				printf("FAIL emitters: emitter 1 is high while emitter 0 is low\n");
+				failures++;
+				break;
+			}
+			if( level[1] == true ) {
+				run++;
+			} else if( (previous == true) && (first == 0) ) {
+				first = run;
+			}
+			previous = level[1];
+		}
+		if( first != high ) {
+			printf("FAIL emitters: started %lu ticks into a mark, the first pulse is %lu ticks\n", (unsigned long)start, (unsigned long)first);
+			failures++;
+		}
+
+		/* Emitter 1 keeps the carrier after emitter 0 is done */
+		embx_ir_tx_modulator_stop_ch(0);
+		run = 0;
+		for( t = 0; t < period; t++ ) {
+			embx_hal_host_run(1);
+			run += (embx_hal_host_get_pin(pin[1]) == true) ? 1 : 0;
+			if( embx_hal_host_get_pin(pin[0]) == true ) {
+				printf("FAIL emitters: emitter 0 is high after its stop\n");
+				failures++;
+				break;
+			}
+		}
+		if( run != high ) {
+			printf("FAIL emitters: emitter 1 has %lu high ticks per period after emitter 0 stopped\n", (unsigned long)run);
+			failures++;
+		}
+		embx_ir_tx_modulator_stop_ch(1);
+		if( (embx_hal_host_tc_running(TC_IR_MODULATOR_MODULE) == true) || (embx_hal_host_get_pin(pin[1]) == true) ) {
+			printf("FAIL emitters: the carrier runs after the last stop\n");
+			failures++;
+		}
+		for( t = 0; t < 100; t++ ) {
+			embx_hal_host_run(1);
+		}
+	}
+}
+
+int main(void)
+{
+	test_phase();
+	test_settings();
+	test_emitters();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_modulator passed\n");
+	return 0;
+}
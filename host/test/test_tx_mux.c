@@ -0,0 +1,209 @@
+/**
+ * @file test_tx_mux.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Replays the schedule of two IR emitters on the host and checks the timeline of each emitter in ticks.
+ * @details The test plays the role of the TC3 interrupt of embx_ir_tx_emitters: each timer period lasts 
+ * embx_ir_tx_mux_get_ticks ticks and ends with embx_ir_tx_mux_advance.  The second emitter is started in the middle
+ * of a period, as a send while the timer runs does.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_tx_mux.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+/** The most intervals recorded per emitter */
+#define TIMELINE_SZ		(16)
+
+/** An emitted mark or space */
+typedef struct {
+	embx_ir_tx_phy_interval_t type;
+	uint32_t start;
+	uint32_t ticks;
+} interval_t;
+
+/** An interval filled into a queue */
+typedef struct {
+	embx_ir_tx_phy_interval_t type;
+	uint32_t usec;
+} fill_t;
+
+static interval_t timeline[EMBX_IR_TX_CHANNELS][TIMELINE_SZ];
+static uint16_t timeline_size[EMBX_IR_TX_CHANNELS];
+static embx_ir_tx_mux_t mux;
+static uint16_t failures;
+
+/** The descriptor module checks the state of the PHY before a reset of channel 0 */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return false;
+}
+
+/**
+* @brief Opens a new interval of an emitter at the time t.
+*/
+static void open(uint8_t channel, uint32_t t)
+{
+	if( timeline_size[channel] < TIMELINE_SZ ) {
+		timeline[channel][timeline_size[channel]].type = mux.type[channel];
+		timeline[channel][timeline_size[channel]].start = t;
+		timeline[channel][timeline_size[channel]].ticks = 0;
+		timeline_size[channel]++;
+	}
+}
+
+/**
+* @brief Closes the interval of each emitter that has changed at the time t and opens the next one if it is active.
+*/
+static void record(uint8_t changed, uint32_t t)
+{
+	uint8_t channel;
+	interval_t *last;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		if( ((changed & (1 << channel)) == 0) || (timeline_size[channel] == 0) ) {
+			continue;
+		}
+		last = &timeline[channel][timeline_size[channel] - 1];
+		last->ticks = t - last->start;
+		if( (mux.active & (1 << channel)) != 0 ) {
+			open(channel, t);
+		}
+	}
+}
+
+/**
+* @brief Fills the queue of an emitter.
+*/
+static void fill(uint8_t channel, const fill_t *f, uint16_t size)
+{
+	uint16_t n;
+
+	for( n = 0; n < size; n++ ) {
+		embx_ir_tx_phy_descriptor_fill_ch(channel, n == 0, f[n].type, f[n].usec, 0, 0);
+	}
+}
+
+/**
+* @brief Checks the timeline of an emitter, each interval lasts the ticks of its descriptor and follows the previous one.
+*/
+static void expect(const char *name, uint8_t channel, const fill_t *f, uint16_t size, uint32_t start)
+{
+	uint32_t ticks;
+	uint16_t n;
+
+	if( timeline_size[channel] != size ) {
+		printf("FAIL %s: emitter %u has %u intervals, expected %u\n", name, channel, timeline_size[channel], size);
+		failures++;
+		return;
+	}
+	for( n = 0; n < size; n++ ) {
+		ticks = (EMBX_IR_TX_PHY_PERIOD(f[n].usec) + 1UL) * (EMBX_IR_TX_PHY_OVERFLOWS(f[n].usec) + 1UL);
+		if( (timeline[channel][n].type != f[n].type) || (timeline[channel][n].start != start) || 
+			(timeline[channel][n].ticks != ticks) ) {
+			printf("FAIL %s: emitter %u interval %u is %s at %lu for %lu ticks, expected %s at %lu for %lu ticks\n", 
+				   name, channel, n, (timeline[channel][n].type == mark) ? "mark" : "space", 
+				   (unsigned long)timeline[channel][n].start, (unsigned long)timeline[channel][n].ticks,
+				   (f[n].type == mark) ? "mark" : "space", (unsigned long)start, (unsigned long)ticks);
+			failures++;
+		}
+		start += ticks;
+	}
+}
+
+/**
+* @brief Emitter 0 starts at tick 0, emitter 1 starts at tick 'at' in the middle of a timer period.
+*/
+static void replay(uint32_t at)
+{
+	uint32_t t = 0, ticks;
+	bool started = false;
+
+	timeline_size[0] = 0;
+	timeline_size[1] = 0;
+	embx_ir_tx_mux_init(&mux);
+	embx_ir_tx_mux_start(&mux, 0);
+	open(0, 0);
+
+	ticks = embx_ir_tx_mux_get_ticks(&mux);
+	while( (ticks != 0) || (started == false) ) {
+		if( (started == false) && ((ticks == 0) || ((t + ticks) > at)) ) {
+			record(embx_ir_tx_mux_advance(&mux, at - t), at);
+			t = at;
+			embx_ir_tx_mux_start(&mux, 1);
+			open(1, t);
+			started = true;
+		} else {
+			t += ticks;
+			record(embx_ir_tx_mux_advance(&mux, ticks), t);
+		}
+		ticks = embx_ir_tx_mux_get_ticks(&mux);
+	}
+}
+
+/**
+* @brief Two emitters with different schedules, the second one starts at several points of the first one's timeline.
+*/
+static void test_schedules(void)
+{
+	static const fill_t f0[] = { { mark, 560 }, { space, 560 }, { mark, 1680 }, { space, 600000 }, { mark, 560 } };
+	static const fill_t f1[] = { { mark, 9000 }, { space, 4500 }, { mark, 560 }, { space, 40000 } };
+	static const uint32_t at[] = { 0, 1, 69, 70, 100, 350, 20000, 80000 };
+	char name[32];
+	uint16_t n;
+
+	for( n = 0; n < (sizeof(at) / sizeof(at[0])); n++ ) {
+		fill(0, f0, sizeof(f0) / sizeof(f0[0]));
+		fill(1, f1, sizeof(f1) / sizeof(f1[0]));
+		replay(at[n]);
+		snprintf(name, sizeof(name), "schedules at %lu", (unsigned long)at[n]);
+		expect(name, 0, f0, sizeof(f0) / sizeof(f0[0]), 0);
+		expect(name, 1, f1, sizeof(f1) / sizeof(f1[0]), at[n]);
+	}
+}
+
+/**
+* @brief An emitter in transmission cannot be started again, an empty queue is refused, a played queue cannot be reset.
+*/
+static void test_refused(void)
+{
+	static const fill_t f[] = { { mark, 560 }, { space, 560 } };
+	enum status_code status;
+
+	embx_ir_tx_mux_init(&mux);
+	fill(1, f, sizeof(f) / sizeof(f[0]));
+	if( embx_ir_tx_mux_start(&mux, 1) != STATUS_OK ) {
+		printf("FAIL refused: start failed\n");
+		failures++;
+	}
+	if( (embx_ir_tx_mux_start(&mux, 1) != STATUS_BUSY) || (embx_ir_tx_phy_descriptor_reset_ch(1) != STATUS_BUSY) ) {
+		printf("FAIL refused: an emitter in transmission was restarted or reset\n");
+		failures++;
+	}
+	while( embx_ir_tx_mux_get_ticks(&mux) != 0 ) {
+		embx_ir_tx_mux_advance(&mux, embx_ir_tx_mux_get_ticks(&mux));
+	}
+	if( embx_ir_tx_phy_descriptor_reset_ch(1) != STATUS_OK ) {
+		printf("FAIL refused: the queue is not released at the end of the transmission\n");
+		failures++;
+	}
+	status = embx_ir_tx_mux_start(&mux, 1);
+	if( (status != STATUS_ERR_BAD_DATA) || (mux.active != 0) ) {
+		printf("FAIL refused: an empty queue returns 0x%x\n", status);
+		failures++;
+	}
+}
+
+int main(void)
+{
+	test_schedules();
+	test_refused();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_mux passed\n");
+	return 0;
+}
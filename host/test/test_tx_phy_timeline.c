@@ -0,0 +1,207 @@
+/**
+ * @file test_tx_phy_timeline.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Replays the IR Tx PHY descriptor timeline on the host and checks the emitted durations.
+ * @details The test plays the role of the TC3 compare match interrupt: each call to embx_ir_tx_phy_descriptor_next
+ * is one period of the timer, the period is top + 1 ticks of EMBX_IR_TX_PHY_USEC_PER_TICK.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+/** The longest timeline replayed by a test */
+#define TIMELINE_SZ		(512)
+
+/** An emitted mark or space */
+typedef struct {
+	embx_ir_tx_phy_interval_t type;
+	uint32_t usec;
+} interval_t;
+
+static interval_t timeline[TIMELINE_SZ];
+static uint16_t timeline_size;
+static bool tx_in_progress;
+static uint16_t failures;
+
+/** The descriptor module checks the state of the PHY before a reset */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return tx_in_progress;
+}
+
+/**
+* @brief Runs the timer until the queue is empty and records the duration of every interval.
+*/
+static void replay(void)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint32_t period_usec = 0;
+
+	timeline_size = 0;
+	tx_in_progress = true;
+	status = embx_ir_tx_phy_descriptor_next(&pd);
+	while( status != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_OK ) {
+			if( timeline_size == TIMELINE_SZ ) {
+				break;
+			}
+			period_usec = (pd->period + 1UL) * EMBX_IR_TX_PHY_USEC_PER_TICK;
+			timeline[timeline_size].type = pd->phy_interval_type;
+			timeline[timeline_size].usec = 0;
+			timeline_size++;
+		}
+		timeline[timeline_size - 1].usec += period_usec;
+		status = embx_ir_tx_phy_descriptor_next(&pd);
+	}
+	tx_in_progress = false;
+}
+
+/**
+* @brief Checks one emitted interval.  The error allowed is half a tick plus one tick for each additional period.
+*/
+static void expect(const char *name, uint16_t n, embx_ir_tx_phy_interval_t type, uint32_t usec)
+{
+	uint32_t periods = (usec / (EMBX_IR_TX_PHY_MAX_TICKS * EMBX_IR_TX_PHY_USEC_PER_TICK)) + 1;
+	uint32_t tolerance = (EMBX_IR_TX_PHY_USEC_PER_TICK / 2) + ((periods - 1) * EMBX_IR_TX_PHY_USEC_PER_TICK);
+	uint32_t error;
+
+	if( n >= timeline_size ) {
+		printf("FAIL %s: interval %u missing\n", name, n);
+		failures++;
+		return;
+	}
+	error = (timeline[n].usec > usec) ? (timeline[n].usec - usec) : (usec - timeline[n].usec);
+	if( (timeline[n].type != type) || (error > tolerance) ) {
+		printf("FAIL %s: interval %u is %s %lu usec, expected %s %lu usec\n", name, n,
+			   (timeline[n].type == mark) ? "mark" : "space", (unsigned long)timeline[n].usec,
+			   (type == mark) ? "mark" : "space", (unsigned long)usec);
+		failures++;
+	}
+}
+
+/**
+* @brief Intervals from one tick up to several periods of the 16-bit timer.
+*/
+static void test_durations(void)
+{
+	static const uint32_t usec[] = { 8, 100, 420, 2040, 2048, 3400, 17100, 30000, 65535, 100000, 524288, 600000, 2000000 };
+	uint16_t n;
+
+	for( n = 0; n < (sizeof(usec) / sizeof(usec[0])); n++ ) {
+		embx_ir_tx_phy_descriptor_fill(n == 0, ((n & 1) == 0) ? mark : space, usec[n], 0, 0);
+	}
+	replay();
+	for( n = 0; n < (sizeof(usec) / sizeof(usec[0])); n++ ) {
+		expect("durations", n, ((n & 1) == 0) ? mark : space, usec[n]);
+	}
+	if( timeline_size != n ) {
+		printf("FAIL durations: %u intervals, expected %u\n", timeline_size, n);
+		failures++;
+	}
+}
+
+/**
+* @brief A repeated long interval keeps its periods on every repeat.
+*/
+static void test_repeat(void)
+{
+	uint16_t n;
+
+	embx_ir_tx_phy_descriptor_fill(true, mark, 3400, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 600000, 2, 2);
+	replay();
+	for( n = 0; n < 6; n += 2 ) {
+		expect("repeat", n, mark, 3400);
+		expect("repeat", n + 1, space, 600000);
+	}
+	if( timeline_size != 6 ) {
+		printf("FAIL repeat: %u intervals, expected 6\n", timeline_size);
+		failures++;
+	}
+}
+
+/**
+* @brief A zero length interval still takes one tick.
+*/
+static void test_minimum(void)
+{
+	embx_ir_tx_phy_descriptor_fill(true, mark, 0, 0, 0);
+	replay();
+	expect("minimum", 0, mark, EMBX_IR_TX_PHY_USEC_PER_TICK);
+}
+
+/**
+* @brief A const table built by the compiler plays the same timeline as the descriptors filled at run time.
+*/
+static void test_const(void)
+{
+	static const uint32_t usec[] = { 0, 3, 4, 100, 3400, 1750, 65535, 524288, 524292, 600000, 2000000 };
+	static const embx_ir_tx_phy_descriptor_t table[] = {
+		EMBX_IR_TX_PHY_MARK(0), EMBX_IR_TX_PHY_SPACE(3), EMBX_IR_TX_PHY_MARK(4), EMBX_IR_TX_PHY_SPACE(100),
+		EMBX_IR_TX_PHY_MARK(3400), EMBX_IR_TX_PHY_SPACE(1750), EMBX_IR_TX_PHY_MARK(65535), EMBX_IR_TX_PHY_SPACE(524288),
+		EMBX_IR_TX_PHY_MARK(524292), EMBX_IR_TX_PHY_SPACE(600000), EMBX_IR_TX_PHY_MARK(2000000),
+	};
+	static const embx_ir_tx_phy_descriptor_t byte[] = { EMBX_IR_TX_PHY_PD_BYTE(0x23, 450, 420, 1300) };
+	interval_t filled[sizeof(usec) / sizeof(usec[0])];
+	uint16_t n;
+
+	for( n = 0; n < (sizeof(usec) / sizeof(usec[0])); n++ ) {
+		embx_ir_tx_phy_descriptor_fill(n == 0, ((n & 1) == 0) ? mark : space, usec[n], 0, 0);
+	}
+	replay();
+	for( n = 0; n < timeline_size; n++ ) {
+		filled[n] = timeline[n];
+	}
+
+	embx_ir_tx_phy_descriptor_load_const(table, EMBX_IR_TX_PHY_DESCRIPTOR_N(table));
+	replay();
+	if( timeline_size != EMBX_IR_TX_PHY_DESCRIPTOR_N(table) ) {
+		printf("FAIL const: %u intervals, expected %u\n", timeline_size, EMBX_IR_TX_PHY_DESCRIPTOR_N(table));
+		failures++;
+	}
+	for( n = 0; n < timeline_size; n++ ) {
+		if( (timeline[n].type != filled[n].type) || (timeline[n].usec != filled[n].usec) ) {
+			printf("FAIL const: interval %u is %lu usec, filled at run time %lu usec\n", n, 
+				   (unsigned long)timeline[n].usec, (unsigned long)filled[n].usec);
+			failures++;
+		}
+	}
+
+	/* 0x23 LSB first is 1, 1, 0, 0, 0, 1, 0, 0 */
+	embx_ir_tx_phy_descriptor_load_const(byte, EMBX_IR_TX_PHY_DESCRIPTOR_N(byte));
+	replay();
+	for( n = 0; n < 8; n++ ) {
+		expect("const byte", 2 * n, mark, 450);
+		expect("const byte", (2 * n) + 1, space, (((0x23 >> n) & 1) != 0) ? 1300 : 420);
+	}
+
+	/* The ring is the source again once the table has been sent */
+	embx_ir_tx_phy_descriptor_fill(false, mark, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 1690, 0, 0);
+	replay();
+	if( timeline_size != 2 ) {
+		printf("FAIL const: %u intervals filled after the table, expected 2\n", timeline_size);
+		failures++;
+	}
+	expect("after const", 0, mark, 560);
+	expect("after const", 1, space, 1690);
+}
+
+int main(void)
+{
+	test_durations();
+	test_repeat();
+	test_minimum();
+	test_const();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_phy_timeline passed\n");
+	return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file test_tx_program.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Compiles IR Tx PHY descriptor queues into programs on the host and checks the carrier cycles.
+ * @details Every edge of a program must be within half a carrier cycle of the edge of the queue, however many
+ * intervals come before it, so the rounding of the cycle counts does not accumulate.  The queues cover repeats, a
+ * stream, intervals longer than an entry, and a table that is too small.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_program.h"
+
+#define PROGRAM_SZ		(512)
+#define NEC_HZ			(38000)
+
+static uint16_t entry[PROGRAM_SZ];
+static embx_ir_tx_program_t program;
+static bool tx_in_progress;
+static uint16_t failures;
+
+/** The descriptor module and the compiler check the state of the PHY */
+bool embx_ir_tx_phy_get_state(void)
+{
+	return tx_in_progress;
+}
+
+static void check(const char *name, bool ok)
+{
+	if( ok == false ) {
+		printf("FAIL %s\n", name);
+		failures++;
+	}
+}
+
+static const embx_ir_tx_phy_interval_t *stream_type;
+static const uint32_t *stream_usec;
+static uint16_t stream_size;
+static uint16_t streamed;
+
+/**
+* @brief Fills the queue with the next intervals of the stream, the stream is closed after the last one.
+*/
+static void stream_callback(void *context)
+{
+	(void)context;
+	while( (streamed < stream_size) && ((streamed == 0) || (embx_ir_tx_phy_descriptor_get_free() != 0)) ) {
+		embx_ir_tx_phy_descriptor_fill(streamed == 0, stream_type[streamed], stream_usec[streamed], 0, 0);
+		streamed++;
+	}
+	if( streamed == stream_size ) {
+		embx_ir_tx_phy_descriptor_stream_close();
+	}
+}
+
+/**
+* @brief Loads intervals of any number into the queue as the Tx PHY would transmit them, through a stream.
+*/
+static void stream(const embx_ir_tx_phy_interval_t *type, const uint32_t *usec, uint16_t n)
+{
+	stream_type = type;
+	stream_usec = usec;
+	stream_size = n;
+	streamed = 0;
+	stream_callback(NULL);
+	if( streamed < n ) {
+		embx_ir_tx_phy_descriptor_stream_open(stream_callback, NULL, EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ / 2);
+	}
+}
+
+/**
+* @brief Checks the program against the intervals, adjacent intervals of the same type are one entry.
+* @returns the largest distance of an edge of the program from the edge of the intervals in nanoseconds.
+*/
+static uint32_t edges(const char *name, const embx_ir_tx_phy_interval_t *type, const uint32_t *usec, uint16_t n)
+{
+	uint64_t expected_ns = 0, cycles = 0, ns;
+	uint32_t error, max_error = 0;
+	uint16_t i, k = 0;
+
+	for( i = 0; i < n; i++ ) {
+		expected_ns += (uint64_t)usec[i] * 1000;
+		if( (i + 1 < n) && (type[i + 1] == type[i]) ) {
+			continue;
+		}
+		while( (k < program.size) && (((entry[k] & EMBX_IR_TX_PROGRAM_MARK) != 0) == (type[i] == mark)) ) {
+			cycles += EMBX_IR_TX_PROGRAM_CYCLES(entry[k]);
+			k++;
+		}
+		ns = (cycles * 1000000000ULL) / program.carrier_hz;
+		error = (uint32_t)((ns > expected_ns) ? (ns - expected_ns) : (expected_ns - ns));
+		max_error = (error > max_error) ? error : max_error;
+	}
+	check(name, k == program.size);
+	return max_error;
+}
+
+/**
+* @brief 67 intervals of 560 and 1690 usec, 21.28 and 64.22 cycles of 38 kHz, more than the queue holds.  Rounding
+* each interval on its own would move the last edge by about 0.25 cycles per interval.
+*/
+static void test_nec(void)
+{
+	static embx_ir_tx_phy_interval_t type[67];
+	static uint32_t usec[67];
+	uint32_t max_error;
+	uint16_t n = 0, b;
+
+	type[n] = mark;
+	usec[n++] = 9000;
+	type[n] = space;
+	usec[n++] = 4500;
+	for( b = 0; b < 32; b++ ) {
+		type[n] = mark;
+		usec[n++] = 560;
+		type[n] = space;
+		usec[n++] = ((0xE0E040BFUL >> b) & 1) ? 1690 : 560;
+	}
+	type[n] = mark;
+	usec[n++] = 560;
+	stream(type, usec, n);
+	check("nec compile", embx_ir_tx_program_compile(&program, entry, PROGRAM_SZ, NEC_HZ) == STATUS_OK);
+	check("nec size", (program.size == n) && (program.carrier_hz == NEC_HZ) && (program.entry == entry));
+	max_error = edges("nec edges", type, usec, n);
+	check("nec rounding", max_error <= (500000000UL / NEC_HZ));
+}
+
+/**
+* @brief A repeat is unrolled, the merged SPACEs of the repeat and of the gap are one entry.
+*/
+static void test_repeat(void)
+{
+	static const embx_ir_tx_phy_interval_t type[] = { mark, space, mark, space, mark, space, space, mark };
+	static const uint32_t usec[] = { 889, 889, 889, 889, 889, 889, 40000, 1778 };
+
+	embx_ir_tx_phy_descriptor_fill(true, mark, 889, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 889, 2, 2);
+	embx_ir_tx_phy_descriptor_fill(false, space, 40000, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 1778, 0, 0);
+	check("repeat compile", embx_ir_tx_program_compile(&program, entry, PROGRAM_SZ, 36000) == STATUS_OK);
+	check("repeat size", program.size == 7);
+	check("repeat rounding", edges("repeat edges", type, usec, 8) <= (500000000UL / 36000));
+}
+
+/**
+* @brief A SPACE of 2 s is 76000 cycles, more than an entry holds.
+*/
+static void test_long(void)
+{
+	embx_ir_tx_phy_descriptor_fill(true, mark, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 2000000, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 560, 0, 0);
+	check("long compile", embx_ir_tx_program_compile(&program, entry, PROGRAM_SZ, NEC_HZ) == STATUS_OK);
+	check("long entries", (program.size == 5) && (entry[1] == EMBX_IR_TX_PROGRAM_MAX_CYCLES) &&
+						  (entry[2] == EMBX_IR_TX_PROGRAM_MAX_CYCLES) && (entry[3] == (76021 - 21 - (2 * EMBX_IR_TX_PROGRAM_MAX_CYCLES))) &&
+						  ((entry[4] & EMBX_IR_TX_PROGRAM_MARK) != 0));
+}
+
+/**
+* @brief A stream of 100 intervals of 600 usec, 24 cycles of 40 kHz, is compiled whole.
+*/
+static void test_stream(void)
+{
+	static embx_ir_tx_phy_interval_t type[100];
+	static uint32_t usec[100];
+	uint16_t n;
+
+	for( n = 0; n < 100; n++ ) {
+		type[n] = ((n & 1) == 0) ? mark : space;
+		usec[n] = 600;
+	}
+	stream(type, usec, n);
+	check("stream compile", embx_ir_tx_program_compile(&program, entry, PROGRAM_SZ, 40000) == STATUS_OK);
+	check("stream size", (streamed == 100) && (program.size == 100) && (EMBX_IR_TX_PROGRAM_CYCLES(entry[99]) == 24));
+}
+
+static void test_errors(void)
+{
+	embx_ir_tx_phy_descriptor_fill(true, mark, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 560, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, mark, 560, 0, 0);
+	check("overflow", embx_ir_tx_program_compile(&program, entry, 2, NEC_HZ) == STATUS_ERR_OVERFLOW);
+	tx_in_progress = true;
+	check("busy", embx_ir_tx_program_compile(&program, entry, PROGRAM_SZ, NEC_HZ) == STATUS_BUSY);
+	tx_in_progress = false;
+}
+
+int main(void)
+{
+	test_nec();
+	test_repeat();
+	test_long();
+	test_stream();
+	test_errors();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_program passed\n");
+	return 0;
+}
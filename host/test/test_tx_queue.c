@@ -0,0 +1,330 @@
+/**
+ * @file test_tx_queue.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Replays the IR Tx message queue on the host and checks the order, the gaps, and the callbacks.
+ * @details The test plays the role of the IR Tx PHY: send marks the PHY busy and each call to 
+ * embx_ir_tx_phy_descriptor_next is one period of the timer.  The frames are longer than the descriptor ring so they
+ * are encoded by the queue callback while they are replayed.  The callbacks of the messages must not be called in a
+ * critical section of the queue.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include "embx/embx_ir/embx_ir_tx_queue.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+/** The longest timeline replayed by a test */
+#define TIMELINE_SZ		(1024)
+/** The most callbacks recorded by a test */
+#define DONE_SZ			(16)
+
+/** A pulse distance protocol with 48 bit frames, a frame does not fit into the ring */
+static const embx_ir_protocol_t protocol = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1680,
+	.trailer_mark_usec = 560,
+	.gap_usec = 40000,
+	.nbits = 48,
+};
+
+/** An emitted mark or space */
+typedef struct {
+	embx_ir_tx_phy_interval_t type;
+	uint32_t usec;
+} interval_t;
+
+static interval_t timeline[TIMELINE_SZ];
+static uint16_t timeline_size;
+static bool tx_in_progress;
+static uint16_t sends;
+static uint16_t failures;
+
+/** The callbacks in the order they were called, the context is the id of the message */
+static uint8_t done_id[DONE_SZ];
+static enum status_code done_status[DONE_SZ];
+static uint8_t done_size;
+/** Queued by the callback of the message with the id chain_after */
+static embx_ir_tx_msg_t chain_msg;
+static uint8_t chain_after;
+
+bool embx_ir_tx_phy_get_state(void)
+{
+	return tx_in_progress;
+}
+
+enum status_code embx_ir_tx_phy_send(void)
+{
+	if( tx_in_progress == true ) {
+		return STATUS_BUSY;
+	}
+	tx_in_progress = true;
+	sends++;
+	return STATUS_OK;
+}
+
+static void callback(enum status_code status, void *context)
+{
+	uint8_t id = (uint8_t)(uintptr_t)context;
+
+	if( embx_hal_host_get_critical_depth() != 0 ) {
+		printf("FAIL callback %u: called in a critical section\n", id);
+		failures++;
+	}
+	if( done_size < DONE_SZ ) {
+		done_id[done_size] = id;
+		done_status[done_size] = status;
+		done_size++;
+	}
+	if( id == chain_after ) {
+		embx_ir_tx_queue_enqueue(&chain_msg);
+	}
+}
+
+/**
+* @brief Fills in a message, the id is sent in the first byte of the frame.
+*/
+static void message(embx_ir_tx_msg_t *msg, uint8_t id, uint8_t repeats, uint8_t priority)
+{
+	memset(msg, 0, sizeof(*msg));
+	msg->protocol = &protocol;
+	msg->frame.nbits = protocol.nbits;
+	msg->frame.data[0] = id;
+	msg->frame.data[5] = 0xA5;
+	msg->repeats = repeats;
+	msg->priority = priority;
+	msg->callback = callback;
+	msg->context = (void *)(uintptr_t)id;
+}
+
+/**
+* @brief Runs the timer until the queue is empty and records the duration of every interval.
+*/
+static void replay(void)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status;
+	uint32_t period_usec = 0;
+
+	timeline_size = 0;
+	status = embx_ir_tx_phy_descriptor_next(&pd);
+	while( status != STATUS_ERR_BAD_DATA ) {
+		if( status == STATUS_OK ) {
+			if( timeline_size == TIMELINE_SZ ) {
+				break;
+			}
+			period_usec = (pd->period + 1UL) * EMBX_IR_TX_PHY_USEC_PER_TICK;
+			timeline[timeline_size].type = pd->phy_interval_type;
+			timeline[timeline_size].usec = 0;
+			timeline_size++;
+		}
+		timeline[timeline_size - 1].usec += period_usec;
+		status = embx_ir_tx_phy_descriptor_next(&pd);
+	}
+	tx_in_progress = false;
+}
+
+/**
+* @brief Splits the timeline into frames and returns the id of each frame, the gap after each frame is checked.
+*/
+static uint8_t frames(const char *name, uint8_t *id, uint8_t max)
+{
+	uint16_t n = 0, i;
+	uint8_t count = 0;
+
+	while( (n < timeline_size) && (count < max) ) {
+		if( (timeline[n].type != mark) || (timeline[n].usec != protocol.header_mark_usec) ) {
+			printf("FAIL %s: interval %u does not start a frame\n", name, n);
+			failures++;
+			return count;
+		}
+		id[count] = 0;
+		for( i = 0; i < 8; i++ ) {
+			if( timeline[n + 3 + (2 * i)].usec > protocol.zero_space_usec ) {
+				id[count] |= (uint8_t)(1 << i);
+			}
+		}
+		n += 2 + (2 * protocol.nbits) + 1;
+		if( (n >= timeline_size) || (timeline[n].type != space) || (timeline[n].usec != protocol.gap_usec) ) {
+			printf("FAIL %s: frame %u is not followed by the gap\n", name, count);
+			failures++;
+		}
+		n++;
+		count++;
+	}
+	return count;
+}
+
+/**
+* @brief Messages queued while the PHY is busy are sent by priority, repeats and chained messages follow without a new start.
+*/
+static void test_order(void)
+{
+	static const uint8_t expected_frames[] = { 1, 1, 3, 2, 4 };
+	static const uint8_t expected_done[] = { 1, 3, 2, 4 };
+	embx_ir_tx_msg_t msg;
+	uint8_t id[8];
+	uint8_t n, count;
+	uint32_t underruns = embx_ir_tx_phy_descriptor_get_underruns();
+
+	embx_ir_tx_queue_init();
+	sends = 0;
+	done_size = 0;
+	chain_after = 3;
+	message(&chain_msg, 4, 0, 0);
+
+	message(&msg, 1, 1, 0);
+	embx_ir_tx_queue_enqueue(&msg);
+	message(&msg, 2, 0, 0);
+	embx_ir_tx_queue_enqueue(&msg);
+	message(&msg, 3, 0, 5);
+	embx_ir_tx_queue_enqueue(&msg);
+	replay();
+
+	count = frames("order", id, sizeof(id));
+	if( (count != sizeof(expected_frames)) || (memcmp(id, expected_frames, count) != 0) ) {
+		printf("FAIL order: %u frames sent", count);
+		for( n = 0; n < count; n++ ) {
+			printf(" %u", id[n]);
+		}
+		printf("\n");
+		failures++;
+	}
+	if( (done_size != sizeof(expected_done)) || (memcmp(done_id, expected_done, done_size) != 0) ) {
+		printf("FAIL order: %u callbacks\n", done_size);
+		failures++;
+	}
+	for( n = 0; n < done_size; n++ ) {
+		if( done_status[n] != STATUS_OK ) {
+			printf("FAIL order: callback %u status 0x%x\n", n, done_status[n]);
+			failures++;
+		}
+	}
+	if( (sends != 1) || (embx_ir_tx_phy_descriptor_get_underruns() != underruns) ) {
+		printf("FAIL order: %u starts, %lu underruns\n", sends, (unsigned long)(embx_ir_tx_phy_descriptor_get_underruns() - underruns));
+		failures++;
+	}
+	if( embx_ir_tx_queue_get_pending() != 0 ) {
+		printf("FAIL order: %u messages left\n", embx_ir_tx_queue_get_pending());
+		failures++;
+	}
+}
+
+/**
+* @brief A flush removes the waiting messages, a full queue and an empty frame are refused.
+*/
+static void test_flush(void)
+{
+	embx_ir_tx_msg_t msg;
+	uint8_t id[4];
+	uint8_t n;
+	enum status_code status = STATUS_OK;
+
+	embx_ir_tx_queue_init();
+	done_size = 0;
+	chain_after = 0;
+
+	for( n = 1; n <= EMBX_IR_TX_QUEUE_SZ + 1; n++ ) {
+		message(&msg, n, 0, 0);
+		status = embx_ir_tx_queue_enqueue(&msg);
+	}
+	if( status != STATUS_ERR_NO_MEMORY ) {
+		printf("FAIL flush: a full queue returned 0x%x\n", status);
+		failures++;
+	}
+	msg.frame.nbits = 0;
+	if( embx_ir_tx_queue_enqueue(&msg) != STATUS_ERR_INVALID_ARG ) {
+		printf("FAIL flush: an empty frame was queued\n");
+		failures++;
+	}
+
+	embx_ir_tx_queue_flush();
+	if( (done_size != EMBX_IR_TX_QUEUE_SZ - 1) || (done_status[0] != STATUS_ERR_REQ_FLUSHED) ) {
+		printf("FAIL flush: %u messages flushed\n", done_size);
+		failures++;
+	}
+	replay();
+	if( (frames("flush", id, sizeof(id)) != 1) || (id[0] != 1) || (done_id[done_size - 1] != 1) ) {
+		printf("FAIL flush: the started message was not sent\n");
+		failures++;
+	}
+}
+
+/**
+* @brief The stream callback that replaces the one of the queue, the ring is not refilled.
+*/
+static void starve(void *context)
+{
+	(void)context;
+}
+
+/**
+* @brief The ring runs empty in the middle of a frame, the message cut short is reported when the next message starts.
+*/
+static void test_cut(void)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	embx_ir_tx_msg_t msg;
+	uint32_t underruns = embx_ir_tx_phy_descriptor_get_underruns();
+	uint8_t id[4];
+	uint8_t n;
+
+	embx_ir_tx_queue_init();
+	done_size = 0;
+	chain_after = 0;
+
+	message(&msg, 1, 0, 0);
+	embx_ir_tx_queue_enqueue(&msg);
+	for( n = 0; n < 10; n++ ) {
+		embx_ir_tx_phy_descriptor_next(&pd);
+	}
+	embx_ir_tx_phy_descriptor_stream_open(starve, NULL, EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ); /** The refills stop */
+	replay();
+	if( (embx_ir_tx_phy_descriptor_get_underruns() - underruns) != 1 ) {
+		printf("FAIL cut: %lu underruns\n", (unsigned long)(embx_ir_tx_phy_descriptor_get_underruns() - underruns));
+		failures++;
+	}
+	if( (timeline_size == 0) || (timeline_size >= (2 + (2 * protocol.nbits) + 1)) || (done_size != 0) ) {
+		printf("FAIL cut: %u intervals sent, %u callbacks\n", timeline_size, done_size);
+		failures++;
+	}
+
+	message(&msg, 2, 0, 0);
+	embx_ir_tx_queue_enqueue(&msg);
+	if( (done_size != 1) || (done_id[0] != 1) || (done_status[0] != STATUS_ERR_IO) ) {
+		printf("FAIL cut: the message cut short was not reported\n");
+		failures++;
+	}
+	replay();
+	if( (frames("cut", id, sizeof(id)) != 1) || (id[0] != 2) || (done_size != 2) || (done_status[1] != STATUS_OK) ) {
+		printf("FAIL cut: the next message was not sent\n");
+		failures++;
+	}
+	if( (embx_ir_tx_phy_descriptor_get_underruns() - underruns) != 1 ) {
+		printf("FAIL cut: the next message underran\n");
+		failures++;
+	}
+}
+
+int main(void)
+{
+	test_order();
+	test_flush();
+	test_cut();
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_tx_queue passed\n");
+	return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_vcd.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Checks a VCD file written by a host tool against the raw timing traces it was written from.
+ * @details usage: test_vcd vcd signal trace...
+ *
+ * The header must have the timescale of the host tools, a scope, the signal, and the end of the definitions.  The
+ * timestamps must increase.  The signal must change at every edge of the traces, with the duration of the intervals
+ * between the edges of a frame, and nowhere else.  tx_gate is high and rx_input is low during a MARK.  A trailing SPACE
+ * merges with the idle line and has no edge at its end.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdlib.h>
+#include <string.h>
+#include "../tools/ir_trace_file.h"
+#include "../tools/ir_vcd.h"
+
+#define LINE_SZ			(16384)
+
+/** The edges of the signal in the VCD file, in units of the timescale, and the level after each */
+static uint64_t *edge_time;
+static bool *edge_level;
+static uint32_t edges_n, edges_max;
+static uint16_t failures;
+
+static void fail(const char *what, unsigned long a, unsigned long b)
+{
+	printf("FAIL test_vcd: %s %lu, expected %lu\n", what, a, b);
+	failures++;
+}
+
+/**
+* @brief Reads the VCD file, checks the header and the timestamps, and records the changes of the signal.
+*/
+static bool read_vcd(const char *path, const char *signal)
+{
+	static char line[LINE_SZ];
+	char id = '\0', var_id, var_name[64];
+	bool timescale = false, scope = false, defined = false, dumpvars = false;
+	uint64_t t = 0, stamp;
+	unsigned width;
+	FILE *f;
+
+	if( (f = fopen(path, "r")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if( defined == false ) {
+			if( strcmp(line, "$timescale " IR_VCD_TIMESCALE " $end") == 0 ) {
+				timescale = true;
+			} else if( strncmp(line, "$scope module ", 14) == 0 ) {
+				scope = true;
+			} else if( (sscanf(line, "$var wire %u %c %63s $end", &width, &var_id, var_name) == 3) && (strcmp(var_name, signal) == 0) ) {
+				id = var_id;
+			} else if( strcmp(line, "$enddefinitions $end") == 0 ) {
+				defined = true;
+			}
+			continue;
+		}
+		if( line[0] == '#' ) {
+			stamp = strtoull(&line[1], NULL, 10);
+			if( (stamp <= t) && ((stamp != 0) || (edges_n != 0)) ) {
+				fail("timestamp", (unsigned long)stamp, (unsigned long)t + 1);
+			}
+			t = stamp;
+		} else if( strcmp(line, "$dumpvars") == 0 ) {
+			dumpvars = true;
+		} else if( strcmp(line, "$end") == 0 ) {
+			dumpvars = false;
+		} else if( (dumpvars == false) && ((line[0] == '0') || (line[0] == '1')) && (line[1] == id) && (line[2] == '\0') ) {
+			if( edges_n == edges_max ) {
+				edges_max = (edges_max == 0) ? 1024 : (2 * edges_max);
+				edge_time = realloc(edge_time, edges_max * sizeof(edge_time[0]));
+				edge_level = realloc(edge_level, edges_max * sizeof(edge_level[0]));
+			}
+			edge_level[edges_n] = (line[0] == '1');
+			edge_time[edges_n++] = t;
+		}
+	}
+	fclose(f);
+	if( (timescale == false) || (scope == false) || (defined == false) || (id == '\0') ) {
+		printf("FAIL test_vcd: %s has no timescale of " IR_VCD_TIMESCALE ", scope, %s, or end of the definitions\n", path, signal);
+		failures++;
+		return false;
+	}
+	return true;
+}
+
+/**
+* @brief Checks the edges of the frames of a trace, from the edge n on.
+* @returns the edge after the last one of the trace.
+*/
+static uint32_t check_trace(const char *path, uint32_t n, bool mark_level)
+{
+	static char line[LINE_SZ];
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_record_t record;
+	uint64_t offset, first = 0;
+	bool has_timestamp, level, started;
+	uint16_t i;
+	FILE *f;
+
+	if( (f = fopen(path, "r")) == NULL ) {
+		perror(path);
+		failures++;
+		return n;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		if( ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp) != STATUS_OK ) {
+			continue;
+		}
+		level = !mark_level;
+		offset = 0;
+		started = false;
+		for( i = 0; i <= record.size; i++ ) {
+			if( i < record.size ) {
+				if( ((elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK) ? mark_level : !mark_level) == level ) {
+					offset += elem[i].time_us * 1000ULL; /** The level continues, no edge */
+					continue;
+				}
+			} else if( level == !mark_level ) {
+				break; /** A trailing SPACE merges with the idle line */
+			}
+			if( n >= edges_n ) {
+				fail("edges", (unsigned long)edges_n, (unsigned long)n + 1);
+				fclose(f);
+				return n;
+			}
+			if( started == false ) { /** The frame starts at its first edge */
+				first = edge_time[n] - offset;
+				started = true;
+			}
+			level = !level;
+			if( (edge_time[n] - first) != offset ) {
+				fail("edge at ns", (unsigned long)(edge_time[n] - first), (unsigned long)offset);
+			}
+			if( edge_level[n] != level ) {
+				fail("level of edge", (unsigned long)edge_level[n], (unsigned long)level);
+			}
+			n++;
+			if( i < record.size ) {
+				offset += elem[i].time_us * 1000ULL;
+			}
+		}
+	}
+	fclose(f);
+	return n;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t n = 0;
+	int i;
+
+	if( argc < 4 ) {
+		fprintf(stderr, "usage: %s vcd signal trace...\n", argv[0]);
+		return 2;
+	}
+	if( read_vcd(argv[1], argv[2]) == true ) {
+		for( i = 3; i < argc; i++ ) {
+			n = check_trace(argv[i], n, strcmp(argv[2], "rx_input") != 0);
+		}
+		if( n != edges_n ) {
+			fail("edges", (unsigned long)edges_n, (unsigned long)n);
+		}
+	}
+	free(edge_time);
+	free(edge_level);
+	if( failures != 0 ) {
+		printf("%u failures\n", failures);
+		return 1;
+	}
+	printf("test_vcd %s passed, %lu edges of %s\n", argv[1], (unsigned long)n, argv[2]);
+	return 0;
+}
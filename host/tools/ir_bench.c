@@ -0,0 +1,343 @@
+/**
+ * @file ir_bench.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Runs the embx_bench cases on the host and compares them with a baseline.
+ * @details usage: ir_bench [-r rounds] [-b baseline] [-w baseline] [-t pct] [trace...]
+ *
+ * The synthetic corpus is measured, then each trace, a binary trace or raw timing text, is decoded as a recorded
+ * corpus with the protocol proposed by the analyzer.  The time is CLOCK_MONOTONIC so only ns/frame is reported, the
+ * cycles are measured on the board with embx_bench_tb.
+ *
+ * A baseline is a line per case: name, ns/frame, stack bytes, allocations.  With -b the exit status is 1 if a case
+ * is slower than its baseline by more than pct percent once the baseline is scaled by the median slowdown of the run, uses more stack, allocates more, or fails a frame of the synthetic
+ * corpus.  A recorded corpus may hold frames that are not frames of its protocol, e.g. the NEC repeat code.  -w writes
+ * the results as the new baseline.
+ */
+#include "ir_trace_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "embx/embx_ir/embx_ir_analyzer.h"
+#include "embx/embx_bench/embx_bench.h"
+
+/** The rounds of the measurement, a round passes over the synthetic corpus and then the recorded ones.  The fastest is reported. */
+#define BENCH_ROUNDS				(10)
+/** The passes over the captures of a trace in a round, a pass over them is shorter than a pass over the synthetic corpus */
+#define BENCH_RECORDED_PASSES		(8)
+/** The slowdown tolerated against the baseline, the clock of a shared host is noisy */
+#define BENCH_THRESHOLD_PCT			(50)
+/** The ratio of a time to its baseline is in units of 1/1000 */
+#define BENCH_RATIO_ONE				(1000UL)
+/** The most cases, the synthetic ones and a recorded one per trace */
+#define BENCH_MAX_RESULTS			(64)
+#define BENCH_NAME_SZ				(64)
+#define BENCH_LINE_SZ				(16384)
+
+/** @brief The captures of a trace */
+typedef struct {
+	const embx_ir_rx_buf_elem_t **elem;
+	uint16_t *size;
+	uint16_t n;
+} bench_captures_t;
+
+static embx_bench_result_t results[BENCH_MAX_RESULTS];
+static char names[BENCH_MAX_RESULTS][BENCH_NAME_SZ];
+static uint8_t results_n;
+/** The results of a round, the synthetic cases and then the recorded ones */
+static embx_bench_result_t pass[BENCH_MAX_RESULTS];
+static uint8_t pass_n;
+
+static uint32_t bench_read_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+}
+
+/**
+* @brief Appends a capture.
+*/
+static void bench_add_capture(bench_captures_t *captures, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	embx_ir_rx_buf_elem_t *copy = malloc(size * sizeof(elem[0]));
+
+	memcpy(copy, elem, size * sizeof(elem[0]));
+	captures->elem = realloc(captures->elem, (captures->n + 1) * sizeof(captures->elem[0]));
+	captures->size = realloc(captures->size, (captures->n + 1) * sizeof(captures->size[0]));
+	captures->elem[captures->n] = copy;
+	captures->size[captures->n] = size;
+	captures->n++;
+}
+
+/**
+* @brief Reads the captures of a trace file, returns false if it cannot be read.
+*/
+static bool bench_read_trace(const char *path, bench_captures_t *captures)
+{
+	static char line[BENCH_LINE_SZ];
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	ir_trace_file_map_t map;
+	enum status_code status;
+	bool has_timestamp;
+	FILE *f;
+
+	if( ir_trace_file_map(path, &map) == false ) {
+		return false;
+	}
+	if( ir_trace_file_is_binary(map.data, map.len) == true ) {
+		status = embx_ir_trace_reader_init(&reader, map.data, map.len);
+		while( (status == STATUS_OK) && ((status = embx_ir_trace_read(&reader, &record)) == STATUS_OK) ) {
+			if( ((status = embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ)) == STATUS_OK) && (record.size != 0) ) {
+				bench_add_capture(captures, elem, record.size);
+			}
+		}
+		ir_trace_file_unmap(&map);
+		if( status != STATUS_NO_CHANGE ) {
+			fprintf(stderr, "%s: not a trace that can be read\n", path);
+			return false;
+		}
+		return true;
+	}
+	ir_trace_file_unmap(&map);
+
+	if( (f = fopen(path, "r")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		status = ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp);
+		if( status == STATUS_OK ) {
+			bench_add_capture(captures, elem, record.size);
+		} else if( status != STATUS_NO_CHANGE ) {
+			fprintf(stderr, "%s: not a frame of at most %u intervals\n", path, EMBX_IR_RX_BUF_SZ);
+			fclose(f);
+			return false;
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+/**
+* @brief Measures the decoder over the captures of a trace, with the protocol proposed by the analyzer.
+*/
+static bool bench_recorded(const embx_bench_timer_t *timer, uint32_t rounds, const char *path)
+{
+	static embx_ir_analyzer_t analyzer;
+	bench_captures_t captures = { NULL, NULL, 0 };
+	embx_ir_protocol_t protocol;
+	const char *base = strrchr(path, '/');
+	uint16_t i;
+
+	if( bench_read_trace(path, &captures) == false ) {
+		return false;
+	}
+	embx_ir_analyzer_init(&analyzer);
+	for( i = 0; i < captures.n; i++ ) {
+		embx_ir_analyzer_add_frame(&analyzer, captures.elem[i], captures.size[i]);
+	}
+	if( (captures.n == 0) || (embx_ir_analyzer_propose(&analyzer, captures.elem[0], captures.size[0], &protocol) != STATUS_OK) ) {
+		fprintf(stderr, "%s: no protocol recognized\n", path);
+		return false;
+	}
+	if( pass_n < BENCH_MAX_RESULTS ) {
+		snprintf(names[pass_n], BENCH_NAME_SZ, "recorded_%.*s", (int)strcspn((base != NULL) ? (base + 1) : path, "."),
+				 (base != NULL) ? (base + 1) : path);
+		embx_bench_run_captures(timer, rounds, names[pass_n], &protocol, captures.elem, captures.size, captures.n,
+								&pass[pass_n]);
+		pass_n++;
+	}
+	for( i = 0; i < captures.n; i++ ) {
+		free((void *)captures.elem[i]);
+	}
+	free(captures.elem);
+	free(captures.size);
+	return true;
+}
+
+/**
+* @brief Orders the ratios of the results to the baseline.
+*/
+static int bench_ratio_cmp(const void *a, const void *b)
+{
+	const uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+* @brief Compares the results with a baseline.
+* @details The median ratio of the times to the baseline is the speed of the host during the run, a shared host runs
+* whole phases slower.  A case is a regression if it is slower than its baseline scaled by that ratio, never below 1.
+* @returns the number of regressions, or -1 if the baseline cannot be read.
+*/
+static int bench_compare(const char *path, uint32_t threshold_pct)
+{
+	static unsigned long baseline_ns[BENCH_MAX_RESULTS];
+	static uint32_t ratio[BENCH_MAX_RESULTS];
+	char line[256], name[BENCH_NAME_SZ];
+	unsigned long ns, stack, allocs;
+	uint8_t index[BENCH_MAX_RESULTS];
+	uint8_t i, n = 0, ratios = 0, j;
+	uint32_t host = BENCH_RATIO_ONE;
+	int regressions = 0;
+	FILE *f;
+
+	if( (f = fopen(path, "r")) == NULL ) {
+		perror(path);
+		return -1;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		if( (line[0] == '#') || (sscanf(line, "%63s %lu %lu %lu", name, &ns, &stack, &allocs) != 4) ) {
+			continue;
+		}
+		for( i = 0; (i < results_n) && (strcmp(results[i].name, name) != 0); i++ ) ;
+		if( i == results_n ) {
+			printf("%s: not measured\n", name);
+			continue;
+		}
+		if( results[i].stack_bytes > stack ) {
+			printf("%s: %u stack bytes, baseline %lu\n", name, results[i].stack_bytes, stack);
+			regressions++;
+		}
+		if( results[i].allocs > allocs ) {
+			printf("%s: %lu allocations, baseline %lu\n", name, (unsigned long)results[i].allocs, allocs);
+			regressions++;
+		}
+		if( n < BENCH_MAX_RESULTS ) {
+			index[n] = i;
+			baseline_ns[n++] = ns;
+			if( ns != 0 ) {
+				ratio[ratios++] = (uint32_t)(((uint64_t)results[i].ns_per_frame * BENCH_RATIO_ONE) / ns);
+			}
+		}
+	}
+	fclose(f);
+
+	if( ratios != 0 ) {
+		qsort(ratio, ratios, sizeof(ratio[0]), bench_ratio_cmp);
+		host = (ratio[ratios / 2] > BENCH_RATIO_ONE) ? ratio[ratios / 2] : BENCH_RATIO_ONE;
+	}
+	printf("host at %lu%% of the time of the baseline\n", (unsigned long)((host * 100UL) / BENCH_RATIO_ONE));
+	for( j = 0; j < n; j++ ) {
+		i = index[j];
+		if( ((uint64_t)results[i].ns_per_frame * BENCH_RATIO_ONE * 100) > ((uint64_t)baseline_ns[j] * host * (100 + threshold_pct)) ) {
+			printf("%s: %lu ns/frame, baseline %lu ns/frame\n", results[i].name, (unsigned long)results[i].ns_per_frame,
+				   baseline_ns[j]);
+			regressions++;
+		}
+	}
+	return regressions;
+}
+
+/**
+* @brief Writes the results as a baseline.
+*/
+static bool bench_write(const char *path, uint32_t rounds)
+{
+	FILE *f;
+	uint8_t i;
+
+	if( (f = fopen(path, "w")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	fprintf(f, "# ir_bench -r %lu, written by ir_bench -w\n", (unsigned long)rounds);
+	fprintf(f, "# name ns/frame stack_bytes allocs\n");
+	for( i = 0; i < results_n; i++ ) {
+		fprintf(f, "%s %lu %u %lu\n", results[i].name, (unsigned long)results[i].ns_per_frame, results[i].stack_bytes,
+				(unsigned long)results[i].allocs);
+	}
+	fclose(f);
+	return true;
+}
+
+/**
+* @brief Keeps the fastest time of a case over the rounds and adds up its frames.
+*/
+static void bench_keep(uint32_t round)
+{
+	uint8_t i;
+
+	for( i = 0; i < pass_n; i++ ) {
+		if( round == 0 ) {
+			results[i] = pass[i];
+			continue;
+		}
+		results[i].frames += pass[i].frames;
+		results[i].errors += pass[i].errors;
+		results[i].ns_per_frame = (pass[i].ns_per_frame < results[i].ns_per_frame) ? pass[i].ns_per_frame : results[i].ns_per_frame;
+		results[i].stack_bytes = (pass[i].stack_bytes > results[i].stack_bytes) ? pass[i].stack_bytes : results[i].stack_bytes;
+		results[i].allocs += pass[i].allocs;
+	}
+	results_n = pass_n;
+}
+
+int main(int argc, char *argv[])
+{
+	const embx_bench_timer_t timer = { bench_read_ns, 0xFFFFFFFFUL, 1000000000UL, false };
+	const char *baseline = NULL, *output = NULL;
+	uint32_t rounds = BENCH_ROUNDS, threshold_pct = BENCH_THRESHOLD_PCT, errors = 0;
+	enum status_code status;
+	int regressions = 0;
+	uint32_t round;
+	uint8_t synthetic_n = 0, i;
+	int opt, arg;
+
+	while( (opt = getopt(argc, argv, "r:b:w:t:")) != -1 ) {
+		switch( opt ) {
+			case 'r': rounds = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'b': baseline = optarg; break;
+			case 'w': output = optarg; break;
+			case 't': threshold_pct = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-r rounds] [-b baseline] [-w baseline] [-t pct] [trace...]\n", argv[0]);
+				return 2;
+		}
+	}
+	if( rounds == 0 ) {
+		rounds = 1;
+	}
+
+	if( (status = embx_bench_init()) != STATUS_OK ) {
+		fprintf(stderr, "synthetic corpus not built, status %d\n", status);
+		return 2;
+	}
+	/** The rounds interleave the cases, a slow phase of the host slows a round of every case rather than every round of one */
+	for( round = 0; round < rounds; round++ ) {
+		pass_n = embx_bench_run(&timer, 1, pass, BENCH_MAX_RESULTS);
+		synthetic_n = pass_n;
+		for( arg = optind; arg < argc; arg++ ) {
+			if( bench_recorded(&timer, BENCH_RECORDED_PASSES, argv[arg]) == false ) {
+				return 2;
+			}
+		}
+		bench_keep(round);
+	}
+
+	printf("%-26s %8s %7s %10s %7s %7s\n", "case", "frames", "errors", "ns/frame", "stack", "allocs");
+	for( i = 0; i < results_n; i++ ) {
+		printf("%-26s %8lu %7lu %10lu %7u %7lu\n", results[i].name, (unsigned long)results[i].frames,
+			   (unsigned long)results[i].errors, (unsigned long)results[i].ns_per_frame, results[i].stack_bytes,
+			   (unsigned long)results[i].allocs);
+		errors += (i < synthetic_n) ? results[i].errors : 0;
+	}
+
+	if( (output != NULL) && (bench_write(output, rounds) == false) ) {
+		return 2;
+	}
+	if( (baseline != NULL) && ((regressions = bench_compare(baseline, threshold_pct)) < 0) ) {
+		return 2;
+	}
+	if( errors != 0 ) {
+		printf("%lu frames of the synthetic corpus failed\n", (unsigned long)errors);
+	}
+	return ((errors != 0) || (regressions != 0)) ? 1 : 0;
+}
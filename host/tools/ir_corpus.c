@@ -0,0 +1,713 @@
+/**
+ * @file ir_corpus.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Analyzes a corpus of field traces on every core: classification, decoding, histograms, and quality scores.
+ * @details usage: ir_corpus [-j threads] [-c records_per_task] [-f] [-H histograms.csv] trace...
+ *
+ * A trace is a binary trace, mapped in memory, or raw timing text, parsed into memory first.  The site of a trace is
+ * the directory that holds it, e.g. corpus/<site>/<day>.irt, or the trace itself with -f.  The records of the traces
+ * are cut into tasks of records_per_task records, found by a pass over the record lengths only.  Each worker thread
+ * owns a deque of tasks, it takes the oldest of its own and steals the newest of another worker once its deque is empty,
+ * so a slow trace does not hold up a core while the others are idle.  Nothing is shared while the tasks run, every
+ * worker adds to its own totals and the totals are merged when the workers have finished, so the reports do not
+ * depend on the number of threads.
+ *
+ * The pass that cuts the tasks runs on one thread before the workers start and reads every page of the corpus, the
+ * records are delta stamped and have no sync marker so a worker cannot start in the middle of a trace.  The time of
+ * that pass is reported on its own and included in the captures per second, it bounds the speedup of more threads.
+ *
+ * A capture is classified as the first of the known protocols that decodes it, its frames are counted, and its marks
+ * and spaces are added to the histograms of the protocol.  Its quality is 100 when every interval is the nominal
+ * duration of the protocol and 0 when the intervals are off by the tolerance of the protocol on average.  A capture
+ * completed by a timeout or an overflow is counted as an error.
+ *
+ * The report is a table per protocol and per site on stdout, -H writes the histograms as CSV.  The exit status is 1
+ * if a trace holds a corrupt record.
+ */
+#include "ir_trace_file.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "embx/embx_ir/embx_ir_protocol.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+
+/** The records of a task */
+#define CORPUS_TASK_RECORDS			(256)
+#define CORPUS_MAX_THREADS			(256)
+/** The histograms of the durations, bins of 50 usec up to 12.75 ms, the last bin holds the longer ones */
+#define CORPUS_BIN_USEC				(50)
+#define CORPUS_BINS					(256)
+/** The distribution of the quality scores, bins of 10 */
+#define CORPUS_QUALITY_BINS			(11)
+#define CORPUS_LINE_SZ				(16384)
+
+/** The known protocols, a capture that none of them decodes is unknown */
+#define CORPUS_NEC					(0)
+#define CORPUS_SIRC					(1)
+#define CORPUS_RC5					(2)
+#define CORPUS_MITSUBISHI			(3)
+#define CORPUS_UNKNOWN				(4)
+#define CORPUS_PROTOCOLS			(5)
+
+/** @brief The totals of a protocol */
+typedef struct {
+	uint64_t captures;
+	uint64_t intervals;
+	uint64_t frames;
+	uint64_t errors;
+	uint64_t quality_sum;
+	uint64_t quality[CORPUS_QUALITY_BINS];
+	uint64_t mark[CORPUS_BINS];
+	uint64_t space[CORPUS_BINS];
+} corpus_protocol_stats_t;
+
+/** @brief The totals of a site */
+typedef struct {
+	uint64_t captures;
+	uint64_t protocol[CORPUS_PROTOCOLS];
+	uint64_t frames;
+	uint64_t errors;
+	uint64_t quality_sum;
+	uint64_t graded; /** The captures of a known protocol */
+} corpus_site_stats_t;
+
+/** @brief A trace */
+typedef struct {
+	const char *path;
+	ir_trace_file_map_t map;
+	uint8_t *text; /** The binary trace of a text trace, NULL if the trace is mapped */
+	uint32_t site;
+} corpus_file_t;
+
+/** @brief A task, the records that follow the reader */
+typedef struct {
+	const corpus_file_t *file;
+	embx_ir_trace_reader_t reader;
+	uint32_t records;
+} corpus_task_t;
+
+/** @brief The tasks of a worker, the owner takes from the head and the thieves from the tail */
+typedef struct {
+	pthread_mutex_t lock;
+	uint32_t *task;
+	uint32_t head;
+	uint32_t tail;
+} corpus_deque_t;
+
+/** @brief A worker thread and its totals */
+typedef struct {
+	pthread_t thread;
+	uint32_t id;
+	uint32_t seed;
+	corpus_deque_t deque;
+	uint64_t tasks;
+	uint64_t steals;
+	uint64_t corrupt;
+	corpus_protocol_stats_t protocol[CORPUS_PROTOCOLS];
+	corpus_site_stats_t *site;
+	embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+} corpus_worker_t;
+
+static const embx_ir_protocol_t corpus_nec = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1690,
+	.trailer_mark_usec = 560,
+	.gap_usec = 40000,
+	.nbits = 32,
+};
+
+static const embx_ir_protocol_t corpus_sirc = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 600,
+	.header_mark_usec = 2400,
+	.header_space_usec = 600,
+	.zero_mark_usec = 600,
+	.zero_space_usec = 600,
+	.one_mark_usec = 1200,
+	.one_space_usec = 600,
+	.gap_usec = 45000,
+	.nbits = 12,
+};
+
+static const embx_ir_protocol_t corpus_rc5 = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER,
+	.bit_order = EMBX_IR_BIG_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 889,
+	.gap_usec = 89000,
+	.nbits = 14,
+};
+
+static const embx_ir_protocol_t *const corpus_protocols[CORPUS_UNKNOWN] = {
+	&corpus_nec, &corpus_sirc, &corpus_rc5, &embx_split_unit_mitsubishi_protocol,
+};
+static const char *const corpus_protocol_names[CORPUS_PROTOCOLS] = { "nec", "sirc", "rc5", "mitsubishi", "unknown" };
+
+static corpus_file_t *files;
+static uint32_t files_n;
+static char **sites;
+static uint32_t sites_n;
+static corpus_task_t *tasks;
+static uint32_t tasks_n, tasks_max;
+static corpus_worker_t *workers;
+static uint32_t workers_n;
+
+/**
+* @brief Returns the site of a trace, the name of its directory or of the trace itself.
+*/
+static uint32_t corpus_site(const char *path, bool per_file)
+{
+	const char *end = strrchr(path, '/'), *start;
+	char name[256];
+	uint32_t i;
+
+	if( (per_file == true) || (end == NULL) ) {
+		start = (end != NULL) ? (end + 1) : path;
+		end = start + strcspn(start, ".");
+	} else {
+		for( start = end; (start > path) && (start[-1] != '/'); start-- ) ;
+	}
+	snprintf(name, sizeof(name), "%.*s", (int)(end - start), start);
+	for( i = 0; i < sites_n; i++ ) {
+		if( strcmp(sites[i], name) == 0 ) {
+			return i;
+		}
+	}
+	sites = realloc(sites, (sites_n + 1) * sizeof(sites[0]));
+	sites[sites_n] = strdup(name);
+	return sites_n++;
+}
+
+/**
+* @brief Writes the frames of a raw timing text into a binary trace in memory, see ir_trace from-raw.
+* @returns false if a line is not a frame.
+*/
+static bool corpus_read_text(corpus_file_t *file)
+{
+	static char line[CORPUS_LINE_SZ];
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_writer_t writer;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	uint64_t next_us = 0;
+	size_t len, size = EMBX_IR_TRACE_HEADER_SZ, max = 0;
+	bool has_timestamp;
+	uint32_t n = 0;
+	uint16_t i;
+	FILE *f;
+
+	if( (f = fopen(file->path, "r")) == NULL ) {
+		perror(file->path);
+		return false;
+	}
+	file->text = malloc(EMBX_IR_TRACE_HEADER_SZ);
+	embx_ir_trace_write_header(&writer, file->text);
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		n++;
+		memset(&record, 0, sizeof(record));
+		record.status = STATUS_OK;
+		record.quality = EMBX_IR_TRACE_QUALITY_UNKNOWN;
+		status = ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp);
+		if( status == STATUS_NO_CHANGE ) {
+			continue;
+		}
+		if( status != STATUS_OK ) {
+			fprintf(stderr, "%s:%lu: not a frame of at most %u intervals\n", file->path, (unsigned long)n, EMBX_IR_RX_BUF_SZ);
+			fclose(f);
+			return false;
+		}
+		if( has_timestamp == false ) {
+			record.timestamp_us = next_us;
+		}
+		if( (size + EMBX_IR_TRACE_RECORD_MAX_SZ(EMBX_IR_RX_BUF_SZ)) > max ) {
+			max = (2 * max) + EMBX_IR_TRACE_RECORD_MAX_SZ(EMBX_IR_RX_BUF_SZ);
+			file->text = realloc(file->text, max);
+		}
+		if( embx_ir_trace_write(&writer, &record, elem, record.size, &file->text[size], max - size, &len) != STATUS_OK ) {
+			fprintf(stderr, "%s:%lu: timestamp earlier than the frame before\n", file->path, (unsigned long)n);
+			fclose(f);
+			return false;
+		}
+		size += len;
+		next_us = record.timestamp_us + IR_TRACE_FILE_GAP_USEC;
+		for( i = 0; i < record.size; i++ ) {
+			next_us += elem[i].time_us;
+		}
+	}
+	fclose(f);
+	file->map.data = file->text;
+	file->map.len = size;
+	return true;
+}
+
+/**
+* @brief Opens a trace and cuts its records into tasks.
+* @returns false if it cannot be read.
+*/
+static bool corpus_add_file(const char *path, bool per_file, uint32_t task_records)
+{
+	corpus_file_t *file;
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	uint32_t records = 0;
+
+	files = realloc(files, (files_n + 1) * sizeof(files[0]));
+	file = &files[files_n++];
+	memset(file, 0, sizeof(*file));
+	file->path = path;
+	file->site = corpus_site(path, per_file);
+	if( ir_trace_file_map(path, &file->map) == false ) {
+		return false;
+	}
+	if( ir_trace_file_is_binary(file->map.data, file->map.len) == false ) {
+		ir_trace_file_unmap(&file->map);
+		if( corpus_read_text(file) == false ) {
+			return false;
+		}
+	}
+	if( embx_ir_trace_reader_init(&reader, file->map.data, file->map.len) != STATUS_OK ) {
+		fprintf(stderr, "%s: not a trace of version %u or earlier\n", path, EMBX_IR_TRACE_VERSION);
+		return false;
+	}
+	/** The tasks are cut before the records are read so the pointers into files stay valid when it grows */
+	do {
+		if( (records % task_records) == 0 ) {
+			if( tasks_n == tasks_max ) {
+				tasks_max = (tasks_max == 0) ? 64 : (2 * tasks_max);
+				tasks = realloc(tasks, tasks_max * sizeof(tasks[0]));
+			}
+			tasks[tasks_n].file = NULL;
+			tasks[tasks_n].reader = reader;
+			tasks[tasks_n].records = 0;
+			tasks_n++;
+		}
+		status = embx_ir_trace_read(&reader, &record);
+		if( status == STATUS_OK ) {
+			tasks[tasks_n - 1].records++;
+			records++;
+		}
+	} while( status == STATUS_OK );
+	if( tasks[tasks_n - 1].records == 0 ) {
+		tasks_n--;
+	}
+	if( status != STATUS_NO_CHANGE ) {
+		fprintf(stderr, "%s: corrupt record at offset %zu, the records before are analyzed\n", path, reader.offset);
+		workers[0].corrupt++;
+	}
+	return true;
+}
+
+/**
+* @brief Returns the nominal duration of the protocol nearest to an interval.
+*/
+static uint32_t corpus_nominal(const embx_ir_protocol_t *protocol, bool mark, uint32_t usec)
+{
+	uint32_t nominal[4], best = 0, d, best_d = UINT32_MAX;
+	uint8_t n = 0, i;
+
+	if( protocol->encoding == EMBX_IR_PROTOCOL_ENCODING_MANCHESTER ) {
+		nominal[n++] = protocol->unit_usec;
+		nominal[n++] = 2 * protocol->unit_usec; /** Two half bits of the same level merge */
+	} else if( mark == true ) {
+		nominal[n++] = protocol->header_mark_usec;
+		nominal[n++] = protocol->zero_mark_usec;
+		nominal[n++] = protocol->one_mark_usec;
+		nominal[n++] = protocol->trailer_mark_usec;
+	} else {
+		nominal[n++] = protocol->header_space_usec;
+		nominal[n++] = protocol->zero_space_usec;
+		nominal[n++] = protocol->one_space_usec;
+	}
+	for( i = 0; i < n; i++ ) {
+		d = (nominal[i] > usec) ? (nominal[i] - usec) : (usec - nominal[i]);
+		if( (nominal[i] != 0) && (d < best_d) ) {
+			best = nominal[i];
+			best_d = d;
+		}
+	}
+	return best;
+}
+
+/**
+* @brief Scores the intervals of a capture against the nominal durations of its protocol, the gaps are not scored.
+* @returns 0 to 100.
+*/
+static uint32_t corpus_quality(const embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	uint64_t deviation = 0;
+	uint32_t nominal, n = 0, mean;
+	bool mark;
+	uint16_t i;
+
+	for( i = 0; i < size; i++ ) {
+		mark = (elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK);
+		if( (mark == false) && (elem[i].time_us >= (protocol->gap_usec / 2)) ) {
+			continue;
+		}
+		if( (nominal = corpus_nominal(protocol, mark, elem[i].time_us)) == 0 ) {
+			continue;
+		}
+		deviation += ((uint64_t)((elem[i].time_us > nominal) ? (elem[i].time_us - nominal) : (nominal - elem[i].time_us)) * 1000) / nominal;
+		n++;
+	}
+	if( n == 0 ) {
+		return 0;
+	}
+	mean = (uint32_t)(deviation / n); /** Per mille */
+	return (mean >= (protocol->tolerance_pct * 10UL)) ? 0 : (100 - ((mean * 100) / (protocol->tolerance_pct * 10UL)));
+}
+
+/**
+* @brief Classifies, decodes, and scores a capture, and adds it to the totals of the worker.
+*/
+static void corpus_capture(corpus_worker_t *w, uint32_t site, const embx_ir_trace_record_t *record)
+{
+	embx_ir_protocol_frame_t frame;
+	corpus_protocol_stats_t *ps;
+	corpus_site_stats_t *ss = &w->site[site];
+	uint32_t frames = 0, quality = 0, bin;
+	uint16_t i, idx;
+	uint8_t p;
+
+	for( p = 0; p < CORPUS_UNKNOWN; p++ ) {
+		idx = 0;
+		while( embx_ir_protocol_decode(corpus_protocols[p], w->elem, record->size, &idx, &frame) == STATUS_OK ) {
+			frames++;
+		}
+		if( frames != 0 ) {
+			break;
+		}
+	}
+
+	ps = &w->protocol[p];
+	ps->captures++;
+	ps->intervals += record->size;
+	ps->frames += frames;
+	ss->captures++;
+	ss->protocol[p]++;
+	ss->frames += frames;
+	if( record->status != STATUS_OK ) {
+		ps->errors++;
+		ss->errors++;
+	}
+	for( i = 0; i < record->size; i++ ) {
+		bin = w->elem[i].time_us / CORPUS_BIN_USEC;
+		bin = (bin < CORPUS_BINS) ? bin : (CORPUS_BINS - 1);
+		if( w->elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK ) {
+			ps->mark[bin]++;
+		} else {
+			ps->space[bin]++;
+		}
+	}
+	if( p != CORPUS_UNKNOWN ) {
+		quality = corpus_quality(corpus_protocols[p], w->elem, record->size);
+		ps->quality_sum += quality;
+		ps->quality[quality / 10]++;
+		ss->quality_sum += quality;
+		ss->graded++;
+	}
+}
+
+/**
+* @brief Runs a task.
+*/
+static void corpus_run(corpus_worker_t *w, const corpus_task_t *task, const corpus_file_t *file)
+{
+	embx_ir_trace_reader_t reader = task->reader;
+	embx_ir_trace_record_t record;
+	uint32_t n;
+
+	for( n = 0; n < task->records; n++ ) {
+		if( (embx_ir_trace_read(&reader, &record) != STATUS_OK) ||
+			(embx_ir_trace_get_elems(&record, w->elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK) ) {
+			w->corrupt++;
+			return;
+		}
+		corpus_capture(w, file->site, &record);
+	}
+	w->tasks++;
+}
+
+/**
+* @brief Takes a task from the head of the own deque, or steals one from the tail of another.
+* @returns the task, or UINT32_MAX once every deque is empty.
+*/
+static uint32_t corpus_next(corpus_worker_t *w)
+{
+	corpus_deque_t *d = &w->deque;
+	uint32_t task = UINT32_MAX, i, victim;
+
+	pthread_mutex_lock(&d->lock);
+	if( d->head != d->tail ) {
+		task = d->task[d->head++];
+	}
+	pthread_mutex_unlock(&d->lock);
+	if( task != UINT32_MAX ) {
+		return task;
+	}
+
+	/** No task is ever added, once a sweep finds every deque empty the work is done */
+	w->seed = (w->seed * 1103515245UL) + 12345UL;
+	for( i = 0; i < workers_n; i++ ) {
+		victim = ((w->seed >> 16) + i) % workers_n;
+		d = &workers[victim].deque;
+		if( victim == w->id ) {
+			continue;
+		}
+		pthread_mutex_lock(&d->lock);
+		if( d->head != d->tail ) {
+			task = d->task[--d->tail];
+		}
+		pthread_mutex_unlock(&d->lock);
+		if( task != UINT32_MAX ) {
+			w->steals++;
+			return task;
+		}
+	}
+	return UINT32_MAX;
+}
+
+static void *corpus_worker(void *arg)
+{
+	corpus_worker_t *w = arg;
+	uint32_t task;
+
+	while( (task = corpus_next(w)) != UINT32_MAX ) {
+		corpus_run(w, &tasks[task], tasks[task].file);
+	}
+	return NULL;
+}
+
+/**
+* @brief Adds the totals of a worker to those of the first.
+*/
+static void corpus_merge(corpus_worker_t *to, const corpus_worker_t *from)
+{
+	const uint64_t *src;
+	uint64_t *dst;
+	size_t i, n;
+
+	dst = (uint64_t *)to->protocol;
+	src = (const uint64_t *)from->protocol;
+	for( i = 0, n = (CORPUS_PROTOCOLS * sizeof(to->protocol[0])) / sizeof(*dst); i < n; i++ ) {
+		dst[i] += src[i];
+	}
+	dst = (uint64_t *)to->site;
+	src = (const uint64_t *)from->site;
+	for( i = 0, n = (sites_n * sizeof(to->site[0])) / sizeof(*dst); i < n; i++ ) {
+		dst[i] += src[i];
+	}
+	to->tasks += from->tasks;
+	to->steals += from->steals;
+	to->corrupt += from->corrupt;
+}
+
+/**
+* @brief Writes the histograms and the quality distributions, a line per bin that is not empty.
+*/
+static bool corpus_write_histograms(const char *path, const corpus_worker_t *total)
+{
+	const corpus_protocol_stats_t *ps;
+	uint32_t i;
+	uint8_t p;
+	FILE *f;
+
+	if( (f = fopen(path, "w")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	fprintf(f, "protocol,histogram,from,count\n");
+	for( p = 0; p < CORPUS_PROTOCOLS; p++ ) {
+		ps = &total->protocol[p];
+		for( i = 0; i < CORPUS_BINS; i++ ) {
+			if( ps->mark[i] != 0 ) {
+				fprintf(f, "%s,mark_usec,%lu,%llu\n", corpus_protocol_names[p], (unsigned long)(i * CORPUS_BIN_USEC), (unsigned long long)ps->mark[i]);
+			}
+		}
+		for( i = 0; i < CORPUS_BINS; i++ ) {
+			if( ps->space[i] != 0 ) {
+				fprintf(f, "%s,space_usec,%lu,%llu\n", corpus_protocol_names[p], (unsigned long)(i * CORPUS_BIN_USEC), (unsigned long long)ps->space[i]);
+			}
+		}
+		for( i = 0; i < CORPUS_QUALITY_BINS; i++ ) {
+			if( ps->quality[i] != 0 ) {
+				fprintf(f, "%s,quality,%lu,%llu\n", corpus_protocol_names[p], (unsigned long)(i * 10), (unsigned long long)ps->quality[i]);
+			}
+		}
+	}
+	if( fclose(f) != 0 ) {
+		perror(path);
+		return false;
+	}
+	return true;
+}
+
+/**
+* @brief Prints the report per protocol and per site.
+*/
+static void corpus_report(const corpus_worker_t *total)
+{
+	const corpus_protocol_stats_t *ps;
+	const corpus_site_stats_t *ss;
+	uint64_t peak;
+	uint32_t i, mark_bin, space_bin;
+	uint8_t p;
+
+	printf("%-11s %10s %12s %10s %8s %8s %12s %12s\n", "protocol", "captures", "intervals", "frames", "errors", "quality",
+		   "mark_peak", "space_peak");
+	for( p = 0; p < CORPUS_PROTOCOLS; p++ ) {
+		ps = &total->protocol[p];
+		for( i = 0, peak = 0, mark_bin = 0; i < CORPUS_BINS; i++ ) {
+			if( ps->mark[i] > peak ) {
+				peak = ps->mark[i];
+				mark_bin = i;
+			}
+		}
+		for( i = 0, peak = 0, space_bin = 0; i < CORPUS_BINS; i++ ) {
+			if( ps->space[i] > peak ) {
+				peak = ps->space[i];
+				space_bin = i;
+			}
+		}
+		printf("%-11s %10llu %12llu %10llu %8llu %8.1f %12lu %12lu\n", corpus_protocol_names[p],
+			   (unsigned long long)ps->captures, (unsigned long long)ps->intervals, (unsigned long long)ps->frames,
+			   (unsigned long long)ps->errors, ((p != CORPUS_UNKNOWN) && (ps->captures != 0)) ? ((double)ps->quality_sum / ps->captures) : 0.0,
+			   (unsigned long)(mark_bin * CORPUS_BIN_USEC), (unsigned long)(space_bin * CORPUS_BIN_USEC));
+	}
+
+	printf("\n%-20s %10s", "site", "captures");
+	for( p = 0; p < CORPUS_PROTOCOLS; p++ ) {
+		printf(" %10s", corpus_protocol_names[p]);
+	}
+	printf(" %10s %8s %8s\n", "frames", "errors", "quality");
+	for( i = 0; i < sites_n; i++ ) {
+		ss = &total->site[i];
+		printf("%-20s %10llu", sites[i], (unsigned long long)ss->captures);
+		for( p = 0; p < CORPUS_PROTOCOLS; p++ ) {
+			printf(" %10llu", (unsigned long long)ss->protocol[p]);
+		}
+		printf(" %10llu %8llu %8.1f\n", (unsigned long long)ss->frames, (unsigned long long)ss->errors,
+			   (ss->graded != 0) ? ((double)ss->quality_sum / ss->graded) : 0.0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t task_records = CORPUS_TASK_RECORDS, i, t, first, last;
+	const char *histograms = NULL;
+	struct timespec start, cut, stop;
+	bool per_file = false;
+	uint64_t captures = 0, intervals = 0;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	double wall, serial;
+	uint8_t p;
+	int opt, rc = 0;
+
+	workers_n = (cores > 0) ? (uint32_t)cores : 1;
+	while( (opt = getopt(argc, argv, "j:c:fH:")) != -1 ) {
+		switch( opt ) {
+			case 'j': workers_n = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'c': task_records = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'f': per_file = true; break;
+			case 'H': histograms = optarg; break;
+			default:
+				fprintf(stderr, "usage: %s [-j threads] [-c records_per_task] [-f] [-H histograms.csv] trace...\n", argv[0]);
+				return 2;
+		}
+	}
+	if( optind >= argc ) {
+		fprintf(stderr, "usage: %s [-j threads] [-c records_per_task] [-f] [-H histograms.csv] trace...\n", argv[0]);
+		return 2;
+	}
+	workers_n = ((workers_n != 0) && (workers_n <= CORPUS_MAX_THREADS)) ? workers_n : 1;
+	task_records = (task_records != 0) ? task_records : 1;
+	workers = calloc(workers_n, sizeof(workers[0]));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for( ; optind < argc; optind++ ) {
+		if( corpus_add_file(argv[optind], per_file, task_records) == false ) {
+			return 2;
+		}
+	}
+	for( t = 0; t < tasks_n; t++ ) {
+		for( i = 0; (i < files_n) && ((tasks[t].reader.data != files[i].map.data) || (tasks[t].reader.len != files[i].map.len)); i++ ) ;
+		tasks[t].file = &files[i];
+	}
+
+	/** Each worker starts with a contiguous share of the tasks, the records of a trace stay together */
+	for( i = 0; i < workers_n; i++ ) {
+		workers[i].id = i;
+		workers[i].seed = i + 1;
+		workers[i].site = calloc((sites_n != 0) ? sites_n : 1, sizeof(workers[i].site[0]));
+		workers[i].deque.task = malloc(((tasks_n != 0) ? tasks_n : 1) * sizeof(uint32_t));
+		pthread_mutex_init(&workers[i].deque.lock, NULL);
+		first = (uint32_t)(((uint64_t)tasks_n * i) / workers_n);
+		last = (uint32_t)(((uint64_t)tasks_n * (i + 1)) / workers_n);
+		for( t = first; t < last; t++ ) {
+			workers[i].deque.task[workers[i].deque.tail++] = t;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &cut);
+	for( i = 1; i < workers_n; i++ ) {
+		if( pthread_create(&workers[i].thread, NULL, corpus_worker, &workers[i]) != 0 ) {
+			fprintf(stderr, "thread %lu not created, its tasks are stolen\n", (unsigned long)i);
+			workers[i].thread = 0;
+		}
+	}
+	corpus_worker(&workers[0]);
+	for( i = 1; i < workers_n; i++ ) {
+		if( workers[i].thread != 0 ) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	wall = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+	serial = (double)(cut.tv_sec - start.tv_sec) + ((double)(cut.tv_nsec - start.tv_nsec) / 1e9);
+
+	for( i = 1; i < workers_n; i++ ) {
+		corpus_merge(&workers[0], &workers[i]);
+	}
+	for( p = 0; p < CORPUS_PROTOCOLS; p++ ) {
+		captures += workers[0].protocol[p].captures;
+		intervals += workers[0].protocol[p].intervals;
+	}
+
+	printf("%lu traces, %lu sites, %llu captures, %lu tasks on %lu threads, %llu stolen\n", (unsigned long)files_n,
+		   (unsigned long)sites_n, (unsigned long long)captures, (unsigned long)tasks_n, (unsigned long)workers_n,
+		   (unsigned long long)workers[0].steals);
+	printf("read and cut in %.3f s on one thread, analyzed in %.3f s, %.0f captures/s, %.0f intervals/s\n\n", serial,
+		   wall - serial, (wall > 0) ? (captures / wall) : 0.0, (wall > 0) ? (intervals / wall) : 0.0);
+	corpus_report(&workers[0]);
+
+	if( (histograms != NULL) && (corpus_write_histograms(histograms, &workers[0]) == false) ) {
+		rc = 2;
+	}
+	if( workers[0].corrupt != 0 ) {
+		rc = (rc != 0) ? rc : 1;
+	}
+	for( i = 0; i < files_n; i++ ) {
+		if( files[i].text != NULL ) {
+			free(files[i].text);
+		} else {
+			ir_trace_file_unmap(&files[i].map);
+		}
+	}
+	return rc;
+}
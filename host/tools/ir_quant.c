@@ -0,0 +1,219 @@
+/**
+ * @file ir_quant.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Quantizes arrays of durations into the symbols and the unit multiples of a protocol, see ir_quant.h.
+ * @details The vector implementations compare 4 or 8 durations with every range at once, an unsigned compare is
+ * max(usec, lo) == usec and min(usec, hi) == usec.  The multiple is (usec + unit / 2) / unit.  There is no vector
+ * integer division, the quotient is estimated in single precision and corrected by one with the remainder, the dividend
+ * is below 2^24 once usec is clamped to 256 units, so the estimate is never off by more.  The durations left over
+ * are quantized by the scalar loop.  The vector functions are built with the target attribute of GCC and clang, so
+ * the file builds without -mavx2 and the instructions run only after the CPU was checked.
+ */
+#include "ir_quant.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IR_QUANT_X86
+#endif
+
+const char *const ir_quant_impl_names[IR_QUANT_IMPLS] = { "scalar", "sse4.1", "avx2" };
+
+/**
+* @brief Sets the range of the durations that embx_ir_protocol_match matches with expected_usec.
+* @details delta * 100 <= expected_usec * tolerance_pct holds for delta up to expected_usec * tolerance_pct / 100.
+*/
+static void ir_quant_range(ir_quant_table_t *table, uint8_t symbol, uint32_t expected_usec, uint8_t tolerance_pct)
+{
+	uint32_t delta = (expected_usec * tolerance_pct) / 100;
+
+	if( expected_usec == 0 ) { /** The decoder does not match a symbol the protocol does not have */
+		table->lo[symbol] = 1;
+		table->hi[symbol] = 0;
+		return;
+	}
+	table->lo[symbol] = (delta < expected_usec) ? (expected_usec - delta) : 0;
+	table->hi[symbol] = expected_usec + delta;
+}
+
+void ir_quant_table_init(ir_quant_table_t *table, const embx_ir_protocol_t *protocol)
+{
+	uint8_t tol = protocol->tolerance_pct;
+
+	ir_quant_range(table, IR_QUANT_HEADER_MARK, protocol->header_mark_usec, tol);
+	ir_quant_range(table, IR_QUANT_ZERO_MARK, protocol->zero_mark_usec, tol);
+	ir_quant_range(table, IR_QUANT_ONE_MARK, protocol->one_mark_usec, tol);
+	ir_quant_range(table, IR_QUANT_TRAILER_MARK, protocol->trailer_mark_usec, tol);
+	ir_quant_range(table, IR_QUANT_HEADER_SPACE, protocol->header_space_usec, tol);
+	ir_quant_range(table, IR_QUANT_ZERO_SPACE, protocol->zero_space_usec, tol);
+	ir_quant_range(table, IR_QUANT_ONE_SPACE, protocol->one_space_usec, tol);
+	ir_quant_range(table, IR_QUANT_UNIT, protocol->unit_usec, tol);
+	ir_quant_range(table, IR_QUANT_DOUBLE_UNIT, 2 * (uint32_t)protocol->unit_usec, tol);
+	table->unit = protocol->unit_usec;
+}
+
+/**
+* @brief The reference, a duration at a time.
+*/
+static void ir_quant_scalar(const ir_quant_table_t *table, const uint32_t *usec, size_t n, uint16_t *symbols, uint8_t *units)
+{
+	uint32_t q;
+	uint16_t mask;
+	uint8_t s;
+	size_t i;
+
+	for( i = 0; i < n; i++ ) {
+		mask = 0;
+		for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+			if( (usec[i] >= table->lo[s]) && (usec[i] <= table->hi[s]) ) {
+				mask |= (uint16_t)(1 << s);
+			}
+		}
+		symbols[i] = mask;
+		if( table->unit == 0 ) {
+			units[i] = 0;
+		} else {
+			q = (uint32_t)(((uint64_t)usec[i] + (table->unit / 2)) / table->unit);
+			units[i] = (uint8_t)((q < IR_QUANT_MAX_UNITS) ? q : IR_QUANT_MAX_UNITS);
+		}
+	}
+}
+
+#ifdef IR_QUANT_X86
+/**
+* @brief 4 durations at a time.
+*/
+__attribute__((target("sse4.1")))
+static size_t ir_quant_sse41(const ir_quant_table_t *table, const uint32_t *usec, size_t n, uint16_t *symbols, uint8_t *units)
+{
+	__m128i lo[IR_QUANT_SYMBOLS], hi[IR_QUANT_SYMBOLS], bit[IR_QUANT_SYMBOLS];
+	const __m128i unit = _mm_set1_epi32((int32_t)table->unit), half = _mm_set1_epi32((int32_t)(table->unit / 2));
+	const __m128i cap = _mm_set1_epi32((int32_t)(table->unit * (IR_QUANT_MAX_UNITS + 1)));
+	const __m128i max_units = _mm_set1_epi32(IR_QUANT_MAX_UNITS), zero = _mm_setzero_si128();
+	const __m128 inv = _mm_set1_ps((table->unit != 0) ? (1.0f / (float)table->unit) : 0.0f);
+	__m128i d, acc, in, x, q, r;
+	int32_t packed;
+	uint8_t s;
+	size_t i;
+
+	for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+		lo[s] = _mm_set1_epi32((int32_t)table->lo[s]);
+		hi[s] = _mm_set1_epi32((int32_t)table->hi[s]);
+		bit[s] = _mm_set1_epi32(1 << s);
+	}
+	for( i = 0; (i + 4) <= n; i += 4 ) {
+		d = _mm_loadu_si128((const __m128i *)&usec[i]);
+		acc = zero;
+		for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+			in = _mm_and_si128(_mm_cmpeq_epi32(_mm_max_epu32(d, lo[s]), d), _mm_cmpeq_epi32(_mm_min_epu32(d, hi[s]), d));
+			acc = _mm_or_si128(acc, _mm_and_si128(in, bit[s]));
+		}
+		_mm_storel_epi64((__m128i *)&symbols[i], _mm_packus_epi32(acc, acc));
+
+		x = _mm_add_epi32(_mm_min_epu32(d, cap), half);
+		q = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(x), inv));
+		r = _mm_sub_epi32(x, _mm_mullo_epi32(q, unit));
+		q = _mm_add_epi32(q, _mm_cmplt_epi32(r, zero)); /** -1 if the estimate is one too many */
+		q = _mm_sub_epi32(q, _mm_andnot_si128(_mm_cmplt_epi32(r, unit), _mm_cmpgt_epi32(r, zero))); /** +1 if one too few */
+		q = _mm_min_epi32(q, max_units);
+		q = _mm_packus_epi32(q, q);
+		packed = _mm_cvtsi128_si32(_mm_packus_epi16(q, q));
+		memcpy(&units[i], &packed, 4);
+	}
+	return i;
+}
+
+/**
+* @brief 8 durations at a time.
+*/
+__attribute__((target("avx2")))
+static size_t ir_quant_avx2(const ir_quant_table_t *table, const uint32_t *usec, size_t n, uint16_t *symbols, uint8_t *units)
+{
+	__m256i lo[IR_QUANT_SYMBOLS], hi[IR_QUANT_SYMBOLS], bit[IR_QUANT_SYMBOLS];
+	const __m256i unit = _mm256_set1_epi32((int32_t)table->unit), half = _mm256_set1_epi32((int32_t)(table->unit / 2));
+	const __m256i cap = _mm256_set1_epi32((int32_t)(table->unit * (IR_QUANT_MAX_UNITS + 1)));
+	const __m256i max_units = _mm256_set1_epi32(IR_QUANT_MAX_UNITS), zero = _mm256_setzero_si256();
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	const __m256 inv = _mm256_set1_ps((table->unit != 0) ? (1.0f / (float)table->unit) : 0.0f);
+	__m256i d, acc, in, x, q, r;
+	uint8_t s;
+	size_t i;
+
+	for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+		lo[s] = _mm256_set1_epi32((int32_t)table->lo[s]);
+		hi[s] = _mm256_set1_epi32((int32_t)table->hi[s]);
+		bit[s] = _mm256_set1_epi32(1 << s);
+	}
+	for( i = 0; (i + 8) <= n; i += 8 ) {
+		d = _mm256_loadu_si256((const __m256i *)&usec[i]);
+		acc = zero;
+		for( s = 0; s < IR_QUANT_SYMBOLS; s++ ) {
+			in = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(d, lo[s]), d), _mm256_cmpeq_epi32(_mm256_min_epu32(d, hi[s]), d));
+			acc = _mm256_or_si256(acc, _mm256_and_si256(in, bit[s]));
+		}
+		/** The packs work within each 128 bit lane, the halves of the results are gathered with a permute */
+		acc = _mm256_permute4x64_epi64(_mm256_packus_epi32(acc, acc), 0x08);
+		_mm_storeu_si128((__m128i *)&symbols[i], _mm256_castsi256_si128(acc));
+
+		x = _mm256_add_epi32(_mm256_min_epu32(d, cap), half);
+		q = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(x), inv));
+		r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, unit));
+		q = _mm256_add_epi32(q, _mm256_cmpgt_epi32(zero, r)); /** -1 if the estimate is one too many */
+		q = _mm256_sub_epi32(q, _mm256_andnot_si256(_mm256_cmpgt_epi32(unit, r), _mm256_cmpgt_epi32(r, zero))); /** +1 if one too few */
+		q = _mm256_min_epi32(q, max_units);
+		q = _mm256_packus_epi16(_mm256_packus_epi32(q, q), zero);
+		q = _mm256_permutevar8x32_epi32(q, order);
+		_mm_storel_epi64((__m128i *)&units[i], _mm256_castsi256_si128(q));
+	}
+	return i;
+}
+#endif
+
+bool ir_quant_supported(ir_quant_impl_t impl)
+{
+	switch( impl ) {
+		case IR_QUANT_SCALAR:
+			return true;
+#ifdef IR_QUANT_X86
+		case IR_QUANT_SSE41:
+			return (__builtin_cpu_supports("sse4.1") != 0);
+		case IR_QUANT_AVX2:
+			return (__builtin_cpu_supports("avx2") != 0);
+#endif
+		default:
+			return false;
+	}
+}
+
+ir_quant_impl_t ir_quant_best(void)
+{
+	ir_quant_impl_t impl;
+
+	for( impl = IR_QUANT_IMPLS - 1; impl > IR_QUANT_SCALAR; impl-- ) {
+		if( ir_quant_supported(impl) == true ) {
+			break;
+		}
+	}
+	return impl;
+}
+
+bool ir_quant_run(const ir_quant_table_t *table, ir_quant_impl_t impl, const uint32_t *usec, size_t n,
+				  uint16_t *symbols, uint8_t *units)
+{
+	size_t done = 0;
+
+	if( ir_quant_supported(impl) == false ) {
+		return false;
+	}
+#ifdef IR_QUANT_X86
+	if( impl == IR_QUANT_SSE41 ) {
+		done = ir_quant_sse41(table, usec, n, symbols, units);
+	} else if( impl == IR_QUANT_AVX2 ) {
+		done = ir_quant_avx2(table, usec, n, symbols, units);
+	}
+#endif
+	ir_quant_scalar(table, &usec[done], n - done, &symbols[done], &units[done]);
+	return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ir_quant.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Quantizes arrays of durations into the symbols and the unit multiples of a protocol, with SSE4.1 and AVX2.
+ * @details The symbols are the durations the decoder of embx_ir_protocol.c matches with embx_ir_protocol_match, each
+ * is turned into the range of the durations it matches, so a duration matches a symbol if lo <= usec <= hi.  The
+ * ranges are those of embx_ir_protocol_match for durations below 42 s, the product of the match does not overflow.
+ * A duration is quantized into the mask of the symbols it matches, a MARK and a SPACE alike, the caller keeps the
+ * symbols of its level with IR_QUANT_MARKS or IR_QUANT_SPACES, and into the nearest multiple of the unit.
+ *
+ * The durations are usec as in the rx buffer elements, the ticks of the Rx PHY are corrected for the stretch of the
+ * receiver before the decoder sees them.  Every implementation writes the same bits as IR_QUANT_SCALAR.
+ */
+#ifndef IR_QUANT_H_
+#define IR_QUANT_H_
+
+#include "embx/embx_hal/embx_hal.h"
+#include <stddef.h>
+#include "embx/embx_ir/embx_ir_protocol.h"
+
+/** The symbols, a bit of the mask each */
+#define IR_QUANT_HEADER_MARK		(0)
+#define IR_QUANT_ZERO_MARK			(1)
+#define IR_QUANT_ONE_MARK			(2)
+#define IR_QUANT_TRAILER_MARK		(3)
+#define IR_QUANT_HEADER_SPACE		(4)
+#define IR_QUANT_ZERO_SPACE			(5)
+#define IR_QUANT_ONE_SPACE			(6)
+#define IR_QUANT_UNIT				(7) /** A half bit of MANCHESTER, a MARK or a SPACE */
+#define IR_QUANT_DOUBLE_UNIT		(8) /** Two half bits of MANCHESTER merged */
+#define IR_QUANT_SYMBOLS			(9)
+
+#define IR_QUANT_MARKS				((uint16_t)((1 << IR_QUANT_HEADER_MARK) | (1 << IR_QUANT_ZERO_MARK) | (1 << IR_QUANT_ONE_MARK) | \
+												(1 << IR_QUANT_TRAILER_MARK) | (1 << IR_QUANT_UNIT) | (1 << IR_QUANT_DOUBLE_UNIT)))
+#define IR_QUANT_SPACES				((uint16_t)((1 << IR_QUANT_HEADER_SPACE) | (1 << IR_QUANT_ZERO_SPACE) | (1 << IR_QUANT_ONE_SPACE) | \
+												(1 << IR_QUANT_UNIT) | (1 << IR_QUANT_DOUBLE_UNIT)))
+
+/** The unit multiple of a duration saturates */
+#define IR_QUANT_MAX_UNITS			(255)
+
+/**
+* @brief Enumerates the implementations, the vector ones run only on a CPU that has the instructions.
+*/
+typedef enum {
+	IR_QUANT_SCALAR = 0,
+	IR_QUANT_SSE41,
+	IR_QUANT_AVX2,
+	IR_QUANT_IMPLS,
+} ir_quant_impl_t;
+
+/**
+* @brief ir_quant_table_t holds the ranges of the symbols of a protocol.
+* @details A symbol that the protocol does not have has an empty range, lo > hi.
+*/
+typedef struct {
+	uint32_t lo[IR_QUANT_SYMBOLS];
+	uint32_t hi[IR_QUANT_SYMBOLS];
+	uint32_t unit; /** The unit of the protocol, the multiples are 0 if it is 0 */
+} ir_quant_table_t;
+
+extern const char *const ir_quant_impl_names[IR_QUANT_IMPLS];
+
+/**
+* @brief Builds the ranges of the symbols of a protocol from its durations and its tolerance.
+*/
+extern void ir_quant_table_init(ir_quant_table_t *table, const embx_ir_protocol_t *protocol);
+
+/**
+* @brief Returns true if the CPU runs an implementation.
+*/
+extern bool ir_quant_supported(ir_quant_impl_t impl);
+
+/**
+* @brief Returns the fastest implementation the CPU runs.
+*/
+extern ir_quant_impl_t ir_quant_best(void);
+
+/**
+* @brief Quantizes n durations.
+* @params symbols - receives the mask of the symbols each duration matches, a bit per symbol.
+* @params units - receives the nearest multiple of the unit of each duration, up to IR_QUANT_MAX_UNITS.
+* @returns false if the CPU does not run the implementation, nothing is written.
+*/
+extern bool ir_quant_run(const ir_quant_table_t *table, ir_quant_impl_t impl, const uint32_t *usec, size_t n,
+						 uint16_t *symbols, uint8_t *units);
+
+#endif /* IR_QUANT_H_ */
@@ -0,0 +1,241 @@
+/**
+ * @file ir_quantize.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Measures the throughput of the quantizer implementations and checks them against the scalar one.
+ * @details usage: ir_quantize [-n durations] [-r rounds] [-s seed] [trace...]
+ *
+ * The durations are the intervals of the traces, binary or raw timing text, repeated up to the count, or random
+ * durations around the symbols of the protocols if no trace is given.  Each protocol is quantized rounds times by
+ * every implementation the CPU runs, the best round is reported in durations per second, and the results of each
+ * implementation are compared with those of the scalar one.  The exit status is 1 if a bit differs.
+ */
+#include "ir_trace_file.h"
+#include "ir_quant.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+
+#define QUANT_DURATIONS				(1 << 20)
+#define QUANT_ROUNDS				(20)
+#define QUANT_LINE_SZ				(16384)
+
+static const embx_ir_protocol_t quant_nec = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1690,
+	.trailer_mark_usec = 560,
+	.gap_usec = 40000,
+	.nbits = 32,
+};
+
+static const embx_ir_protocol_t quant_sirc = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 600,
+	.header_mark_usec = 2400,
+	.header_space_usec = 600,
+	.zero_mark_usec = 600,
+	.zero_space_usec = 600,
+	.one_mark_usec = 1200,
+	.one_space_usec = 600,
+	.gap_usec = 45000,
+	.nbits = 12,
+};
+
+static const embx_ir_protocol_t quant_rc5 = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER,
+	.bit_order = EMBX_IR_BIG_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 889,
+	.gap_usec = 89000,
+	.nbits = 14,
+};
+
+#define QUANT_PROTOCOLS				(4)
+static const embx_ir_protocol_t *const quant_protocols[QUANT_PROTOCOLS] = {
+	&quant_nec, &quant_sirc, &quant_rc5, &embx_split_unit_mitsubishi_protocol,
+};
+static const char *const quant_protocol_names[QUANT_PROTOCOLS] = { "nec", "sirc", "rc5", "mitsubishi" };
+
+static uint32_t *usec;
+static size_t usec_n;
+
+/**
+* @brief Appends the intervals of a trace, returns false if it cannot be read.
+*/
+static bool quant_read_trace(const char *path)
+{
+	static char line[QUANT_LINE_SZ];
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	ir_trace_file_map_t map;
+	bool has_timestamp;
+	uint16_t i;
+	FILE *f;
+
+	if( ir_trace_file_map(path, &map) == false ) {
+		return false;
+	}
+	if( ir_trace_file_is_binary(map.data, map.len) == true ) {
+		embx_ir_trace_reader_init(&reader, map.data, map.len);
+		while( embx_ir_trace_read(&reader, &record) == STATUS_OK ) {
+			if( embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK ) {
+				break;
+			}
+			usec = realloc(usec, (usec_n + record.size) * sizeof(usec[0]));
+			for( i = 0; i < record.size; i++ ) {
+				usec[usec_n++] = elem[i].time_us;
+			}
+		}
+		ir_trace_file_unmap(&map);
+		return true;
+	}
+	ir_trace_file_unmap(&map);
+	if( (f = fopen(path, "r")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		if( ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp) != STATUS_OK ) {
+			continue;
+		}
+		usec = realloc(usec, (usec_n + record.size) * sizeof(usec[0]));
+		for( i = 0; i < record.size; i++ ) {
+			usec[usec_n++] = elem[i].time_us;
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+/**
+* @brief Fills the durations with random intervals of the protocols, with 30 percent of jitter and a gap now and then.
+*/
+static void quant_random(size_t n, uint32_t seed)
+{
+	const embx_ir_protocol_t *protocol;
+	uint32_t nominal;
+	size_t i;
+
+	usec = realloc(usec, n * sizeof(usec[0]));
+	for( i = 0; i < n; i++ ) {
+		seed = (seed * 1103515245UL) + 12345UL;
+		protocol = quant_protocols[(seed >> 16) % QUANT_PROTOCOLS];
+		switch( (seed >> 20) & 7 ) {
+			case 0: nominal = (protocol->header_mark_usec != 0) ? protocol->header_mark_usec : protocol->unit_usec; break;
+			case 1: nominal = protocol->one_space_usec; break;
+			case 2: nominal = protocol->one_mark_usec; break;
+			case 3: nominal = 2 * (uint32_t)protocol->unit_usec; break;
+			case 4: nominal = protocol->gap_usec; break;
+			default: nominal = protocol->unit_usec; break;
+		}
+		nominal = (nominal != 0) ? nominal : protocol->unit_usec;
+		seed = (seed * 1103515245UL) + 12345UL;
+		usec[i] = nominal - ((nominal * 3) / 10) + (uint32_t)(((uint64_t)(seed >> 8) * ((nominal * 6) / 10)) >> 24);
+	}
+	usec_n = n;
+}
+
+static uint64_t quant_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t n = QUANT_DURATIONS, i;
+	uint32_t rounds = QUANT_ROUNDS, seed = 1, r;
+	uint16_t *symbols[IR_QUANT_IMPLS];
+	uint8_t *units[IR_QUANT_IMPLS];
+	uint64_t start, ns, best;
+	double rate[IR_QUANT_IMPLS];
+	ir_quant_table_t table;
+	ir_quant_impl_t impl;
+	bool identical = true, same;
+	uint8_t p;
+	int opt;
+
+	while( (opt = getopt(argc, argv, "n:r:s:")) != -1 ) {
+		switch( opt ) {
+			case 'n': n = (size_t)strtoul(optarg, NULL, 0); break;
+			case 'r': rounds = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-n durations] [-r rounds] [-s seed] [trace...]\n", argv[0]);
+				return 2;
+		}
+	}
+	n = (n != 0) ? n : 1;
+	rounds = (rounds != 0) ? rounds : 1;
+	for( ; optind < argc; optind++ ) {
+		if( quant_read_trace(argv[optind]) == false ) {
+			return 2;
+		}
+	}
+	if( usec_n == 0 ) {
+		quant_random(n, seed);
+	} else { /** The intervals of the traces, repeated */
+		usec = realloc(usec, n * sizeof(usec[0]));
+		for( i = usec_n; i < n; i++ ) {
+			usec[i] = usec[i % usec_n];
+		}
+		usec_n = n;
+	}
+	for( impl = IR_QUANT_SCALAR; impl < IR_QUANT_IMPLS; impl++ ) {
+		symbols[impl] = malloc(n * sizeof(symbols[0][0]));
+		units[impl] = malloc(n);
+	}
+
+	printf("%lu durations, %lu rounds, best of the rounds\n", (unsigned long)n, (unsigned long)rounds);
+	printf("%-11s", "protocol");
+	for( impl = IR_QUANT_SCALAR; impl < IR_QUANT_IMPLS; impl++ ) {
+		printf(" %14s", ir_quant_impl_names[impl]);
+	}
+	printf(" %9s %s\n", "speedup", "identical");
+	for( p = 0; p < QUANT_PROTOCOLS; p++ ) {
+		ir_quant_table_init(&table, quant_protocols[p]);
+		same = true;
+		printf("%-11s", quant_protocol_names[p]);
+		for( impl = IR_QUANT_SCALAR; impl < IR_QUANT_IMPLS; impl++ ) {
+			rate[impl] = 0;
+			if( ir_quant_supported(impl) == false ) {
+				printf(" %14s", "-");
+				continue;
+			}
+			for( r = 0, best = UINT64_MAX; r < rounds; r++ ) {
+				start = quant_ns();
+				ir_quant_run(&table, impl, usec, n, symbols[impl], units[impl]);
+				ns = quant_ns() - start;
+				best = (ns < best) ? ns : best;
+			}
+			rate[impl] = (best != 0) ? ((double)n * 1e9 / (double)best) : 0;
+			printf(" %14.0f", rate[impl]);
+			if( impl != IR_QUANT_SCALAR ) {
+				same = same && (memcmp(symbols[impl], symbols[IR_QUANT_SCALAR], n * sizeof(symbols[0][0])) == 0) &&
+					   (memcmp(units[impl], units[IR_QUANT_SCALAR], n) == 0);
+			}
+		}
+		impl = ir_quant_best();
+		printf(" %8.1fx %s\n", (rate[IR_QUANT_SCALAR] > 0) ? (rate[impl] / rate[IR_QUANT_SCALAR]) : 0.0, (same == true) ? "yes" : "NO");
+		identical = identical && same;
+	}
+	printf("durations/s, the speedup of %s over scalar\n", ir_quant_impl_names[ir_quant_best()]);
+	return (identical == true) ? 0 : 1;
+}
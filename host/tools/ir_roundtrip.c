@@ -0,0 +1,363 @@
+/**
+ * @file ir_roundtrip.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Round trip property test: split unit states are encoded, transmitted, received, and decoded on the host.
+ * @details usage: ir_roundtrip [-n states] [-j jitter_usec,...] [-b bias_usec] [-g glitch_per_mille] [-w glitch_usec]
+ *                              [-l latency_ns] [-f filter_ns] [-s seed] [-J jitter_usec] [-p pct] [-r cases_per_s]
+ *                              [-o vcd] [-v]
+ *
+ * Each random state is encoded by embx_split_unit_encode and sent by the Tx PHY driving TC3 and TC4 of the host
+ * backend, the edges of the debug pin of the Tx PHY are recorded as the envelope of the carrier.  The envelope then
+ * goes through a channel for each jitter level: every edge moves by a uniform random amount up to the jitter, the
+ * end of each MARK is late by the bias like the output of an IR receiver, and an interval holds a glitch of the other
+ * level with a probability.  The channel output is driven onto the EIC pin of the Rx PHY and the capture is decoded
+ * with the codec.  A case is a state at a jitter level, it passes if the decoded state is the one sent.
+ *
+ * The report is the success rate per jitter level and the cases per second.  The exit status is 1 if a case decodes
+ * into another state, if a level up to -J passes less than pct percent of its cases, or if fewer than -r cases run
+ * per second, so the run can gate a change of the PHYs or of the protocol layer.  -o writes the Tx gate, the carrier,
+ * the EIC pin, and the state of the Rx PHY of every case to a VCD file, see ir_vcd_sim.h, e.g. with -n 1.
+ */
+#include "ir_vcd_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_digital_io/digital_output.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+
+/** The GCLK ticks per usec */
+#define RT_TICKS_PER_USEC			(EMBX_HAL_HOST_GCLK_HZ / 1000000UL)
+/** The defaults, see ir_rx_sim */
+#define RT_LATENCY_NS				(3000)
+#define RT_FILTER_NS				(125)
+#define RT_STATES					(1000)
+#define RT_GLITCH_USEC				(40)
+/** The jitter levels swept by default, and the gate: every level up to RT_GATE_JITTER_USEC passes every case */
+#define RT_JITTER_USEC				"0,10,20,30,40,50,60,70,80,100"
+#define RT_GATE_JITTER_USEC			(40)
+#define RT_GATE_PCT					(100)
+#define RT_MAX_LEVELS				(16)
+/** The idle line after a frame, every state of the Rx PHY times out */
+#define RT_GAP_MS					((EMBX_IR_RX_PHY_SPACE_DELAY * EMBX_IR_RX_PHY_USEC_PER_TICK / 1000) * (EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE + 2))
+/** The most edges of a transmission, and of the channel output with the glitches */
+#define RT_MAX_EDGES				(1024)
+#define RT_MAX_SEGMENTS				(3 * RT_MAX_EDGES)
+
+/** @brief The results of a jitter level */
+typedef struct {
+	uint32_t jitter_usec;
+	uint32_t cases;
+	uint32_t passed;
+	uint32_t lost; /** Not captured, or captured with an error status */
+	uint32_t rejected; /** Captured, but no frame decoded */
+	uint32_t wrong; /** Decoded into another state */
+} rt_level_t;
+
+/** @brief A level held on the EIC pin */
+typedef struct {
+	bool level;
+	uint64_t ticks;
+} rt_segment_t;
+
+static uint64_t rt_edge[RT_MAX_EDGES]; /** When the debug pin of the Tx PHY changed, in GCLK ticks */
+static uint16_t rt_edges;
+static rt_segment_t rt_segment[RT_MAX_SEGMENTS];
+static rt_level_t rt_levels[RT_MAX_LEVELS];
+static uint8_t rt_levels_n;
+static uint64_t rt_seed = 1;
+static bool verbose;
+
+static uint32_t rt_random(void)
+{
+	rt_seed = (rt_seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+	return (uint32_t)(rt_seed >> 33);
+}
+
+/**
+* @brief Records the edges of the debug pin of the Tx PHY, it is high during a MARK.
+*/
+static void rt_tx_edge(uint8_t pin, bool level)
+{
+	if( (pin == DEBUG_IR_TX_PHY_PIN) && (rt_edges < RT_MAX_EDGES) && (level == ((rt_edges & 1) == 0)) ) {
+		rt_edge[rt_edges++] = embx_hal_host_get_time();
+	}
+}
+
+/**
+* @brief Draws a state that the codec can carry, the timers are in units of 10 minutes.
+*/
+static void rt_random_state(embx_split_unit_state_t *state)
+{
+	uint32_t r = rt_random();
+
+	state->power = ((r & 1) != 0);
+	state->mode = (embx_split_unit_mode_t)((r >> 1) % (EMBX_SPLIT_UNIT_MODE_FAN + 1));
+	state->setpoint = (uint8_t)(EMBX_SPLIT_UNIT_SETPOINT_MIN + ((r >> 4) % (EMBX_SPLIT_UNIT_SETPOINT_MAX - EMBX_SPLIT_UNIT_SETPOINT_MIN + 1)));
+	state->fan = (uint8_t)((r >> 9) % (EMBX_SPLIT_UNIT_FAN_MAX + 1));
+	state->swing = (uint8_t)((r >> 12) % (EMBX_SPLIT_UNIT_SWING_MAX + 2));
+	state->swing = (state->swing > EMBX_SPLIT_UNIT_SWING_MAX) ? EMBX_SPLIT_UNIT_SWING_MOVE : state->swing;
+	r = rt_random();
+	state->on_timer_min = (uint16_t)(((r & 1) != 0) ? (((r >> 1) & 0xFF) * 10) : 0);
+	state->off_timer_min = (uint16_t)(((r & 0x200) != 0) ? (((r >> 10) & 0xFF) * 10) : 0);
+}
+
+static bool rt_state_equal(const embx_split_unit_state_t *a, const embx_split_unit_state_t *b)
+{
+	return (a->power == b->power) && (a->mode == b->mode) && (a->setpoint == b->setpoint) && (a->fan == b->fan) &&
+		   (a->swing == b->swing) && (a->on_timer_min == b->on_timer_min) && (a->off_timer_min == b->off_timer_min);
+}
+
+/**
+* @brief Transmits a state with the Tx PHY and records the edges of the envelope.
+* @returns STATUS_OK or the error of the encoder.
+*/
+static enum status_code rt_transmit(const embx_split_unit_state_t *state)
+{
+	static embx_ir_protocol_stream_t stream;
+	enum status_code status;
+
+	rt_edges = 0;
+	if( (status = embx_split_unit_encode(&embx_split_unit_mitsubishi_codec, state, &stream)) != STATUS_OK ) {
+		return status;
+	}
+	embx_hal_host_set_pin_callback(rt_tx_edge);
+	status = embx_ir_tx_phy_send();
+	while( embx_ir_tx_phy_get_state() == true ) {
+		embx_hal_host_run(1000 * RT_TICKS_PER_USEC);
+	}
+	embx_hal_host_set_pin_callback(NULL);
+	return status;
+}
+
+/**
+* @brief The channel from the emitter to the EIC pin: jitter and bias on the edges, then glitches in the intervals.
+* @returns the number of segments, the line is idle after the last one.
+*/
+static uint16_t rt_channel(uint32_t jitter_usec, int32_t bias_usec, uint32_t glitch_per_mille, uint32_t glitch_usec)
+{
+	static int64_t edge[RT_MAX_EDGES];
+	uint64_t len, at, width;
+	uint16_t n = 0, i;
+	int64_t shift;
+
+	for( i = 0; i < rt_edges; i++ ) {
+		shift = (jitter_usec != 0) ? ((int64_t)(rt_random() % ((2 * jitter_usec * RT_TICKS_PER_USEC) + 1)) - (int64_t)(jitter_usec * RT_TICKS_PER_USEC)) : 0;
+		shift += ((i & 1) != 0) ? ((int64_t)bias_usec * (int64_t)RT_TICKS_PER_USEC) : 0;
+		edge[i] = (int64_t)rt_edge[i] + shift;
+		if( (i != 0) && (edge[i] <= edge[i - 1]) ) {
+			edge[i] = edge[i - 1] + 1; /** The edges keep their order */
+		}
+	}
+	for( i = 0; (i + 1) < rt_edges; i++ ) {
+		len = (uint64_t)(edge[i + 1] - edge[i]);
+		width = ((glitch_usec != 0) ? (1 + (rt_random() % glitch_usec)) : 1) * RT_TICKS_PER_USEC;
+		if( ((rt_random() % 1000) < glitch_per_mille) && (len > (width + 2)) ) {
+			at = 1 + (rt_random() % (len - width - 1));
+			rt_segment[n].level = ((i & 1) != 0);
+			rt_segment[n++].ticks = at;
+			rt_segment[n].level = ((i & 1) == 0);
+			rt_segment[n++].ticks = width;
+			len -= at + width;
+		}
+		rt_segment[n].level = ((i & 1) != 0); /** The receiver output is low during a MARK */
+		rt_segment[n++].ticks = len;
+	}
+	return n;
+}
+
+/**
+* @brief Drives the channel output onto the EIC pin and decodes the captures.
+*/
+static void rt_receive(uint16_t segments, const embx_split_unit_state_t *sent, rt_level_t *level)
+{
+	embx_split_unit_state_t state;
+	embx_ir_protocol_frame_t frame;
+	embx_ir_rx_buf_t *buf;
+	enum status_code status;
+	bool captured = false, passed = false, wrong = false;
+	uint16_t i, idx;
+
+	for( i = 0; i < segments; i++ ) {
+		embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, rt_segment[i].level);
+		embx_hal_host_run(rt_segment[i].ticks);
+	}
+	embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, true);
+	embx_hal_delay_ms(RT_GAP_MS);
+
+	while( embx_ir_rx_buf_get_full(&buf) == STATUS_OK ) {
+		captured = captured || (buf->status == STATUS_OK);
+		idx = 0;
+		do {
+			status = embx_ir_protocol_decode(&embx_split_unit_mitsubishi_protocol, buf->elem, buf->size, &idx, &frame);
+			if( (status == STATUS_OK) && (embx_split_unit_mitsubishi_codec.decode(&frame, &state) == STATUS_OK) ) {
+				if( rt_state_equal(&state, sent) == true ) {
+					passed = true;
+				} else {
+					wrong = true;
+				}
+			}
+		} while( status != STATUS_ERR_BAD_DATA );
+		embx_ir_rx_buf_release();
+	}
+
+	level->cases++;
+	if( wrong == true ) {
+		level->wrong++;
+	} else if( passed == true ) {
+		level->passed++;
+	} else if( captured == true ) {
+		level->rejected++;
+	} else {
+		level->lost++;
+	}
+	if( (verbose == true) && ((passed == false) || (wrong == true)) ) {
+		printf("jitter %lu usec: power %u mode %u setpoint %u fan %u swing %u timers %u/%u %s\n",
+			   (unsigned long)level->jitter_usec, sent->power, sent->mode, sent->setpoint, sent->fan, sent->swing,
+			   sent->on_timer_min, sent->off_timer_min, (wrong == true) ? "decoded into another state" :
+			   (captured == true) ? "rejected" : "lost");
+	}
+}
+
+/**
+* @brief Parses the comma separated jitter levels.
+*/
+static bool rt_parse_levels(const char *list)
+{
+	char *end;
+
+	rt_levels_n = 0;
+	while( *list != '\0' ) {
+		if( rt_levels_n == RT_MAX_LEVELS ) {
+			return false;
+		}
+		rt_levels[rt_levels_n++].jitter_usec = (uint32_t)strtoul(list, &end, 0);
+		if( (end == list) || ((*end != ',') && (*end != '\0')) ) {
+			return false;
+		}
+		list = (*end == ',') ? (end + 1) : end;
+	}
+	return (rt_levels_n != 0);
+}
+
+static void rt_usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-n states] [-j jitter_usec,...] [-b bias_usec] [-g glitch_per_mille] [-w glitch_usec]\n"
+					"       [-l latency_ns] [-f filter_ns] [-s seed] [-J jitter_usec] [-p pct] [-r cases_per_s] [-o vcd] [-v]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t states = RT_STATES, glitch_per_mille = 0, glitch_usec = RT_GLITCH_USEC;
+	uint32_t latency_ns = RT_LATENCY_NS, filter_ns = RT_FILTER_NS;
+	uint32_t gate_jitter_usec = RT_GATE_JITTER_USEC, gate_pct = RT_GATE_PCT, min_rate = 0;
+	embx_split_unit_state_t state;
+	const char *vcd = NULL;
+	struct timespec start, stop;
+	uint64_t cases = 0;
+	int32_t bias_usec = 0;
+	bool failed = false;
+	uint16_t segments;
+	enum status_code status;
+	uint32_t n;
+	double wall, rate;
+	uint8_t l;
+	int opt;
+
+	rt_parse_levels(RT_JITTER_USEC);
+	while( (opt = getopt(argc, argv, "n:j:b:g:w:l:f:s:J:p:r:o:v")) != -1 ) {
+		switch( opt ) {
+			case 'n': states = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'j':
+				if( rt_parse_levels(optarg) == false ) {
+					fprintf(stderr, "%s: at most %u jitter levels in usec\n", optarg, RT_MAX_LEVELS);
+					return 2;
+				}
+			break;
+			case 'b': bias_usec = (int32_t)strtol(optarg, NULL, 0); break;
+			case 'g': glitch_per_mille = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'w': glitch_usec = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'l': latency_ns = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'f': filter_ns = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 's': rt_seed = strtoull(optarg, NULL, 0); break;
+			case 'J': gate_jitter_usec = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'p': gate_pct = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'r': min_rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'o': vcd = optarg; break;
+			case 'v': verbose = true; break;
+			default:
+				rt_usage(argv[0]);
+				return 2;
+		}
+	}
+	if( optind < argc ) {
+		rt_usage(argv[0]);
+		return 2;
+	}
+	printf("seed %llu, %lu states, bias %ld usec, glitches %lu per mille up to %lu usec\n", (unsigned long long)rt_seed,
+		   (unsigned long)states, (long)bias_usec, (unsigned long)glitch_per_mille, (unsigned long)glitch_usec);
+
+	embx_hal_host_reset();
+	embx_hal_host_set_isr_latency((latency_ns * RT_TICKS_PER_USEC) / 1000);
+	embx_hal_host_set_extint_filter((filter_ns * RT_TICKS_PER_USEC) / 1000);
+	embx_ir_tx_phy_init(KHz_38);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	if( (vcd != NULL) && (ir_vcd_sim_open(vcd, true) == false) ) {
+		return 2;
+	}
+	embx_hal_delay_ms(2 * EMBX_IR_RX_PHY_SYNC_DELAY * EMBX_IR_RX_PHY_USEC_PER_TICK / 1000); /** The line is idle */
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for( n = 0; n < states; n++ ) {
+		rt_random_state(&state);
+		if( (status = rt_transmit(&state)) != STATUS_OK ) {
+			printf("state %lu: not transmitted, status %d\n", (unsigned long)n, status);
+			return 1;
+		}
+		for( l = 0; l < rt_levels_n; l++ ) {
+			segments = rt_channel(rt_levels[l].jitter_usec, bias_usec, glitch_per_mille, glitch_usec);
+			rt_receive(segments, &state, &rt_levels[l]);
+			cases++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	if( (vcd != NULL) && (ir_vcd_sim_close() == false) ) {
+		return 2;
+	}
+	wall = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+	rate = (wall > 0) ? (cases / wall) : 0.0;
+
+	printf("%12s %8s %8s %8s %8s %8s %9s\n", "jitter_usec", "cases", "passed", "lost", "rejected", "wrong", "success");
+	for( l = 0; l < rt_levels_n; l++ ) {
+		printf("%12lu %8lu %8lu %8lu %8lu %8lu %8.2f%%\n", (unsigned long)rt_levels[l].jitter_usec,
+			   (unsigned long)rt_levels[l].cases, (unsigned long)rt_levels[l].passed, (unsigned long)rt_levels[l].lost,
+			   (unsigned long)rt_levels[l].rejected, (unsigned long)rt_levels[l].wrong,
+			   (rt_levels[l].cases != 0) ? ((100.0 * rt_levels[l].passed) / rt_levels[l].cases) : 0.0);
+		if( rt_levels[l].wrong != 0 ) {
+			printf("jitter %lu usec: %lu cases decoded into another state\n", (unsigned long)rt_levels[l].jitter_usec,
+				   (unsigned long)rt_levels[l].wrong);
+			failed = true;
+		}
+		if( (rt_levels[l].jitter_usec <= gate_jitter_usec) &&
+			(((uint64_t)rt_levels[l].passed * 100) < ((uint64_t)rt_levels[l].cases * gate_pct)) ) {
+			printf("jitter %lu usec: fewer than %lu%% of the cases passed\n", (unsigned long)rt_levels[l].jitter_usec,
+				   (unsigned long)gate_pct);
+			failed = true;
+		}
+	}
+	printf("%llu cases in %.3f s, %.0f cases/s\n", (unsigned long long)cases, wall, rate);
+	if( (min_rate != 0) && (rate < min_rate) ) {
+		printf("fewer than %lu cases/s\n", (unsigned long)min_rate);
+		failed = true;
+	}
+	return (failed == true) ? 1 : 0;
+}
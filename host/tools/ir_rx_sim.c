@@ -0,0 +1,329 @@
+/**
+ * @file ir_rx_sim.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Replays IR traces into the Rx PHY running unchanged on the host backend of the HAL.
+ * @details usage: ir_rx_sim [-l latency_ns] [-f filter_ns] [-g gap_ms] [-o vcd] [-v] trace...
+ *
+ * A trace is a binary trace, or a text file with a frame per line in the raw timing format, see ir_trace_file.h.
+ * Each frame is driven onto the EIC pin of the receiver, low during a MARK, and the line is idle for the gap so the Rx PHY completes the buffer.  The backend models TC5,
+ * the EIC filter, and the interrupt latency, see embx_hal_host.h.
+ *
+ * Every buffer completed by the Rx PHY is compared with its frame.  A frame error is a frame that is not captured or
+ * captured with another number of intervals, the timing error is the difference of the durations of the others.
+ * The captures are then decoded with the protocol proposed by the analyzer.  The exit status is 1 if there is a
+ * frame error, so a set of traces can gate a change of the Rx PHY.  -o writes the EIC pin and the state of the Rx PHY
+ * to a VCD file, see ir_vcd_sim.h.
+ */
+#include "ir_trace_file.h"
+#include "ir_vcd_sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+#include "embx/embx_ir/embx_ir_protocol.h"
+#include "embx/embx_ir/embx_ir_analyzer.h"
+
+/** The GCLK ticks per usec */
+#define SIM_TICKS_PER_USEC			(EMBX_HAL_HOST_GCLK_HZ / 1000000UL)
+/** The defaults: a few usec to reach the callback, 3 samples of the EIC clocked at 48 MHz, and the Rx PHY timeout */
+#define SIM_LATENCY_NS				(3000)
+#define SIM_FILTER_NS				(125)
+#define SIM_GAP_MS					((EMBX_IR_RX_PHY_SPACE_DELAY * EMBX_IR_RX_PHY_USEC_PER_TICK / 1000) * (EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE + 2))
+/** An interval is counted as a timing error if it is off by more than a tick of the Rx PHY and the latency jitter */
+#define SIM_TOLERANCE_USEC			(2 * EMBX_IR_RX_PHY_USEC_PER_TICK)
+/** The longest line of a text trace */
+#define SIM_LINE_SZ					(16384)
+
+/** @brief A frame of a trace */
+typedef struct {
+	embx_ir_rx_buf_elem_t *elem;
+	uint16_t size;
+} sim_frame_t;
+
+/** @brief The results of the replay */
+typedef struct {
+	uint32_t frames;
+	uint32_t edges;
+	uint32_t captured;
+	uint32_t frame_errors;
+	uint32_t intervals; /** The intervals compared */
+	uint32_t timing_errors;
+	uint32_t error_max_usec;
+	uint64_t error_sum_usec;
+	uint32_t decoded;
+} sim_stats_t;
+
+static sim_frame_t *frames;
+static uint32_t frames_n;
+static embx_ir_rx_buf_t *captures;
+static uint32_t captures_n;
+static sim_stats_t stats;
+static bool verbose;
+
+/**
+* @brief Appends a frame.
+*/
+static void sim_add_frame(const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	frames = realloc(frames, (frames_n + 1) * sizeof(frames[0]));
+	frames[frames_n].elem = malloc(size * sizeof(elem[0]));
+	memcpy(frames[frames_n].elem, elem, size * sizeof(elem[0]));
+	frames[frames_n].size = size;
+	frames_n++;
+}
+
+/**
+* @brief Reads the frames of a binary trace.
+*/
+static bool sim_read_binary(const char *path, const ir_trace_file_map_t *map)
+{
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+
+	if( embx_ir_trace_reader_init(&reader, map->data, map->len) != STATUS_OK ) {
+		fprintf(stderr, "%s: not a trace of version %u or earlier\n", path, EMBX_IR_TRACE_VERSION);
+		return false;
+	}
+	while( (status = embx_ir_trace_read(&reader, &record)) == STATUS_OK ) {
+		if( embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK ) {
+			break;
+		}
+		if( record.size != 0 ) {
+			sim_add_frame(elem, record.size);
+		}
+	}
+	if( status != STATUS_NO_CHANGE ) {
+		fprintf(stderr, "%s: corrupt record at offset %zu\n", path, reader.offset);
+		return false;
+	}
+	return true;
+}
+
+/**
+* @brief Reads the frames of a trace file, returns false if it cannot be read.
+*/
+static bool sim_read_trace(const char *path)
+{
+	static char line[SIM_LINE_SZ];
+	static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+	embx_ir_trace_record_t record;
+	ir_trace_file_map_t map;
+	enum status_code status = STATUS_NO_CHANGE;
+	bool has_timestamp, ok;
+	uint32_t n = 0;
+	FILE *f;
+
+	if( strcmp(path, "-") != 0 ) {
+		if( ir_trace_file_map(path, &map) == false ) {
+			return false;
+		}
+		ok = ir_trace_file_is_binary(map.data, map.len);
+		if( ok == true ) {
+			ok = sim_read_binary(path, &map);
+			ir_trace_file_unmap(&map);
+			return ok;
+		}
+		ir_trace_file_unmap(&map);
+	}
+
+	if( (f = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r")) == NULL ) {
+		perror(path);
+		return false;
+	}
+	while( fgets(line, sizeof(line), f) != NULL ) {
+		n++;
+		status = ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp);
+		if( status == STATUS_OK ) {
+			sim_add_frame(elem, record.size);
+		} else if( status != STATUS_NO_CHANGE ) {
+			fprintf(stderr, "%s:%lu: not a frame of at most %u intervals\n", path, (unsigned long)n, EMBX_IR_RX_BUF_SZ);
+			break;
+		}
+	}
+	if( f != stdin ) {
+		fclose(f);
+	}
+	return ((status == STATUS_OK) || (status == STATUS_NO_CHANGE));
+}
+
+/**
+* @brief Compares a capture with its frame.  A trailing SPACE of the frame merges with the gap and is not captured.
+*/
+static void sim_check(uint32_t n, const embx_ir_rx_buf_t *buf)
+{
+	const sim_frame_t *frame = &frames[n];
+	uint16_t expected = ((frame->size & 1) == 0) ? (frame->size - 1) : frame->size;
+	uint32_t error;
+	uint16_t i;
+
+	if( (buf->status != STATUS_OK) || (buf->size != expected) ) {
+		stats.frame_errors++;
+		printf("frame %lu: %u intervals captured with status %d, %u sent\n", (unsigned long)n, buf->size, buf->status, expected);
+		return;
+	}
+	for( i = 0; i < expected; i++ ) {
+		error = (buf->elem[i].time_us > frame->elem[i].time_us) ? (buf->elem[i].time_us - frame->elem[i].time_us) :
+																 (frame->elem[i].time_us - buf->elem[i].time_us);
+		stats.intervals++;
+		stats.error_sum_usec += error;
+		if( error > stats.error_max_usec ) {
+			stats.error_max_usec = error;
+		}
+		if( error > SIM_TOLERANCE_USEC ) {
+			stats.timing_errors++;
+			if( verbose == true ) {
+				printf("frame %lu: interval %u is %lu usec, sent %lu usec\n", (unsigned long)n, i,
+					(unsigned long)buf->elem[i].time_us, (unsigned long)frame->elem[i].time_us);
+			}
+		}
+	}
+}
+
+/**
+* @brief Drives a frame onto the EIC pin, waits for the gap, and collects the buffers completed by the Rx PHY.
+*/
+static void sim_replay(uint32_t n, uint32_t gap_ms)
+{
+	const sim_frame_t *frame = &frames[n];
+	embx_ir_rx_buf_t *buf;
+	uint32_t got = 0;
+	uint16_t i;
+
+	for( i = 0; i < frame->size; i++ ) {
+		embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, frame->elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE);
+		embx_hal_host_run((uint64_t)frame->elem[i].time_us * SIM_TICKS_PER_USEC);
+		stats.edges++;
+	}
+	embx_hal_host_set_input(EMBX_IR_RX_EIC_PIN, true);
+	stats.edges += ((frame->size & 1) != 0) ? 1 : 0;
+	embx_hal_delay_ms(gap_ms);
+
+	while( embx_ir_rx_buf_get_full(&buf) == STATUS_OK ) {
+		if( got++ == 0 ) {
+			sim_check(n, buf);
+		} else {
+			stats.frame_errors++;
+			printf("frame %lu: split into %lu captures\n", (unsigned long)n, (unsigned long)got);
+		}
+		captures = realloc(captures, (captures_n + 1) * sizeof(captures[0]));
+		memcpy(&captures[captures_n++], buf, sizeof(*buf));
+		embx_ir_rx_buf_release();
+	}
+	if( got == 0 ) {
+		stats.frame_errors++;
+		printf("frame %lu: not captured\n", (unsigned long)n);
+	} else {
+		stats.captured++;
+	}
+}
+
+/**
+* @brief Decodes the captures with the protocol proposed by the analyzer from all of them.
+*/
+static void sim_decode(void)
+{
+	static embx_ir_analyzer_t analyzer;
+	embx_ir_protocol_t protocol;
+	embx_ir_protocol_frame_t frame;
+	uint32_t n;
+	uint16_t idx, i;
+
+	if( captures_n == 0 ) {
+		return;
+	}
+	embx_ir_analyzer_init(&analyzer);
+	for( n = 0; n < captures_n; n++ ) {
+		embx_ir_analyzer_add_frame(&analyzer, captures[n].elem, captures[n].size);
+	}
+	if( embx_ir_analyzer_propose(&analyzer, captures[0].elem, captures[0].size, &protocol) != STATUS_OK ) {
+		printf("decoded: no protocol recognized\n");
+		return;
+	}
+	printf("protocol: encoding %d, header %u/%u usec, zero %u/%u usec, one %u/%u usec, %u bits\n", protocol.encoding,
+		protocol.header_mark_usec, protocol.header_space_usec, protocol.zero_mark_usec, protocol.zero_space_usec,
+		protocol.one_mark_usec, protocol.one_space_usec, protocol.nbits);
+	for( n = 0; n < captures_n; n++ ) {
+		idx = 0;
+		while( embx_ir_protocol_decode(&protocol, captures[n].elem, captures[n].size, &idx, &frame) == STATUS_OK ) {
+			stats.decoded++;
+			if( verbose == true ) {
+				printf("capture %lu:", (unsigned long)n);
+				for( i = 0; i < ((frame.nbits + 7) / 8); i++ ) {
+					printf(" %02X", frame.data[i]);
+				}
+				printf("\n");
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t latency_ns = SIM_LATENCY_NS, filter_ns = SIM_FILTER_NS, gap_ms = SIM_GAP_MS;
+	const char *vcd = NULL;
+	struct timespec start, stop;
+	double wall;
+	uint32_t n;
+	int opt;
+
+	while( (opt = getopt(argc, argv, "l:f:g:o:v")) != -1 ) {
+		switch( opt ) {
+			case 'l': latency_ns = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'f': filter_ns = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'g': gap_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'o': vcd = optarg; break;
+			case 'v': verbose = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-l latency_ns] [-f filter_ns] [-g gap_ms] [-o vcd] [-v] trace...\n", argv[0]);
+				return 2;
+		}
+	}
+	if( optind >= argc ) {
+		fprintf(stderr, "usage: %s [-l latency_ns] [-f filter_ns] [-g gap_ms] [-o vcd] [-v] trace...\n", argv[0]);
+		return 2;
+	}
+	for( ; optind < argc; optind++ ) {
+		if( sim_read_trace(argv[optind]) == false ) {
+			return 2;
+		}
+	}
+
+	embx_hal_host_reset();
+	embx_hal_host_set_isr_latency((latency_ns * SIM_TICKS_PER_USEC) / 1000);
+	embx_hal_host_set_extint_filter((filter_ns * SIM_TICKS_PER_USEC) / 1000);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	if( (vcd != NULL) && (ir_vcd_sim_open(vcd, false) == false) ) {
+		return 2;
+	}
+	embx_hal_delay_ms(2 * EMBX_IR_RX_PHY_SYNC_DELAY * EMBX_IR_RX_PHY_USEC_PER_TICK / 1000); /** The line is idle */
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for( n = 0; n < frames_n; n++ ) {
+		stats.frames++;
+		sim_replay(n, gap_ms);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	if( (vcd != NULL) && (ir_vcd_sim_close() == false) ) {
+		return 2;
+	}
+	wall = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+
+	sim_decode();
+	printf("frames %lu, captured %lu, frame errors %lu, decoded %lu\n", (unsigned long)stats.frames,
+		(unsigned long)stats.captured, (unsigned long)stats.frame_errors, (unsigned long)stats.decoded);
+	printf("timing error max %lu usec, mean %.1f usec, %lu of %lu intervals over %u usec\n", (unsigned long)stats.error_max_usec,
+		(stats.intervals != 0) ? ((double)stats.error_sum_usec / stats.intervals) : 0.0, (unsigned long)stats.timing_errors,
+		(unsigned long)stats.intervals, SIM_TOLERANCE_USEC);
+	printf("%lu edges in %.3f s simulated %.1f s, %.0f edges/s\n", (unsigned long)stats.edges, wall,
+		(double)embx_hal_host_get_time() / EMBX_HAL_HOST_GCLK_HZ, (wall > 0) ? (stats.edges / wall) : 0.0);
+
+	return (stats.frame_errors != 0) ? 1 : 0;
+}
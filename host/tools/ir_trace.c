@@ -0,0 +1,343 @@
+/**
+ * @file ir_trace.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Converts the binary IR traces to and from raw timing text and Pronto hex, and summarizes them.
+ * @details usage: ir_trace info trace...
+ *                 ir_trace to-raw [-t] [-s] trace
+ *                 ir_trace to-pronto trace
+ *                 ir_trace from-raw [-c carrier_hz] text trace
+ *                 ir_trace from-pronto text trace
+ *                 ir_trace to-vcd [-m] trace vcd
+ *
+ * The binary traces are mapped in memory and read in place, see embx_ir_trace.h for the format and ir_trace_file.h
+ * for the text formats.  The text is written to stdout, "-" reads the text from stdin.  A text frame without a
+ * timestamp is stamped IR_TRACE_FILE_GAP_USEC after the end of the frame before it.
+ *
+ * to-vcd writes the captures at their timestamps as tx_gate and rx_input of a VCD file, see ir_vcd.h, and with -m the
+ * carrier at the frequency of each record.  The file is streamed from the mapped trace, "-" writes it to stdout.  The
+ * state of the Rx PHY is written by ir_rx_sim -o, which replays the trace into the Rx PHY.
+ */
+#include "ir_trace_file.h"
+#include "ir_vcd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/** The longest line of a text trace */
+#define IR_TRACE_LINE_SZ			(16384)
+
+static embx_ir_rx_buf_elem_t elem[EMBX_IR_RX_BUF_SZ];
+static char line[IR_TRACE_LINE_SZ];
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: ir_trace info trace...\n"
+					"       ir_trace to-raw [-t] [-s] trace\n"
+					"       ir_trace to-pronto trace\n"
+					"       ir_trace from-raw [-c carrier_hz] text trace\n"
+					"       ir_trace from-pronto text trace\n"
+					"       ir_trace to-vcd [-m] trace vcd\n");
+	return 2;
+}
+
+/**
+* @brief Returns the duration of a capture in usec.
+*/
+static uint64_t ir_trace_duration(const embx_ir_rx_buf_elem_t *e, uint16_t size)
+{
+	uint64_t usec = 0;
+	uint16_t i;
+
+	for( i = 0; i < size; i++ ) {
+		usec += e[i].time_us;
+	}
+	return usec;
+}
+
+/**
+* @brief Summarizes the traces: the records, their status and size, and how fast they are read.
+*/
+static int ir_trace_info(int argc, char *argv[])
+{
+	ir_trace_file_map_t map;
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	uint64_t records, failed, intervals, first, last;
+	struct timespec start, stop;
+	double wall;
+	int rc = 0, i;
+
+	for( i = 1; i < argc; i++ ) {
+		if( ir_trace_file_map(argv[i], &map) == false ) {
+			return 2;
+		}
+		if( (status = embx_ir_trace_reader_init(&reader, map.data, map.len)) != STATUS_OK ) {
+			fprintf(stderr, "%s: %s\n", argv[i], (status == STATUS_ERR_UNSUPPORTED_DEV) ? "later version" : "not a trace");
+			ir_trace_file_unmap(&map);
+			return 2;
+		}
+		records = failed = intervals = first = last = 0;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		while( (status = embx_ir_trace_read(&reader, &record)) == STATUS_OK ) {
+			if( embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK ) {
+				status = STATUS_ERR_BAD_FORMAT;
+				break;
+			}
+			first = (records == 0) ? record.timestamp_us : first;
+			last = record.timestamp_us + ir_trace_duration(elem, record.size);
+			failed += (record.status != STATUS_OK) ? 1 : 0;
+			intervals += record.size;
+			records++;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		wall = (double)(stop.tv_sec - start.tv_sec) + ((double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+
+		printf("%s: version %u, %llu records, %llu failed captures, %llu intervals, %.2f bytes per interval\n", argv[i],
+			reader.version, (unsigned long long)records, (unsigned long long)failed, (unsigned long long)intervals,
+			(intervals != 0) ? ((double)map.len / intervals) : 0.0);
+		printf("%s: %.3f s from %llu usec, read at %.0f MB/s\n", argv[i], (last - first) / 1e6, (unsigned long long)first,
+			(wall > 0) ? (reader.offset / wall / 1e6) : 0.0);
+		if( status != STATUS_NO_CHANGE ) {
+			fprintf(stderr, "%s: corrupt record at offset %zu\n", argv[i], reader.offset);
+			rc = 1;
+		}
+		ir_trace_file_unmap(&map);
+	}
+	return rc;
+}
+
+/**
+* @brief Prints a trace as raw timing text or Pronto hex.
+*/
+static int ir_trace_to_text(const char *path, bool pronto, bool timestamp, bool sign)
+{
+	ir_trace_file_map_t map;
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	uint64_t n = 0;
+	int rc = 0;
+
+	if( ir_trace_file_map(path, &map) == false ) {
+		return 2;
+	}
+	if( embx_ir_trace_reader_init(&reader, map.data, map.len) != STATUS_OK ) {
+		fprintf(stderr, "%s: not a trace of version %u or earlier\n", path, EMBX_IR_TRACE_VERSION);
+		ir_trace_file_unmap(&map);
+		return 2;
+	}
+	while( (status = embx_ir_trace_read(&reader, &record)) == STATUS_OK ) {
+		if( embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK ) {
+			status = STATUS_ERR_BAD_FORMAT;
+			break;
+		}
+		if( pronto == false ) {
+			ir_trace_file_print_raw(stdout, &record, elem, timestamp, sign);
+		} else if( ir_trace_file_print_pronto(stdout, &record, elem) != STATUS_OK ) {
+			fprintf(stderr, "%s: record %llu does not alternate from a MARK, skipped\n", path, (unsigned long long)n);
+			rc = 1;
+		}
+		n++;
+	}
+	if( status != STATUS_NO_CHANGE ) {
+		fprintf(stderr, "%s: corrupt record at offset %zu\n", path, reader.offset);
+		rc = 1;
+	}
+	ir_trace_file_unmap(&map);
+	return rc;
+}
+
+/**
+* @brief Writes the carrier of a MARK, high for the first half of each period.
+*/
+static void ir_trace_vcd_carrier(ir_vcd_t *vcd, uint8_t carrier, uint64_t start_ns, uint64_t end_ns, uint32_t carrier_hz)
+{
+	uint64_t k, t;
+
+	for( k = 0; (t = start_ns + ((k * 1000000000ULL) / (2 * carrier_hz))) < end_ns; k++ ) {
+		ir_vcd_change(vcd, carrier, t, ((k & 1) == 0));
+	}
+	ir_vcd_change(vcd, carrier, end_ns, 0);
+}
+
+/**
+* @brief Writes a trace as a VCD file, a record at a time.
+*/
+static int ir_trace_to_vcd(const char *path, const char *vcd_path, bool modulate)
+{
+	ir_trace_file_map_t map;
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	uint8_t tx_gate, carrier = IR_VCD_MAX_SIGNALS, rx_input;
+	uint64_t t = 0, end;
+	ir_vcd_t vcd;
+	bool mark;
+	uint16_t i;
+	int rc = 0;
+
+	if( ir_trace_file_map(path, &map) == false ) {
+		return 2;
+	}
+	if( embx_ir_trace_reader_init(&reader, map.data, map.len) != STATUS_OK ) {
+		fprintf(stderr, "%s: not a trace of version %u or earlier\n", path, EMBX_IR_TRACE_VERSION);
+		ir_trace_file_unmap(&map);
+		return 2;
+	}
+	if( ir_vcd_open(&vcd, vcd_path, IR_VCD_TIMESCALE, "ir") == false ) {
+		ir_trace_file_unmap(&map);
+		return 2;
+	}
+	tx_gate = ir_vcd_add(&vcd, "tx_gate", 1, 0);
+	if( modulate == true ) {
+		carrier = ir_vcd_add(&vcd, "carrier", 1, 0);
+	}
+	rx_input = ir_vcd_add(&vcd, "rx_input", 1, 1);
+
+	while( (status = embx_ir_trace_read(&reader, &record)) == STATUS_OK ) {
+		if( embx_ir_trace_get_elems(&record, elem, EMBX_IR_RX_BUF_SZ) != STATUS_OK ) {
+			status = STATUS_ERR_BAD_FORMAT;
+			break;
+		}
+		t = (record.timestamp_us * 1000ULL > t) ? (record.timestamp_us * 1000ULL) : t; /** A record that overlaps the one before starts at its end */
+		for( i = 0; i < record.size; i++ ) {
+			mark = (elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK);
+			end = t + ((uint64_t)elem[i].time_us * 1000ULL);
+			ir_vcd_change(&vcd, tx_gate, t, mark);
+			ir_vcd_change(&vcd, rx_input, t, !mark);
+			if( (mark == true) && (modulate == true) ) {
+				ir_trace_vcd_carrier(&vcd, carrier, t, end, (record.carrier_hz != 0) ? record.carrier_hz : IR_TRACE_FILE_CARRIER_HZ);
+			}
+			t = end;
+		}
+		ir_vcd_change(&vcd, tx_gate, t, 0);
+		ir_vcd_change(&vcd, rx_input, t, 1);
+	}
+	if( status != STATUS_NO_CHANGE ) {
+		fprintf(stderr, "%s: corrupt record at offset %zu\n", path, reader.offset);
+		rc = 1;
+	}
+	ir_trace_file_unmap(&map);
+	return (ir_vcd_close(&vcd, t) == true) ? rc : 2;
+}
+
+/**
+* @brief Writes a binary trace from raw timing text or Pronto hex.
+*/
+static int ir_trace_from_text(const char *in_path, const char *out_path, bool pronto, uint32_t carrier_hz)
+{
+	static uint8_t out[EMBX_IR_TRACE_RECORD_MAX_SZ(EMBX_IR_RX_BUF_SZ)];
+	embx_ir_trace_writer_t writer;
+	embx_ir_trace_record_t record;
+	enum status_code status;
+	FILE *in, *f;
+	uint64_t next_us = 0;
+	uint32_t n = 0;
+	bool has_timestamp = false;
+	size_t len;
+	int rc = 0;
+
+	in = (strcmp(in_path, "-") == 0) ? stdin : fopen(in_path, "r");
+	if( in == NULL ) {
+		perror(in_path);
+		return 2;
+	}
+	if( (f = fopen(out_path, "wb")) == NULL ) {
+		perror(out_path);
+		if( in != stdin ) {
+			fclose(in);
+		}
+		return 2;
+	}
+	embx_ir_trace_write_header(&writer, out);
+	fwrite(out, 1, EMBX_IR_TRACE_HEADER_SZ, f);
+
+	while( fgets(line, sizeof(line), in) != NULL ) {
+		n++;
+		memset(&record, 0, sizeof(record));
+		record.status = STATUS_OK;
+		record.quality = EMBX_IR_TRACE_QUALITY_UNKNOWN;
+		record.carrier_hz = carrier_hz;
+		if( pronto == false ) {
+			status = ir_trace_file_parse_raw(line, elem, EMBX_IR_RX_BUF_SZ, &record, &has_timestamp);
+		} else {
+			status = ir_trace_file_parse_pronto(line, elem, EMBX_IR_RX_BUF_SZ, &record);
+		}
+		if( status == STATUS_NO_CHANGE ) {
+			continue;
+		}
+		if( status != STATUS_OK ) {
+			fprintf(stderr, "%s:%lu: %s, skipped\n", in_path, (unsigned long)n,
+				(status == STATUS_ERR_OVERFLOW) ? "longer than an rx buffer" : "bad format");
+			rc = 1;
+			continue;
+		}
+		if( has_timestamp == false ) {
+			record.timestamp_us = next_us;
+		}
+		if( embx_ir_trace_write(&writer, &record, elem, record.size, out, sizeof(out), &len) != STATUS_OK ) {
+			fprintf(stderr, "%s:%lu: timestamp earlier than the frame before, skipped\n", in_path, (unsigned long)n);
+			rc = 1;
+			continue;
+		}
+		fwrite(out, 1, len, f);
+		next_us = record.timestamp_us + ir_trace_duration(elem, record.size) + IR_TRACE_FILE_GAP_USEC;
+	}
+
+	if( in != stdin ) {
+		fclose(in);
+	}
+	if( fclose(f) != 0 ) {
+		perror(out_path);
+		return 2;
+	}
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *cmd;
+	uint32_t carrier_hz = 0;
+	bool timestamp = false, sign = false, modulate = false;
+	int opt;
+
+	if( argc < 2 ) {
+		return usage();
+	}
+	cmd = argv[1];
+	argc--;
+	argv++;
+	if( strcmp(cmd, "info") == 0 ) {
+		return (argc < 2) ? usage() : ir_trace_info(argc, argv);
+	}
+	while( (opt = getopt(argc, argv, "tsmc:")) != -1 ) {
+		switch( opt ) {
+			case 't': timestamp = true; break;
+			case 's': sign = true; break;
+			case 'm': modulate = true; break;
+			case 'c': carrier_hz = (uint32_t)strtoul(optarg, NULL, 0); break;
+			default: return usage();
+		}
+	}
+	if( (strcmp(cmd, "to-raw") == 0) && (argc == (optind + 1)) ) {
+		return ir_trace_to_text(argv[optind], false, timestamp, sign);
+	}
+	if( (strcmp(cmd, "to-pronto") == 0) && (argc == (optind + 1)) ) {
+		return ir_trace_to_text(argv[optind], true, false, false);
+	}
+	if( (strcmp(cmd, "from-raw") == 0) && (argc == (optind + 2)) ) {
+		return ir_trace_from_text(argv[optind], argv[optind + 1], false, carrier_hz);
+	}
+	if( (strcmp(cmd, "from-pronto") == 0) && (argc == (optind + 2)) ) {
+		return ir_trace_from_text(argv[optind], argv[optind + 1], true, 0);
+	}
+	if( (strcmp(cmd, "to-vcd") == 0) && (argc == (optind + 2)) ) {
+		return ir_trace_to_vcd(argv[optind], argv[optind + 1], modulate);
+	}
+	return usage();
+}
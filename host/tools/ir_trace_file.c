@@ -0,0 +1,249 @@
+/**
+ * @file ir_trace_file.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The trace files of the host tools: binary traces mapped in memory, raw timing text, and Pronto hex.
+ */
+#include "ir_trace_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+
+/** The period of the Pronto carrier word in usec, the carrier frequency is 1 / (word * 0.241246 usec) */
+#define IR_TRACE_FILE_PRONTO_UNIT		(0.241246)
+#define IR_TRACE_FILE_PRONTO_WORDS		(4)
+
+bool ir_trace_file_map(const char *path, ir_trace_file_map_t *map)
+{
+	struct stat st;
+	void *data;
+	int fd;
+
+	if( (fd = open(path, O_RDONLY)) < 0 ) {
+		perror(path);
+		return false;
+	}
+	if( fstat(fd, &st) != 0 ) {
+		perror(path);
+		close(fd);
+		return false;
+	}
+	map->len = (size_t)st.st_size;
+	map->data = NULL;
+	if( map->len != 0 ) {
+		data = mmap(NULL, map->len, PROT_READ, MAP_PRIVATE, fd, 0);
+		if( data == MAP_FAILED ) {
+			perror(path);
+			close(fd);
+			return false;
+		}
+		madvise(data, map->len, MADV_SEQUENTIAL);
+		map->data = data;
+	}
+	close(fd); /** The mapping holds the file */
+	return true;
+}
+
+void ir_trace_file_unmap(ir_trace_file_map_t *map)
+{
+	if( map->data != NULL ) {
+		munmap((void *)map->data, map->len);
+		map->data = NULL;
+	}
+}
+
+bool ir_trace_file_is_binary(const uint8_t *data, size_t len)
+{
+	embx_ir_trace_reader_t reader;
+
+	return (embx_ir_trace_reader_init(&reader, data, len) != STATUS_ERR_BAD_FORMAT);
+}
+
+/**
+* @brief Returns the first character of the next token, skipping the separators.
+*/
+static char *ir_trace_file_token(char *p)
+{
+	while( (*p == ' ') || (*p == '\t') || (*p == ',') || (*p == '\r') || (*p == '\n') ) {
+		p++;
+	}
+	return p;
+}
+
+/**
+* @brief Appends an interval, a duration in the state of the previous one is added to it.
+*/
+static enum status_code ir_trace_file_append(embx_ir_rx_buf_elem_t *elem, uint16_t max, uint16_t *size,
+											 embx_ir_rx_gpio_state_t state, uint32_t usec)
+{
+	if( (*size != 0) && (elem[*size - 1].gpio_state == state) ) {
+		elem[*size - 1].time_us += usec;
+	} else if( *size < max ) {
+		elem[*size].gpio_state = state;
+		elem[*size].time_us = usec;
+		(*size)++;
+	} else {
+		return STATUS_ERR_OVERFLOW;
+	}
+	elem[*size - 1].ticks = elem[*size - 1].time_us / EMBX_IR_RX_PHY_USEC_PER_TICK;
+	return STATUS_OK;
+}
+
+enum status_code ir_trace_file_parse_raw(char *line, embx_ir_rx_buf_elem_t *elem, uint16_t max,
+										 embx_ir_trace_record_t *record, bool *has_timestamp)
+{
+	embx_ir_rx_gpio_state_t state = EMBX_IR_RX_GPIO_STATE_MARK;
+	enum status_code status;
+	uint16_t size = 0;
+	char *p, *end;
+	unsigned long long value;
+
+	if( (p = strchr(line, '#')) != NULL ) {
+		*p = '\0';
+	}
+	*has_timestamp = false;
+	p = ir_trace_file_token(line);
+	if( *p == '@' ) {
+		record->timestamp_us = strtoull(p + 1, &end, 10);
+		if( end == (p + 1) ) {
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		*has_timestamp = true;
+		p = end;
+	}
+	while( *(p = ir_trace_file_token(p)) != '\0' ) {
+		if( *p == '+' ) {
+			state = EMBX_IR_RX_GPIO_STATE_MARK;
+			p++;
+		} else if( *p == '-' ) {
+			state = EMBX_IR_RX_GPIO_STATE_SPACE;
+			p++;
+		}
+		value = strtoull(p, &end, 10);
+		if( (end == p) || (value > UINT32_MAX) ) {
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		p = end;
+		if( (size == 0) && (state == EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			return STATUS_ERR_BAD_FORMAT; /** A capture starts with a MARK */
+		}
+		if( (status = ir_trace_file_append(elem, max, &size, state, (uint32_t)value)) != STATUS_OK ) {
+			return status;
+		}
+		state = (state == EMBX_IR_RX_GPIO_STATE_MARK) ? EMBX_IR_RX_GPIO_STATE_SPACE : EMBX_IR_RX_GPIO_STATE_MARK;
+	}
+	record->size = size;
+	return (size == 0) ? STATUS_NO_CHANGE : STATUS_OK;
+}
+
+enum status_code ir_trace_file_parse_pronto(char *line, embx_ir_rx_buf_elem_t *elem, uint16_t max,
+											embx_ir_trace_record_t *record)
+{
+	uint32_t words[IR_TRACE_FILE_PRONTO_WORDS];
+	enum status_code status;
+	uint16_t size = 0;
+	uint32_t n = 0, pairs = 0, i;
+	unsigned long value;
+	double unit = 0;
+	char *p, *end;
+
+	if( (p = strchr(line, '#')) != NULL ) {
+		*p = '\0';
+	}
+	p = line;
+	while( *(p = ir_trace_file_token(p)) != '\0' ) {
+		value = strtoul(p, &end, 16);
+		if( (end == p) || (value > 0xFFFF) ) {
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		p = end;
+		if( n < IR_TRACE_FILE_PRONTO_WORDS ) {
+			words[n++] = (uint32_t)value;
+			if( n == IR_TRACE_FILE_PRONTO_WORDS ) {
+				if( (words[0] != 0) || (words[1] == 0) ) {
+					return STATUS_ERR_BAD_FORMAT; /** Only the learned format carries the timing */
+				}
+				unit = words[1] * IR_TRACE_FILE_PRONTO_UNIT;
+				pairs = words[2] + words[3];
+			}
+			continue;
+		}
+		if( (n - IR_TRACE_FILE_PRONTO_WORDS) >= (2 * pairs) ) {
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		i = n++ - IR_TRACE_FILE_PRONTO_WORDS;
+		status = ir_trace_file_append(elem, max, &size, ((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE,
+									  (uint32_t)((value * unit) + 0.5));
+		if( status != STATUS_OK ) {
+			return status;
+		}
+	}
+	if( n == 0 ) {
+		return STATUS_NO_CHANGE;
+	}
+	if( (n < IR_TRACE_FILE_PRONTO_WORDS) || ((n - IR_TRACE_FILE_PRONTO_WORDS) != (2 * pairs)) || (pairs == 0) ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	if( elem[size - 1].gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE ) {
+		size--;
+	}
+	record->size = size;
+	record->carrier_hz = (uint32_t)((1000000.0 / unit) + 0.5);
+	return STATUS_OK;
+}
+
+void ir_trace_file_print_raw(FILE *f, const embx_ir_trace_record_t *record, const embx_ir_rx_buf_elem_t *elem,
+							 bool timestamp, bool sign)
+{
+	uint16_t i;
+
+	if( timestamp == true ) {
+		fprintf(f, "@%llu ", (unsigned long long)record->timestamp_us);
+	}
+	for( i = 0; i < record->size; i++ ) {
+		if( sign == true ) {
+			fputc((elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE) ? '-' : '+', f);
+		}
+		fprintf(f, (i == (record->size - 1)) ? "%lu" : "%lu ", (unsigned long)elem[i].time_us);
+	}
+	fputc('\n', f);
+}
+
+/**
+* @brief Returns a duration in carrier periods, a Pronto word.
+*/
+static inline uint32_t ir_trace_file_pronto_count(uint32_t usec, double unit)
+{
+	uint32_t count = (uint32_t)((usec / unit) + 0.5);
+
+	return (count == 0) ? 1 : ((count > 0xFFFF) ? 0xFFFF : count);
+}
+
+enum status_code ir_trace_file_print_pronto(FILE *f, const embx_ir_trace_record_t *record, const embx_ir_rx_buf_elem_t *elem)
+{
+	uint32_t carrier_hz = (record->carrier_hz != 0) ? record->carrier_hz : IR_TRACE_FILE_CARRIER_HZ;
+	uint32_t word = (uint32_t)((1000000.0 / (carrier_hz * IR_TRACE_FILE_PRONTO_UNIT)) + 0.5);
+	double unit = word * IR_TRACE_FILE_PRONTO_UNIT;
+	uint16_t i;
+
+	for( i = 0; i < record->size; i++ ) {
+		if( elem[i].gpio_state != (((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			return STATUS_ERR_BAD_DATA;
+		}
+	}
+	fprintf(f, "0000 %04X %04X 0000", (unsigned)word, (unsigned)((record->size + 1) / 2));
+	for( i = 0; i < record->size; i++ ) {
+		fprintf(f, " %04X", (unsigned)ir_trace_file_pronto_count(elem[i].time_us, unit));
+	}
+	if( (record->size & 1) != 0 ) {
+		fprintf(f, " %04X", (unsigned)ir_trace_file_pronto_count(IR_TRACE_FILE_GAP_USEC, unit));
+	}
+	fputc('\n', f);
+	return STATUS_OK;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file ir_trace_file.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The trace files of the host tools: binary traces mapped in memory, raw timing text, and Pronto hex.
+ * @details A binary trace is read in place with embx_ir_trace_reader_t, the pages are mapped read only and read
+ * ahead sequentially, so a corpus of any size is a single streaming pass.
+ *
+ * A raw timing line is the durations in usec of one frame starting with a MARK, separated by spaces or commas.
+ * A duration may be signed, + for a MARK and - for a SPACE, as exported by IRremote and IrScrutinizer, otherwise
+ * they alternate.  The line may start with @usec, the timestamp of the frame.  A '#' starts a comment.
+ *
+ * A Pronto hex line is the learned format 0000, the carrier word, the pairs of the once and the repeat sequences,
+ * then the pairs in carrier periods.
+ */
+#ifndef IR_TRACE_FILE_H_
+#define IR_TRACE_FILE_H_
+
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+#include "embx/embx_ir/embx_ir_trace.h"
+
+/** The carrier frequency of a frame whose frequency is unknown */
+#define IR_TRACE_FILE_CARRIER_HZ		(38000)
+/** The SPACE that ends a Pronto sequence when the capture ends with a MARK */
+#define IR_TRACE_FILE_GAP_USEC			(40000)
+
+/** @brief A file mapped in memory */
+typedef struct {
+	const uint8_t *data;
+	size_t len;
+} ir_trace_file_map_t;
+
+/**
+* @brief Maps a file read only.
+* @returns false if it cannot be opened, the error is printed.
+*/
+extern bool ir_trace_file_map(const char *path, ir_trace_file_map_t *map);
+
+extern void ir_trace_file_unmap(ir_trace_file_map_t *map);
+
+/** @brief Returns true if the data starts like a binary trace */
+extern bool ir_trace_file_is_binary(const uint8_t *data, size_t len);
+
+/**
+* @brief Parses a raw timing line, the line is modified.
+* @params elem, max - receives the intervals.
+* @params record - receives the size, and the timestamp if the line has one.
+* @returns STATUS_OK, STATUS_NO_CHANGE if the line has no intervals, STATUS_ERR_OVERFLOW if it has more than max,
+*          or STATUS_ERR_BAD_FORMAT.
+*/
+extern enum status_code ir_trace_file_parse_raw(char *line, embx_ir_rx_buf_elem_t *elem, uint16_t max,
+												embx_ir_trace_record_t *record, bool *has_timestamp);
+
+/**
+* @brief Parses a Pronto hex line, the once sequence followed by the repeat sequence.  The SPACE that ends the frame
+* is not an interval of the capture, the Rx PHY merges it with the idle line.
+* @returns as ir_trace_file_parse_raw, the carrier frequency is set in the record.
+*/
+extern enum status_code ir_trace_file_parse_pronto(char *line, embx_ir_rx_buf_elem_t *elem, uint16_t max,
+												   embx_ir_trace_record_t *record);
+
+/**
+* @brief Prints a raw timing line.
+* @params timestamp, sign - prefix the timestamp, and sign the durations.
+*/
+extern void ir_trace_file_print_raw(FILE *f, const embx_ir_trace_record_t *record, const embx_ir_rx_buf_elem_t *elem,
+									bool timestamp, bool sign);
+
+/**
+* @brief Prints a Pronto hex line with the carrier frequency of the record, IR_TRACE_FILE_CARRIER_HZ if it is unknown.
+* @returns STATUS_OK or STATUS_ERR_BAD_DATA if the capture does not alternate from a MARK.
+*/
+extern enum status_code ir_trace_file_print_pronto(FILE *f, const embx_ir_trace_record_t *record, const embx_ir_rx_buf_elem_t *elem);
+
+#endif /* IR_TRACE_FILE_H_ */
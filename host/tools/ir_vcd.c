@@ -0,0 +1,127 @@
+/**
+ * @file ir_vcd.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Writes Value Change Dump files, see ir_vcd.h.
+ */
+#include "ir_vcd.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** The identifier of a signal is a printable character from '!' */
+#define IR_VCD_ID(signal)			((char)('!' + (signal)))
+/** The stdio buffer of a file, a change is a few bytes */
+#define IR_VCD_BUF_SZ				(1 << 16)
+
+/**
+* @brief Writes the value of a signal.
+*/
+static void ir_vcd_value(ir_vcd_t *vcd, uint8_t signal)
+{
+	char bits[33];
+	uint8_t width = vcd->signal[signal].width, i;
+
+	if( width == 1 ) {
+		fprintf(vcd->f, "%c%c\n", (vcd->signal[signal].value != 0) ? '1' : '0', IR_VCD_ID(signal));
+		return;
+	}
+	for( i = 0; i < width; i++ ) {
+		bits[i] = ((vcd->signal[signal].value >> (width - 1 - i)) & 1) ? '1' : '0';
+	}
+	bits[width] = '\0';
+	fprintf(vcd->f, "b%s %c\n", bits, IR_VCD_ID(signal));
+}
+
+/**
+* @brief Closes the definitions and dumps the initial values at time 0.
+*/
+static void ir_vcd_start(ir_vcd_t *vcd)
+{
+	uint8_t i;
+
+	fprintf(vcd->f, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+	for( i = 0; i < vcd->n; i++ ) {
+		ir_vcd_value(vcd, i);
+	}
+	fprintf(vcd->f, "$end\n");
+	vcd->time = 0;
+	vcd->started = true;
+}
+
+bool ir_vcd_open(ir_vcd_t *vcd, const char *path, const char *timescale, const char *scope)
+{
+	memset(vcd, 0, sizeof(*vcd));
+	vcd->f = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+	if( vcd->f == NULL ) {
+		perror(path);
+		return false;
+	}
+	setvbuf(vcd->f, NULL, _IOFBF, IR_VCD_BUF_SZ);
+	fprintf(vcd->f, "$version embx ir host tools $end\n$timescale %s $end\n$scope module %s $end\n", timescale, scope);
+	return true;
+}
+
+void ir_vcd_comment(ir_vcd_t *vcd, const char *text)
+{
+	if( vcd->started == false ) {
+		fprintf(vcd->f, "$comment %s $end\n", text);
+	}
+}
+
+uint8_t ir_vcd_add(ir_vcd_t *vcd, const char *name, uint8_t width, uint32_t initial)
+{
+	uint8_t signal = vcd->n;
+
+	if( (vcd->started == true) || (signal == IR_VCD_MAX_SIGNALS) || (width == 0) || (width > 32) ) {
+		return IR_VCD_MAX_SIGNALS;
+	}
+	vcd->signal[signal].width = width;
+	vcd->signal[signal].value = initial;
+	vcd->n++;
+	fprintf(vcd->f, "$var %s %u %c %s $end\n", (width == 1) ? "wire" : "reg", width, IR_VCD_ID(signal), name);
+	return signal;
+}
+
+void ir_vcd_change(ir_vcd_t *vcd, uint8_t signal, uint64_t time, uint32_t value)
+{
+	if( signal >= vcd->n ) {
+		return;
+	}
+	if( vcd->started == false ) {
+		ir_vcd_start(vcd);
+	}
+	if( vcd->signal[signal].value == value ) {
+		return;
+	}
+	if( time > vcd->time ) {
+		fprintf(vcd->f, "#%llu\n", (unsigned long long)time);
+		vcd->time = time;
+	}
+	vcd->signal[signal].value = value;
+	ir_vcd_value(vcd, signal);
+}
+
+bool ir_vcd_close(ir_vcd_t *vcd, uint64_t time)
+{
+	bool ok;
+
+	if( vcd->started == false ) {
+		ir_vcd_start(vcd);
+	}
+	if( time > vcd->time ) {
+		fprintf(vcd->f, "#%llu\n", (unsigned long long)time);
+	}
+	ok = (ferror(vcd->f) == 0);
+	if( vcd->f == stdout ) {
+		ok = (fflush(vcd->f) == 0) && ok;
+	} else {
+		ok = (fclose(vcd->f) == 0) && ok;
+	}
+	if( ok == false ) {
+		perror("vcd");
+	}
+	vcd->f = NULL;
+	return ok;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file ir_vcd.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Writes Value Change Dump files, the waveform format of IEEE 1364 read by GTKWave, PulseView, and the others.
+ * @details The file is streamed: the definitions are written as the signals are added, and each change is written
+ * when it is made, so a trace of any length is exported with the memory of the signals only.  A change that does not
+ * change the value is not written, and the time never goes back, an earlier change is written at the time of the last.
+ *
+ * The signals of the host tools, see ir_vcd_sim.h and ir_trace to-vcd:
+ *   tx_gate   - high while the Tx PHY sends a MARK, the debug pin of the Tx PHY
+ *   carrier   - the modulated output of the emitter
+ *   rx_input  - the EIC pin of the Rx PHY, the output of the IR receiver is low during a MARK
+ *   rx_state  - the state of the Rx PHY state machine, see embx_ir_rx_phy_state_t
+ */
+#ifndef IR_VCD_H_
+#define IR_VCD_H_
+
+#include "embx/embx_hal/embx_hal.h"
+#include <stdio.h>
+
+/** The most signals of a file */
+#define IR_VCD_MAX_SIGNALS			(8)
+/** The time unit of the files of the host tools */
+#define IR_VCD_TIMESCALE			"1ns"
+
+/** @brief A file being written */
+typedef struct {
+	FILE *f;
+	uint64_t time; /** The time of the last change written */
+	bool started; /** The definitions are closed and the initial values written */
+	uint8_t n;
+	struct {
+		uint8_t width;
+		uint32_t value;
+	} signal[IR_VCD_MAX_SIGNALS];
+} ir_vcd_t;
+
+/**
+* @brief Creates a file and writes the header, "-" writes to stdout.
+* @params timescale - the time unit of the changes, e.g. IR_VCD_TIMESCALE.
+* @params scope - the module that holds the signals.
+* @returns false if it cannot be created, the error is printed.
+*/
+extern bool ir_vcd_open(ir_vcd_t *vcd, const char *path, const char *timescale, const char *scope);
+
+/**
+* @brief Writes a comment into the definitions, e.g. the names of the values of a state.
+*/
+extern void ir_vcd_comment(ir_vcd_t *vcd, const char *text);
+
+/**
+* @brief Adds a signal of width bits, 1 is a wire and more a vector.  Call before the first change.
+* @returns the signal, or IR_VCD_MAX_SIGNALS if there are too many or the changes have started.
+*/
+extern uint8_t ir_vcd_add(ir_vcd_t *vcd, const char *name, uint8_t width, uint32_t initial);
+
+/**
+* @brief Changes the value of a signal at a time, in units of the timescale.
+*/
+extern void ir_vcd_change(ir_vcd_t *vcd, uint8_t signal, uint64_t time, uint32_t value);
+
+/**
+* @brief Writes the end time and closes the file.
+* @returns false if a write failed, the error is printed.
+*/
+extern bool ir_vcd_close(ir_vcd_t *vcd, uint64_t time);
+
+#endif /* IR_VCD_H_ */
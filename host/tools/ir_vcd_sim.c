@@ -0,0 +1,55 @@
+/**
+ * @file ir_vcd_sim.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Follows the PHYs running on the host backend of the HAL into a VCD file, see ir_vcd_sim.h.
+ */
+#include "ir_vcd_sim.h"
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_digital_io/digital_output.h"
+#include "embx/embx_ir/embx_ir_tx_modulator.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_gpio.h"
+
+/** The ns per GCLK tick */
+#define IR_VCD_SIM_NS_PER_TICK		(1000000000UL / EMBX_HAL_HOST_GCLK_HZ)
+
+static ir_vcd_t vcd;
+static uint8_t tx_gate = IR_VCD_MAX_SIGNALS, carrier = IR_VCD_MAX_SIGNALS, rx_input, rx_state;
+
+/**
+* @brief Samples the pins and the state, only the changes are written.
+*/
+static void ir_vcd_sim_sample(void)
+{
+	uint64_t time = embx_hal_host_get_time() * IR_VCD_SIM_NS_PER_TICK;
+
+	ir_vcd_change(&vcd, tx_gate, time, embx_hal_host_get_pin(DEBUG_IR_TX_PHY_PIN));
+	ir_vcd_change(&vcd, carrier, time, embx_hal_host_get_pin(TC_IR_MODULATOR_PIN));
+	ir_vcd_change(&vcd, rx_input, time, embx_hal_host_get_pin(EMBX_IR_RX_EIC_PIN));
+	ir_vcd_change(&vcd, rx_state, time, (uint32_t)embx_ir_rx_phy_get_state());
+}
+
+bool ir_vcd_sim_open(const char *path, bool tx)
+{
+	if( ir_vcd_open(&vcd, path, IR_VCD_TIMESCALE, "ir") == false ) {
+		return false;
+	}
+	ir_vcd_comment(&vcd, "rx_state 0 SYNCHRONIZE, 1 IDLE, 2 MARKING, 3 SPACING");
+	if( tx == true ) {
+		tx_gate = ir_vcd_add(&vcd, "tx_gate", 1, embx_hal_host_get_pin(DEBUG_IR_TX_PHY_PIN));
+		carrier = ir_vcd_add(&vcd, "carrier", 1, embx_hal_host_get_pin(TC_IR_MODULATOR_PIN));
+	}
+	rx_input = ir_vcd_add(&vcd, "rx_input", 1, embx_hal_host_get_pin(EMBX_IR_RX_EIC_PIN));
+	rx_state = ir_vcd_add(&vcd, "rx_state", 2, (uint32_t)embx_ir_rx_phy_get_state());
+	embx_hal_host_set_probe(ir_vcd_sim_sample);
+	return true;
+}
+
+bool ir_vcd_sim_close(void)
+{
+	embx_hal_host_set_probe(NULL);
+	return ir_vcd_close(&vcd, embx_hal_host_get_time() * IR_VCD_SIM_NS_PER_TICK);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file ir_vcd_sim.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Follows the PHYs running on the host backend of the HAL into a VCD file.
+ * @details The pins and the state of the Rx PHY are sampled by the probe of the backend, after every interrupt, every
+ * edge of the carrier, and every change of the EIC pin, so the changes are at the GCLK tick they happen, see
+ * embx_hal_host_set_probe.  The time unit is IR_VCD_TIMESCALE.
+ */
+#ifndef IR_VCD_SIM_H_
+#define IR_VCD_SIM_H_
+
+#include "ir_vcd.h"
+
+/**
+* @brief Creates the file and starts to follow the PHYs, call after embx_hal_host_reset.
+* @params tx - follow tx_gate and carrier too, the Tx PHY is linked and initialized.
+* @returns false if the file cannot be created.
+*/
+extern bool ir_vcd_sim_open(const char *path, bool tx);
+
+/**
+* @brief Stops following the PHYs and closes the file at the current time.
+* @returns false if a write failed.
+*/
+extern bool ir_vcd_sim_close(void);
+
+#endif /* IR_VCD_SIM_H_ */
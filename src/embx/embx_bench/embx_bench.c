@@ -0,0 +1,569 @@
+/**
+ * @file embx_bench.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_bench module measures the decoders and the encoders of the protocol layer.
+ * @details A case has a prepare function that is not timed, e.g. it reads the capture of a frame from the corpus,
+ * and a run function that is timed.  The encoders are timed until the descriptor queue has been drained, i.e.
+ * including the refills of the stream that the IR Tx PHY interrupt makes during a transmission.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <stdlib.h>
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_analyzer.h"
+#include "embx/embx_ir/embx_ir_trace.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+#include "embx/embx_bench/embx_bench.h"
+
+/** The protocols of the synthetic corpus */
+#define EMBX_BENCH_NEC				(0)
+#define EMBX_BENCH_SIRC				(1)
+#define EMBX_BENCH_RC5				(2)
+#define EMBX_BENCH_MITSUBISHI		(3)
+#define EMBX_BENCH_PROTOCOLS		(4)
+/** The corpus takes about 2 bytes per interval, 900 bytes for a frame of each protocol */
+#define EMBX_BENCH_CORPUS_SZ		(EMBX_BENCH_HEADER_SZ + (EMBX_BENCH_FRAMES * 1024))
+#define EMBX_BENCH_HEADER_SZ		(EMBX_IR_TRACE_HEADER_SZ)
+/** The timer is read this many times to find the time it takes */
+#define EMBX_BENCH_OVERHEAD_READS	(8)
+#define EMBX_BENCH_STACK_PATTERN	(0xA5)
+
+/**
+* @brief A case, prepare is not timed, run is timed.  p is the protocol and n the frame.
+*/
+typedef struct {
+	const char *name;
+	void (*prepare)(uint8_t p, uint16_t n);
+	enum status_code (*run)(uint8_t p, uint16_t n);
+	uint8_t p;
+} embx_bench_case_t;
+
+static const embx_ir_protocol_t embx_bench_nec = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 560,
+	.header_mark_usec = 9000,
+	.header_space_usec = 4500,
+	.zero_mark_usec = 560,
+	.zero_space_usec = 560,
+	.one_mark_usec = 560,
+	.one_space_usec = 1690,
+	.trailer_mark_usec = 560,
+	.gap_usec = 40000,
+	.nbits = 32,
+};
+
+static const embx_ir_protocol_t embx_bench_sirc = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 600,
+	.header_mark_usec = 2400,
+	.header_space_usec = 600,
+	.zero_mark_usec = 600,
+	.zero_space_usec = 600,
+	.one_mark_usec = 1200,
+	.one_space_usec = 600,
+	.gap_usec = 45000,
+	.nbits = 12,
+};
+
+static const embx_ir_protocol_t embx_bench_rc5 = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER,
+	.bit_order = EMBX_IR_BIG_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 889,
+	.gap_usec = 89000,
+	.nbits = 14,
+};
+
+static const embx_ir_protocol_t *const embx_bench_protocols[EMBX_BENCH_PROTOCOLS] = {
+	&embx_bench_nec, &embx_bench_sirc, &embx_bench_rc5, &embx_split_unit_mitsubishi_protocol,
+};
+
+volatile uint32_t embx_bench_allocs;
+
+static uint8_t embx_bench_corpus[EMBX_BENCH_CORPUS_SZ];
+static size_t embx_bench_corpus_len;
+static size_t embx_bench_offset[EMBX_BENCH_PROTOCOLS][EMBX_BENCH_FRAMES]; /** The record of each frame in the corpus */
+static embx_ir_protocol_frame_t embx_bench_frames[EMBX_BENCH_PROTOCOLS][EMBX_BENCH_FRAMES];
+static embx_split_unit_state_t embx_bench_states[EMBX_BENCH_FRAMES];
+static uint32_t embx_bench_seed = 1;
+
+/** The work area of the cases */
+static embx_ir_rx_buf_elem_t embx_bench_elem[EMBX_BENCH_MAX_INTERVALS];
+static const embx_ir_rx_buf_elem_t *embx_bench_cur_elem;
+static uint16_t embx_bench_cur_size;
+static const embx_ir_protocol_t *embx_bench_cur_protocol;
+static embx_ir_protocol_frame_t embx_bench_frame;
+static embx_ir_protocol_stream_t embx_bench_stream;
+static embx_ir_analyzer_t embx_bench_analyzer;
+static embx_split_unit_state_t embx_bench_state;
+
+/** The captures of embx_bench_run_captures */
+static const embx_ir_rx_buf_elem_t *const *embx_bench_captures;
+static const uint16_t *embx_bench_capture_size;
+
+static volatile uintptr_t embx_bench_stack; /** The address of the painted stack */
+
+/**
+* @brief Returns a pseudo random number, the corpus is the same on every run.
+*/
+static uint32_t embx_bench_random(void)
+{
+	embx_bench_seed = (embx_bench_seed * 1664525UL) + 1013904223UL;
+	return embx_bench_seed >> 8;
+}
+
+/**
+* @brief Plays the descriptor queue back as an IR Tx PHY interrupt would, the intervals are stored in elem if it is not NULL.
+* @returns the number of intervals.
+*/
+static uint16_t embx_bench_drain(embx_ir_rx_buf_elem_t *elem, uint16_t max)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	embx_ir_rx_gpio_state_t state;
+	enum status_code status;
+	uint16_t size = 0;
+
+	while( (status = embx_ir_tx_phy_descriptor_next(&pd)) != STATUS_ERR_BAD_DATA ) {
+		if( status != STATUS_OK ) {
+			continue; /** Another period of the same descriptor */
+		}
+		state = (pd->phy_interval_type == mark) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE;
+		if( (size != 0) && ((elem == NULL) || (elem[size - 1].gpio_state == state)) ) {
+			if( elem != NULL ) {
+				elem[size - 1].time_us += pd->usec;
+			} else {
+				size++;
+			}
+		} else if( size < max ) {
+			if( elem != NULL ) {
+				elem[size].gpio_state = state;
+				elem[size].time_us = pd->usec;
+			}
+			size++;
+		}
+	}
+	return size;
+}
+
+/**
+* @brief Encodes a frame, captures it with jitter, and appends it to the corpus.
+*/
+static enum status_code embx_bench_add(embx_ir_trace_writer_t *writer, uint8_t p, uint16_t n)
+{
+	embx_ir_trace_record_t record = { 0 };
+	enum status_code status;
+	uint16_t size, i;
+	int32_t usec;
+	size_t len;
+
+	if( p == EMBX_BENCH_MITSUBISHI ) {
+		status = embx_split_unit_encode(&embx_split_unit_mitsubishi_codec, &embx_bench_states[n], &embx_bench_stream);
+	} else {
+		status = embx_ir_protocol_stream_start(&embx_bench_stream, embx_bench_protocols[p], &embx_bench_frames[p][n]);
+	}
+	if( status != STATUS_OK ) {
+		return status;
+	}
+	size = embx_bench_drain(embx_bench_elem, EMBX_BENCH_MAX_INTERVALS);
+	if( embx_bench_elem[size - 1].gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE ) {
+		size--; /** The Rx PHY merges the last SPACE with the idle line */
+	}
+	for( i = 0; i < size; i++ ) {
+		usec = (int32_t)embx_bench_elem[i].time_us + (int32_t)(embx_bench_random() % ((2 * EMBX_BENCH_JITTER_USEC) + 1)) - EMBX_BENCH_JITTER_USEC;
+		embx_bench_elem[i].time_us = (usec > 0) ? (uint32_t)usec : 1;
+	}
+
+	record.status = STATUS_OK;
+	record.quality = EMBX_IR_TRACE_QUALITY_UNKNOWN;
+	embx_bench_offset[p][n] = embx_bench_corpus_len;
+	status = embx_ir_trace_write(writer, &record, embx_bench_elem, size, &embx_bench_corpus[embx_bench_corpus_len],
+								 EMBX_BENCH_CORPUS_SZ - embx_bench_corpus_len, &len);
+	embx_bench_corpus_len += (status == STATUS_OK) ? len : 0;
+	return status;
+}
+
+enum status_code embx_bench_init(void)
+{
+	embx_ir_trace_writer_t writer;
+	enum status_code status;
+	embx_ir_protocol_frame_t *f;
+	embx_split_unit_state_t *s;
+	uint32_t r;
+	uint16_t n;
+	uint8_t p;
+
+	embx_bench_seed = 1;
+	for( n = 0; n < EMBX_BENCH_FRAMES; n++ ) {
+		r = embx_bench_random();
+		f = &embx_bench_frames[EMBX_BENCH_NEC][n]; /** Address and command, each followed by its complement */
+		f->nbits = 32;
+		f->data[0] = (uint8_t)r;
+		f->data[1] = (uint8_t)~r;
+		f->data[2] = (uint8_t)(r >> 8);
+		f->data[3] = (uint8_t)~(r >> 8);
+		f = &embx_bench_frames[EMBX_BENCH_SIRC][n];
+		f->nbits = 12;
+		f->data[0] = (uint8_t)r;
+		f->data[1] = (uint8_t)((r >> 8) & 0x0F);
+		f = &embx_bench_frames[EMBX_BENCH_RC5][n]; /** The start bit is a 1 so the frame starts with a MARK */
+		f->nbits = 14;
+		f->data[0] = (uint8_t)(0x80 | (r >> 12));
+		f->data[1] = (uint8_t)((r >> 4) & 0xFC);
+
+		s = &embx_bench_states[n];
+		s->power = ((r & 1) != 0);
+		s->mode = (embx_split_unit_mode_t)((r >> 1) % (EMBX_SPLIT_UNIT_MODE_FAN + 1));
+		s->setpoint = (uint8_t)(EMBX_SPLIT_UNIT_SETPOINT_MIN + ((r >> 4) % (EMBX_SPLIT_UNIT_SETPOINT_MAX - EMBX_SPLIT_UNIT_SETPOINT_MIN + 1)));
+		s->fan = (uint8_t)((r >> 9) % (EMBX_SPLIT_UNIT_FAN_MAX + 1));
+		s->swing = (uint8_t)((r >> 12) % (EMBX_SPLIT_UNIT_SWING_MAX + 1));
+		s->on_timer_min = 0;
+		s->off_timer_min = (uint16_t)(((r >> 15) & 1) * 120);
+	}
+
+	embx_ir_trace_write_header(&writer, embx_bench_corpus);
+	embx_bench_corpus_len = EMBX_BENCH_HEADER_SZ;
+	for( p = 0; p < EMBX_BENCH_PROTOCOLS; p++ ) {
+		for( n = 0; n < EMBX_BENCH_FRAMES; n++ ) {
+			if( (status = embx_bench_add(&writer, p, n)) != STATUS_OK ) {
+				return status;
+			}
+		}
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Reads the capture of a frame from the corpus.
+*/
+static void embx_bench_prepare_capture(uint8_t p, uint16_t n)
+{
+	embx_ir_trace_reader_t reader;
+	embx_ir_trace_record_t record;
+
+	embx_bench_cur_protocol = embx_bench_protocols[p];
+	embx_bench_cur_elem = embx_bench_elem;
+	embx_bench_cur_size = 0;
+	embx_ir_trace_reader_init(&reader, embx_bench_corpus, embx_bench_corpus_len);
+	reader.offset = embx_bench_offset[p][n];
+	if( (embx_ir_trace_read(&reader, &record) == STATUS_OK) &&
+		(embx_ir_trace_get_elems(&record, embx_bench_elem, EMBX_BENCH_MAX_INTERVALS) == STATUS_OK) ) {
+		embx_bench_cur_size = record.size;
+	}
+}
+
+/**
+* @brief Reads the capture and decodes the frame, for the cases that start from a frame.
+*/
+static void embx_bench_prepare_frame(uint8_t p, uint16_t n)
+{
+	uint16_t idx = 0;
+
+	embx_bench_prepare_capture(p, n);
+	embx_ir_protocol_decode(embx_bench_cur_protocol, embx_bench_cur_elem, embx_bench_cur_size, &idx, &embx_bench_frame);
+}
+
+static void embx_bench_prepare_none(uint8_t p, uint16_t n)
+{
+}
+
+static enum status_code embx_bench_run_decode(uint8_t p, uint16_t n)
+{
+	uint16_t idx = 0;
+
+	return embx_ir_protocol_decode(embx_bench_cur_protocol, embx_bench_cur_elem, embx_bench_cur_size, &idx, &embx_bench_frame);
+}
+
+static enum status_code embx_bench_run_analyze(uint8_t p, uint16_t n)
+{
+	embx_ir_protocol_t protocol;
+
+	embx_ir_analyzer_init(&embx_bench_analyzer);
+	embx_ir_analyzer_add_frame(&embx_bench_analyzer, embx_bench_cur_elem, embx_bench_cur_size);
+	return embx_ir_analyzer_propose(&embx_bench_analyzer, embx_bench_cur_elem, embx_bench_cur_size, &protocol);
+}
+
+static enum status_code embx_bench_run_codec_decode(uint8_t p, uint16_t n)
+{
+	return embx_split_unit_mitsubishi_codec.decode(&embx_bench_frame, &embx_bench_state);
+}
+
+static enum status_code embx_bench_run_encode(uint8_t p, uint16_t n)
+{
+	enum status_code status;
+
+	if( (status = embx_ir_protocol_stream_start(&embx_bench_stream, embx_bench_protocols[p], &embx_bench_frames[p][n])) != STATUS_OK ) {
+		return status;
+	}
+	return (embx_bench_drain(NULL, EMBX_BENCH_MAX_INTERVALS) != 0) ? STATUS_OK : STATUS_ERR_BAD_DATA;
+}
+
+static enum status_code embx_bench_run_codec_encode(uint8_t p, uint16_t n)
+{
+	enum status_code status;
+
+	if( (status = embx_split_unit_encode(&embx_split_unit_mitsubishi_codec, &embx_bench_states[n], &embx_bench_stream)) != STATUS_OK ) {
+		return status;
+	}
+	return (embx_bench_drain(NULL, EMBX_BENCH_MAX_INTERVALS) != 0) ? STATUS_OK : STATUS_ERR_BAD_DATA;
+}
+
+static const embx_bench_case_t embx_bench_cases[] = {
+	{ "decode_nec", embx_bench_prepare_capture, embx_bench_run_decode, EMBX_BENCH_NEC },
+	{ "decode_sirc", embx_bench_prepare_capture, embx_bench_run_decode, EMBX_BENCH_SIRC },
+	{ "decode_rc5", embx_bench_prepare_capture, embx_bench_run_decode, EMBX_BENCH_RC5 },
+	{ "decode_mitsubishi", embx_bench_prepare_capture, embx_bench_run_decode, EMBX_BENCH_MITSUBISHI },
+	{ "codec_decode_mitsubishi", embx_bench_prepare_frame, embx_bench_run_codec_decode, EMBX_BENCH_MITSUBISHI },
+	{ "analyze_nec", embx_bench_prepare_capture, embx_bench_run_analyze, EMBX_BENCH_NEC },
+	{ "analyze_mitsubishi", embx_bench_prepare_capture, embx_bench_run_analyze, EMBX_BENCH_MITSUBISHI },
+	{ "encode_nec", embx_bench_prepare_none, embx_bench_run_encode, EMBX_BENCH_NEC },
+	{ "encode_sirc", embx_bench_prepare_none, embx_bench_run_encode, EMBX_BENCH_SIRC },
+	{ "encode_rc5", embx_bench_prepare_none, embx_bench_run_encode, EMBX_BENCH_RC5 },
+	{ "codec_encode_mitsubishi", embx_bench_prepare_none, embx_bench_run_codec_encode, EMBX_BENCH_MITSUBISHI },
+};
+
+/**
+* @brief Returns the stack pointer of the function it is inlined into.
+*/
+static inline __attribute__((always_inline)) uintptr_t embx_bench_sp(void)
+{
+	uintptr_t sp;
+
+#if defined(__arm__) || defined(__aarch64__)
+	__asm__ volatile ("mov %0, sp" : "=r" (sp));
+#elif defined(__x86_64__)
+	__asm__ volatile ("mov %%rsp, %0" : "=r" (sp));
+#elif defined(__i386__)
+	__asm__ volatile ("mov %%esp, %0" : "=r" (sp));
+#else
+	sp = (uintptr_t)__builtin_frame_address(0); /** Counts the locals of the caller as used */
+#endif
+	return sp;
+}
+
+/**
+* @brief Paints the stack below the stack pointer of the caller, where the frames of the functions it calls go.
+* @details Inlined so that no frame of its own is below the stack pointer.  The writes are volatile so the loop is
+* not turned into a call of memset, whose frame would be painted over.
+*/
+static inline __attribute__((always_inline)) void embx_bench_stack_paint(void)
+{
+	volatile uint8_t *stack = (volatile uint8_t *)(embx_bench_sp() - EMBX_BENCH_STACK_SZ);
+	uint16_t i;
+
+	for( i = 0; i < EMBX_BENCH_STACK_SZ; i++ ) {
+		stack[i] = EMBX_BENCH_STACK_PATTERN;
+	}
+	embx_bench_stack = (uintptr_t)stack;
+}
+
+/**
+* @brief Returns the depth below the stack pointer of the caller that has been written since it was painted.
+* @details Inlined so that its own frame does not write to the painted stack before it is read.
+*/
+static inline __attribute__((always_inline)) uint16_t embx_bench_stack_used(void)
+{
+	const volatile uint8_t *stack = (const volatile uint8_t *)embx_bench_stack;
+	uint16_t i = 0;
+
+	while( (i < EMBX_BENCH_STACK_SZ) && (stack[i] == EMBX_BENCH_STACK_PATTERN) ) {
+		i++;
+	}
+	return (uint16_t)(EMBX_BENCH_STACK_SZ - i);
+}
+
+/**
+* @brief Times the runs of a frame between two reads of the timer.
+* @returns the ticks of the timer, less the time to read it.
+*/
+static uint32_t embx_bench_batch(const embx_bench_timer_t *timer, const embx_bench_case_t *c, uint16_t n, uint32_t batch,
+								 uint32_t overhead, embx_bench_result_t *result)
+{
+	uint32_t t, i;
+
+	t = timer->read();
+	for( i = 0; i < batch; i++ ) {
+		if( c->run(c->p, n) != STATUS_OK ) {
+			result->errors++;
+		}
+	}
+	t = (timer->read() - t) & timer->mask;
+	return (t > overhead) ? (t - overhead) : 0;
+}
+
+/**
+* @brief Returns the time to read the timer.
+*/
+static uint32_t embx_bench_overhead(const embx_bench_timer_t *timer)
+{
+	uint32_t overhead = timer->mask, t;
+	uint8_t i;
+
+	for( i = 0; i < EMBX_BENCH_OVERHEAD_READS; i++ ) {
+		t = timer->read();
+		t = (timer->read() - t) & timer->mask;
+		overhead = (t < overhead) ? t : overhead;
+	}
+	return overhead;
+}
+
+/**
+* @brief Starts the measurement of a case, measures its stack and allocations.
+* @returns the runs of a frame between two reads of the timer, doubled until they last EMBX_BENCH_BATCH_MS.
+*/
+static uint32_t embx_bench_start(const embx_bench_timer_t *timer, const embx_bench_case_t *c, uint32_t overhead,
+								 embx_bench_result_t *result)
+{
+	uint32_t allocs = embx_bench_allocs, batch = 1;
+
+	result->name = c->name;
+	result->frames = 0;
+
+	c->prepare(c->p, 0);
+	embx_bench_stack_paint();
+	c->run(c->p, 0);
+	result->stack_bytes = embx_bench_stack_used();
+
+	while( (embx_bench_batch(timer, c, 0, batch, overhead, result) < ((timer->hz / 1000UL) * EMBX_BENCH_BATCH_MS)) &&
+		   (batch < EMBX_BENCH_MAX_BATCH) ) {
+		batch *= 2;
+	}
+	result->allocs = embx_bench_allocs - allocs;
+	result->errors = 0;
+	return batch;
+}
+
+/**
+* @brief Times a pass of a case over n frames, each frame is run batch times between two reads of the timer.
+* @returns the ticks of the timer.
+*/
+static uint64_t embx_bench_pass(const embx_bench_timer_t *timer, const embx_bench_case_t *c, uint16_t frames,
+								uint32_t batch, uint32_t overhead, embx_bench_result_t *result)
+{
+	uint64_t sum = 0;
+	uint32_t allocs = embx_bench_allocs;
+	uint16_t n;
+
+	for( n = 0; n < frames; n++ ) {
+		c->prepare(c->p, n);
+		sum += embx_bench_batch(timer, c, n, batch, overhead, result);
+		result->frames += batch;
+	}
+	result->allocs += embx_bench_allocs - allocs;
+	return sum;
+}
+
+/**
+* @brief Ends the measurement of a case with its fastest pass.
+*/
+static void embx_bench_end(const embx_bench_timer_t *timer, uint64_t best, uint16_t frames, uint32_t batch,
+						   embx_bench_result_t *result)
+{
+	result->ns_per_frame = (uint32_t)(((best * 1000000000ULL) / timer->hz) / ((uint64_t)frames * batch));
+	result->cycles_per_frame = (timer->cpu_cycles == true) ? (uint32_t)(best / ((uint64_t)frames * batch)) : 0;
+}
+
+uint8_t embx_bench_run(const embx_bench_timer_t *timer, uint32_t rounds, embx_bench_result_t *results, uint8_t max)
+{
+	static uint32_t batch[EMBX_BENCH_MAX_CASES];
+	static uint64_t best[EMBX_BENCH_MAX_CASES];
+	uint32_t overhead = embx_bench_overhead(timer), round;
+	uint64_t t;
+	uint8_t i, n;
+
+	n = (uint8_t)(sizeof(embx_bench_cases) / sizeof(embx_bench_cases[0]));
+	n = (n < max) ? n : max;
+	for( i = 0; i < n; i++ ) {
+		batch[i] = embx_bench_start(timer, &embx_bench_cases[i], overhead, &results[i]);
+		best[i] = UINT64_MAX;
+	}
+	/** The passes of the cases are interleaved, a slow phase of the host slows a pass of every case, not every pass of one */
+	for( round = 0; round < rounds; round++ ) {
+		for( i = 0; i < n; i++ ) {
+			t = embx_bench_pass(timer, &embx_bench_cases[i], EMBX_BENCH_FRAMES, batch[i], overhead, &results[i]);
+			best[i] = (t < best[i]) ? t : best[i]; /** The other passes were disturbed by interrupts or a cold cache */
+		}
+	}
+	for( i = 0; i < n; i++ ) {
+		embx_bench_end(timer, best[i], EMBX_BENCH_FRAMES, batch[i], &results[i]);
+	}
+	return n;
+}
+
+/**
+* @brief Selects a capture of embx_bench_run_captures.
+*/
+static void embx_bench_prepare_recorded(uint8_t p, uint16_t n)
+{
+	embx_bench_cur_elem = embx_bench_captures[n];
+	embx_bench_cur_size = embx_bench_capture_size[n];
+}
+
+enum status_code embx_bench_run_captures(const embx_bench_timer_t *timer, uint32_t rounds, const char *name,
+										 const embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *const *elem,
+										 const uint16_t *size, uint16_t n, embx_bench_result_t *result)
+{
+	const embx_bench_case_t c = { name, embx_bench_prepare_recorded, embx_bench_run_decode, 0 };
+	uint32_t overhead, batch, round;
+	uint64_t t, best = UINT64_MAX;
+
+	if( n == 0 ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	embx_bench_captures = elem;
+	embx_bench_capture_size = size;
+	embx_bench_cur_protocol = protocol;
+	overhead = embx_bench_overhead(timer);
+	batch = embx_bench_start(timer, &c, overhead, result);
+	for( round = 0; round < rounds; round++ ) {
+		t = embx_bench_pass(timer, &c, n, batch, overhead, result);
+		best = (t < best) ? t : best;
+	}
+	embx_bench_end(timer, best, n, batch, result);
+	return STATUS_OK;
+}
+
+#ifdef EMBX_BENCH_WRAP_MALLOC
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t n, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	embx_bench_allocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+	embx_bench_allocs++;
+	return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	embx_bench_allocs++;
+	return __real_realloc(ptr, size);
+}
+#endif
+
+/** @brief Test bench, measures the cases in CPU cycles and stays in a loop. */
+void embx_bench_tb(void)
+{
+	static embx_bench_result_t results[EMBX_BENCH_MAX_CASES];
+	static uint8_t n;
+	embx_bench_timer_t timer = { embx_hal_get_cycles, EMBX_HAL_CYCLES_MASK, 0, true };
+
+	embx_hal_cycles_init();
+	timer.hz = embx_hal_get_cpu_hz();
+	if( embx_bench_init() == STATUS_OK ) {
+		n = embx_bench_run(&timer, 10, results, EMBX_BENCH_MAX_CASES);
+	}
+	(void)n;
+	while(1) ;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file embx_bench.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_bench module measures the decoders and the encoders of the protocol layer.
+ * @details The synthetic corpus holds EMBX_BENCH_FRAMES frames of random data for each protocol: NEC (pulse
+ * distance), SIRC (pulse width), RC5 (Manchester), and the Mitsubishi split unit frame (pulse distance with a
+ * checksum).  The frames are encoded into the IR Tx PHY descriptor queue, played back into rx buffer elements with
+ * up to EMBX_BENCH_JITTER_USEC of jitter, and kept as a binary trace, see embx_ir_trace.h, so the corpus fits the RAM
+ * of the board.  Captures recorded in the field are measured with embx_bench_run_captures.
+ *
+ * Each case is timed with a timer supplied by the caller: the cycle counter of the HAL on the board, see
+ * embx_bench_tb, or a clock of the host.  A frame is run as many times between two reads of the timer as it takes to
+ * last EMBX_BENCH_BATCH_MS, so a case of a few ns is measured well above the resolution of the timer.  The time to
+ * read the timer is subtracted and the fastest pass over the corpus is reported.  The passes of the cases are
+ * interleaved, so a slow phase of the host slows one pass of every case rather than every pass of one case.  The
+ * stack is painted before a case and the depth reached is reported.  The protocol layer does not allocate, the allocations are
+ * counted when the image is linked with --wrap=malloc,--wrap=calloc,--wrap=realloc and EMBX_BENCH_WRAP_MALLOC is
+ * defined.
+ */
+#ifndef EMBX_BENCH_H_
+#define EMBX_BENCH_H_
+
+#include "embx/embx_ir/embx_ir_protocol.h"
+
+/** The frames of each protocol in the synthetic corpus */
+#ifndef EMBX_BENCH_FRAMES
+#define EMBX_BENCH_FRAMES			(4)
+#endif
+/** The most intervals of a frame, a Mitsubishi frame has 291 */
+#define EMBX_BENCH_MAX_INTERVALS	(300)
+/** The most cases reported by embx_bench_run */
+#define EMBX_BENCH_MAX_CASES		(16)
+/** The largest deviation added to a duration of the synthetic corpus */
+#define EMBX_BENCH_JITTER_USEC		(40)
+/** The shortest time in ms between the two reads of the timer around the runs of a frame */
+#define EMBX_BENCH_BATCH_MS			(1)
+/** The most runs of a frame between the two reads of the timer */
+#define EMBX_BENCH_MAX_BATCH		(1UL << 20)
+/** The bytes of stack painted below the stack pointer of the measurement */
+#define EMBX_BENCH_STACK_SZ			(1024)
+
+/**
+* @brief embx_bench_timer_t is the time base of the measurements.
+*/
+typedef struct {
+	uint32_t (*read)(void); /** Returns the count of a free running counter */
+	uint32_t mask; /** The counter wraps at mask + 1 */
+	uint32_t hz; /** The frequency of the counter */
+	bool cpu_cycles; /** The counter counts the cycles of the CPU */
+} embx_bench_timer_t;
+
+/**
+* @brief embx_bench_result_t is the measurement of a case.
+*/
+typedef struct {
+	const char *name;
+	uint32_t frames; /** The frames measured, the frames of the corpus times the runs of a frame times the rounds */
+	uint32_t errors; /** The frames that were not decoded or encoded */
+	uint32_t ns_per_frame; /** The mean of the fastest pass over the corpus */
+	uint32_t cycles_per_frame; /** 0 unless the timer counts the cycles of the CPU */
+	uint16_t stack_bytes; /** The deepest stack used below the caller of the case, including the return address */
+	uint32_t allocs; /** The allocations made by the case */
+} embx_bench_result_t;
+
+/** @brief The allocations counted by the wrappers of malloc, calloc, and realloc */
+extern volatile uint32_t embx_bench_allocs;
+
+/**
+* @brief Builds the synthetic corpus.
+* @returns STATUS_OK or the error of the encoder or the trace writer.
+*/
+extern enum status_code embx_bench_init(void);
+
+/**
+* @brief Measures every case over the synthetic corpus.
+* @params rounds - the number of passes over the corpus, a pass runs each frame for at least EMBX_BENCH_BATCH_MS.
+* @params results, max - receives at most max results.
+* @returns the number of results.
+*/
+extern uint8_t embx_bench_run(const embx_bench_timer_t *timer, uint32_t rounds, embx_bench_result_t *results, uint8_t max);
+
+/**
+* @brief Measures embx_ir_protocol_decode over a set of captures.
+* @params protocol - the protocol of the captures, e.g. proposed by embx_ir_analyzer.
+* @params elem, size, n - the captures.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG if there are no captures.
+*/
+extern enum status_code embx_bench_run_captures(const embx_bench_timer_t *timer, uint32_t rounds, const char *name,
+												const embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *const *elem,
+												const uint16_t *size, uint16_t n, embx_bench_result_t *result);
+
+/** @brief Test bench, measures the cases in CPU cycles and stays in a loop.  Read the results with the debugger. */
+extern void embx_bench_tb(void);
+
+#endif /* EMBX_BENCH_H_ */
@@ -0,0 +1,108 @@
+/**
+ * @file embx_bench_isr.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Measures the CPU cycles of the interrupt handlers of the IR PHYs, see embx_bench_isr.h.
+ * @details The statistics are written by the handlers only, each handler writes its own, so the bookkeeping needs no
+ * critical section.  The readers copy them with the interrupts masked.
+ */
+#include "embx/embx_bench/embx_bench_isr.h"
+
+#ifdef EMBX_BENCH_ISR
+const char *const embx_bench_isr_names[EMBX_BENCH_ISR_N] = { "rx_gpio", "rx_phy", "tx_phy" };
+
+/** The counter is read this many times to find the cost of the harness, the fastest is kept */
+#define EMBX_BENCH_ISR_CALIBRATE_N	(8)
+
+static embx_bench_isr_stats_t embx_bench_isr_stats[EMBX_BENCH_ISR_N];
+static uint32_t embx_bench_isr_overhead;
+static uint32_t embx_bench_isr_cost;
+
+void embx_bench_isr_reset(void)
+{
+	uint8_t h, i;
+
+	embx_hal_enter_critical_section();
+	for( h = 0; h < EMBX_BENCH_ISR_N; h++ ) {
+		embx_bench_isr_stats[h].count = 0;
+		embx_bench_isr_stats[h].min = UINT32_MAX;
+		embx_bench_isr_stats[h].max = 0;
+		embx_bench_isr_stats[h].sum = 0;
+		for( i = 0; i < EMBX_BENCH_ISR_BINS; i++ ) {
+			embx_bench_isr_stats[h].hist[i] = 0;
+		}
+	}
+	embx_hal_leave_critical_section();
+}
+
+void embx_bench_isr_init(void)
+{
+	uint32_t overhead = UINT32_MAX, cost = UINT32_MAX, cycles, start;
+	uint8_t i;
+
+	embx_hal_cycles_init();
+	embx_bench_isr_overhead = 0;
+	embx_hal_enter_critical_section();
+	for( i = 0; i < EMBX_BENCH_ISR_CALIBRATE_N; i++ ) {
+		start = embx_hal_get_cycles();
+		cycles = (embx_hal_get_cycles() - start) & EMBX_HAL_CYCLES_MASK;
+		overhead = (cycles < overhead) ? cycles : overhead;
+	}
+	embx_bench_isr_overhead = overhead;
+	for( i = 0; i < EMBX_BENCH_ISR_CALIBRATE_N; i++ ) { /** An empty handler, as the handlers measure it */
+		start = embx_hal_get_cycles();
+		{
+			EMBX_BENCH_ISR_ENTER();
+			EMBX_BENCH_ISR_EXIT(EMBX_BENCH_ISR_RX_GPIO);
+		}
+		cycles = (embx_hal_get_cycles() - start) & EMBX_HAL_CYCLES_MASK;
+		cost = (cycles < cost) ? cycles : cost;
+	}
+	embx_bench_isr_cost = (cost > overhead) ? (cost - overhead) : 0;
+	embx_hal_leave_critical_section();
+	embx_bench_isr_reset();
+}
+
+void embx_bench_isr_record(embx_bench_isr_handler_t handler, uint32_t cycles)
+{
+	embx_bench_isr_stats_t *stats = &embx_bench_isr_stats[handler];
+	uint32_t bin;
+
+	cycles &= EMBX_HAL_CYCLES_MASK;
+	cycles = (cycles > embx_bench_isr_overhead) ? (cycles - embx_bench_isr_overhead) : 0;
+	stats->count++;
+	stats->sum += cycles;
+	if( cycles < stats->min ) {
+		stats->min = cycles;
+	}
+	if( cycles > stats->max ) {
+		stats->max = cycles;
+	}
+	bin = cycles >> EMBX_BENCH_ISR_BIN_SHIFT;
+	stats->hist[(bin < EMBX_BENCH_ISR_BINS) ? bin : (EMBX_BENCH_ISR_BINS - 1)]++;
+}
+
+void embx_bench_isr_get(embx_bench_isr_handler_t handler, embx_bench_isr_stats_t *stats)
+{
+	embx_hal_enter_critical_section();
+	*stats = embx_bench_isr_stats[handler];
+	embx_hal_leave_critical_section();
+}
+
+uint32_t embx_bench_isr_get_mean(const embx_bench_isr_stats_t *stats)
+{
+	return (stats->count != 0) ? (uint32_t)(stats->sum / stats->count) : 0;
+}
+
+uint32_t embx_bench_isr_get_overhead(void)
+{
+	return embx_bench_isr_overhead;
+}
+
+uint32_t embx_bench_isr_get_cost(void)
+{
+	return embx_bench_isr_cost;
+}
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file embx_bench_isr.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Measures the CPU cycles of the interrupt handlers of the IR PHYs.
+ * @details The Cortex-M0+ has no DWT cycle counter, the handlers read the cycle counter of the HAL, SysTick counting
+ * the CPU clock, on entry and on exit.  Each handler keeps the count, the min, the max, the sum for the mean, and a
+ * histogram of its durations in EMBX_BENCH_ISR_BINS bins of 2^EMBX_BENCH_ISR_BIN_SHIFT cycles, the last bin holds
+ * the longer ones.  The bins are found with a shift, the M0+ has no divider.
+ *
+ * The harness is built when EMBX_BENCH_ISR is defined in the symbols of the compiler, otherwise the macros are empty
+ * and embx_bench_isr.c is empty, it costs nothing.  When it is built:
+ *   - the time to read the counter twice is measured by embx_bench_isr_init and subtracted from every duration,
+ *   - each interrupt takes longer by the two reads and the bookkeeping, see embx_bench_isr_get_cost,
+ *   - an interrupt that preempts a handler is counted in the duration of that handler,
+ *   - the ASF delay routines reprogram SysTick, call embx_bench_isr_init again after embx_hal_delay_ms.
+ * The host backend of the HAL counts the cycles of the modelled time, a handler takes none, host/test/test_bench_isr
+ * tests the bookkeeping with durations of its own.
+ */
+#ifndef EMBX_BENCH_ISR_H_
+#define EMBX_BENCH_ISR_H_
+
+#include "embx/embx_hal/embx_hal.h"
+
+/** The histogram of a handler, 32 bins of 16 cycles, 512 cycles or 10 usec at 48 MHz */
+#define EMBX_BENCH_ISR_BINS			(32)
+#define EMBX_BENCH_ISR_BIN_SHIFT	(4)
+
+/**
+* @brief Enumerates the handlers measured.
+*/
+typedef enum {
+	EMBX_BENCH_ISR_RX_GPIO = 0, /** embx_ir_rx_gpio_callback, an edge of the IR receiver */
+	EMBX_BENCH_ISR_RX_PHY, /** tc_callback_ir_rx_phy, a timeout of the Rx PHY */
+	EMBX_BENCH_ISR_TX_PHY, /** tc_callback_ir_tx_phy, the end of an interval of the Tx PHY */
+	EMBX_BENCH_ISR_N,
+} embx_bench_isr_handler_t;
+
+/**
+* @brief embx_bench_isr_stats_t holds the durations of a handler in CPU cycles.
+*/
+typedef struct {
+	uint32_t count;
+	uint32_t min; /** UINT32_MAX until the first duration */
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[EMBX_BENCH_ISR_BINS];
+} embx_bench_isr_stats_t;
+
+#ifdef EMBX_BENCH_ISR
+extern const char *const embx_bench_isr_names[EMBX_BENCH_ISR_N];
+
+/** @brief Opens and closes the measurement, ENTER is the first statement of the handler and EXIT the last */
+#define EMBX_BENCH_ISR_ENTER()			const uint32_t embx_bench_isr_start = embx_hal_get_cycles()
+#define EMBX_BENCH_ISR_EXIT(handler)	embx_bench_isr_record((handler), embx_hal_get_cycles() - embx_bench_isr_start)
+
+/**
+* @brief Starts the cycle counter, measures the cost of the harness, and clears the statistics.
+*/
+extern void embx_bench_isr_init(void);
+
+/**
+* @brief Clears the statistics of every handler.
+*/
+extern void embx_bench_isr_reset(void);
+
+/**
+* @brief Adds a duration to the statistics of a handler, called by EMBX_BENCH_ISR_EXIT.
+* @params cycles - the difference of the two counts, it is masked with EMBX_HAL_CYCLES_MASK for the wrap of the
+*                  counter and the cost of the two reads is subtracted.
+*/
+extern void embx_bench_isr_record(embx_bench_isr_handler_t handler, uint32_t cycles);
+
+/**
+* @brief Copies the statistics of a handler, the interrupts are masked while they are copied.
+*/
+extern void embx_bench_isr_get(embx_bench_isr_handler_t handler, embx_bench_isr_stats_t *stats);
+
+/**
+* @brief Returns the mean duration in cycles, 0 if there is none.
+*/
+extern uint32_t embx_bench_isr_get_mean(const embx_bench_isr_stats_t *stats);
+
+/**
+* @brief Returns the cycles subtracted from every duration, the two reads of the counter.
+*/
+extern uint32_t embx_bench_isr_get_overhead(void);
+
+/**
+* @brief Returns the cycles the harness adds to an interrupt, the two reads and embx_bench_isr_record.
+*/
+extern uint32_t embx_bench_isr_get_cost(void);
+#else
+#define EMBX_BENCH_ISR_ENTER()			do { } while( 0 )
+#define EMBX_BENCH_ISR_EXIT(handler)	do { } while( 0 )
+#endif
+
+#endif /* EMBX_BENCH_ISR_H_ */
@@ -0,0 +1,134 @@
+/**
+ * @file embx_hal.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The hardware abstraction layer of the embx modules.
+ * @details The embx modules reach the peripherals through these functions only: the critical sections, the TC 
+ * timers, the pins, and the external interrupts.  The board backend in embx_hal_asf.c forwards them to the ASF 
+ * drivers.  The host backend in host/hal/ models the same peripherals so the modules are compiled unchanged on a
+ * workstation, it is selected by defining EMBX_HAL_HOST.  The backend also provides the pin names, e.g. 
+ * PIN_PB09E_TC4_WO1, and enum gclk_generator.
+ *
+ * The TC semantics are those of the SAMD21 with a 16-bit counter counting up:
+ *   - Stop resets the count to 0.  Start resumes a stopped counter from its count and restarts a running one from 0.
+ *   - NORMAL_FREQ counts to 0xFFFF, the CC0 callback is called when the count matches CC0.
+ *   - MATCH_FREQ counts to CC0, the CC0 callback is called when the counter wraps.
+ *   - MATCH_PWM counts to CC0, the overflow callback is called when the counter wraps and sets WO1, the CC1 
+ *     callback when the count matches CC1 and clears WO1.
+ * The modules that drive the TCC, the DMAC, or the EVSYS registers directly, embx_ir_tx_tcc and embx_ir_tx_evsys,
+ * are board only and keep using the ASF.
+ */ 
+#ifndef EMBX_HAL_H_
+#define EMBX_HAL_H_
+
+#ifdef EMBX_HAL_HOST
+#include "embx_hal_host.h"
+#else
+#include <asf.h>
+#endif
+
+/** @brief The TC timers used by the embx modules */
+typedef enum {
+	EMBX_HAL_TC3,
+	EMBX_HAL_TC4,
+	EMBX_HAL_TC5,
+	EMBX_HAL_TC_N,
+} embx_hal_tc_t;
+
+/** @brief The waveform generation modes, see above */
+typedef enum {
+	EMBX_HAL_TC_WAVE_NORMAL_FREQ,
+	EMBX_HAL_TC_WAVE_MATCH_FREQ,
+	EMBX_HAL_TC_WAVE_MATCH_PWM,
+} embx_hal_tc_wave_t;
+
+/** @brief The events of a TC that call a callback */
+typedef enum {
+	EMBX_HAL_TC_CALLBACK_OVERFLOW,
+	EMBX_HAL_TC_CALLBACK_CC0,
+	EMBX_HAL_TC_CALLBACK_CC1,
+	EMBX_HAL_TC_CALLBACK_N,
+} embx_hal_tc_callback_type_t;
+
+/** @brief A TC callback, called from the interrupt of the TC */
+typedef void (*embx_hal_tc_callback_t)(embx_hal_tc_t tc);
+
+/** @brief The configuration of a TC, the counter is 16-bit */
+typedef struct {
+	enum gclk_generator gclk; /** The GCLK that clocks the TC */
+	uint16_t prescaler; /** The GCLK divider: 1, 2, 4, 8, 16, 64, 256, or 1024 */
+	embx_hal_tc_wave_t wave;
+	uint16_t cc[2]; /** The initial compare values, CC0 is the top value in the MATCH modes */
+} embx_hal_tc_config_t;
+
+/** @brief An external interrupt callback, called from the interrupt on both edges of the pin */
+typedef void (*embx_hal_extint_callback_t)(uint8_t channel);
+
+/** @brief Critical sections, they nest */
+extern void embx_hal_enter_critical_section(void);
+extern void embx_hal_leave_critical_section(void);
+
+/** @brief Busy waits, the host backend runs the peripheral model for the time instead */
+extern void embx_hal_delay_ms(uint32_t ms);
+
+/** The cycle counter wraps at EMBX_HAL_CYCLES_MASK + 1, mask the difference of two counts */
+#define EMBX_HAL_CYCLES_MASK		(0x00FFFFFFUL)
+/** 
+* @brief Starts the cycle counter, SysTick counting the CPU clock without its interrupt on the board.
+* @details The ASF delay routines reprogram SysTick, start the counter again after embx_hal_delay_ms.  The host 
+* backend counts the CPU cycles of the modelled time.
+*/
+extern void embx_hal_cycles_init(void);
+extern uint32_t embx_hal_get_cycles(void);
+/** @brief Returns the frequency of the CPU clock */
+extern uint32_t embx_hal_get_cpu_hz(void);
+
+/** @brief Fills in the defaults: GCLK 0, no prescaler, NORMAL_FREQ, compare values 0 */
+extern void embx_hal_tc_get_config_defaults(embx_hal_tc_config_t *config);
+/**
+* @brief Initializes a TC with a configuration, the TC is enabled and its counter stopped.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG if the prescaler is not supported.
+*/
+extern enum status_code embx_hal_tc_init(embx_hal_tc_t tc, const embx_hal_tc_config_t *config);
+/** @brief Enables and disables a TC that has been initialized, and returns it to its reset state */
+extern void embx_hal_tc_enable(embx_hal_tc_t tc);
+extern void embx_hal_tc_disable(embx_hal_tc_t tc);
+extern void embx_hal_tc_reset(embx_hal_tc_t tc);
+/** @brief Starts and stops the counter, see above */
+extern void embx_hal_tc_start(embx_hal_tc_t tc);
+extern void embx_hal_tc_stop(embx_hal_tc_t tc);
+extern uint32_t embx_hal_tc_get_count(embx_hal_tc_t tc);
+extern void embx_hal_tc_set_count(embx_hal_tc_t tc, uint32_t count);
+/** @brief Sets CC0 in the MATCH modes */
+extern void embx_hal_tc_set_top(embx_hal_tc_t tc, uint32_t top);
+extern void embx_hal_tc_set_compare(embx_hal_tc_t tc, uint8_t channel, uint32_t compare);
+/** 
+* @brief Returns true if the count has matched a compare value since the flag was cleared, and clears the flag.
+* @details The flag is the interrupt flag, the callback of a match that is cleared before it is served is not called.
+*/
+extern bool embx_hal_tc_get_match(embx_hal_tc_t tc, uint8_t channel);
+extern void embx_hal_tc_clear_match(embx_hal_tc_t tc, uint8_t channel);
+extern void embx_hal_tc_register_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type, embx_hal_tc_callback_t callback);
+extern void embx_hal_tc_enable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type);
+extern void embx_hal_tc_disable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type);
+
+/** @brief Configures a pin as a GPIO output at a level */
+extern void embx_hal_pin_config_output(uint8_t pin, bool level);
+extern void embx_hal_pin_set_level(uint8_t pin, bool level);
+extern bool embx_hal_pin_get_level(uint8_t pin);
+/** @brief Selects the peripheral function of a pin, the pin stays a GPIO until embx_hal_pin_enable_mux */
+extern void embx_hal_pin_select_mux(uint8_t pin, uint32_t mux);
+/** @brief Gives a pin to its peripheral function or back to the GPIO, fast enough for an interrupt */
+extern void embx_hal_pin_enable_mux(uint8_t pin, bool enable);
+
+/**
+* @brief Configures an external interrupt channel on a pin, with the pull-up, the filter, and detection of both edges.
+* @details The callback is registered but not enabled.  The detection flag is cleared after the callback returns.
+*/
+extern void embx_hal_extint_init(uint8_t channel, uint8_t pin, uint32_t mux, embx_hal_extint_callback_t callback);
+extern void embx_hal_extint_enable_callback(uint8_t channel);
+extern void embx_hal_extint_disable_callback(uint8_t channel);
+
+#endif /* EMBX_HAL_H_ */
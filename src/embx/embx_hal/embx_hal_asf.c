@@ -0,0 +1,300 @@
+/**
+ * @file embx_hal_asf.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The board backend of the hardware abstraction layer, it forwards to the ASF drivers.
+ * @details The ASF callbacks receive the ASF module, they are dispatched to the callbacks of the HAL by a small
+ * function per callback type.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+
+/** @brief The hardware of each HAL TC */
+static Tc *const embx_hal_tc_hw[EMBX_HAL_TC_N] = { TC3, TC4, TC5 };
+
+/** @brief The ASF module of each HAL TC */
+static struct tc_module embx_hal_tc_module[EMBX_HAL_TC_N];
+
+/** @brief The callbacks registered with the HAL */
+static embx_hal_tc_callback_t embx_hal_tc_callback[EMBX_HAL_TC_N][EMBX_HAL_TC_CALLBACK_N];
+static embx_hal_extint_callback_t embx_hal_extint_callback[EIC_NUMBER_OF_INTERRUPTS];
+
+/** @brief The ASF callback type of each HAL callback type */
+static const enum tc_callback embx_hal_tc_callback_asf[EMBX_HAL_TC_CALLBACK_N] = {
+	TC_CALLBACK_OVERFLOW, TC_CALLBACK_CC_CHANNEL0, TC_CALLBACK_CC_CHANNEL1
+};
+
+/** @brief The ASF status flag of the match of each channel */
+static const uint32_t embx_hal_tc_match_flag[2] = { TC_STATUS_CHANNEL_0_MATCH, TC_STATUS_CHANNEL_1_MATCH };
+
+/**
+* @brief Calls the HAL callback of the TC that the ASF module belongs to.
+*/
+static inline void embx_hal_tc_dispatch(struct tc_module *const module, embx_hal_tc_callback_type_t type)
+{
+	embx_hal_tc_t tc = (embx_hal_tc_t)(module - embx_hal_tc_module);
+
+	if( embx_hal_tc_callback[tc][type] != NULL ) {
+		embx_hal_tc_callback[tc][type](tc);
+	}
+}
+
+static void embx_hal_tc_overflow(struct tc_module *const module)
+{
+	embx_hal_tc_dispatch(module, EMBX_HAL_TC_CALLBACK_OVERFLOW);
+}
+
+static void embx_hal_tc_cc0(struct tc_module *const module)
+{
+	embx_hal_tc_dispatch(module, EMBX_HAL_TC_CALLBACK_CC0);
+}
+
+static void embx_hal_tc_cc1(struct tc_module *const module)
+{
+	embx_hal_tc_dispatch(module, EMBX_HAL_TC_CALLBACK_CC1);
+}
+
+/** @brief The ASF callback of each HAL callback type */
+static const tc_callback_t embx_hal_tc_trampoline[EMBX_HAL_TC_CALLBACK_N] = {
+	embx_hal_tc_overflow, embx_hal_tc_cc0, embx_hal_tc_cc1
+};
+
+void embx_hal_enter_critical_section(void)
+{
+	system_interrupt_enter_critical_section();
+}
+
+void embx_hal_leave_critical_section(void)
+{
+	system_interrupt_leave_critical_section();
+}
+
+void embx_hal_delay_ms(uint32_t ms)
+{
+	delay_ms(ms);
+}
+
+void embx_hal_cycles_init(void)
+{
+	SysTick->CTRL = 0;
+	SysTick->LOAD = EMBX_HAL_CYCLES_MASK;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+uint32_t embx_hal_get_cycles(void)
+{
+	return EMBX_HAL_CYCLES_MASK - SysTick->VAL; /** SysTick counts down */
+}
+
+uint32_t embx_hal_get_cpu_hz(void)
+{
+	return system_cpu_clock_get_hz();
+}
+
+void embx_hal_tc_get_config_defaults(embx_hal_tc_config_t *config)
+{
+	config->gclk = GCLK_GENERATOR_0;
+	config->prescaler = 1;
+	config->wave = EMBX_HAL_TC_WAVE_NORMAL_FREQ;
+	config->cc[0] = 0;
+	config->cc[1] = 0;
+}
+
+/**
+* @brief Initializes a TC with a configuration, the TC is enabled and its counter stopped.
+*/
+enum status_code embx_hal_tc_init(embx_hal_tc_t tc, const embx_hal_tc_config_t *config)
+{
+	struct tc_config config_tc;
+
+	tc_get_config_defaults(&config_tc);
+	config_tc.counter_size = TC_COUNTER_SIZE_16BIT;
+	config_tc.clock_source = config->gclk;
+	switch( config->prescaler ) {
+		case 1:		config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV1;	break;
+		case 2:		config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV2;	break;
+		case 4:		config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV4;	break;
+		case 8:		config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV8;	break;
+		case 16:	config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV16;	break;
+		case 64:	config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV64;	break;
+		case 256:	config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV256;	break;
+		case 1024:	config_tc.clock_prescaler = TC_CLOCK_PRESCALER_DIV1024; break;
+		default:
+			return STATUS_ERR_INVALID_ARG;
+	}
+	switch( config->wave ) {
+		case EMBX_HAL_TC_WAVE_MATCH_FREQ:	config_tc.wave_generation = TC_WAVE_GENERATION_MATCH_FREQ;	break;
+		case EMBX_HAL_TC_WAVE_MATCH_PWM:	config_tc.wave_generation = TC_WAVE_GENERATION_MATCH_PWM;	break;
+		default:							config_tc.wave_generation = TC_WAVE_GENERATION_NORMAL_FREQ; break;
+	}
+	config_tc.counter_16_bit.compare_capture_channel[0] = config->cc[0];
+	config_tc.counter_16_bit.compare_capture_channel[1] = config->cc[1];
+
+	tc_init(&embx_hal_tc_module[tc], embx_hal_tc_hw[tc], &config_tc);
+	tc_enable(&embx_hal_tc_module[tc]);
+	tc_stop_counter(&embx_hal_tc_module[tc]);
+	return STATUS_OK;
+}
+
+void embx_hal_tc_enable(embx_hal_tc_t tc)
+{
+	tc_enable(&embx_hal_tc_module[tc]);
+}
+
+void embx_hal_tc_disable(embx_hal_tc_t tc)
+{
+	tc_disable(&embx_hal_tc_module[tc]);
+}
+
+void embx_hal_tc_reset(embx_hal_tc_t tc)
+{
+	tc_reset(&embx_hal_tc_module[tc]);
+}
+
+void embx_hal_tc_start(embx_hal_tc_t tc)
+{
+	tc_start_counter(&embx_hal_tc_module[tc]);
+}
+
+void embx_hal_tc_stop(embx_hal_tc_t tc)
+{
+	tc_stop_counter(&embx_hal_tc_module[tc]);
+}
+
+uint32_t embx_hal_tc_get_count(embx_hal_tc_t tc)
+{
+	return tc_get_count_value(&embx_hal_tc_module[tc]);
+}
+
+void embx_hal_tc_set_count(embx_hal_tc_t tc, uint32_t count)
+{
+	tc_set_count_value(&embx_hal_tc_module[tc], count);
+}
+
+void embx_hal_tc_set_top(embx_hal_tc_t tc, uint32_t top)
+{
+	tc_set_top_value(&embx_hal_tc_module[tc], top);
+}
+
+void embx_hal_tc_set_compare(embx_hal_tc_t tc, uint8_t channel, uint32_t compare)
+{
+	tc_set_compare_value(&embx_hal_tc_module[tc], (enum tc_compare_capture_channel)channel, compare);
+}
+
+bool embx_hal_tc_get_match(embx_hal_tc_t tc, uint8_t channel)
+{
+	bool match = (tc_get_status(&embx_hal_tc_module[tc]) & embx_hal_tc_match_flag[channel]) != 0;
+
+	if( match == true ) {
+		tc_clear_status(&embx_hal_tc_module[tc], embx_hal_tc_match_flag[channel]);
+	}
+	return match;
+}
+
+void embx_hal_tc_clear_match(embx_hal_tc_t tc, uint8_t channel)
+{
+	tc_clear_status(&embx_hal_tc_module[tc], embx_hal_tc_match_flag[channel]);
+}
+
+void embx_hal_tc_register_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type, embx_hal_tc_callback_t callback)
+{
+	embx_hal_tc_callback[tc][type] = callback;
+	tc_register_callback(&embx_hal_tc_module[tc], embx_hal_tc_trampoline[type], embx_hal_tc_callback_asf[type]);
+}
+
+void embx_hal_tc_enable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type)
+{
+	tc_enable_callback(&embx_hal_tc_module[tc], embx_hal_tc_callback_asf[type]);
+}
+
+void embx_hal_tc_disable_callback(embx_hal_tc_t tc, embx_hal_tc_callback_type_t type)
+{
+	tc_disable_callback(&embx_hal_tc_module[tc], embx_hal_tc_callback_asf[type]);
+}
+
+void embx_hal_pin_config_output(uint8_t pin, bool level)
+{
+	struct port_config config_port;
+
+	port_get_config_defaults(&config_port);
+	config_port.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_config(pin, &config_port);
+	port_pin_set_output_level(pin, level);
+}
+
+void embx_hal_pin_set_level(uint8_t pin, bool level)
+{
+	port_pin_set_output_level(pin, level);
+}
+
+bool embx_hal_pin_get_level(uint8_t pin)
+{
+	return port_pin_get_input_level(pin);
+}
+
+/**
+* @brief Selects the peripheral function of a pin, the pin stays a GPIO until embx_hal_pin_enable_mux.
+*/
+void embx_hal_pin_select_mux(uint8_t pin, uint32_t mux)
+{
+	struct system_pinmux_config config_pinmux;
+
+	system_pinmux_get_config_defaults(&config_pinmux);
+	config_pinmux.mux_position = mux;
+	system_pinmux_pin_set_config(pin, &config_pinmux);
+	embx_hal_pin_enable_mux(pin, false);
+}
+
+/**
+* @brief Gives a pin to its peripheral function or back to the GPIO by its PMUXEN bit.
+*/
+void embx_hal_pin_enable_mux(uint8_t pin, bool enable)
+{
+	PortGroup *const port = system_pinmux_get_group_from_gpio_pin(pin);
+
+	port->PINCFG[pin % 32].bit.PMUXEN = enable;
+}
+
+/**
+* @brief Calls the HAL callback of the channel that detected an edge and clears the detection.
+*/
+static void embx_hal_extint_dispatch(void)
+{
+	uint8_t channel = extint_get_current_channel();
+
+	if( embx_hal_extint_callback[channel] != NULL ) {
+		embx_hal_extint_callback[channel](channel);
+	}
+	extint_chan_clear_detected(channel);
+}
+
+/**
+* @brief Configures an external interrupt channel on a pin, with the pull-up, the filter, and detection of both edges.
+*/
+void embx_hal_extint_init(uint8_t channel, uint8_t pin, uint32_t mux, embx_hal_extint_callback_t callback)
+{
+	struct extint_chan_conf config_extint_chan;
+
+	extint_chan_get_config_defaults(&config_extint_chan);
+	config_extint_chan.gpio_pin = pin;
+	config_extint_chan.gpio_pin_mux = mux;
+	config_extint_chan.gpio_pin_pull = EXTINT_PULL_UP;
+	config_extint_chan.detection_criteria = EXTINT_DETECT_BOTH;
+	config_extint_chan.filter_input_signal = true;
+	extint_chan_set_config(channel, &config_extint_chan);
+
+	embx_hal_extint_callback[channel] = callback;
+	extint_register_callback(embx_hal_extint_dispatch, channel, EXTINT_CALLBACK_TYPE_DETECT);
+}
+
+void embx_hal_extint_enable_callback(uint8_t channel)
+{
+	extint_chan_enable_callback(channel, EXTINT_CALLBACK_TYPE_DETECT);
+}
+
+void embx_hal_extint_disable_callback(uint8_t channel)
+{
+	extint_chan_disable_callback(channel, EXTINT_CALLBACK_TYPE_DETECT);
+}
@@ -0,0 +1,373 @@
+/**
+ * @file embx_ir_analyzer.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_analyzer module infers a protocol descriptor from captured IR frames.
+ * @details Durations are assigned to the closest cluster in a single pass.  A duration that is not within
+ * EMBX_IR_ANALYZER_TOLERANCE_PCT of any cluster starts a new one.  When the table is full the duration is merged
+ * into the closest cluster.  Only the cluster sums are kept so any number of frames can be added, on the device or
+ * on a host analyzing a large set of captures.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_analyzer.h"
+
+/**
+* @brief Adds a duration to a cluster.
+* @details The mean that classifies the durations is refreshed when the count reaches a power of 2, with a shift,
+* so no duration costs a divide.  The exact means are computed by embx_ir_analyzer_propose.
+*/
+static void embx_ir_analyzer_cluster_add(embx_ir_analyzer_cluster_t *cluster, uint32_t usec)
+{
+	if( cluster->count == 0 ) {
+		cluster->min_usec = usec;
+		cluster->max_usec = usec;
+	} else if( usec < cluster->min_usec ) {
+		cluster->min_usec = usec;
+	} else if( usec > cluster->max_usec ) {
+		cluster->max_usec = usec;
+	}
+	cluster->sum_usec += usec;
+	cluster->count++;
+	if( (cluster->count & (cluster->count - 1)) == 0 ) {
+		cluster->mean_usec = (uint32_t)(cluster->sum_usec >> __builtin_ctz(cluster->count));
+	}
+}
+
+/**
+* @brief Returns the exact mean of a cluster, 0 if it is empty.
+*/
+static uint32_t embx_ir_analyzer_mean(const embx_ir_analyzer_cluster_t *cluster)
+{
+	return (cluster->count != 0) ? (uint32_t)(cluster->sum_usec / cluster->count) : 0;
+}
+
+/**
+* @brief Assigns a duration to the closest cluster of the table or starts a new cluster.
+*/
+static void embx_ir_analyzer_classify(embx_ir_analyzer_t *analyzer, embx_ir_analyzer_cluster_t *table, uint8_t *n, uint32_t usec)
+{
+	uint8_t k, closest = 0;
+	uint32_t delta, closest_delta = UINT32_MAX;
+
+	for( k = 0; k < *n; k++ ) {
+		delta = (usec > table[k].mean_usec) ? (usec - table[k].mean_usec) : (table[k].mean_usec - usec);
+		if( delta < closest_delta ) {
+			closest_delta = delta;
+			closest = k;
+		}
+	}
+
+	if( (*n > 0) && embx_ir_protocol_match(usec, table[closest].mean_usec, EMBX_IR_ANALYZER_TOLERANCE_PCT) ) {
+		embx_ir_analyzer_cluster_add(&table[closest], usec);
+	} else if( *n < EMBX_IR_ANALYZER_MAX_CLUSTERS ) {
+		embx_ir_analyzer_cluster_add(&table[*n], usec);
+		(*n)++;
+	} else {
+		embx_ir_analyzer_cluster_add(&table[closest], usec);
+		analyzer->merges++;
+	}
+}
+
+/**
+* @brief Resets the analyzer so a new set of frames can be added.
+*/
+void embx_ir_analyzer_init(embx_ir_analyzer_t *analyzer)
+{
+	uint8_t *p = (uint8_t *)analyzer;
+	uint16_t i;
+	for( i = 0; i < sizeof(embx_ir_analyzer_t); i++ ) {
+		p[i] = 0;
+	}
+}
+
+/**
+* @brief Adds the durations of a captured frame to the analyzer.
+* @details A mark is classified when the element that follows it is known.  A mark followed by a data space is a data mark,
+* a mark followed by a gap or by the end of the buffer is a trailer candidate.  The header space of a segment without
+* data, the repeat code of NEC, is left out so it does not pull the header space of the frames towards its own.
+*/
+enum status_code embx_ir_analyzer_add_frame(embx_ir_analyzer_t *analyzer, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	uint16_t i;
+	uint8_t pos = 0; /** 0 - header mark, 1 - header space, 2 - data */
+	uint32_t usec, mark_usec = 0;
+	uint16_t seg_elems = 0;
+	uint32_t seg_usec = 0;
+	uint32_t seg_header_usec = 0;
+	uint32_t header_space_usec = 0;
+	bool end_segment;
+
+	if( (size == 0) || (elem[0].gpio_state != EMBX_IR_RX_GPIO_STATE_MARK) ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+
+	for( i = 0; i <= size; i++ ) {
+		end_segment = false;
+		if( (i == size) || (elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_UNINITIALIZED) ) {
+			end_segment = (pos != 0);
+		} else {
+			usec = elem[i].time_us;
+			if( elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK ) {
+				if( pos == 0 ) {
+					embx_ir_analyzer_cluster_add(&analyzer->header_mark, usec);
+					seg_header_usec = usec;
+					pos = 1;
+				} else {
+					mark_usec = usec;
+				}
+			} else if( pos != 0 ) { /** A SPACE */
+				if( usec >= EMBX_IR_ANALYZER_GAP_USEC ) {
+					embx_ir_analyzer_cluster_add(&analyzer->gap, usec);
+					end_segment = true;
+				} else if( pos == 1 ) {
+					header_space_usec = usec;
+					seg_header_usec += usec;
+					pos = 2;
+				} else if( mark_usec != 0 ) {
+					embx_ir_analyzer_classify(analyzer, analyzer->mark, &analyzer->n_mark, mark_usec);
+					embx_ir_analyzer_classify(analyzer, analyzer->space, &analyzer->n_space, usec);
+					seg_elems += 2;
+					seg_usec += mark_usec + usec;
+					mark_usec = 0;
+				}
+			}
+		}
+
+		if( end_segment == true ) {
+			if( mark_usec != 0 ) {
+				embx_ir_analyzer_cluster_add(&analyzer->trailer_mark, mark_usec);
+				seg_usec += mark_usec;
+				mark_usec = 0;
+			}
+			if( (seg_elems != 0) && (header_space_usec != 0) ) {
+				embx_ir_analyzer_cluster_add(&analyzer->header_space, header_space_usec);
+			}
+			analyzer->segments++;
+			if( seg_elems > analyzer->segment_elems ) {
+				analyzer->segment_elems = seg_elems;
+			}
+			if( seg_usec > analyzer->segment_usec ) {
+				analyzer->segment_usec = seg_usec;
+			}
+			if( (seg_usec + seg_header_usec) > analyzer->segment_total_usec ) {
+				analyzer->segment_total_usec = seg_usec + seg_header_usec;
+			}
+			seg_elems = 0;
+			seg_usec = 0;
+			seg_header_usec = 0;
+			header_space_usec = 0;
+			pos = 0;
+		}
+		if( (i < size) && (elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_UNINITIALIZED) ) {
+			break;
+		}
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Collects the indexes of the clusters that are not noise, ordered by increasing mean.
+* @returns the number of indexes stored in sig.
+*/
+static uint8_t embx_ir_analyzer_significant(const embx_ir_analyzer_cluster_t *table, uint8_t n, uint8_t *sig)
+{
+	uint8_t k, j, m = 0;
+	uint32_t total = 0;
+
+	for( k = 0; k < n; k++ ) {
+		total += table[k].count;
+	}
+	for( k = 0; k < n; k++ ) {
+		if( (table[k].count * EMBX_IR_ANALYZER_NOISE_DIV) >= total ) {
+			for( j = m; (j > 0) && (table[sig[j - 1]].mean_usec > table[k].mean_usec); j-- ) {
+				sig[j] = sig[j - 1];
+			}
+			sig[j] = k;
+			m++;
+		}
+	}
+	return m;
+}
+
+/**
+* @brief Scores a decoded frame by the checksums commonly found in AC protocols.
+* @details The last byte of a frame is often the sum of the bytes before it.  Decoding with the wrong bit order
+* breaks the sum so the bit order with the higher score is the more likely one.
+*/
+static uint8_t embx_ir_analyzer_score(const embx_ir_protocol_frame_t *frame)
+{
+	uint16_t nbytes = frame->nbits >> 3;
+	uint16_t k;
+	uint8_t sum = 0, nibble_sum = 0, score = 0;
+
+	if( nbytes < 2 ) {
+		return 0;
+	}
+	for( k = 0; k < (nbytes - 1); k++ ) {
+		sum += frame->data[k];
+		nibble_sum += (frame->data[k] & 0x0F) + (frame->data[k] >> 4);
+	}
+	if( sum == frame->data[nbytes - 1] ) {
+		score += 2;
+	}
+	if( (nibble_sum & 0x0F) == (frame->data[nbytes - 1] & 0x0F) ) {
+		score += 1;
+	}
+	return score;
+}
+
+/**
+* @brief Infers the bit order by decoding the reference frame in both orders.
+*/
+static uint8_t embx_ir_analyzer_bit_order(embx_ir_protocol_t *protocol, const embx_ir_rx_buf_elem_t *ref_elem, uint16_t ref_size)
+{
+	embx_ir_protocol_frame_t frame;
+	uint16_t idx;
+	uint8_t lsb_score = 0, msb_score = 0;
+
+	if( ref_elem == NULL ) {
+		return EMBX_IR_ENDIANESS;
+	}
+
+	protocol->bit_order = EMBX_IR_LITTLE_ENDIAN;
+	idx = 0;
+	if( embx_ir_protocol_decode(protocol, ref_elem, ref_size, &idx, &frame) == STATUS_OK ) {
+		lsb_score = embx_ir_analyzer_score(&frame);
+	}
+	protocol->bit_order = EMBX_IR_BIG_ENDIAN;
+	idx = 0;
+	if( embx_ir_protocol_decode(protocol, ref_elem, ref_size, &idx, &frame) == STATUS_OK ) {
+		msb_score = embx_ir_analyzer_score(&frame);
+	}
+
+	if( lsb_score > msb_score ) {
+		return EMBX_IR_LITTLE_ENDIAN;
+	} else if( msb_score > lsb_score ) {
+		return EMBX_IR_BIG_ENDIAN;
+	}
+	return EMBX_IR_ENDIANESS;
+}
+
+/**
+* @brief Proposes a protocol descriptor from the frames added so far.
+* @details The encoding follows from the number of significant mark and space clusters:
+*    1 mark, 2 spaces - PULSE_DISTANCE
+*    2 marks, 1 space - PULSE_WIDTH
+*    2 marks, 2 spaces, long = 2 * short - MANCHESTER
+* The base unit is the smallest cluster refined by the weighted average of all the clusters.
+*/
+enum status_code embx_ir_analyzer_propose(const embx_ir_analyzer_t *analyzer,
+										  const embx_ir_rx_buf_elem_t *ref_elem, uint16_t ref_size,
+										  embx_ir_protocol_t *protocol)
+{
+	uint8_t m_sig[EMBX_IR_ANALYZER_MAX_CLUSTERS], s_sig[EMBX_IR_ANALYZER_MAX_CLUSTERS];
+	uint8_t m, s, k;
+	const embx_ir_analyzer_cluster_t *mark_short, *mark_long, *space_short, *space_long;
+	uint32_t mark_short_usec, mark_long_usec, space_short_usec, space_long_usec, header_mark_usec, header_space_usec;
+	uint64_t num = 0;
+	uint32_t u0, den = 0, halves;
+	uint32_t nbits;
+	bool has_header;
+
+	protocol->encoding = EMBX_IR_PROTOCOL_ENCODING_UNKNOWN;
+	protocol->bit_order = EMBX_IR_ENDIANESS;
+	protocol->tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT;
+	protocol->unit_usec = 0;
+	protocol->header_mark_usec = 0;
+	protocol->header_space_usec = 0;
+	protocol->zero_mark_usec = 0;
+	protocol->zero_space_usec = 0;
+	protocol->one_mark_usec = 0;
+	protocol->one_space_usec = 0;
+	protocol->trailer_mark_usec = 0;
+	protocol->gap_usec = embx_ir_analyzer_mean(&analyzer->gap);
+	protocol->nbits = 0;
+	protocol->integrity = NULL;
+	protocol->integrity_n = 0;
+
+	m = embx_ir_analyzer_significant(analyzer->mark, analyzer->n_mark, m_sig);
+	s = embx_ir_analyzer_significant(analyzer->space, analyzer->n_space, s_sig);
+	if( (analyzer->segments == 0) || (m == 0) || (s == 0) ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	mark_short = &analyzer->mark[m_sig[0]];
+	mark_long = &analyzer->mark[m_sig[m - 1]];
+	space_short = &analyzer->space[s_sig[0]];
+	space_long = &analyzer->space[s_sig[s - 1]];
+	/** The exact means, computed once per cluster */
+	mark_short_usec = embx_ir_analyzer_mean(mark_short);
+	mark_long_usec = embx_ir_analyzer_mean(mark_long);
+	space_short_usec = embx_ir_analyzer_mean(space_short);
+	space_long_usec = embx_ir_analyzer_mean(space_long);
+	header_mark_usec = embx_ir_analyzer_mean(&analyzer->header_mark);
+	header_space_usec = embx_ir_analyzer_mean(&analyzer->header_space);
+
+	/** The base unit */
+	u0 = (mark_short_usec < space_short_usec) ? mark_short_usec : space_short_usec;
+	if( u0 == 0 ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	for( k = 0; k < m; k++ ) {
+		num += analyzer->mark[m_sig[k]].sum_usec;
+		den += analyzer->mark[m_sig[k]].count * ((2 * embx_ir_analyzer_mean(&analyzer->mark[m_sig[k]]) + u0) / (2 * u0));
+	}
+	for( k = 0; k < s; k++ ) {
+		num += analyzer->space[s_sig[k]].sum_usec;
+		den += analyzer->space[s_sig[k]].count * ((2 * embx_ir_analyzer_mean(&analyzer->space[s_sig[k]]) + u0) / (2 * u0));
+	}
+	protocol->unit_usec = (uint16_t)(num / den);
+
+	/** The header */
+	has_header = (analyzer->header_mark.count != 0) &&
+				 ((header_mark_usec * 100) >= (EMBX_IR_ANALYZER_HEADER_RATIO * mark_long_usec * (100 - EMBX_IR_ANALYZER_TOLERANCE_PCT)));
+	if( has_header == true ) {
+		protocol->header_mark_usec = (uint16_t)header_mark_usec;
+		protocol->header_space_usec = (uint16_t)header_space_usec;
+	}
+
+	/** The encoding and the number of bits */
+	if( (m == 1) && (s == 2) ) {
+		protocol->encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE;
+		protocol->zero_mark_usec = (uint16_t)mark_short_usec;
+		protocol->one_mark_usec = (uint16_t)mark_short_usec;
+		protocol->zero_space_usec = (uint16_t)space_short_usec;
+		protocol->one_space_usec = (uint16_t)space_long_usec;
+		protocol->trailer_mark_usec = (uint16_t)embx_ir_analyzer_mean(&analyzer->trailer_mark);
+		nbits = (analyzer->segment_elems >> 1) + ((has_header == true) ? 0 : 1);
+	} else if( (m == 2) && (s == 1) ) {
+		protocol->encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH;
+		protocol->zero_mark_usec = (uint16_t)mark_short_usec;
+		protocol->one_mark_usec = (uint16_t)mark_long_usec;
+		protocol->zero_space_usec = (uint16_t)space_short_usec;
+		protocol->one_space_usec = (uint16_t)space_short_usec;
+		/** The last MARK of a PULSE_WIDTH frame is the last data bit */
+		nbits = (analyzer->segment_elems >> 1) + 1 + ((has_header == true) ? 0 : 1);
+	} else if( (m == 2) && (s == 2) &&
+			   embx_ir_protocol_match(mark_long_usec, 2 * mark_short_usec, EMBX_IR_ANALYZER_TOLERANCE_PCT) &&
+			   embx_ir_protocol_match(space_long_usec, 2 * space_short_usec, EMBX_IR_ANALYZER_TOLERANCE_PCT) &&
+			   embx_ir_protocol_match(mark_short_usec, space_short_usec, EMBX_IR_ANALYZER_TOLERANCE_PCT) ) {
+		protocol->encoding = EMBX_IR_PROTOCOL_ENCODING_MANCHESTER;
+		protocol->unit_usec = (uint16_t)((mark_short->sum_usec + space_short->sum_usec) / (mark_short->count + space_short->count));
+		protocol->zero_mark_usec = protocol->unit_usec;
+		protocol->zero_space_usec = protocol->unit_usec;
+		protocol->one_mark_usec = protocol->unit_usec;
+		protocol->one_space_usec = protocol->unit_usec;
+		/** Without a header the first MARK and SPACE are half bits of the longest segment */
+		halves = (has_header == true) ? analyzer->segment_usec : analyzer->segment_total_usec;
+		halves = (2 * halves + protocol->unit_usec) / (2 * protocol->unit_usec);
+		nbits = (halves + 1) >> 1;
+	} else {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	if( nbits > (EMBX_IR_PROTOCOL_MAX_BYTES * 8) ) {
+		nbits = EMBX_IR_PROTOCOL_MAX_BYTES * 8;
+	}
+	protocol->nbits = (uint16_t)nbits;
+
+	protocol->bit_order = embx_ir_analyzer_bit_order(protocol, ref_elem, ref_size);
+
+	return STATUS_OK;
+}
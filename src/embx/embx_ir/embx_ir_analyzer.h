@@ -0,0 +1,82 @@
+/**
+ * @file embx_ir_analyzer.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_analyzer module infers a protocol descriptor from captured IR frames.
+ * @details The durations of the marks and spaces of one or more frames are clustered.  The clusters are used to
+ * propose the base unit, the header, the bit encoding, the number of bits, and the bit order of the protocol.
+ * The analyzer state is a fixed size structure so it runs in bounded memory regardless of the number of frames added.
+ */ 
+#ifndef EMBX_IR_ANALYZER_H_
+#define EMBX_IR_ANALYZER_H_
+
+#include "embx/embx_ir/embx_ir_protocol.h"
+
+/** The maximum number of distinct mark (and space) durations tracked by the analyzer */
+#define EMBX_IR_ANALYZER_MAX_CLUSTERS		(8)
+/** A duration joins a cluster if it is within this percentage of the cluster's mean */
+#define EMBX_IR_ANALYZER_TOLERANCE_PCT		(20)
+/** Spaces longer than this separate two frames of the same transmission */
+#define EMBX_IR_ANALYZER_GAP_USEC			(8000)
+/** A header mark is at least this many times longer than the longest data mark, less EMBX_IR_ANALYZER_TOLERANCE_PCT, e.g. SIRC */
+#define EMBX_IR_ANALYZER_HEADER_RATIO		(2)
+/** A cluster with fewer than 1 / EMBX_IR_ANALYZER_NOISE_DIV of the durations is treated as noise */
+#define EMBX_IR_ANALYZER_NOISE_DIV			(20)
+
+/**
+* @brief A cluster of similar durations.
+*/
+typedef struct {
+	uint64_t sum_usec; /** The sum of the durations, 32 bits wrap after about 70 minutes of durations */
+	uint32_t mean_usec; /** The mean of the first durations, refreshed when count reaches a power of 2, see embx_ir_analyzer_propose for the exact mean */
+	uint32_t count;
+	uint32_t min_usec;
+	uint32_t max_usec;
+} embx_ir_analyzer_cluster_t;
+
+/**
+* @brief embx_ir_analyzer_t accumulates the statistics of the frames added to the analyzer.
+* @details A frame is split into segments by gaps.  The first mark and space of each segment are header candidates,
+* the last mark of each segment is a trailer candidate, and everything in between is data.
+*/
+typedef struct {
+	embx_ir_analyzer_cluster_t mark[EMBX_IR_ANALYZER_MAX_CLUSTERS];
+	embx_ir_analyzer_cluster_t space[EMBX_IR_ANALYZER_MAX_CLUSTERS];
+	uint8_t n_mark;
+	uint8_t n_space;
+	embx_ir_analyzer_cluster_t header_mark;
+	embx_ir_analyzer_cluster_t header_space;
+	embx_ir_analyzer_cluster_t trailer_mark;
+	embx_ir_analyzer_cluster_t gap;
+	uint32_t segments; /** The number of segments added */
+	uint16_t segment_elems; /** The largest number of data elements in a segment */
+	uint32_t segment_usec; /** The largest data duration of a segment in usec */
+	uint32_t segment_total_usec; /** The largest duration of a segment in usec, its header candidates included */
+	uint32_t merges; /** Durations merged into the nearest cluster because the cluster table was full */
+} embx_ir_analyzer_t;
+
+/** @brief Resets the analyzer so a new set of frames can be added. */
+extern void embx_ir_analyzer_init(embx_ir_analyzer_t *analyzer);
+
+/**
+* @brief Adds the durations of a captured frame to the analyzer.
+* @params elem, size - the elements of an IR rx buffer.
+* @returns STATUS_OK or STATUS_ERR_BAD_DATA if the buffer does not start with a MARK.
+*/
+extern enum status_code embx_ir_analyzer_add_frame(embx_ir_analyzer_t *analyzer, const embx_ir_rx_buf_elem_t *elem, uint16_t size);
+
+/**
+* @brief Proposes a protocol descriptor from the frames added so far.
+* @params ref_elem, ref_size - optional frame (may be NULL) that is decoded to infer the bit order.  If the bit order cannot be
+* inferred, EMBX_IR_ENDIANESS is used.
+* @params protocol - receives the proposal.
+* @returns STATUS_OK if an encoding was recognized, STATUS_ERR_BAD_DATA if no frames were added or
+*          STATUS_ERR_BAD_FORMAT if the clusters do not match a known encoding.
+*/
+extern enum status_code embx_ir_analyzer_propose(const embx_ir_analyzer_t *analyzer,
+												 const embx_ir_rx_buf_elem_t *ref_elem, uint16_t ref_size,
+												 embx_ir_protocol_t *protocol);
+
+#endif /* EMBX_IR_ANALYZER_H_ */
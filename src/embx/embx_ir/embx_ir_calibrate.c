@@ -0,0 +1,227 @@
+/**
+ * @file embx_ir_calibrate.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_calibrate module measures the end to end timing of the board with the IR LED looped back to the receiver.
+ * @details The errors are measured against the durations that the IR Tx PHY actually programs, i.e. the pattern
+ * rounded to timer ticks, and the raw ticks of the capture.  So the result does not depend on the corrections in use.
+ * A capture is validated completely before it is added so a rejected capture leaves the statistics unchanged.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_calibrate.h"
+#include "embx/embx_ir/embx_ir_protocol.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+
+/**
+* @brief The calibration pattern in usec, marks at even indices.  The durations cover the range of the common 
+* protocols and each mark is followed by spaces of different lengths.  The final space is not captured, the
+* reception ends with a timeout.
+*/
+static const uint16_t embx_ir_calibrate_pattern[EMBX_IR_CALIBRATE_PATTERN_SZ] = {
+	9000, 4500, 560, 560, 560, 1690, 1200, 600, 600, 1200, 2400, 600, 880, 2640, 4000, 1000, 560
+};
+
+/**
+* @brief Returns the duration in usec that the IR Tx PHY programs for an interval of the pattern.
+*/
+static uint32_t embx_ir_calibrate_sent(uint16_t idx)
+{
+	uint32_t usec = embx_ir_calibrate_pattern[idx];
+	
+	return (EMBX_IR_TX_PHY_PERIOD(usec) + 1UL) * (EMBX_IR_TX_PHY_OVERFLOWS(usec) + 1UL) * EMBX_IR_TX_PHY_USEC_PER_TICK;
+}
+
+/**
+* @brief Returns the error in usec of a received interval, received - sent.
+*/
+static int32_t embx_ir_calibrate_error(const embx_ir_rx_buf_elem_t *elem, uint16_t idx)
+{
+	return (int32_t)(elem->ticks * EMBX_IR_RX_PHY_USEC_PER_TICK) - (int32_t)embx_ir_calibrate_sent(idx);
+}
+
+/**
+* @brief Divides and rounds to the nearest integer, away from 0 on a tie.
+*/
+static int32_t embx_ir_calibrate_div(int32_t num, int32_t den)
+{
+	return (num >= 0) ? ((num + (den / 2)) / den) : -((-num + (den / 2)) / den);
+}
+
+/**
+* @brief Starts a calibration session.
+*/
+void embx_ir_calibrate_init(embx_ir_calibrate_t *cal, uint8_t captures)
+{
+	uint16_t i;
+
+	cal->target = (captures == 0) ? 1 : captures;
+	cal->captures = 0;
+	cal->rejects = 0;
+	cal->waiting = false;
+	cal->tx_latency_usec = 0;
+	cal->rx_stretch_usec = 0;
+	for( i = 0; i < EMBX_IR_CALIBRATE_PATTERN_SZ; i++ ) {
+		cal->error[i].sum = 0;
+		cal->error[i].min = INT32_MAX;
+		cal->error[i].max = INT32_MIN;
+	}
+	embx_ir_tx_phy_descriptor_set_correction(0);
+}
+
+/**
+* @brief Returns the duration in usec of an interval of the calibration pattern.
+*/
+uint32_t embx_ir_calibrate_get_pattern(uint16_t idx)
+{
+	return (idx < EMBX_IR_CALIBRATE_PATTERN_SZ) ? embx_ir_calibrate_pattern[idx] : 0;
+}
+
+/**
+* @brief Compares a capture with the pattern and adds the errors of its intervals to the statistics.
+*/
+enum status_code embx_ir_calibrate_add(embx_ir_calibrate_t *cal, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	int32_t error;
+	uint16_t i;
+
+	if( cal->captures >= cal->target ) {
+		return STATUS_NO_CHANGE;
+	}
+	if( size != EMBX_IR_CALIBRATE_PATTERN_SZ ) {
+		cal->rejects++;
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	for( i = 0; i < size; i++ ) { /** MARKs and SPACEs alternate starting with a MARK, each close to the pattern */
+		if( (elem[i].gpio_state != (((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE)) ||
+			(embx_ir_protocol_match(elem[i].ticks * EMBX_IR_RX_PHY_USEC_PER_TICK, embx_ir_calibrate_sent(i), EMBX_IR_CALIBRATE_TOLERANCE_PCT) == false) ) {
+			cal->rejects++;
+			return STATUS_ERR_BAD_FORMAT;
+		}
+	}
+	for( i = 0; i < size; i++ ) {
+		error = embx_ir_calibrate_error(&elem[i], i);
+		cal->error[i].sum += error;
+		if( error < cal->error[i].min ) {
+			cal->error[i].min = error;
+		}
+		if( error > cal->error[i].max ) {
+			cal->error[i].max = error;
+		}
+	}
+	cal->captures++;
+	return STATUS_OK;
+}
+
+/**
+* @brief Sends the calibration pattern with the IR Tx PHY.
+*/
+static enum status_code embx_ir_calibrate_send(void)
+{
+	enum status_code status;
+	uint16_t i;
+
+	for( i = 0; i < EMBX_IR_CALIBRATE_PATTERN_SZ; i++ ) {
+		status = embx_ir_tx_phy_descriptor_fill(i == 0, ((i & 1) == 0) ? mark : space, embx_ir_calibrate_pattern[i], 0, 0);
+		if( status != STATUS_OK ) {
+			return status;
+		}
+	}
+	return embx_ir_tx_phy_send();
+}
+
+/**
+* @brief Runs the session from the main loop.
+* @details Captures that complete while no pattern is in flight, e.g. from a remote control, are discarded.
+*/
+bool embx_ir_calibrate_poll(embx_ir_calibrate_t *cal)
+{
+	embx_ir_rx_buf_t *buf;
+
+	while( embx_ir_rx_buf_get_full(&buf) == STATUS_OK ) {
+		if( cal->waiting == true ) {
+			cal->waiting = false;
+			if( buf->status == STATUS_OK ) {
+				embx_ir_calibrate_add(cal, buf->elem, buf->size);
+			} else {
+				cal->rejects++;
+			}
+		}
+		embx_ir_rx_buf_release();
+	}
+	if( (embx_ir_calibrate_done(cal) == false) && (cal->waiting == false) && (embx_ir_tx_phy_get_state() == false) ) {
+		cal->waiting = (embx_ir_calibrate_send() == STATUS_OK);
+	}
+	return embx_ir_calibrate_done(cal);
+}
+
+/** @brief Returns true once the session has the requested captures or has given up. */
+bool embx_ir_calibrate_done(const embx_ir_calibrate_t *cal)
+{
+	return (cal->captures >= cal->target) || (cal->rejects >= EMBX_IR_CALIBRATE_MAX_REJECTS);
+}
+
+/**
+* @brief Returns the error statistics of an interval of the pattern.
+*/
+enum status_code embx_ir_calibrate_get_error(const embx_ir_calibrate_t *cal, uint16_t idx, int32_t *mean, int32_t *min, int32_t *max)
+{
+	if( (cal->captures == 0) || (idx >= EMBX_IR_CALIBRATE_PATTERN_SZ) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	*mean = embx_ir_calibrate_div(cal->error[idx].sum, cal->captures);
+	*min = cal->error[idx].min;
+	*max = cal->error[idx].max;
+	return STATUS_OK;
+}
+
+/**
+* @brief Derives the interrupt latency of the IR Tx PHY and the mark stretch of the receiver and applies them.
+* @details With e_mark and e_space the mean errors: latency = (e_mark + e_space) / 2, stretch = (e_mark - e_space) / 2.
+* Both are computed from the sums so the captures are averaged before rounding.
+*/
+enum status_code embx_ir_calibrate_finish(embx_ir_calibrate_t *cal)
+{
+	int32_t mark_sum = 0, space_sum = 0;
+	int32_t marks = 0, spaces = 0;
+	uint16_t i;
+
+	if( cal->captures == 0 ) {
+		return STATUS_ERR_NOT_INITIALIZED;
+	}
+	for( i = 0; i < EMBX_IR_CALIBRATE_PATTERN_SZ; i++ ) {
+		if( (i & 1) == 0 ) {
+			mark_sum += cal->error[i].sum;
+			marks++;
+		} else {
+			space_sum += cal->error[i].sum;
+			spaces++;
+		}
+	}
+	/* e_mark = mark_sum / (marks * captures), e_space = space_sum / (spaces * captures) */
+	mark_sum *= spaces;
+	space_sum *= marks;
+	cal->tx_latency_usec = (int16_t)embx_ir_calibrate_div(mark_sum + space_sum, 2 * marks * spaces * cal->captures);
+	cal->rx_stretch_usec = (int16_t)embx_ir_calibrate_div(mark_sum - space_sum, 2 * marks * spaces * cal->captures);
+
+	embx_ir_tx_phy_descriptor_set_correction(-cal->tx_latency_usec);
+	embx_ir_rx_phy_set_mark_stretch(cal->rx_stretch_usec);
+	return STATUS_OK;
+}
+
+/** @brief Test bench, calibrates with 4 captures and stays in a loop. */
+void embx_ir_calibrate_tb(void)
+{
+	static embx_ir_calibrate_t cal;
+
+	embx_ir_tx_phy_init(KHz_38);
+	embx_ir_rx_phy_init();
+	embx_ir_rx_phy_enable();
+	embx_ir_calibrate_init(&cal, 4);
+	while( embx_ir_calibrate_poll(&cal) == false ) ;
+	embx_ir_calibrate_finish(&cal);
+	while(1) ;
+}
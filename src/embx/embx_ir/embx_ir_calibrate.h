@@ -0,0 +1,97 @@
+/**
+ * @file embx_ir_calibrate.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_calibrate module measures the end to end timing of the board with the IR LED looped back to the receiver.
+ * @details A calibration pattern is sent with embx_ir_tx_phy_send and captured by the IR Rx PHY several times.  The
+ * error of every interval, received - sent, is averaged over the captures.  Two errors are separated:
+ *   - The IR Tx PHY restarts its timer from the interrupt at the start of each interval, so every interval, mark or 
+ *     space, is longer by the interrupt latency.  It is the mean of the mark error and the space error.
+ *   - The receiver stretches a mark by the time it shortens the following space.  It is half the difference of the 
+ *     mark error and the space error.
+ * The latency is removed from the intervals filled into the IR Tx PHY and the stretch from the received durations.
+ */ 
+#ifndef EMBX_IR_CALIBRATE_H_
+#define EMBX_IR_CALIBRATE_H_
+
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+
+/** The number of intervals of the calibration pattern, it starts and ends with a mark */
+#define EMBX_IR_CALIBRATE_PATTERN_SZ		(17)
+/** A capture is rejected if any of its intervals deviates from the pattern by more than this percentage */
+#define EMBX_IR_CALIBRATE_TOLERANCE_PCT		(25)
+/** The session gives up after this many rejected captures */
+#define EMBX_IR_CALIBRATE_MAX_REJECTS		(8)
+
+/**
+* @brief The error statistics of one interval of the pattern, received - sent in usec.
+*/
+typedef struct {
+	int32_t sum;
+	int32_t min;
+	int32_t max;
+} embx_ir_calibrate_error_t;
+
+/**
+* @brief embx_ir_calibrate_t holds the state of a calibration session.
+*/
+typedef struct {
+	uint8_t target; /** The number of captures to average */
+	uint8_t captures; /** The number of captures accepted */
+	uint32_t rejects; /** Captures that did not match the pattern */
+	bool waiting; /** A pattern has been sent and its capture has not been received yet */
+	int16_t tx_latency_usec; /** Set by embx_ir_calibrate_finish */
+	int16_t rx_stretch_usec; /** Set by embx_ir_calibrate_finish */
+	embx_ir_calibrate_error_t error[EMBX_IR_CALIBRATE_PATTERN_SZ];
+} embx_ir_calibrate_t;
+
+/**
+* @brief Starts a calibration session and clears the correction of the IR Tx PHY so that the pattern is sent as programmed.
+* @params captures - the number of captures to average.
+*/
+extern void embx_ir_calibrate_init(embx_ir_calibrate_t *cal, uint8_t captures);
+
+/**
+* @brief Returns the duration in usec of an interval of the calibration pattern, 0 if idx is out of range.
+*/
+extern uint32_t embx_ir_calibrate_get_pattern(uint16_t idx);
+
+/**
+* @brief Compares a capture with the pattern and adds the errors of its intervals to the statistics.
+* @returns STATUS_OK if the capture was accepted, STATUS_ERR_BAD_FORMAT if it does not match the pattern,
+*          STATUS_NO_CHANGE if the session already has enough captures.
+*/
+extern enum status_code embx_ir_calibrate_add(embx_ir_calibrate_t *cal, const embx_ir_rx_buf_elem_t *elem, uint16_t size);
+
+/**
+* @brief Runs the session from the main loop.  Sends the pattern when the IR Tx PHY is idle and adds the capture that
+* the IR Rx PHY completes after it.  The IR Tx PHY and the IR Rx PHY must be initialized and enabled.
+* @details The IR Rx PHY completes a capture after EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE timeouts of space, so each
+* capture takes a few seconds.
+* @returns true once the session is done.
+*/
+extern bool embx_ir_calibrate_poll(embx_ir_calibrate_t *cal);
+
+/** @brief Returns true once the session has the requested captures or has given up. */
+extern bool embx_ir_calibrate_done(const embx_ir_calibrate_t *cal);
+
+/**
+* @brief Returns the error statistics of an interval of the pattern.
+* @params mean, min, max - receive the error in usec, received - sent.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG if idx is out of range or no capture was accepted.
+*/
+extern enum status_code embx_ir_calibrate_get_error(const embx_ir_calibrate_t *cal, uint16_t idx, int32_t *mean, int32_t *min, int32_t *max);
+
+/**
+* @brief Derives the interrupt latency of the IR Tx PHY and the mark stretch of the receiver and applies them
+* with embx_ir_tx_phy_descriptor_set_correction and embx_ir_rx_phy_set_mark_stretch.
+* @returns STATUS_OK or STATUS_ERR_NOT_INITIALIZED if no capture was accepted.
+*/
+extern enum status_code embx_ir_calibrate_finish(embx_ir_calibrate_t *cal);
+
+/** @brief Test bench, calibrates with 4 captures and stays in a loop. */
+extern void embx_ir_calibrate_tb(void);
+
+#endif /* EMBX_IR_CALIBRATE_H_ */
@@ -14,16 +14,19 @@
 #define DEBUG_IR_TX_PHY			(1)
 #define DEBUG_IR_TX_PHY_PIN		PIN_D7
 
-/** GCLK Frequency = 8MHz, Prescaler = 64, Clock ticks, Typical IR Modulation Frequencies listed together with counter periods */
+/** Typical IR Modulation Frequencies in Hz.  Any frequency from EMBX_IR_TX_MODULATOR_MIN_HZ to _MAX_HZ may be used. */
 typedef enum {
-	KHz_30 = 132,
-	KHz_33 = 120,
-	KHz_36 = 110,
-	KHz_38 = 104,
-	KHz_40 = 99,
-	KHz_56 = 70
+	KHz_30 = 30000,
+	KHz_33 = 33000,
+	KHz_36 = 36000,
+	KHz_38 = 38000,
+	KHz_40 = 40000,
+	KHz_56 = 56000
 } embx_ir_tx_mod_freq_t;
 
+/** The number of IR emitters.  Each has its own descriptor queue, channel 0 is the one of the IR Tx PHY. */
+#define EMBX_IR_TX_CHANNELS				(2)
+
 /** The GCLK used to clock the timer counter.  Verify that it is enabled in conf_clocks.h */
 #define EMBX_IR_MODULATOR_GCLK			((enum gclk_generator)GCLK_GENERATOR_3)
 
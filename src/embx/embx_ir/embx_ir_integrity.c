@@ -0,0 +1,208 @@
+/**
+ * @file embx_ir_integrity.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_integrity module validates the checksums and CRCs carried in AC protocol frames.
+ * @details Each check keeps a one byte accumulator.  The accumulator is updated as each covered byte arrives and is
+ * compared against the check byte when the last byte of the check arrives.  Nothing is buffered so the checks cost the
+ * same whether they are run incrementally by a decoder or over a complete frame.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_integrity.h"
+
+/**
+* @brief Reverses the bit order of a byte.
+*/
+static inline uint8_t embx_ir_integrity_reverse(uint8_t b)
+{
+	b = (uint8_t)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+	b = (uint8_t)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+	b = (uint8_t)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+	return b;
+}
+
+/**
+* @brief Updates a CRC-8 with one byte, a bit at a time.
+*/
+static inline uint8_t embx_ir_integrity_crc8(uint8_t crc, uint8_t byte, uint8_t poly, bool reflect)
+{
+	uint8_t bit;
+
+	crc ^= byte;
+	if( reflect == true ) {
+		poly = embx_ir_integrity_reverse(poly);
+		for( bit = 0; bit < 8; bit++ ) {
+			crc = (crc & 0x01) ? (uint8_t)((crc >> 1) ^ poly) : (uint8_t)(crc >> 1);
+		}
+	} else {
+		for( bit = 0; bit < 8; bit++ ) {
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ poly) : (uint8_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/**
+* @brief Adds a covered byte (not the check byte) to the accumulator of a check.
+*/
+static inline uint8_t embx_ir_integrity_accumulate(const embx_ir_integrity_cfg_t *cfg, uint8_t acc, uint8_t byte)
+{
+	switch( cfg->scheme ) {
+		case EMBX_IR_INTEGRITY_BYTE_SUM:
+			acc += byte;
+		break;
+		case EMBX_IR_INTEGRITY_NIBBLE_SUM:
+			acc += (byte & 0x0F) + (byte >> 4);
+		break;
+		case EMBX_IR_INTEGRITY_CRC8:
+			acc = embx_ir_integrity_crc8(acc, byte, cfg->poly, cfg->reflect);
+		break;
+		case EMBX_IR_INTEGRITY_CRC8_TABLE:
+			acc = cfg->crc_table[acc ^ byte];
+		break;
+		default:
+		break;
+	}
+	return acc;
+}
+
+/**
+* @brief Returns the value the check byte must have once all the covered bytes have been accumulated.
+*/
+static inline uint8_t embx_ir_integrity_result(const embx_ir_integrity_cfg_t *cfg, uint8_t acc)
+{
+	if( (cfg->scheme == EMBX_IR_INTEGRITY_CRC8) || (cfg->scheme == EMBX_IR_INTEGRITY_CRC8_TABLE) ) {
+		acc ^= cfg->xor_out;
+	}
+	return acc;
+}
+
+/**
+* @brief Builds the lookup table for a table driven CRC-8.
+* @details table[i] is the CRC of the byte i with a zero register so that a byte update is crc = table[crc ^ byte].
+*/
+void embx_ir_integrity_crc8_table(uint8_t poly, bool reflect, uint8_t *table)
+{
+	uint16_t i;
+	for( i = 0; i < EMBX_IR_INTEGRITY_CRC8_TABLE_SZ; i++ ) {
+		table[i] = embx_ir_integrity_crc8(0, (uint8_t)i, poly, reflect);
+	}
+}
+
+/**
+* @brief Resets the running state of the checks.
+*/
+void embx_ir_integrity_init(embx_ir_integrity_t *integrity, const embx_ir_integrity_cfg_t *cfg, uint8_t n)
+{
+	uint8_t k;
+
+	if( n > EMBX_IR_INTEGRITY_MAX_CHECKS ) {
+		n = EMBX_IR_INTEGRITY_MAX_CHECKS;
+	}
+	integrity->cfg = cfg;
+	integrity->n = n;
+	integrity->idx = 0;
+	integrity->prev = 0;
+	for( k = 0; k < n; k++ ) {
+		integrity->acc[k] = cfg[k].init;
+	}
+}
+
+/**
+* @brief Adds the next byte of the frame to the checks.
+* @details Only the checks that cover the byte are updated.  A check is evaluated when its last byte arrives,
+* an INVERTED_PAIRS check is evaluated at every second byte.
+* @returns STATUS_OK if every check that ends at this byte passed, STATUS_ERR_BAD_DATA if a check failed.
+*/
+enum status_code embx_ir_integrity_update(embx_ir_integrity_t *integrity, uint8_t byte)
+{
+	enum status_code rval = STATUS_OK;
+	const embx_ir_integrity_cfg_t *cfg;
+	uint8_t k, mask, pos = integrity->idx;
+
+	for( k = 0; k < integrity->n; k++ ) {
+		cfg = &integrity->cfg[k];
+		if( (pos < cfg->start) || (pos >= (cfg->start + cfg->length)) ) {
+			continue;
+		}
+		if( cfg->scheme == EMBX_IR_INTEGRITY_INVERTED_PAIRS ) {
+			if( ((pos - cfg->start) & 1) && ((integrity->prev ^ byte) != 0xFF) ) {
+				rval = STATUS_ERR_BAD_DATA;
+			}
+		} else if( pos == (cfg->start + cfg->length - 1) ) { /** The check byte, a NIBBLE_SUM only checks the low nibble */
+			mask = (cfg->scheme == EMBX_IR_INTEGRITY_NIBBLE_SUM) ? 0x0F : 0xFF;
+			if( ((embx_ir_integrity_result(cfg, integrity->acc[k]) ^ byte) & mask) != 0 ) {
+				rval = STATUS_ERR_BAD_DATA;
+			}
+		} else {
+			integrity->acc[k] = embx_ir_integrity_accumulate(cfg, integrity->acc[k], byte);
+		}
+	}
+	integrity->prev = byte;
+	integrity->idx++;
+	return rval;
+}
+
+/**
+* @brief Returns true once every check of the table has been completed.
+*/
+bool embx_ir_integrity_complete(const embx_ir_integrity_t *integrity)
+{
+	uint8_t k;
+	for( k = 0; k < integrity->n; k++ ) {
+		if( integrity->idx < (integrity->cfg[k].start + integrity->cfg[k].length) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @brief Validates a complete frame.
+*/
+enum status_code embx_ir_integrity_check(const embx_ir_integrity_cfg_t *cfg, uint8_t n, const uint8_t *data, uint8_t len)
+{
+	embx_ir_integrity_t integrity;
+	uint8_t i;
+
+	embx_ir_integrity_init(&integrity, cfg, n);
+	for( i = 0; i < len; i++ ) {
+		if( embx_ir_integrity_update(&integrity, data[i]) != STATUS_OK ) {
+			return STATUS_ERR_BAD_DATA;
+		}
+	}
+	return (embx_ir_integrity_complete(&integrity) == true) ? STATUS_OK : STATUS_ERR_BAD_DATA;
+}
+
+/**
+* @brief Computes the check bytes of a frame so that it passes the checks.
+* @details The checks are filled in table order so a check may cover the check byte of an earlier check.
+*/
+void embx_ir_integrity_fill(const embx_ir_integrity_cfg_t *cfg, uint8_t n, uint8_t *data, uint8_t len)
+{
+	uint8_t k, i, last, acc;
+
+	for( k = 0; (k < n) && (k < EMBX_IR_INTEGRITY_MAX_CHECKS); k++ ) {
+		last = cfg[k].start + cfg[k].length - 1;
+		if( (cfg[k].length == 0) || (last >= len) ) {
+			continue;
+		}
+		if( cfg[k].scheme == EMBX_IR_INTEGRITY_INVERTED_PAIRS ) {
+			for( i = cfg[k].start + 1; i <= last; i += 2 ) {
+				data[i] = (uint8_t)~data[i - 1];
+			}
+		} else if( cfg[k].scheme != EMBX_IR_INTEGRITY_NONE ) {
+			acc = cfg[k].init;
+			for( i = cfg[k].start; i < last; i++ ) {
+				acc = embx_ir_integrity_accumulate(&cfg[k], acc, data[i]);
+			}
+			acc = embx_ir_integrity_result(&cfg[k], acc);
+			if( cfg[k].scheme == EMBX_IR_INTEGRITY_NIBBLE_SUM ) {
+				acc = (uint8_t)((data[last] & 0xF0) | (acc & 0x0F));
+			}
+			data[last] = acc;
+		}
+	}
+}
@@ -0,0 +1,97 @@
+/**
+ * @file embx_ir_integrity.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_integrity module validates the checksums and CRCs carried in AC protocol frames.
+ * @details A protocol describes its integrity checks with a table of embx_ir_integrity_cfg_t entries.  Each entry
+ * covers a range of bytes and checks the last byte of the range.  The checks are updated one byte at a time so a
+ * decoder can reject a corrupt frame as soon as the byte that fails a check has been received.
+ */ 
+#ifndef EMBX_IR_INTEGRITY_H_
+#define EMBX_IR_INTEGRITY_H_
+
+/** The number of entries in a CRC-8 lookup table */
+#define EMBX_IR_INTEGRITY_CRC8_TABLE_SZ		(256)
+
+/** The maximum number of checks in a protocol's table, e.g. one sum per section of a multi section frame */
+#define EMBX_IR_INTEGRITY_MAX_CHECKS		(4)
+
+/**
+* @brief Enumerates the integrity schemes.
+*/
+typedef enum {
+	EMBX_IR_INTEGRITY_NONE = 0,
+	EMBX_IR_INTEGRITY_BYTE_SUM, /** The check byte is the sum of the covered bytes plus init */
+	EMBX_IR_INTEGRITY_NIBBLE_SUM, /** The low nibble of the check byte is the sum of the nibbles of the covered bytes plus init */
+	EMBX_IR_INTEGRITY_INVERTED_PAIRS, /** Every second byte is the complement of the byte before it, there is no check byte */
+	EMBX_IR_INTEGRITY_CRC8, /** CRC-8 computed a bit at a time, no table required */
+	EMBX_IR_INTEGRITY_CRC8_TABLE, /** CRC-8 computed a byte at a time from a lookup table */
+} embx_ir_integrity_scheme_t;
+
+/**
+* @brief embx_ir_integrity_cfg_t describes one check.
+* @details The check covers the bytes start to start + length - 1.  For the sum and CRC schemes the last byte of the
+* range is the check byte.  The CRC is computed over the bytes before the check byte, then xor_out is applied.
+*/
+typedef struct {
+	embx_ir_integrity_scheme_t scheme;
+	uint8_t start; /** The index of the first byte covered by the check */
+	uint8_t length; /** The number of bytes covered including the check byte */
+	uint8_t init; /** The initial value of the sum or the CRC register */
+	uint8_t poly; /** The CRC-8 polynomial in normal (MSB first) form */
+	uint8_t xor_out; /** Applied to the CRC before it is compared */
+	bool reflect; /** The CRC processes the bytes LSB first */
+	const uint8_t *crc_table; /** EMBX_IR_INTEGRITY_CRC8_TABLE only, see embx_ir_integrity_crc8_table */
+} embx_ir_integrity_cfg_t;
+
+/**
+* @brief embx_ir_integrity_t holds the running state of the checks while a frame is received.
+*/
+typedef struct {
+	const embx_ir_integrity_cfg_t *cfg; /** The table of checks */
+	uint8_t n; /** The number of checks in the table */
+	uint8_t idx; /** The number of bytes received */
+	uint8_t prev; /** The previous byte, used by INVERTED_PAIRS */
+	uint8_t acc[EMBX_IR_INTEGRITY_MAX_CHECKS]; /** The running sum or CRC of each check */
+} embx_ir_integrity_t;
+
+/**
+* @brief Builds the lookup table for a table driven CRC-8.
+* @params poly, reflect - the polynomial and bit order of the CRC.
+* @params table - receives EMBX_IR_INTEGRITY_CRC8_TABLE_SZ entries.
+*/
+extern void embx_ir_integrity_crc8_table(uint8_t poly, bool reflect, uint8_t *table);
+
+/**
+* @brief Resets the running state of the checks.
+* @params cfg, n - the table of checks, n is limited to EMBX_IR_INTEGRITY_MAX_CHECKS.
+*/
+extern void embx_ir_integrity_init(embx_ir_integrity_t *integrity, const embx_ir_integrity_cfg_t *cfg, uint8_t n);
+
+/**
+* @brief Adds the next byte of the frame to the checks.
+* @returns STATUS_OK if every check that ends at this byte passed,
+*          STATUS_ERR_BAD_DATA if a check failed.  The frame should be rejected.
+*/
+extern enum status_code embx_ir_integrity_update(embx_ir_integrity_t *integrity, uint8_t byte);
+
+/**
+* @brief Returns true once every check of the table has been completed.
+*/
+extern bool embx_ir_integrity_complete(const embx_ir_integrity_t *integrity);
+
+/**
+* @brief Validates a complete frame.
+* @returns STATUS_OK if all the checks pass, STATUS_ERR_BAD_DATA if a check fails or the frame is too short.
+*/
+extern enum status_code embx_ir_integrity_check(const embx_ir_integrity_cfg_t *cfg, uint8_t n, const uint8_t *data, uint8_t len);
+
+/**
+* @brief Computes the check bytes of a frame so that it passes the checks.  Used by encoders.
+* @details The INVERTED_PAIRS scheme overwrites every second byte with the complement of the byte before it.
+*/
+extern void embx_ir_integrity_fill(const embx_ir_integrity_cfg_t *cfg, uint8_t n, uint8_t *data, uint8_t len);
+
+#endif /* EMBX_IR_INTEGRITY_H_ */
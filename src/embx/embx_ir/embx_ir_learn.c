@@ -0,0 +1,185 @@
+/**
+ * @file embx_ir_learn.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_learn module extracts a canonical timing set from repeated captures of the same button.
+ * @details The first accepted capture fixes the number of edges.  Every following capture must have the same number
+ * of edges, start with a MARK, and have each edge within EMBX_IR_LEARN_TOLERANCE_PCT of the running mean, otherwise
+ * it is rejected.  A capture is validated completely before it is added so a rejected capture leaves the statistics unchanged.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_learn.h"
+#include "embx/embx_ir/embx_ir_protocol.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+
+/**
+* @brief Starts a learning session.
+*/
+void embx_ir_learn_init(embx_ir_learn_t *learn, uint8_t captures)
+{
+	learn->target = (captures == 0) ? 1 : captures;
+	learn->captures = 0;
+	learn->size = 0;
+	learn->rejects = 0;
+	learn->tx_edge = 0;
+}
+
+/**
+* @brief Returns true if the capture has the same shape as the session and every edge is close to the running mean.
+*/
+static bool embx_ir_learn_aligned(const embx_ir_learn_t *learn, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	uint16_t i;
+
+	if( (size == 0) || (size > EMBX_IR_LEARN_MAX_EDGES) ) {
+		return false;
+	}
+	for( i = 0; i < size; i++ ) { /** MARKs and SPACEs alternate starting with a MARK */
+		if( elem[i].gpio_state != (((i & 1) == 0) ? EMBX_IR_RX_GPIO_STATE_MARK : EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			return false;
+		}
+	}
+	if( learn->captures == 0 ) {
+		return true;
+	}
+	if( size != learn->size ) {
+		return false;
+	}
+	for( i = 0; i < size; i++ ) {
+		if( embx_ir_protocol_match(elem[i].time_us, learn->edge[i].mean >> EMBX_IR_LEARN_FRAC_BITS, EMBX_IR_LEARN_TOLERANCE_PCT) == false ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* @brief Aligns a capture with the session and adds its durations to the running statistics.
+* @details Welford's method: n++, delta = x - mean, mean += delta / n, m2 += delta * (x - mean).
+*/
+enum status_code embx_ir_learn_add(embx_ir_learn_t *learn, const embx_ir_rx_buf_elem_t *elem, uint16_t size)
+{
+	uint16_t i;
+	uint8_t n;
+	int32_t x, delta, delta2;
+	uint64_t m2;
+
+	if( learn->captures >= learn->target ) {
+		return STATUS_NO_CHANGE;
+	}
+	if( embx_ir_learn_aligned(learn, elem, size) == false ) {
+		learn->rejects++;
+		return STATUS_ERR_BAD_FORMAT;
+	}
+
+	n = ++learn->captures;
+	learn->size = size;
+	for( i = 0; i < size; i++ ) {
+		x = (int32_t)(elem[i].time_us << EMBX_IR_LEARN_FRAC_BITS);
+		if( n == 1 ) {
+			learn->edge[i].mean = (uint32_t)x;
+			learn->edge[i].m2 = 0;
+		} else {
+			delta = x - (int32_t)learn->edge[i].mean;
+			learn->edge[i].mean = (uint32_t)((int32_t)learn->edge[i].mean + (delta / n));
+			delta2 = x - (int32_t)learn->edge[i].mean;
+			m2 = learn->edge[i].m2 + (uint64_t)(((int64_t)delta * delta2) >> (2 * EMBX_IR_LEARN_FRAC_BITS));
+			learn->edge[i].m2 = (m2 > UINT32_MAX) ? UINT32_MAX : (uint32_t)m2;
+		}
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Adds every capture that the IR Rx PHY has completed to the session and releases the buffers.
+* @details Captures that ended with an error (e.g. a buffer overflow) are released without being added.
+*/
+bool embx_ir_learn_poll(embx_ir_learn_t *learn)
+{
+	embx_ir_rx_buf_t *buf;
+
+	while( embx_ir_rx_buf_get_full(&buf) == STATUS_OK ) {
+		if( buf->status == STATUS_OK ) {
+			embx_ir_learn_add(learn, buf->elem, buf->size);
+		}
+		embx_ir_rx_buf_release();
+	}
+	return embx_ir_learn_done(learn);
+}
+
+/** @brief Returns true once the session has the requested number of captures. */
+bool embx_ir_learn_done(const embx_ir_learn_t *learn)
+{
+	return (learn->captures >= learn->target);
+}
+
+/**
+* @brief Returns the canonical duration and the variance of an edge.
+*/
+enum status_code embx_ir_learn_get(const embx_ir_learn_t *learn, uint16_t idx, uint32_t *usec, uint32_t *variance)
+{
+	if( (learn->captures == 0) || (idx >= learn->size) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	*usec = (learn->edge[idx].mean + (1 << (EMBX_IR_LEARN_FRAC_BITS - 1))) >> EMBX_IR_LEARN_FRAC_BITS;
+	if( variance != NULL ) {
+		*variance = (learn->captures > 1) ? (learn->edge[idx].m2 / (learn->captures - 1)) : 0;
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Loads the edges of the session that fit into the IR Tx PHY descriptor queue.
+* @details The first edge resets the queue.  The stream is closed after the last edge.
+* @returns STATUS_OK once every edge is in the queue, STATUS_BUSY if the queue is full, or the error of the fill function.
+*/
+static enum status_code embx_ir_learn_stream_fill(embx_ir_learn_t *learn)
+{
+	enum status_code status;
+	uint32_t usec = 0;
+
+	while( learn->tx_edge < learn->size ) {
+		if( (learn->tx_edge != 0) && (embx_ir_tx_phy_descriptor_get_free() == 0) ) {
+			return STATUS_BUSY;
+		}
+		embx_ir_learn_get(learn, learn->tx_edge, &usec, NULL);
+		status = embx_ir_tx_phy_descriptor_fill((learn->tx_edge == 0), ((learn->tx_edge & 1) == 0) ? mark : space, usec, 0, 0);
+		if( status != STATUS_OK ) {
+			return status;
+		}
+		learn->tx_edge++;
+	}
+	embx_ir_tx_phy_descriptor_stream_close();
+	return STATUS_OK;
+}
+
+/**
+* @brief The low watermark callback of the IR Tx PHY.
+*/
+static void embx_ir_learn_stream_callback(void *context)
+{
+	embx_ir_learn_stream_fill((embx_ir_learn_t *)context);
+}
+
+/**
+* @brief Loads the canonical timing set into the IR Tx PHY descriptor queue.
+* @details The edges are loaded without repeats.  A frame of the Rx buffer has more edges than the queue has
+* descriptors, e.g. the 67 edges of NEC, so the rest of the edges are streamed as in embx_ir_protocol_stream_start.
+*/
+enum status_code embx_ir_learn_fill_tx(embx_ir_learn_t *learn)
+{
+	enum status_code status;
+
+	if( learn->captures == 0 ) {
+		return STATUS_ERR_NOT_INITIALIZED;
+	}
+	learn->tx_edge = 0;
+	status = embx_ir_learn_stream_fill(learn);
+	if( (status == STATUS_BUSY) && (learn->tx_edge != 0) ) { /** Not the reset of a queue that is transmitting */
+		embx_ir_tx_phy_descriptor_stream_open(embx_ir_learn_stream_callback, learn, EMBX_IR_PROTOCOL_STREAM_LOW_WATERMARK);
+		status = STATUS_OK;
+	}
+	return status;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file embx_ir_learn.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_learn module extracts a canonical timing set from repeated captures of the same button.
+ * @details Each capture is aligned edge by edge with the captures before it.  The mean and the variance of every edge are
+ * updated as the capture arrives (Welford's method) so no capture is stored.  The averaged timing removes the receiver
+ * jitter of a single capture and can be loaded directly into the IR Tx PHY descriptor queue.
+ */ 
+#ifndef EMBX_IR_LEARN_H_
+#define EMBX_IR_LEARN_H_
+
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+
+/** The maximum number of edges (marks and spaces) of a learned frame */
+#define EMBX_IR_LEARN_MAX_EDGES			(EMBX_IR_RX_BUF_SZ)
+/** A capture is rejected if any of its edges deviates from the running mean by more than this percentage */
+#define EMBX_IR_LEARN_TOLERANCE_PCT		(35)
+/** The running means are kept with this many fractional bits */
+#define EMBX_IR_LEARN_FRAC_BITS			(4)
+
+/**
+* @brief The running statistics of one edge.
+*/
+typedef struct {
+	uint32_t mean; /** The mean duration in usec << EMBX_IR_LEARN_FRAC_BITS */
+	uint32_t m2; /** The sum of the squared deviations from the mean in usec^2, saturates at UINT32_MAX */
+} embx_ir_learn_edge_t;
+
+/**
+* @brief embx_ir_learn_t holds the state of a learning session.
+*/
+typedef struct {
+	uint8_t target; /** The number of captures to average */
+	uint8_t captures; /** The number of captures accepted */
+	uint16_t size; /** The number of edges, set by the first capture */
+	uint32_t rejects; /** Captures that did not align with the first capture */
+	uint16_t tx_edge; /** The next edge loaded into the IR Tx PHY descriptor queue by embx_ir_learn_fill_tx */
+	embx_ir_learn_edge_t edge[EMBX_IR_LEARN_MAX_EDGES];
+} embx_ir_learn_t;
+
+/**
+* @brief Starts a learning session.
+* @params captures - the number of captures of the button to average.
+*/
+extern void embx_ir_learn_init(embx_ir_learn_t *learn, uint8_t captures);
+
+/**
+* @brief Aligns a capture with the session and adds its durations to the running statistics.
+* @returns STATUS_OK if the capture was accepted, STATUS_ERR_BAD_FORMAT if its edges do not align with the
+*          previous captures, STATUS_NO_CHANGE if the session already has enough captures.
+*/
+extern enum status_code embx_ir_learn_add(embx_ir_learn_t *learn, const embx_ir_rx_buf_elem_t *elem, uint16_t size);
+
+/**
+* @brief Adds every capture that the IR Rx PHY has completed to the session and releases the buffers.
+* @returns true once the session has the requested number of captures.
+*/
+extern bool embx_ir_learn_poll(embx_ir_learn_t *learn);
+
+/** @brief Returns true once the session has the requested number of captures. */
+extern bool embx_ir_learn_done(const embx_ir_learn_t *learn);
+
+/**
+* @brief Returns the canonical duration and the variance of an edge.
+* @params idx - the edge, 0 is the first mark.
+* @params usec - receives the mean duration rounded to usec.
+* @params variance - receives the sample variance in usec^2, may be NULL.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG if idx is out of range.
+*/
+extern enum status_code embx_ir_learn_get(const embx_ir_learn_t *learn, uint16_t idx, uint32_t *usec, uint32_t *variance);
+
+/**
+* @brief Loads the canonical timing set into the IR Tx PHY descriptor queue with embx_ir_tx_phy_descriptor_fill.
+* @details The queue is reset and filled.  If the edges do not fit, a stream is opened and the IR Tx PHY interrupt
+* refills the queue from the session as it is transmitted.  The session must not be changed until the transmission ends.
+* The caller starts the transmission with embx_ir_tx_phy_send.
+* @returns STATUS_OK, STATUS_ERR_NOT_INITIALIZED if no capture was accepted, or the status of embx_ir_tx_phy_descriptor_fill.
+*/
+extern enum status_code embx_ir_learn_fill_tx(embx_ir_learn_t *learn);
+
+#endif /* EMBX_IR_LEARN_H_ */
@@ -4,11 +4,415 @@
  * @author bbernath
  * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
  *
- * @brief
- * @details
+ * @brief Decodes the marks and spaces captured by the IR Rx PHY using a protocol descriptor.
+ * @details The decoder walks the buffer elements once.  Each duration is compared against the descriptor
+ * with the tolerance of the descriptor so no per protocol decoder is required.  The integrity checks of the
+ * protocol are updated as each byte completes.
  */
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx/embx_ir/embx_ir_common.h"
 #include "embx/embx_ir/embx_ir_protocol.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
 
- 
\ No newline at end of file
+/**
+* @brief Returns true if usec is within tolerance_pct percent of expected_usec.
+* @details Uses multiplication only, the M0+ does not have a hardware divider.
+*/
+bool embx_ir_protocol_match(uint32_t usec, uint32_t expected_usec, uint8_t tolerance_pct)
+{
+	uint32_t delta = (usec > expected_usec) ? (usec - expected_usec) : (expected_usec - usec);
+	return ( (delta * 100) <= (expected_usec * tolerance_pct) );
+}
+
+/**
+* @brief Stores a bit in the frame in the bit order of the protocol.
+* @details When the bit completes a byte, the byte is passed to the integrity checks so that a corrupt
+* frame is rejected without a second pass over the data.
+* @returns STATUS_OK or STATUS_ERR_PROTOCOL if an integrity check failed.
+*/
+static inline enum status_code embx_ir_protocol_put_bit(const embx_ir_protocol_t *protocol, embx_ir_protocol_frame_t *frame,
+														 embx_ir_integrity_t *integrity, bool bit)
+{
+	uint16_t n = frame->nbits;
+	if( bit == true ) {
+		if( protocol->bit_order == EMBX_IR_LITTLE_ENDIAN ) {
+			frame->data[n >> 3] |= (uint8_t)(1 << (n & 7));
+		} else {
+			frame->data[n >> 3] |= (uint8_t)(0x80 >> (n & 7));
+		}
+	}
+	frame->nbits++;
+	if( ((frame->nbits & 7) == 0) && (integrity != NULL) ) {
+		if( embx_ir_integrity_update(integrity, frame->data[(frame->nbits >> 3) - 1]) != STATUS_OK ) {
+			return STATUS_ERR_PROTOCOL;
+		}
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Returns true if the element at idx is a MARK or a SPACE.
+*/
+static inline bool embx_ir_protocol_is_elem(const embx_ir_rx_buf_elem_t *elem, uint16_t size, uint16_t idx, embx_ir_rx_gpio_state_t state)
+{
+	return ( (idx < size) && (elem[idx].gpio_state == state) );
+}
+
+/**
+* @brief Decodes the bits of a PULSE_DISTANCE or PULSE_WIDTH frame.
+* @details Every bit is a MARK followed by a SPACE.  The SPACE of the last bit may be missing when the frame
+* does not have a trailer, the last bit is then decoded from the MARK alone.
+*/
+static enum status_code embx_ir_protocol_decode_pulse(const embx_ir_protocol_t *protocol,
+													   const embx_ir_rx_buf_elem_t *elem, uint16_t size, uint16_t *idx,
+													   embx_ir_protocol_frame_t *frame, embx_ir_integrity_t *integrity)
+{
+	enum status_code rval = STATUS_OK;
+	uint16_t i = *idx;
+	uint8_t tol = protocol->tolerance_pct;
+	uint16_t max_bits = (protocol->nbits != 0) ? protocol->nbits : (EMBX_IR_PROTOCOL_MAX_BYTES * 8);
+	bool one_mark, zero_mark, one_space, zero_space;
+
+	while( (frame->nbits < max_bits) && embx_ir_protocol_is_elem(elem, size, i, EMBX_IR_RX_GPIO_STATE_MARK) ) {
+		one_mark = embx_ir_protocol_match(elem[i].time_us, protocol->one_mark_usec, tol);
+		zero_mark = embx_ir_protocol_match(elem[i].time_us, protocol->zero_mark_usec, tol);
+		if( embx_ir_protocol_is_elem(elem, size, i + 1, EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+			one_space = embx_ir_protocol_match(elem[i + 1].time_us, protocol->one_space_usec, tol);
+			zero_space = embx_ir_protocol_match(elem[i + 1].time_us, protocol->zero_space_usec, tol);
+			if( one_mark && one_space ) {
+				rval = embx_ir_protocol_put_bit(protocol, frame, integrity, true);
+			} else if( zero_mark && zero_space ) {
+				rval = embx_ir_protocol_put_bit(protocol, frame, integrity, false);
+			} else {
+				break; /** A trailer, a gap, or a bad duration ends the data bits */
+			}
+			i += 2;
+			if( rval != STATUS_OK ) {
+				break;
+			}
+		} else { /** Last MARK of the buffer, only a PULSE_WIDTH bit can be decoded without its SPACE */
+			if( (protocol->encoding == EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH) && (protocol->trailer_mark_usec == 0) && (one_mark != zero_mark) ) {
+				rval = embx_ir_protocol_put_bit(protocol, frame, integrity, one_mark);
+				i++;
+			}
+			break;
+		}
+	}
+	*idx = i;
+	return rval;
+}
+
+/**
+* @brief Decodes the bits of a MANCHESTER frame.
+* @details Each MARK or SPACE is one or two half bits long.  The half bits are paired into bits.  The SPACE that
+* follows the last MARK is not captured by the Rx PHY, a final MARK half bit is completed with a SPACE half bit.
+*/
+static enum status_code embx_ir_protocol_decode_manchester(const embx_ir_protocol_t *protocol,
+															const embx_ir_rx_buf_elem_t *elem, uint16_t size, uint16_t *idx,
+															embx_ir_protocol_frame_t *frame, embx_ir_integrity_t *integrity)
+{
+	enum status_code rval = STATUS_OK;
+	uint16_t i = *idx;
+	uint8_t tol = protocol->tolerance_pct;
+	uint16_t max_bits = (protocol->nbits != 0) ? protocol->nbits : (EMBX_IR_PROTOCOL_MAX_BYTES * 8);
+	int8_t pending = -1; /** The first half of the current bit, -1 if none */
+	uint8_t halves, level;
+
+	while( (frame->nbits < max_bits) && (i < size) && (elem[i].gpio_state != EMBX_IR_RX_GPIO_STATE_UNINITIALIZED) ) {
+		if( embx_ir_protocol_match(elem[i].time_us, protocol->unit_usec, tol) ) {
+			halves = 1;
+		} else if( embx_ir_protocol_match(elem[i].time_us, 2 * (uint32_t)protocol->unit_usec, tol) ) {
+			halves = 2;
+		} else {
+			break; /** A gap or a bad duration ends the frame */
+		}
+		level = (elem[i].gpio_state == EMBX_IR_RX_GPIO_STATE_MARK) ? 1 : 0;
+		while( halves-- > 0 ) {
+			if( pending < 0 ) {
+				pending = (int8_t)level;
+			} else if( pending != level ) {
+				rval = embx_ir_protocol_put_bit(protocol, frame, integrity, (pending == 1));
+				pending = -1;
+				if( rval != STATUS_OK ) {
+					break;
+				}
+			} else { /** Two equal half bits are not a valid bit */
+				rval = STATUS_ERR_BAD_FORMAT;
+				break;
+			}
+		}
+		if( rval != STATUS_OK ) {
+			break;
+		}
+		i++;
+	}
+	if( (rval == STATUS_OK) && (pending == 1) && (frame->nbits < max_bits) ) {
+		rval = embx_ir_protocol_put_bit(protocol, frame, integrity, true);
+	}
+	*idx = i;
+	return rval;
+}
+
+/**
+* @brief Decodes one frame from the marks and spaces of an IR rx buffer.
+* @details The header is matched first if the protocol has one, then the data bits, then the trailer.  A SPACE
+* that follows the trailer is consumed so that idx points at the start of the next frame.
+* @returns STATUS_OK if the frame was decoded and has protocol->nbits bits (any number of bits if nbits is 0).
+*          STATUS_ERR_BAD_FORMAT if the header or a bit does not match the descriptor.
+*          STATUS_ERR_BAD_DATA if idx is at the end of the buffer.
+*/
+enum status_code embx_ir_protocol_decode(const embx_ir_protocol_t *protocol,
+										 const embx_ir_rx_buf_elem_t *elem, uint16_t size, uint16_t *idx,
+										 embx_ir_protocol_frame_t *frame)
+{
+	enum status_code rval;
+	uint16_t i = *idx;
+	uint8_t tol = protocol->tolerance_pct;
+	uint16_t n;
+	embx_ir_integrity_t integrity;
+	embx_ir_integrity_t *p_integrity = NULL;
+
+	frame->nbits = 0;
+	for( n = 0; n < EMBX_IR_PROTOCOL_MAX_BYTES; n++ ) {
+		frame->data[n] = 0;
+	}
+
+	if( embx_ir_protocol_is_elem(elem, size, i, EMBX_IR_RX_GPIO_STATE_MARK) == false ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+
+	if( protocol->header_mark_usec != 0 ) {
+		if( (embx_ir_protocol_match(elem[i].time_us, protocol->header_mark_usec, tol) == false) ||
+			(embx_ir_protocol_is_elem(elem, size, i + 1, EMBX_IR_RX_GPIO_STATE_SPACE) == false) ||
+			(embx_ir_protocol_match(elem[i + 1].time_us, protocol->header_space_usec, tol) == false) ) {
+			*idx = i + 1;
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		i += 2;
+	}
+
+	if( protocol->integrity != NULL ) {
+		embx_ir_integrity_init(&integrity, protocol->integrity, protocol->integrity_n);
+		p_integrity = &integrity;
+	}
+
+	switch( protocol->encoding ) {
+		case EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE:
+		case EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH:
+			rval = embx_ir_protocol_decode_pulse(protocol, elem, size, &i, frame, p_integrity);
+		break;
+		case EMBX_IR_PROTOCOL_ENCODING_MANCHESTER:
+			rval = embx_ir_protocol_decode_manchester(protocol, elem, size, &i, frame, p_integrity);
+		break;
+		default:
+			rval = STATUS_ERR_BAD_FORMAT;
+		break;
+	}
+
+	/** The trailer MARK and the gap SPACE that follows it */
+	if( (protocol->trailer_mark_usec != 0) && embx_ir_protocol_is_elem(elem, size, i, EMBX_IR_RX_GPIO_STATE_MARK) &&
+		embx_ir_protocol_match(elem[i].time_us, protocol->trailer_mark_usec, tol) ) {
+		i++;
+	}
+	if( embx_ir_protocol_is_elem(elem, size, i, EMBX_IR_RX_GPIO_STATE_SPACE) ) {
+		i++;
+	}
+	*idx = (i > *idx) ? i : (*idx + 1); /** Always make progress */
+
+	if( rval == STATUS_OK ) {
+		if( (frame->nbits == 0) || ((protocol->nbits != 0) && (frame->nbits != protocol->nbits)) ) {
+			rval = STATUS_ERR_BAD_FORMAT;
+		} else if( (p_integrity != NULL) && (embx_ir_integrity_complete(p_integrity) == false) ) {
+			rval = STATUS_ERR_PROTOCOL; /** The frame ended before all of its checks */
+		}
+	}
+	return rval;
+}
+
+/**
+* @brief Writes the pending interval of the encoder to the descriptor queue.
+*/
+static void embx_ir_protocol_encoder_flush(embx_ir_protocol_encoder_t *encoder)
+{
+	if( (encoder->usec != 0) && (encoder->status == STATUS_OK) ) {
+		encoder->status = embx_ir_tx_phy_descriptor_fill(encoder->first, encoder->type, encoder->usec, 0, 0);
+		encoder->first = false;
+	}
+	encoder->usec = 0;
+}
+
+/**
+* @brief Adds an interval to the encoder, an interval of the same type as the pending interval extends it.
+*/
+static void embx_ir_protocol_encoder_put(embx_ir_protocol_encoder_t *encoder, embx_ir_tx_phy_interval_t type, uint32_t usec)
+{
+	if( usec == 0 ) {
+		return;
+	}
+	if( (encoder->usec != 0) && (encoder->type != type) ) {
+		embx_ir_protocol_encoder_flush(encoder);
+	}
+	encoder->type = type;
+	encoder->usec += usec;
+}
+
+/**
+* @brief Returns bit n of the frame in the bit order of the protocol.
+*/
+static inline bool embx_ir_protocol_get_bit(const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame, uint16_t n)
+{
+	if( protocol->bit_order == EMBX_IR_LITTLE_ENDIAN ) {
+		return ((frame->data[n >> 3] >> (n & 7)) & 1) != 0;
+	}
+	return ((frame->data[n >> 3] << (n & 7)) & 0x80) != 0;
+}
+
+/**
+* @brief Returns interval number step of a frame: the header MARK and SPACE, two intervals per bit, and the trailer MARK.
+* @returns false if the frame has no more intervals.
+*/
+static bool embx_ir_protocol_get_interval(const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame, uint16_t step,
+										  embx_ir_tx_phy_interval_t *type, uint32_t *usec)
+{
+	uint16_t last = 2 + 2 * frame->nbits;
+	bool bit;
+
+	if( step == 0 ) {
+		*type = mark;
+		*usec = protocol->header_mark_usec;
+	} else if( step == 1 ) {
+		*type = space;
+		*usec = protocol->header_space_usec;
+	} else if( step < last ) {
+		bit = embx_ir_protocol_get_bit(protocol, frame, (step - 2) >> 1);
+		if( protocol->encoding == EMBX_IR_PROTOCOL_ENCODING_MANCHESTER ) {
+			*type = ((((step & 1) == 0) ? bit : !bit) == true) ? mark : space;
+			*usec = protocol->unit_usec;
+		} else if( (step & 1) == 0 ) {
+			*type = mark;
+			*usec = (bit == true) ? protocol->one_mark_usec : protocol->zero_mark_usec;
+		} else {
+			*type = space;
+			*usec = (bit == true) ? protocol->one_space_usec : protocol->zero_space_usec;
+		}
+	} else if( step == last ) {
+		*type = mark;
+		*usec = protocol->trailer_mark_usec;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+/**
+* @brief Prepares a stream, the frame is copied.
+*/
+static enum status_code embx_ir_protocol_stream_init(embx_ir_protocol_stream_t *stream, const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame)
+{
+	if( (frame->nbits == 0) || (frame->nbits > (EMBX_IR_PROTOCOL_MAX_BYTES * 8)) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	stream->protocol = protocol;
+	stream->frame = *frame;
+	stream->step = 0;
+	stream->close = true;
+	stream->encoder.type = unknown;
+	stream->encoder.usec = 0;
+	stream->encoder.first = true;
+	stream->encoder.status = STATUS_OK;
+	return STATUS_OK;
+}
+
+/**
+* @brief Encodes a frame into the IR Tx PHY descriptor queue.
+*/
+enum status_code embx_ir_protocol_encode(const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame)
+{
+	embx_ir_protocol_stream_t stream;
+	enum status_code status;
+
+	status = embx_ir_protocol_stream_init(&stream, protocol, frame);
+	if( status == STATUS_OK ) {
+		status = embx_ir_protocol_stream_fill(&stream);
+		if( status == STATUS_BUSY ) {
+			status = STATUS_ERR_OVERFLOW;
+		}
+	}
+	return status;
+}
+
+/**
+* @brief The low watermark callback of the IR Tx PHY.
+*/
+static void embx_ir_protocol_stream_callback(void *context)
+{
+	embx_ir_protocol_stream_fill((embx_ir_protocol_stream_t *)context);
+}
+
+/**
+* @brief Starts to encode a frame of any length into the IR Tx PHY descriptor queue.
+*/
+enum status_code embx_ir_protocol_stream_start(embx_ir_protocol_stream_t *stream, const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame)
+{
+	enum status_code status;
+
+	status = embx_ir_protocol_stream_init(stream, protocol, frame);
+	if( status == STATUS_OK ) {
+		status = embx_ir_protocol_stream_fill(stream);
+		if( status == STATUS_BUSY ) {
+			embx_ir_tx_phy_descriptor_stream_open(embx_ir_protocol_stream_callback, stream, EMBX_IR_PROTOCOL_STREAM_LOW_WATERMARK);
+			status = STATUS_OK;
+		}
+	}
+	return status;
+}
+
+/**
+* @brief Prepares a stream that appends a frame to the IR Tx PHY descriptor queue.
+*/
+enum status_code embx_ir_protocol_stream_append(embx_ir_protocol_stream_t *stream, const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame)
+{
+	enum status_code status;
+
+	status = embx_ir_protocol_stream_init(stream, protocol, frame);
+	stream->close = false;
+	stream->encoder.first = false;
+	return status;
+}
+
+/**
+* @brief Encodes the intervals of the frame that fit into the IR Tx PHY descriptor queue.
+* @details An interval is only written when the next interval has a different type, i.e. when it can no longer grow.
+*/
+enum status_code embx_ir_protocol_stream_fill(embx_ir_protocol_stream_t *stream)
+{
+	embx_ir_protocol_encoder_t *encoder = &stream->encoder;
+	embx_ir_tx_phy_interval_t type;
+	uint32_t usec;
+
+	while( embx_ir_protocol_get_interval(stream->protocol, &stream->frame, stream->step, &type, &usec) == true ) {
+		if( (usec != 0) && (encoder->usec != 0) && (encoder->type != type) ) {
+			if( (encoder->first == false) && (embx_ir_tx_phy_descriptor_get_free() == 0) ) {
+				return STATUS_BUSY;
+			}
+			embx_ir_protocol_encoder_flush(encoder);
+			if( encoder->status != STATUS_OK ) {
+				return encoder->status;
+			}
+		}
+		embx_ir_protocol_encoder_put(encoder, type, usec);
+		stream->step++;
+	}
+
+	if( encoder->type == space ) {
+		encoder->usec = 0; /** The line idles as a SPACE, a trailing SPACE is not transmitted */
+	}
+	if( (encoder->usec != 0) && (encoder->first == false) && (embx_ir_tx_phy_descriptor_get_free() == 0) ) {
+		return STATUS_BUSY;
+	}
+	embx_ir_protocol_encoder_flush(encoder);
+	if( (encoder->first == false) && (stream->close == true) ) {
+		embx_ir_tx_phy_descriptor_stream_close();
+	}
+	return encoder->status;
+}
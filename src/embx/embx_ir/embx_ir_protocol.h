@@ -4,14 +4,141 @@
  * @author bbernath
  * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
  *
- * @brief
- * @details
+ * @brief Describes the framing and bit encoding of an IR remote protocol.
+ * @details A protocol descriptor holds the timing of the header, the data bits, and the trailer of a frame
+ * in usec together with the bit encoding and the bit order.  The decode function uses a descriptor to turn
+ * the marks and spaces stored in an IR rx buffer into a frame of data bytes.
  */ 
 #ifndef EMBX_IR_PROTOCOL_H_
 #define EMBX_IR_PROTOCOL_H_
 
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+#include "embx/embx_ir/embx_ir_integrity.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
 
+/** The maximum number of data bytes in a frame.  Large enough for the 18 byte Mitsubishi and 19 byte Daikin frames. */
+#define EMBX_IR_PROTOCOL_MAX_BYTES			(32)
 
+/** The default allowed deviation in percent when a received duration is matched against the descriptor */
+#define EMBX_IR_PROTOCOL_TOLERANCE_PCT		(25)
 
+/** A stream is refilled when no more than this number of descriptors are left to transmit */
+#define EMBX_IR_PROTOCOL_STREAM_LOW_WATERMARK	(EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ / 2)
 
-#endif /* EMBX_IR_PROTOCOL_H_ */
\ No newline at end of file
+/**
+* @brief Enumerates the bit encodings used by IR remotes.
+*/
+typedef enum {
+	EMBX_IR_PROTOCOL_ENCODING_UNKNOWN = 0,
+	EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE, /** The mark is constant, the duration of the space carries the bit */
+	EMBX_IR_PROTOCOL_ENCODING_PULSE_WIDTH, /** The space is constant, the duration of the mark carries the bit */
+	EMBX_IR_PROTOCOL_ENCODING_MANCHESTER, /** Each bit is two half bits of one unit, a 1 is MARK then SPACE, a 0 is SPACE then MARK */
+} embx_ir_protocol_encoding_t;
+
+/**
+* @brief embx_ir_protocol_t describes the timing of a protocol.
+* @details All durations are in usec.  A duration of 0 means that the protocol does not have the element.
+* For MANCHESTER protocols the zero and one durations are both set to the unit, i.e. the duration of a half bit.
+*/
+typedef struct {
+	embx_ir_protocol_encoding_t encoding;
+	uint8_t bit_order; /** EMBX_IR_LITTLE_ENDIAN (LSB first) or EMBX_IR_BIG_ENDIAN (MSB first) */
+	uint8_t tolerance_pct; /** Allowed deviation of a received duration in percent */
+	uint16_t unit_usec; /** The base timing unit, every other duration is close to a multiple of it */
+	uint16_t header_mark_usec;
+	uint16_t header_space_usec;
+	uint16_t zero_mark_usec;
+	uint16_t zero_space_usec;
+	uint16_t one_mark_usec;
+	uint16_t one_space_usec;
+	uint16_t trailer_mark_usec; /** The stop bit that terminates the last space of the frame */
+	uint32_t gap_usec; /** The space between two frames of a transmission */
+	uint16_t nbits; /** The number of data bits in a frame, 0 if unknown */
+	const embx_ir_integrity_cfg_t *integrity; /** The integrity checks of the frame, NULL if there are none */
+	uint8_t integrity_n; /** The number of entries in the integrity table */
+} embx_ir_protocol_t;
+
+/**
+* @brief embx_ir_protocol_frame_t holds the data decoded from one frame.
+* @details Bits are packed into bytes in the bit order of the protocol, bit 0 of the frame is in data[0].
+*/
+typedef struct {
+	uint16_t nbits; /** The number of bits decoded */
+	uint8_t data[EMBX_IR_PROTOCOL_MAX_BYTES];
+} embx_ir_protocol_frame_t;
+
+/**
+* @brief Collects the intervals of a frame being encoded so that adjacent intervals of the same type are merged.
+*/
+typedef struct {
+	embx_ir_tx_phy_interval_t type; /** The type of the interval that has not been written yet */
+	uint32_t usec; /** Its duration */
+	bool first; /** The next descriptor is the first of the queue */
+	enum status_code status;
+} embx_ir_protocol_encoder_t;
+
+/**
+* @brief embx_ir_protocol_stream_t encodes a frame into the IR Tx PHY descriptor queue while it is transmitted.
+*/
+typedef struct {
+	const embx_ir_protocol_t *protocol;
+	embx_ir_protocol_frame_t frame; /** A copy of the frame */
+	uint16_t step; /** The next interval of the frame */
+	bool close; /** Close the IR Tx PHY stream after the last interval */
+	embx_ir_protocol_encoder_t encoder;
+} embx_ir_protocol_stream_t;
+
+/**
+* @brief Returns true if usec is within tolerance_pct percent of expected_usec.
+*/
+extern bool embx_ir_protocol_match(uint32_t usec, uint32_t expected_usec, uint8_t tolerance_pct);
+
+/**
+* @brief Decodes one frame from the marks and spaces of an IR rx buffer.
+* @params protocol - describes the frame.
+* @params elem, size - the buffer elements and the number of valid elements.
+* @params idx - in: the element where the frame starts, out: the element following the frame.  Call again to decode the next frame.
+* @params frame - receives the decoded bits.
+* @returns STATUS_OK if a complete frame was decoded, STATUS_ERR_BAD_FORMAT if the timing does not match the descriptor,
+*          STATUS_ERR_PROTOCOL if an integrity check failed, or STATUS_ERR_BAD_DATA if there are no elements left.
+*/
+extern enum status_code embx_ir_protocol_decode(const embx_ir_protocol_t *protocol,
+												const embx_ir_rx_buf_elem_t *elem, uint16_t size, uint16_t *idx,
+												embx_ir_protocol_frame_t *frame);
+
+/**
+* @brief Encodes a frame into the IR Tx PHY descriptor queue.
+* @details The queue is reset and loaded with the header, the data bits, and the trailer.  Adjacent MARKs or SPACEs
+* (MANCHESTER half bits) are merged into a single descriptor.  The caller starts the transmission with embx_ir_tx_phy_send.
+* @returns STATUS_OK or the error returned by embx_ir_tx_phy_descriptor_fill, e.g. STATUS_ERR_OVERFLOW if the
+*          frame has more intervals than the descriptor queue.
+*/
+extern enum status_code embx_ir_protocol_encode(const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame);
+
+/**
+* @brief Starts to encode a frame of any length into the IR Tx PHY descriptor queue.
+* @details The queue is reset and filled.  If the frame does not fit, a stream is opened and the IR Tx PHY interrupt 
+* refills the queue from the stream as it is transmitted.  The stream must stay in scope until the transmission ends.
+* The caller starts the transmission with embx_ir_tx_phy_send.
+* @returns STATUS_OK, STATUS_ERR_INVALID_ARG, or the error returned by embx_ir_tx_phy_descriptor_fill, e.g. STATUS_BUSY
+*          if a transmission is in progress.
+*/
+extern enum status_code embx_ir_protocol_stream_start(embx_ir_protocol_stream_t *stream, const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame);
+
+/**
+* @brief Prepares a stream that appends a frame to the IR Tx PHY descriptor queue.
+* @details Nothing is filled yet and the queue is not reset.  The caller owns the stream of the IR Tx PHY, it calls 
+* embx_ir_protocol_stream_fill until it returns STATUS_OK and it is not closed by the frame.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG.
+*/
+extern enum status_code embx_ir_protocol_stream_append(embx_ir_protocol_stream_t *stream, const embx_ir_protocol_t *protocol, const embx_ir_protocol_frame_t *frame);
+
+/**
+* @brief Encodes the intervals of the frame that fit into the IR Tx PHY descriptor queue.
+* @details Called by the IR Tx PHY interrupt through the low watermark callback.  A started stream is closed after the last interval.
+* @returns STATUS_OK once the whole frame is in the queue, STATUS_BUSY if the queue is full, or the error of the fill function.
+*/
+extern enum status_code embx_ir_protocol_stream_fill(embx_ir_protocol_stream_t *stream);
+
+#endif /* EMBX_IR_PROTOCOL_H_ */
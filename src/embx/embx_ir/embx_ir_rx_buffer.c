@@ -11,7 +11,7 @@
 *
 *	The module implements methods that allow users to reset the buffer, store and retrieve data, gather statistics, ...
 */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx/embx_ir/embx_ir_rx_buffer.h"
 
 /** The buffers used to store data received via IR */
@@ -23,6 +23,9 @@ static embx_ir_rx_buf_err_t embx_ir_rx_buf_err = {0, 0};
 /** The buffer index used by the interrupt service routines */
 static uint8_t idx_ir_rx_buf_isr = 0;
 
+/** The buffer index used by the background loop, follows idx_ir_rx_buf_isr */
+static uint8_t idx_ir_rx_buf_bg = 0;
+
 /** 
 * @brief Resets a single buffer to a known state.
 * @params idx - the index of the buffer to reset.  This value is boundary checked.
@@ -34,12 +37,13 @@ enum status_code embx_ir_rx_phy_buf_reset(uint8_t idx)
 	uint16_t i;
 	
 	if( idx < EMBX_IR_RX_NUMBER_OF_BUFFERS ) {
-		embx_ir_rx_buf[idx].state = EMBX_IR_RX_BUF_EMPTY;
 		embx_ir_rx_buf[idx].status = STATUS_OK;
 		embx_ir_rx_buf[idx].size = 0;
 		for( i = 0; i < EMBX_IR_RX_BUF_SZ; i++ ) {
 			embx_ir_rx_buf[idx].elem[i].gpio_state = EMBX_IR_RX_GPIO_STATE_UNINITIALIZED;
 		}
+		/** EMPTY is set last, the ISR may start using the buffer as soon as it is EMPTY */
+		embx_ir_rx_buf[idx].state = EMBX_IR_RX_BUF_EMPTY;
 	} else {
 		rval = STATUS_ERR_NO_MEMORY	;
 	}
@@ -69,6 +73,7 @@ void embx_ir_rx_phy_buf_init(void)
 	embx_ir_rx_phy_buf_reset_stats();	
 	
 	idx_ir_rx_buf_isr = 0;
+	idx_ir_rx_buf_bg = 0;
 }
 
 /**
@@ -91,12 +96,11 @@ enum status_code embx_ir_rx_buf_isr_get_elem(embx_ir_rx_buf_elem_t **buf_elem)
 			embx_ir_rx_buf_err.overflows++;
 			rval = STATUS_ERR_OVERFLOW;
 		}
-	} else { /* No Available Buffers */
+		embx_ir_rx_buf[idx_ir_rx_buf_isr].status = rval;			
+	} else { /* No Available Buffers, the buffer belongs to the background loop so it is left as it is */
 		embx_ir_rx_buf_err.no_memory++;
 		rval = STATUS_ERR_NO_MEMORY;		
 	}
-		
-	embx_ir_rx_buf[idx_ir_rx_buf_isr].status = rval;			
 	
 	return rval;
 }
@@ -106,11 +110,16 @@ enum status_code embx_ir_rx_buf_isr_get_elem(embx_ir_rx_buf_elem_t **buf_elem)
 * @details The buf_state is set to EMBX_IR_RX_BUF_FULL to allow the background loop to process the buffer.
 * @params status_code - This is meant for the caller to set status variable in the buffer.  Possible values are
 *  STATUS_OK or STATUS_ERR_TIMEOUT.
-* @params status_code - Only STATUS_OK
+* @returns STATUS_OK, or STATUS_ERR_NO_MEMORY if the current buffer is still FULL, e.g. a MARK timed out while every
+* buffer was full.  The buffer belongs to the background loop and the index is not moved.
 */
 extern enum status_code embx_ir_rx_buf_complete(enum status_code buffer_status)
 {
 	enum status_code rval = STATUS_OK;
+	if( embx_ir_rx_buf[idx_ir_rx_buf_isr].state != EMBX_IR_RX_BUF_EMPTY ) {
+		embx_ir_rx_buf_err.no_memory++;
+		return STATUS_ERR_NO_MEMORY;
+	}
 	embx_ir_rx_buf[idx_ir_rx_buf_isr].state = EMBX_IR_RX_BUF_FULL; /** The current buffer is full */
 	embx_ir_rx_buf[idx_ir_rx_buf_isr].status = buffer_status; /** The caller sets the status */
 	idx_ir_rx_buf_isr++; /** increment the buffer index and */
@@ -119,3 +128,34 @@ extern enum status_code embx_ir_rx_buf_complete(enum status_code buffer_status)
 	}		
 	return rval;
 }
+
+/**
+* @brief Returns the oldest FULL buffer to the background loop.
+* @details The ISR fills the buffers in order so the background loop reads them in the same order.
+* @returns STATUS_OK if buf points to a FULL buffer else STATUS_ERR_BAD_DATA if there is nothing to process.
+*/
+enum status_code embx_ir_rx_buf_get_full(embx_ir_rx_buf_t **buf)
+{
+	enum status_code rval = STATUS_OK;
+	if( embx_ir_rx_buf[idx_ir_rx_buf_bg].state == EMBX_IR_RX_BUF_FULL ) {
+		*buf = &embx_ir_rx_buf[idx_ir_rx_buf_bg];
+	} else {
+		rval = STATUS_ERR_BAD_DATA;
+	}
+	return rval;
+}
+
+/**
+* @brief Resets the buffer returned by embx_ir_rx_buf_get_full so the ISR can use it again.
+* @details The buffer is reset before it is marked EMPTY, the ISR only writes EMPTY buffers.
+*/
+void embx_ir_rx_buf_release(void)
+{
+	if( embx_ir_rx_buf[idx_ir_rx_buf_bg].state == EMBX_IR_RX_BUF_FULL ) {
+		embx_ir_rx_phy_buf_reset(idx_ir_rx_buf_bg);
+		idx_ir_rx_buf_bg++;
+		if( idx_ir_rx_buf_bg == EMBX_IR_RX_NUMBER_OF_BUFFERS ) {
+			idx_ir_rx_buf_bg = 0;
+		}
+	}
+}
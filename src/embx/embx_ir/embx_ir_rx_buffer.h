@@ -11,8 +11,8 @@
 /** The number of IR Rx Data Buffers */
 #define EMBX_IR_RX_NUMBER_OF_BUFFERS	(4)
 
-/** The number of Buffer Elements per IR Rx Data Buffer */
-#define EMBX_IR_RX_BUF_SZ   (256)
+/** The number of Buffer Elements per IR Rx Data Buffer, a Mitsubishi split unit frame of 291 intervals fits */
+#define EMBX_IR_RX_BUF_SZ   (320)
 
 /**
 * @brief embx_ir_rx_gpio_state_t describes the state of the GPIO pin connected to the IR receiver.
@@ -86,4 +86,18 @@ extern enum status_code embx_ir_rx_buf_isr_get_elem(embx_ir_rx_buf_elem_t **buf_
 */
 extern enum status_code embx_ir_rx_buf_complete(enum status_code buffer_status);
 
+/**
+	@brief Returns the oldest FULL buffer so that the background loop can process it.
+	@details - Buffers are returned in the order that the ISR completed them.  The buffer remains
+	FULL until embx_ir_rx_buf_release is called.
+	@params - buf - set to the FULL buffer.
+	@returns STATUS_OK if a buffer is available else STATUS_ERR_BAD_DATA.
+*/
+extern enum status_code embx_ir_rx_buf_get_full(embx_ir_rx_buf_t **buf);
+
+/** 
+	@brief Releases the buffer returned by embx_ir_rx_buf_get_full back to the ISR. 
+*/
+extern void embx_ir_rx_buf_release(void);
+
 #endif /* EMBX_IR_RX_BUFFER_H_ */
\ No newline at end of file
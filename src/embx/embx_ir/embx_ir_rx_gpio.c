@@ -12,16 +12,14 @@
  *            callback function that handles the rising or falling edge events.  The call back function simply
  *            calls the embx_rx_ir_phy_state_machine.  The state machine handles the event.  
 */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx/embx_ir/embx_ir_rx_phy.h"
 #include "embx/embx_ir/embx_ir_rx_gpio.h"
+#include "embx/embx_bench/embx_bench_isr.h"
 
 /** Module statistics */
 static embx_ir_rx_gpio_stats_t embx_ir_rx_gpio_stats = {0, 0};
 
-/** The configuration is saved to allow the module to be enabled and disabled */
-static struct extint_chan_conf config_extint_chan;
-
 /** @brief Reset the module's statistics */
 static void embx_ir_rx_gpio_reset_stats(void)
 {
@@ -34,10 +32,10 @@ static void embx_ir_rx_gpio_reset_stats(void)
 * @details - The callback function determines if a rising or falling edge occured and
 * triggers the state machine with the appropriate input.
 */
-static void embx_ir_rx_gpio_callback(void)
+static void embx_ir_rx_gpio_callback(uint8_t channel)
 {
-	uint8_t channel = extint_get_current_channel();
-	bool pin_state = port_pin_get_input_level(EMBX_IR_RX_EIC_PIN);
+	EMBX_BENCH_ISR_ENTER();
+	bool pin_state = embx_hal_pin_get_level(EMBX_IR_RX_EIC_PIN);
 	if( pin_state == true ) { /* Rising Edge -> Mark Ended, SPACE started or Packet Ended */ 
 		embx_rx_ir_phy_state_machine(EMBX_IR_RX_GPIO_EVENT_RISING_EDGE);
 		embx_ir_rx_gpio_stats.rising_edge_events++; 
@@ -45,7 +43,7 @@ static void embx_ir_rx_gpio_callback(void)
 		embx_rx_ir_phy_state_machine(EMBX_IR_RX_GPIO_EVENT_FALLING_EDGE);
 		embx_ir_rx_gpio_stats.falling_edge_events++; 		 
 	}
-	extint_chan_clear_detected(channel);
+	EMBX_BENCH_ISR_EXIT(EMBX_BENCH_ISR_RX_GPIO);
 }
 
 /**
@@ -58,28 +56,18 @@ void embx_ir_rx_gpio_init(void)
 {
 	embx_ir_rx_gpio_reset_stats();	
 	
-	extint_chan_get_config_defaults(&config_extint_chan);
-
-	/* Configure the GPIO pin for use as an external interrupt input */
-	config_extint_chan.gpio_pin = EMBX_IR_RX_EIC_PIN;
-	config_extint_chan.gpio_pin_mux = EMBX_IR_RX_EIC_MUX;
-	config_extint_chan.gpio_pin_pull = EXTINT_PULL_UP;
-	config_extint_chan.detection_criteria = EXTINT_DETECT_BOTH; /* Both edges */	
-	config_extint_chan.filter_input_signal = true;
-	
-	extint_chan_set_config(EMBX_IR_RX_EIC_CHANNEL, &config_extint_chan);
-
-	extint_register_callback(embx_ir_rx_gpio_callback, EMBX_IR_RX_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
+	/* Configure the GPIO pin for use as an external interrupt input, both edges with the pull-up and the filter */
+	embx_hal_extint_init(EMBX_IR_RX_EIC_CHANNEL, EMBX_IR_RX_EIC_PIN, EMBX_IR_RX_EIC_MUX, embx_ir_rx_gpio_callback);
 }
 
 /** @brief - Enables the module.*/
 void embx_ir_rx_gpio_enable(void)
 {
-	extint_chan_enable_callback(EMBX_IR_RX_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);	
+	embx_hal_extint_enable_callback(EMBX_IR_RX_EIC_CHANNEL);	
 }
 
 /** @brief - Disables the module. */
 void embx_ir_rx_gpio_disable(void)
 {
-	extint_chan_disable_callback(EMBX_IR_RX_EIC_CHANNEL, EXTINT_CALLBACK_TYPE_DETECT);
+	embx_hal_extint_disable_callback(EMBX_IR_RX_EIC_CHANNEL);
 }
@@ -10,14 +10,10 @@
  * to store the marks/space and timing information.
  * 
  */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx/embx_ir/embx_ir_rx_gpio.h"
 #include "embx/embx_ir/embx_ir_rx_phy.h"
-
-/**
-* @brief The TC used by the PHY.
-*/
-static struct tc_module tc_instance_ir_rx_phy;
+#include "embx/embx_bench/embx_bench_isr.h"
 
 /** 
 * @brief The state variable used to store the current state of the state machine. 
@@ -34,6 +30,22 @@ static embx_ir_rx_phy_timer_overflows_t embx_ir_rx_phy_timer_overflow = {0, 0, 0
 * @brief
 */
 static embx_ir_rx_phy_stats_t embx_ir_rx_phy_stats = {0};
+
+/**
+* @brief The time in usec that the receiver stretches a mark and shortens the following space, see embx_ir_rx_phy_set_mark_stretch.
+*/
+static int16_t embx_ir_rx_phy_mark_stretch_usec = 0;
+
+/**
+* @brief Returns the duration in usec of a received interval corrected for the mark stretching of the receiver.
+* @details ticks is kept as measured.  A duration is never less than 0.
+*/
+static inline uint32_t embx_ir_rx_phy_correct(uint32_t ticks, int16_t stretch_usec)
+{
+	int32_t usec = (int32_t)(ticks * EMBX_IR_RX_PHY_USEC_PER_TICK) - stretch_usec;
+	
+	return (usec > 0) ? (uint32_t)usec : 0;
+}
  	
 /**
 * @brief - Handles the case when the state machine wants to re-synchronize after an error.
@@ -54,7 +66,8 @@ static inline void handle_resync(void)
 static inline void handle_overflow(void)
 {
 	if( embx_ir_rx_buf_complete(STATUS_ERR_OVERFLOW) == STATUS_OK ) {
-		/* Change the state back to IDLE for the next reception, no need to start timer */
+		/* Change the state back to IDLE for the next reception, the timer is off while IDLE */
+		embx_hal_tc_stop(TC_IR_RX_PHY_MODULE);
 		embx_ir_rx_phy_state = EMBX_IR_RX_PHY_STATE_IDLE;
 	} else {
 		embx_ir_rx_phy_stats.buffer_overflows++;
@@ -69,7 +82,8 @@ static inline void handle_overflow(void)
 static inline void handle_state_synchronize(embx_ir_rx_event_t event, uint32_t count)
 {
 	if( event == EMBX_IR_RX_TIMER_EVENT_TIMEOUT ) { /** A timeout event has occured */
-		if( count > EMBX_IR_RX_PHY_SYNC_DELAY ) { /** Check if the elapsed time is greater than the required time for synchronization to occur */
+		if( count >= EMBX_IR_RX_PHY_SYNC_DELAY ) { /** Check if the elapsed time reached the required time for synchronization to occur */
+			embx_hal_tc_stop(TC_IR_RX_PHY_MODULE); /** The timer is off while IDLE */
 			embx_ir_rx_phy_state = EMBX_IR_RX_PHY_STATE_IDLE; /** If so, we are synced so move to the idle state */
 		} else { /** Otherwise start over */
 			embx_ir_rx_phy_restart_timer(EMBX_IR_RX_PHY_SYNC_DELAY); 
@@ -89,10 +103,12 @@ static inline void handle_state_idle(embx_ir_rx_event_t event)
 	if( event == EMBX_IR_RX_GPIO_EVENT_FALLING_EDGE ) { /* Falling edge detected, so transition to MARKING */
 		/* Start the counter to time the first mark */
 		embx_ir_rx_phy_restart_timer(EMBX_IR_RX_PHY_MARK_DELAY);
+		embx_ir_rx_phy_timer_overflow.mark = 0;
 				
 		/* Change the state to MARKING */
 		embx_ir_rx_phy_state = EMBX_IR_RX_PHY_STATE_MARKING;
 	} else if( event == EMBX_IR_RX_TIMER_EVENT_TIMEOUT ) { /* This shouldn't happen so if idle_timer_overflows is > 0 something is wrong */
+		embx_hal_tc_stop(TC_IR_RX_PHY_MODULE);
 		embx_ir_rx_phy_timer_overflow.idle++;
 	}
 }
@@ -113,7 +129,7 @@ static inline enum status_code handle_received_mark(uint32_t count)
 	if( rval == STATUS_OK ) {	/** A buffer element is available so record relevant info */
 		rx_buf_elem->gpio_state = EMBX_IR_RX_GPIO_STATE_MARK; /** This is a MARK */
 		rx_buf_elem->ticks = count + EMBX_IR_RX_PHY_MARK_DELAY * embx_ir_rx_phy_timer_overflow.mark; /** This is the duration of the MARK in timer ticks */
-		rx_buf_elem->time_us = rx_buf_elem->ticks * EMBX_IR_RX_PHY_USEC_PER_TICK; /** This is the duration of the MARK in us */
+		rx_buf_elem->time_us = embx_ir_rx_phy_correct(rx_buf_elem->ticks, embx_ir_rx_phy_mark_stretch_usec); /** This is the duration of the MARK in us */
 		
 		/** A SPACE or an IDLE follows a MARK so restart the counter to time the SPACE */
 		embx_ir_rx_phy_restart_timer(EMBX_IR_RX_PHY_SPACE_DELAY); 
@@ -133,8 +149,8 @@ static inline enum status_code handle_received_space(uint32_t count)
 	enum status_code rval = embx_ir_rx_buf_isr_get_elem(&rx_buf_elem);
 	if( rval == STATUS_OK ) {
 		rx_buf_elem->gpio_state = EMBX_IR_RX_GPIO_STATE_SPACE;
-		rx_buf_elem->ticks = count;
-		rx_buf_elem->time_us = rx_buf_elem->ticks * EMBX_IR_RX_PHY_USEC_PER_TICK;
+		rx_buf_elem->ticks = count + EMBX_IR_RX_PHY_SPACE_DELAY * embx_ir_rx_phy_timer_overflow.space; /** The SPACE may be longer than the timer period */
+		rx_buf_elem->time_us = embx_ir_rx_phy_correct(rx_buf_elem->ticks, -embx_ir_rx_phy_mark_stretch_usec);
 					
 		/* Restart the counter to time the MARK */
 		embx_ir_rx_phy_restart_timer(EMBX_IR_RX_PHY_MARK_DELAY);
@@ -156,7 +172,8 @@ static inline enum status_code handle_received_space(uint32_t count)
 static inline void handle_rx_complete(enum status_code buffer_status)
 {
 	if( embx_ir_rx_buf_complete(buffer_status) == STATUS_OK ) {
-		/* Change the state back to IDLE for the next reception, no need to start timer */
+		/* Change the state back to IDLE for the next reception, the timer is off while IDLE */
+		embx_hal_tc_stop(TC_IR_RX_PHY_MODULE);
 		embx_ir_rx_phy_state = EMBX_IR_RX_PHY_STATE_IDLE;
 	} else {
 		handle_resync();
@@ -173,12 +190,14 @@ static inline void handle_rx_complete(enum status_code buffer_status)
 * by a TIMER timerout.  A falling edge event from the GPIO causes the spacing time and state to be saved into a rx_buf_elem.  A timeout signals the end
 * of the data reception and the state machine returns to the IDLE state.
 * To measure the duration of marks and spaces, the timer is used.  
+* The timer is only stopped or restarted by a handler that acts on the event.  An edge out of turn, e.g. the second
+* edge of a glitch shorter than the interrupt latency reads the same level as the first, keeps the timer running so
+* the interval and its timeout are not lost.
 * @params embx_ir_rx_event_t - the event that the state machine handles.  Currently, the GPIO generates rising and falling edge events and the timer generates timeout events.
 */
 void embx_rx_ir_phy_state_machine(embx_ir_rx_event_t event)
 {
-	uint32_t count = tc_get_count_value(&tc_instance_ir_rx_phy);
-	tc_stop_counter(&tc_instance_ir_rx_phy);
+	uint32_t count = embx_hal_tc_get_count(TC_IR_RX_PHY_MODULE);
 		
 	switch(embx_ir_rx_phy_state)
 	{
@@ -207,6 +226,7 @@ void embx_rx_ir_phy_state_machine(embx_ir_rx_event_t event)
 		case EMBX_IR_RX_PHY_STATE_SPACING:						
 			if( event == EMBX_IR_RX_GPIO_EVENT_FALLING_EDGE ) { /* Falling Edge detected, handle the received space and change state back to marking */
 				handle_received_space(count);
+				embx_ir_rx_phy_timer_overflow.space = 0; /* Set back to 0 */
 			} else if( event == EMBX_IR_RX_TIMER_EVENT_TIMEOUT ) {
 				if( embx_ir_rx_phy_timer_overflow.space == EMBX_IR_RX_PHY_TIMER_OVERFLOWS_SPACE ) {			
 					embx_ir_rx_phy_timer_overflow.space = 0;
@@ -229,9 +249,11 @@ void embx_rx_ir_phy_state_machine(embx_ir_rx_event_t event)
 * @brief The callback function occurs when the TC times out.
 * @details TC times out when ...
 */
-static void tc_callback_ir_rx_phy( struct tc_module *const module_inst)
+static void tc_callback_ir_rx_phy(embx_hal_tc_t tc)
 {
+	EMBX_BENCH_ISR_ENTER();
 	embx_rx_ir_phy_state_machine(EMBX_IR_RX_TIMER_EVENT_TIMEOUT);
+	EMBX_BENCH_ISR_EXIT(EMBX_BENCH_ISR_RX_PHY);
 }
  
 /**
@@ -239,30 +261,27 @@ static void tc_callback_ir_rx_phy( struct tc_module *const module_inst)
 */
 static void embx_time_configure_tc_callbacks(void)
 {
-	tc_register_callback(&tc_instance_ir_rx_phy, &tc_callback_ir_rx_phy, TC_CALLBACK_CC_CHANNEL0);
-	tc_enable_callback(&tc_instance_ir_rx_phy, TC_CALLBACK_CC_CHANNEL0);
+	embx_hal_tc_register_callback(TC_IR_RX_PHY_MODULE, EMBX_HAL_TC_CALLBACK_CC0, tc_callback_ir_rx_phy);
+	embx_hal_tc_enable_callback(TC_IR_RX_PHY_MODULE, EMBX_HAL_TC_CALLBACK_CC0);
 }
 
 /**
 * @brief Initializes the IR RX PHY timer
-* @details TC is configured to use an 16-bit counter clocked at 8 Mhz / EMBX_IR_RX_PHY_PRESCALER.  Currently,
+* @details TC is configured to use an 16-bit counter clocked at 8 Mhz / EMBX_IR_RX_PHY_DIV_FACTOR.  Currently,
 * this results in 8 usec per tick.  This function initializes, enables, and stops the counter.
 * @param gclk which clock to use....See embx_ir_common.h
 * @returns void
 */
 static void embx_ir_rx_phy_tc_init(enum gclk_generator gclk)
 {
-	struct tc_config config_tc;
+	embx_hal_tc_config_t config_tc;
 	
-	tc_get_config_defaults(&config_tc);
+	embx_hal_tc_get_config_defaults(&config_tc);
 	
-	config_tc.counter_size = TC_COUNTER_SIZE_16BIT;
-	config_tc.clock_source = gclk; /* 8 MHz */
-	config_tc.clock_prescaler = EMBX_IR_RX_PHY_PRESCALER;  /* 8 us per tick  */
+	config_tc.gclk = gclk; /* 8 MHz */
+	config_tc.prescaler = EMBX_IR_RX_PHY_DIV_FACTOR;  /* 8 us per tick  */
 	
-	tc_init(&tc_instance_ir_rx_phy, TC_IR_RX_PHY_MODULE, &config_tc);
-	tc_enable(&tc_instance_ir_rx_phy);
-	tc_stop_counter(&tc_instance_ir_rx_phy);
+	embx_hal_tc_init(TC_IR_RX_PHY_MODULE, &config_tc);
 
 	embx_time_configure_tc_callbacks();
 }
@@ -273,7 +292,7 @@ static void embx_ir_rx_phy_tc_init(enum gclk_generator gclk)
 */
 void embx_ir_rx_phy_stop_timer(void)
 {
-	tc_stop_counter(&tc_instance_ir_rx_phy);
+	embx_hal_tc_stop(TC_IR_RX_PHY_MODULE);
 }
 
 /**
@@ -281,9 +300,9 @@ void embx_ir_rx_phy_stop_timer(void)
 */
 void embx_ir_rx_phy_start_timer(embx_ir_rx_phy_timeout_t timeout)
 {
-	tc_stop_counter(&tc_instance_ir_rx_phy);
-	tc_set_compare_value(&tc_instance_ir_rx_phy, TC_COMPARE_CAPTURE_CHANNEL_0, timeout);  /* 20 ms = 8 us per tick * x ticks, x = 20 e3 / 8 e6 */
-	tc_start_counter(&tc_instance_ir_rx_phy);
+	embx_hal_tc_stop(TC_IR_RX_PHY_MODULE);
+	embx_hal_tc_set_compare(TC_IR_RX_PHY_MODULE, 0, timeout);  /* 20 ms = 8 us per tick * x ticks, x = 20 e3 / 8 e6 */
+	embx_hal_tc_start(TC_IR_RX_PHY_MODULE);
 }
 
 /**
@@ -291,8 +310,8 @@ void embx_ir_rx_phy_start_timer(embx_ir_rx_phy_timeout_t timeout)
 */
 void embx_ir_rx_phy_restart_timer(embx_ir_rx_phy_timeout_t timeout)
 {
-	tc_set_compare_value(&tc_instance_ir_rx_phy, TC_COMPARE_CAPTURE_CHANNEL_0, timeout);  /* 20 ms = 8 us per tick * x ticks, x = 20 e3 / 8 e6 */
-	tc_start_counter(&tc_instance_ir_rx_phy);
+	embx_hal_tc_set_compare(TC_IR_RX_PHY_MODULE, 0, timeout);  /* 20 ms = 8 us per tick * x ticks, x = 20 e3 / 8 e6 */
+	embx_hal_tc_start(TC_IR_RX_PHY_MODULE);
 }
 
 /**
@@ -305,23 +324,48 @@ void embx_ir_rx_phy_init(void)
 	embx_ir_rx_gpio_init();	
 }
 
+/**
+* @brief Sets the time that the receiver stretches a mark, it is removed from the time_us of every mark and added to 
+* the time_us of every space that follows.  Measured by embx_ir_calibrate.
+*/
+void embx_ir_rx_phy_set_mark_stretch(int16_t usec)
+{
+	embx_ir_rx_phy_mark_stretch_usec = usec;
+}
+
+int16_t embx_ir_rx_phy_get_mark_stretch(void)
+{
+	return embx_ir_rx_phy_mark_stretch_usec;
+}
+
+/**
+* @brief Returns the state of the state machine, e.g. to follow it in a waveform.
+*/
+embx_ir_rx_phy_state_t embx_ir_rx_phy_get_state(void)
+{
+	return embx_ir_rx_phy_state;
+}
+
 void embx_ir_rx_phy_reset(void)
 {
-	tc_disable(&tc_instance_ir_rx_phy);
-	tc_reset(&tc_instance_ir_rx_phy);
+	embx_hal_tc_disable(TC_IR_RX_PHY_MODULE);
+	embx_hal_tc_reset(TC_IR_RX_PHY_MODULE);
 }
 
 void embx_ir_rx_phy_enable(void)
 {	
 	embx_ir_rx_phy_buf_init();	
 	embx_ir_rx_phy_state = EMBX_IR_RX_PHY_STATE_SYNCRONIZE;		
+	embx_ir_rx_phy_timer_overflow.mark = 0; /** A reception cut short by embx_ir_rx_phy_disable leaves them counting */
+	embx_ir_rx_phy_timer_overflow.space = 0;
+	embx_hal_tc_enable(TC_IR_RX_PHY_MODULE); /** embx_ir_rx_phy_disable disables the TC */
 	embx_ir_rx_phy_start_timer(EMBX_IR_RX_PHY_SYNC_DELAY);
 	embx_ir_rx_gpio_enable();	
 }
 
 void embx_ir_rx_phy_disable(void)
 {
-	tc_disable(&tc_instance_ir_rx_phy);
+	embx_hal_tc_disable(TC_IR_RX_PHY_MODULE);
 	embx_ir_rx_gpio_disable();
 }
 
@@ -14,11 +14,10 @@
 /**
 * @brief Define the timer counter used by the module.
 */
-#define TC_IR_RX_PHY_MODULE					TC5
+#define TC_IR_RX_PHY_MODULE					EMBX_HAL_TC5
 
 /** @brief The TC uses the 8 MHz input GCLK divided by the prescaler as it's clock */
-#define EMBX_IR_RX_PHY_PRESCALER			TC_CLOCK_PRESCALER_DIV64 /** Selected to give 125 kHz or 8 us per tick */
-#define EMBX_IR_RX_PHY_DIV_FACTOR			(64)
+#define EMBX_IR_RX_PHY_DIV_FACTOR			(64) /** Selected to give 125 kHz or 8 us per tick */
 #define EMBX_IR_RX_PHY_CLK_FREQ				(EMBX_IR_MODULATOR_GCLK / EMBX_IR_RX_PHY_DIV_FACTOR) /* 8000000 / 64 = 125 kHz */
 #define EMBX_IR_RX_PHY_USEC_PER_TICK		(8)   /* 64 / 8000000 */
 
@@ -111,6 +110,13 @@ extern void embx_ir_rx_phy_disable(void);
 /** @brief Handles the rx phy state machine logic 
     @params embx_ir_rx_event_t - an event that is handled based upon the current state. */
 extern void embx_rx_ir_phy_state_machine(embx_ir_rx_event_t event);
+/** @brief Sets the time in usec that the receiver stretches a mark and shortens the following space.
+    @details The time_us of the received intervals is corrected, ticks is kept as measured. */
+extern void embx_ir_rx_phy_set_mark_stretch(int16_t usec);
+extern int16_t embx_ir_rx_phy_get_mark_stretch(void);
+
+/** @brief Returns the state of the state machine. */
+extern embx_ir_rx_phy_state_t embx_ir_rx_phy_get_state(void);
 /** For testing ... */
 extern void embx_ir_rx_phy_tb(void);
 
@@ -0,0 +1,200 @@
+/**
+ * @file embx_ir_trace.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_trace module serializes the captures of the IR rx buffers into a compact binary trace.
+ * @details The writer works on a caller supplied buffer so a capture can be streamed out of the target as it is
+ * released, the reader works in place on a trace held in memory, e.g. mapped from a file by the host tools.
+ */
+#include "embx/embx_hal/embx_hal.h"
+#include <string.h>
+#include "embx/embx_ir/embx_ir_rx_phy.h"
+#include "embx/embx_ir/embx_ir_trace.h"
+
+static const uint8_t embx_ir_trace_magic[4] = { 'E', 'I', 'R', 'T' };
+
+/**
+* @brief Returns the number of bytes of the varint of a value.
+*/
+static inline uint8_t embx_ir_trace_varint_len(uint64_t value)
+{
+	uint8_t len = 1;
+
+	while( value >= 0x80 ) {
+		value >>= 7;
+		len++;
+	}
+	return len;
+}
+
+/**
+* @brief Writes a varint, out has room for it.
+*/
+static inline uint8_t *embx_ir_trace_put_varint(uint8_t *out, uint64_t value)
+{
+	while( value >= 0x80 ) {
+		*out++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+/**
+* @brief Reads a varint of at most bits bits from data[*offset] up to data[end].
+* @returns false if it is truncated or too long.
+*/
+static inline bool embx_ir_trace_get_varint(const uint8_t *data, size_t end, size_t *offset, uint8_t bits, uint64_t *value)
+{
+	uint64_t v = 0;
+	uint8_t shift = 0;
+	uint8_t byte;
+
+	do {
+		if( (*offset >= end) || (shift >= bits) ) {
+			return false;
+		}
+		byte = data[(*offset)++];
+		v |= (uint64_t)(byte & 0x7F) << shift;
+		shift += 7;
+	} while( byte & 0x80 );
+
+	if( (bits < 64) && ((v >> bits) != 0) ) {
+		return false;
+	}
+	*value = v;
+	return true;
+}
+
+/**
+* @brief Returns the varint of an interval.
+*/
+static inline uint64_t embx_ir_trace_interval(const embx_ir_rx_buf_elem_t *elem)
+{
+	return ((uint64_t)elem->time_us << 1) | ((elem->gpio_state == EMBX_IR_RX_GPIO_STATE_SPACE) ? 1 : 0);
+}
+
+void embx_ir_trace_write_header(embx_ir_trace_writer_t *writer, uint8_t *out)
+{
+	memcpy(out, embx_ir_trace_magic, sizeof(embx_ir_trace_magic));
+	out[4] = EMBX_IR_TRACE_VERSION;
+	out[5] = EMBX_IR_TRACE_HEADER_SZ;
+	out[6] = 0; /** Flags */
+	out[7] = 0;
+	writer->timestamp_us = 0;
+}
+
+enum status_code embx_ir_trace_write(embx_ir_trace_writer_t *writer, const embx_ir_trace_record_t *record,
+									 const embx_ir_rx_buf_elem_t *elem, uint16_t size,
+									 uint8_t *out, size_t out_sz, size_t *len)
+{
+	uint64_t delta;
+	size_t payload;
+	uint8_t *p = out;
+	uint16_t i;
+
+	if( record->timestamp_us < writer->timestamp_us ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	delta = record->timestamp_us - writer->timestamp_us;
+
+	payload = embx_ir_trace_varint_len(delta) + 2 + embx_ir_trace_varint_len(record->carrier_hz) + embx_ir_trace_varint_len(size);
+	for( i = 0; i < size; i++ ) {
+		payload += embx_ir_trace_varint_len(embx_ir_trace_interval(&elem[i]));
+	}
+	if( (embx_ir_trace_varint_len(payload) + payload) > out_sz ) {
+		return STATUS_ERR_NO_MEMORY;
+	}
+
+	p = embx_ir_trace_put_varint(p, payload);
+	p = embx_ir_trace_put_varint(p, delta);
+	*p++ = record->status;
+	*p++ = record->quality;
+	p = embx_ir_trace_put_varint(p, record->carrier_hz);
+	p = embx_ir_trace_put_varint(p, size);
+	for( i = 0; i < size; i++ ) {
+		p = embx_ir_trace_put_varint(p, embx_ir_trace_interval(&elem[i]));
+	}
+
+	writer->timestamp_us = record->timestamp_us;
+	*len = (size_t)(p - out);
+	return STATUS_OK;
+}
+
+enum status_code embx_ir_trace_reader_init(embx_ir_trace_reader_t *reader, const uint8_t *data, size_t len)
+{
+	if( (len < EMBX_IR_TRACE_HEADER_SZ) || (memcmp(data, embx_ir_trace_magic, sizeof(embx_ir_trace_magic)) != 0) ||
+		(data[5] < EMBX_IR_TRACE_HEADER_SZ) || (data[5] > len) ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	if( data[4] > EMBX_IR_TRACE_VERSION ) {
+		return STATUS_ERR_UNSUPPORTED_DEV;
+	}
+	reader->data = data;
+	reader->len = len;
+	reader->offset = data[5]; /** The header length, a later header may be longer */
+	reader->version = data[4];
+	reader->timestamp_us = 0;
+	return STATUS_OK;
+}
+
+enum status_code embx_ir_trace_read(embx_ir_trace_reader_t *reader, embx_ir_trace_record_t *record)
+{
+	size_t offset = reader->offset;
+	size_t end;
+	uint64_t value;
+
+	if( offset >= reader->len ) {
+		return STATUS_NO_CHANGE;
+	}
+	if( (embx_ir_trace_get_varint(reader->data, reader->len, &offset, 32, &value) == false) || (value > (reader->len - offset)) ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	end = offset + (size_t)value;
+
+	if( embx_ir_trace_get_varint(reader->data, end, &offset, 64, &value) == false ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	record->timestamp_us = reader->timestamp_us + value;
+	if( (end - offset) < 2 ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	record->status = reader->data[offset++];
+	record->quality = reader->data[offset++];
+	if( embx_ir_trace_get_varint(reader->data, end, &offset, 32, &value) == false ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	record->carrier_hz = (uint32_t)value;
+	if( (embx_ir_trace_get_varint(reader->data, end, &offset, 16, &value) == false) || (value > (end - offset)) ) {
+		return STATUS_ERR_BAD_FORMAT; /** Every interval takes a byte at least */
+	}
+	record->size = (uint16_t)value;
+	record->intervals = &reader->data[offset];
+	record->intervals_len = end - offset; /** Includes the fields appended by a later writer */
+
+	reader->timestamp_us = record->timestamp_us;
+	reader->offset = end;
+	return STATUS_OK;
+}
+
+enum status_code embx_ir_trace_get_elems(const embx_ir_trace_record_t *record, embx_ir_rx_buf_elem_t *elem, uint16_t max)
+{
+	size_t offset = 0;
+	uint64_t value;
+	uint16_t i;
+
+	if( record->size > max ) {
+		return STATUS_ERR_OVERFLOW;
+	}
+	for( i = 0; i < record->size; i++ ) {
+		if( embx_ir_trace_get_varint(record->intervals, record->intervals_len, &offset, 33, &value) == false ) {
+			return STATUS_ERR_BAD_FORMAT;
+		}
+		elem[i].gpio_state = (value & 1) ? EMBX_IR_RX_GPIO_STATE_SPACE : EMBX_IR_RX_GPIO_STATE_MARK;
+		elem[i].time_us = (uint32_t)(value >> 1);
+		elem[i].ticks = elem[i].time_us / EMBX_IR_RX_PHY_USEC_PER_TICK;
+	}
+	return STATUS_OK;
+}
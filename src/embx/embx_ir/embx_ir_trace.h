@@ -0,0 +1,110 @@
+/**
+ * @file embx_ir_trace.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_ir_trace module serializes the captures of the IR rx buffers into a compact binary trace.
+ * @details A trace is a header followed by one record per capture, all fields are little endian or LEB128 varints:
+ *
+ *   header:  'E' 'I' 'R' 'T', version, header length, flags, reserved
+ *   record:  varint length of the rest of the record
+ *            varint usec since the timestamp of the previous record (since 0 for the first)
+ *            status, the enum status_code of the rx buffer
+ *            quality, 0 to 100 or EMBX_IR_TRACE_QUALITY_UNKNOWN
+ *            varint carrier frequency in Hz, 0 if unknown
+ *            varint number of intervals
+ *            varint per interval: (usec << 1) | 1 for a SPACE, 0 for a MARK
+ *
+ * A reader skips the bytes of a record or a header it does not know, so fields can be appended without changing the
+ * version.  The version changes when the meaning of an existing field changes, a reader rejects a later version.
+ * A NEC frame takes about 100 bytes against 2 KB for the rx buffer.
+ */
+#ifndef EMBX_IR_TRACE_H_
+#define EMBX_IR_TRACE_H_
+
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+
+#define EMBX_IR_TRACE_VERSION				(1)
+#define EMBX_IR_TRACE_HEADER_SZ				(8)
+/** The quality of a capture that has not been graded */
+#define EMBX_IR_TRACE_QUALITY_UNKNOWN		(0xFF)
+/** The most bytes taken by a varint of 32 and 64 bits */
+#define EMBX_IR_TRACE_VARINT32_SZ			(5)
+#define EMBX_IR_TRACE_VARINT64_SZ			(10)
+/** The most bytes taken by a record of size intervals */
+#define EMBX_IR_TRACE_RECORD_MAX_SZ(size)	(EMBX_IR_TRACE_VARINT32_SZ + EMBX_IR_TRACE_VARINT64_SZ + 2 + \
+											 (2 * EMBX_IR_TRACE_VARINT32_SZ) + ((size) * EMBX_IR_TRACE_VARINT32_SZ))
+
+/**
+* @brief embx_ir_trace_record_t describes a capture.
+* @details The intervals stay encoded in the trace, see embx_ir_trace_get_elems.
+*/
+typedef struct {
+	uint64_t timestamp_us; /** The time of the first edge of the capture */
+	uint8_t status; /** The status of the rx buffer */
+	uint8_t quality;
+	uint32_t carrier_hz;
+	uint16_t size; /** The number of intervals */
+	const uint8_t *intervals; /** The encoded intervals, set by embx_ir_trace_read */
+	size_t intervals_len;
+} embx_ir_trace_record_t;
+
+/**
+* @brief embx_ir_trace_writer_t holds the timestamp of the previous record written.
+*/
+typedef struct {
+	uint64_t timestamp_us;
+} embx_ir_trace_writer_t;
+
+/**
+* @brief embx_ir_trace_reader_t walks the records of a trace held in memory.
+*/
+typedef struct {
+	const uint8_t *data;
+	size_t len;
+	size_t offset; /** The offset of the next record */
+	uint8_t version;
+	uint64_t timestamp_us; /** The timestamp of the previous record read */
+} embx_ir_trace_reader_t;
+
+/**
+* @brief Writes the header of a trace and resets the writer.
+* @params out - receives EMBX_IR_TRACE_HEADER_SZ bytes.
+*/
+extern void embx_ir_trace_write_header(embx_ir_trace_writer_t *writer, uint8_t *out);
+
+/**
+* @brief Writes the record of a capture.
+* @params record - the timestamp, status, quality, and carrier frequency.  The intervals are taken from elem.
+* @params elem, size - the elements of an IR rx buffer.
+* @params out, out_sz - receives the record, EMBX_IR_TRACE_RECORD_MAX_SZ(size) bytes are always enough.
+* @params len - receives the number of bytes written.
+* @returns STATUS_OK, STATUS_ERR_INVALID_ARG if the timestamp is earlier than the previous one, or
+*          STATUS_ERR_NO_MEMORY if out_sz is too small.
+*/
+extern enum status_code embx_ir_trace_write(embx_ir_trace_writer_t *writer, const embx_ir_trace_record_t *record,
+											const embx_ir_rx_buf_elem_t *elem, uint16_t size,
+											uint8_t *out, size_t out_sz, size_t *len);
+
+/**
+* @brief Checks the header of a trace.
+* @returns STATUS_OK, STATUS_ERR_BAD_FORMAT if it is not a trace, or STATUS_ERR_UNSUPPORTED_DEV if its version is later.
+*/
+extern enum status_code embx_ir_trace_reader_init(embx_ir_trace_reader_t *reader, const uint8_t *data, size_t len);
+
+/**
+* @brief Reads the next record.
+* @returns STATUS_OK, STATUS_NO_CHANGE at the end of the trace, or STATUS_ERR_BAD_FORMAT if the record is truncated
+*          or corrupt.  The reader does not move past a corrupt record.
+*/
+extern enum status_code embx_ir_trace_read(embx_ir_trace_reader_t *reader, embx_ir_trace_record_t *record);
+
+/**
+* @brief Decodes the intervals of a record into rx buffer elements.
+* @params elem, max - receives at most max elements.
+* @returns STATUS_OK, STATUS_ERR_OVERFLOW if the record has more than max intervals, or STATUS_ERR_BAD_FORMAT.
+*/
+extern enum status_code embx_ir_trace_get_elems(const embx_ir_trace_record_t *record, embx_ir_rx_buf_elem_t *elem, uint16_t max);
+
+#endif /* EMBX_IR_TRACE_H_ */
@@ -0,0 +1,163 @@
+/**
+ * @file embx_ir_tx_emitters.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Transmits on several IR emitters at the same time, e.g. one per indoor unit.
+ * @details TC3 runs as a 16-bit match frequency timer.  Each period lasts until the next emitter reaches the end of
+ * one of its timer periods, the interrupt advances the multiplexer, switches the carrier of the emitters whose 
+ * interval has changed, and programs the next period.  A send while the timer runs restarts it after the ticks 
+ * elapsed so far have been accounted to the emitters.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_modulator.h"
+#include "embx/embx_ir/embx_ir_tx_mux.h"
+#include "embx/embx_ir/embx_ir_tx_emitters.h"
+
+/** @brief The schedule of the emitters */
+static embx_ir_tx_mux_t mux;
+
+/** The ticks of the current timer period, 0 while the timer is stopped */
+static volatile uint32_t armed = 0;
+
+/**
+* @brief Switches the carrier of the emitters whose interval has changed.
+*/
+static void embx_ir_tx_emitters_apply(uint8_t changed)
+{
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		if( (changed & (1 << channel)) == 0 ) {
+			continue;
+		}
+		if( mux.type[channel] == mark ) {
+			embx_ir_tx_modulator_start_ch(channel);
+		} else {
+			embx_ir_tx_modulator_stop_ch(channel);
+		}
+	}
+}
+
+/**
+* @brief Programs the timer up to the end of the next period of an emitter, stops it when no emitter is active.
+* @details The counter has been running since the match for the latency of the interrupt.  If it has already passed 
+* the new top value it would run on to its maximum, so that period is accounted at once and the counter is moved 
+* back by its ticks.
+*/
+static void embx_ir_tx_emitters_arm(void)
+{
+	uint32_t count;
+
+	armed = embx_ir_tx_mux_get_ticks(&mux);
+	while( armed != 0 ) {
+		embx_hal_tc_set_top(EMBX_IR_TX_EMITTERS_TC_MODULE, armed - 1);
+		count = embx_hal_tc_get_count(EMBX_IR_TX_EMITTERS_TC_MODULE);
+		if( count < armed ) {
+			return;
+		}
+		embx_hal_tc_set_count(EMBX_IR_TX_EMITTERS_TC_MODULE, count - armed);
+		embx_ir_tx_emitters_apply(embx_ir_tx_mux_advance(&mux, armed));
+		armed = embx_ir_tx_mux_get_ticks(&mux);
+	}
+	embx_hal_tc_stop(EMBX_IR_TX_EMITTERS_TC_MODULE);
+}
+
+/**
+* @brief The callback occurs when TC3 matches CC0, the counter has wrapped and runs the next period.
+*/
+static void tc_callback_ir_tx_emitters(embx_hal_tc_t tc)
+{
+	embx_ir_tx_emitters_apply(embx_ir_tx_mux_advance(&mux, armed));
+	embx_ir_tx_emitters_arm();
+}
+
+/**
+* @brief Initializes TC3 and the modulator.
+*/
+void embx_ir_tx_emitters_init(uint32_t carrier_hz)
+{
+	embx_hal_tc_config_t config_tc;
+
+	embx_hal_tc_get_config_defaults(&config_tc);
+	config_tc.wave = EMBX_HAL_TC_WAVE_MATCH_FREQ;
+	config_tc.gclk = EMBX_IR_MODULATOR_GCLK; /* 8 MHz */
+	config_tc.prescaler = EMBX_IR_TX_PHY_DIV_FACTOR;  /* 8 us per tick  */
+
+	embx_hal_tc_init(EMBX_IR_TX_EMITTERS_TC_MODULE, &config_tc);
+
+	embx_hal_tc_register_callback(EMBX_IR_TX_EMITTERS_TC_MODULE, EMBX_HAL_TC_CALLBACK_CC0, tc_callback_ir_tx_emitters);
+	embx_hal_tc_enable_callback(EMBX_IR_TX_EMITTERS_TC_MODULE, EMBX_HAL_TC_CALLBACK_CC0);
+
+	embx_ir_tx_modulator_init(EMBX_IR_MODULATOR_GCLK, carrier_hz, false);
+	embx_ir_tx_mux_init(&mux);
+	armed = 0;
+}
+
+/**
+* @brief Returns true while a transmission is in progress on an emitter.
+*/
+bool embx_ir_tx_emitters_get_state(uint8_t channel)
+{
+	return (mux.active & (1 << channel)) != 0;
+}
+
+/**
+* @brief Transmits the descriptor queue of an emitter.
+* @details If the timer runs, the ticks it has counted are accounted to the other emitters before the emitter joins
+* the schedule.  The count is read before the timer is stopped, stopping resets it.  A match that is pending is 
+* accounted as the whole period.
+*/
+enum status_code embx_ir_tx_emitters_send(uint8_t channel)
+{
+	enum status_code status;
+	uint32_t elapsed;
+
+	embx_hal_enter_critical_section();
+	if( armed != 0 ) {
+		elapsed = embx_hal_tc_get_count(EMBX_IR_TX_EMITTERS_TC_MODULE);
+		embx_hal_tc_stop(EMBX_IR_TX_EMITTERS_TC_MODULE);
+		if( embx_hal_tc_get_match(EMBX_IR_TX_EMITTERS_TC_MODULE, 0) == true ) { /** Its interrupt is not served */
+			elapsed += armed;
+		}
+		embx_ir_tx_emitters_apply(embx_ir_tx_mux_advance(&mux, elapsed));
+	}
+
+	status = embx_ir_tx_mux_start(&mux, channel);
+	if( (status == STATUS_OK) && (mux.type[channel] == mark) ) {
+		embx_ir_tx_modulator_start_ch(channel);
+	}
+
+	embx_hal_tc_set_count(EMBX_IR_TX_EMITTERS_TC_MODULE, 0);
+	embx_ir_tx_emitters_arm();
+	if( armed != 0 ) {
+		embx_hal_tc_start(EMBX_IR_TX_EMITTERS_TC_MODULE);
+	}
+	embx_hal_leave_critical_section();
+
+	return status;
+}
+
+/** @brief Test bench, emitter 0 transmits the pattern of embx_time_tb, emitter 1 a slower one */
+void embx_ir_tx_emitters_tb(void)
+{
+	embx_ir_tx_emitters_init(KHz_38);
+
+	while(1) {
+		if( embx_ir_tx_emitters_get_state(0) == false ) {
+			embx_ir_tx_phy_descriptor_fill_ch(0, true, mark, 384, 0, 0);
+			embx_ir_tx_phy_descriptor_fill_ch(0, false, space, 1192, 1, 2);
+			embx_ir_tx_emitters_send(0);
+		}
+		if( embx_ir_tx_emitters_get_state(1) == false ) {
+			embx_ir_tx_phy_descriptor_fill_ch(1, true, mark, 9000, 0, 0);
+			embx_ir_tx_phy_descriptor_fill_ch(1, false, space, 4500, 0, 0);
+			embx_ir_tx_phy_descriptor_fill_ch(1, false, mark, 560, 0, 0);
+			embx_ir_tx_emitters_send(1);
+		}
+		embx_hal_delay_ms(7);
+	}
+}
@@ -0,0 +1,39 @@
+/**
+ * @file embx_ir_tx_emitters.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Transmits on several IR emitters at the same time, e.g. one per indoor unit.
+ * @details Each emitter plays its own descriptor queue, filled with embx_ir_tx_phy_descriptor_fill_ch.  TC3 times
+ * the intervals of all emitters through embx_ir_tx_mux and the emitters share the carrier of the modulator, each
+ * emitter switches its own pin.  A transmission may start on one emitter while the others are transmitting.
+ * Use this module instead of embx_ir_tx_phy, both use TC3.
+ */ 
+#ifndef EMBX_IR_TX_EMITTERS_H_
+#define EMBX_IR_TX_EMITTERS_H_
+
+/** The interval timer */
+#define EMBX_IR_TX_EMITTERS_TC_MODULE		EMBX_HAL_TC3
+
+/**
+* @brief Initializes TC3 and the modulator.
+* @params carrier_hz - the carrier frequency shared by the emitters.
+*/
+extern void embx_ir_tx_emitters_init(uint32_t carrier_hz);
+
+/**
+* @brief Returns true while a transmission is in progress on an emitter.
+*/
+extern bool embx_ir_tx_emitters_get_state(uint8_t channel);
+
+/**
+* @brief Transmits the descriptor queue of an emitter.
+* @returns STATUS_OK, STATUS_BUSY if the emitter is transmitting, or STATUS_ERR_BAD_DATA if its queue is empty.
+*/
+extern enum status_code embx_ir_tx_emitters_send(uint8_t channel);
+
+/** @brief - Test bench for the module. */
+extern void embx_ir_tx_emitters_tb(void);
+
+#endif /* EMBX_IR_TX_EMITTERS_H_ */
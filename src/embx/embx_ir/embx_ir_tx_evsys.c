@@ -0,0 +1,224 @@
+/**
+ * @file embx_ir_tx_evsys.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Event gated IR transmission: the overflow event of the interval timer starts and stops the carrier.
+ * @details The EVSYS channel carries the TC3 overflow.  Before each overflow the channel is connected to the TCC1
+ * retrigger input, to the TCC1 stop input, or to neither while a long interval continues.  TC3 is never stopped
+ * during a transmission so the interrupt latency does not add up from one interval to the next.
+ * There are no ASF drivers for the TCC and the EVSYS in the project, their registers are accessed directly.
+ */ 
+#include <asf.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_gate.h"
+#include "embx/embx_ir/embx_ir_tx_evsys.h"
+
+/** @brief The TC used to time the intervals. */
+static struct tc_module tc_instance_ir_tx_evsys;
+
+/** @brief The plan of the transmission */
+static embx_ir_tx_gate_t gate;
+
+/** Set by the send function and cleared by the interrupt of the last overflow. */
+static volatile bool embx_ir_tx_evsys_in_progress = false;
+
+/**
+* @brief Waits until the registers of the TCC are synchronized.
+*/
+static inline void embx_ir_tx_evsys_tcc_sync(void)
+{
+	while( EMBX_IR_TX_EVSYS_TCC_MODULE->SYNCBUSY.reg != 0 ) {
+		/* Wait */
+	}
+}
+
+/**
+* @brief Connects the EVSYS channel to the carrier input that the next overflow should act on.
+*/
+static void embx_ir_tx_evsys_route(embx_ir_tx_gate_action_t action)
+{
+	uint8_t start = (action == EMBX_IR_TX_GATE_START) ? (EMBX_IR_TX_EVSYS_CHANNEL + 1) : 0;
+	uint8_t stop = ((action == EMBX_IR_TX_GATE_STOP) || (action == EMBX_IR_TX_GATE_END)) ? (EMBX_IR_TX_EVSYS_CHANNEL + 1) : 0;
+
+	EVSYS->USER.reg = EVSYS_USER_USER(EMBX_IR_TX_EVSYS_TCC_USER_START) | EVSYS_USER_CHANNEL(start);
+	EVSYS->USER.reg = EVSYS_USER_USER(EMBX_IR_TX_EVSYS_TCC_USER_STOP) | EVSYS_USER_CHANNEL(stop);
+}
+
+/**
+* @brief Switches the carrier in software as the overflow event would have.
+*/
+static void embx_ir_tx_evsys_switch(embx_ir_tx_gate_action_t action)
+{
+	if( action == EMBX_IR_TX_GATE_START ) {
+		EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER;
+	} else if( (action == EMBX_IR_TX_GATE_STOP) || (action == EMBX_IR_TX_GATE_END) ) {
+		EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+	}
+}
+
+/**
+* @brief The callback occurs after each overflow of TC3, the carrier has already been switched by the event.
+* @details The period that has just started gets its top value and the next overflow gets its action.  The count is
+* read after the top value is written.  If it has passed the top value, the counter would run on to its maximum and
+* the overflow at the end of the period is lost: the carrier is switched in software, the counter is moved back by the
+* period, and the next period is programmed.  After the last overflow TC3 is stopped.
+*/
+static void tc_callback_ir_tx_evsys(struct tc_module *const module_inst)
+{
+	uint16_t top;
+	uint32_t count;
+	embx_ir_tx_gate_action_t action;
+
+	while( embx_ir_tx_gate_next(&gate, &top, &action) == STATUS_OK ) {
+		tc_set_compare_value(&tc_instance_ir_tx_evsys, TC_COMPARE_CAPTURE_CHANNEL_0, top);
+		embx_ir_tx_evsys_route(action);
+		count = tc_get_count_value(&tc_instance_ir_tx_evsys);
+		if( count <= top ) {
+			return;
+		}
+		tc_set_count_value(&tc_instance_ir_tx_evsys, count - (top + 1));
+		embx_ir_tx_evsys_switch(action);
+	}
+	tc_stop_counter(&tc_instance_ir_tx_evsys);
+	embx_ir_tx_evsys_route(EMBX_IR_TX_GATE_NONE);
+	embx_ir_tx_evsys_in_progress = false;
+}
+
+/**
+* @brief Initializes TC3 as a 16-bit match frequency timer that generates an event on each overflow.
+*/
+static void embx_ir_tx_evsys_tc_init(void)
+{
+	struct tc_config config_tc;
+	struct tc_events events_tc = { 0 };
+
+	tc_get_config_defaults(&config_tc);
+	config_tc.counter_size = TC_COUNTER_SIZE_16BIT;
+	config_tc.wave_generation = TC_WAVE_GENERATION_MATCH_FREQ;
+	config_tc.clock_source = EMBX_IR_MODULATOR_GCLK; /* 8 MHz */
+	config_tc.clock_prescaler = EMBX_IR_TX_PHY_PRESCALER;  /* 8 us per tick  */
+	
+	tc_init(&tc_instance_ir_tx_evsys, EMBX_IR_TX_EVSYS_TC_MODULE, &config_tc);
+	events_tc.generate_event_on_overflow = true;
+	tc_enable_events(&tc_instance_ir_tx_evsys, &events_tc);
+	tc_enable(&tc_instance_ir_tx_evsys);	
+	tc_stop_counter(&tc_instance_ir_tx_evsys);
+
+	tc_register_callback(&tc_instance_ir_tx_evsys, tc_callback_ir_tx_evsys, TC_CALLBACK_OVERFLOW);
+	tc_enable_callback(&tc_instance_ir_tx_evsys, TC_CALLBACK_OVERFLOW);
+}
+
+/**
+* @brief Initializes TCC1 as the carrier.  The event inputs retrigger and stop the counter, a stopped counter drives the output low.
+*/
+static void embx_ir_tx_evsys_tcc_init(uint32_t carrier_hz)
+{
+	struct system_gclk_chan_config gclk_chan_conf;
+	struct system_pinmux_config pin_conf;
+	uint32_t period = (EMBX_IR_MODULATOR_GCLK_FREQ + (carrier_hz / 2)) / carrier_hz;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, EMBX_IR_TX_EVSYS_TCC_APBCMASK);
+	system_gclk_chan_get_config_defaults(&gclk_chan_conf);
+	gclk_chan_conf.source_generator = EMBX_IR_MODULATOR_GCLK;
+	system_gclk_chan_set_config(EMBX_IR_TX_EVSYS_TCC_GCLK_ID, &gclk_chan_conf);
+	system_gclk_chan_enable(EMBX_IR_TX_EVSYS_TCC_GCLK_ID);
+
+	EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLA.reg = TCC_CTRLA_SWRST;
+	while( (EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLA.reg & TCC_CTRLA_SWRST) != 0 ) {
+		/* Wait */
+	}
+	EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLA.reg = TCC_CTRLA_PRESCALER_DIV1;
+	EMBX_IR_TX_EVSYS_TCC_MODULE->EVCTRL.reg = TCC_EVCTRL_EVACT0_RETRIGGER | TCC_EVCTRL_EVACT1_STOP | 
+											  TCC_EVCTRL_TCEI0 | TCC_EVCTRL_TCEI1;
+	EMBX_IR_TX_EVSYS_TCC_MODULE->DRVCTRL.reg = TCC_DRVCTRL_NRE0; /* Low while stopped, NRV0 = 0 */
+	EMBX_IR_TX_EVSYS_TCC_MODULE->WAVE.reg = TCC_WAVE_WAVEGEN_NPWM;
+	embx_ir_tx_evsys_tcc_sync();
+	EMBX_IR_TX_EVSYS_TCC_MODULE->PER.reg = TCC_PER_PER(period - 1);
+	embx_ir_tx_evsys_tcc_sync();
+	EMBX_IR_TX_EVSYS_TCC_MODULE->CC[EMBX_IR_TX_EVSYS_TCC_CHANNEL].reg = (period * EMBX_IR_TX_EVSYS_DUTY_PCT) / 100;
+	embx_ir_tx_evsys_tcc_sync();
+	EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLA.reg |= TCC_CTRLA_ENABLE;
+	embx_ir_tx_evsys_tcc_sync();
+	EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+	embx_ir_tx_evsys_tcc_sync();
+
+	system_pinmux_get_config_defaults(&pin_conf);
+	pin_conf.mux_position = EMBX_IR_TX_EVSYS_TCC_MUX;
+	pin_conf.direction = SYSTEM_PINMUX_PIN_DIR_OUTPUT;
+	system_pinmux_pin_set_config(EMBX_IR_TX_EVSYS_TCC_PIN, &pin_conf);
+}
+
+/**
+* @brief Initializes TC3, TCC1, the output pin, and the EVSYS.
+*/
+void embx_ir_tx_evsys_init(uint32_t carrier_hz)
+{
+	embx_ir_tx_evsys_tc_init();
+	embx_ir_tx_evsys_tcc_init(carrier_hz);
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_EVSYS);
+	EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(EMBX_IR_TX_EVSYS_CHANNEL) | EVSYS_CHANNEL_EVGEN(EMBX_IR_TX_EVSYS_EVGEN) |
+						 EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+	embx_ir_tx_evsys_route(EMBX_IR_TX_GATE_NONE);
+}
+
+/**
+* @brief Returns true while a transmission is in progress.
+*/
+bool embx_ir_tx_evsys_get_state(void)
+{
+	return embx_ir_tx_evsys_in_progress;
+}
+
+/**
+* @brief Transmits the IR Tx PHY descriptor queue.
+* @details The first interval is switched in software, it is the time reference of the transmission.
+*/
+enum status_code embx_ir_tx_evsys_send(void)
+{
+	embx_ir_tx_phy_interval_t type;
+	embx_ir_tx_gate_action_t action;
+	enum status_code status;
+	uint16_t top;
+
+	if( embx_ir_tx_evsys_in_progress == true ) {
+		return STATUS_BUSY;
+	}
+	status = embx_ir_tx_gate_first(&gate, &type, &top, &action);
+	if( status == STATUS_ERR_BAD_DATA ) {
+		return STATUS_OK; /* Nothing to send */
+	} else if( status != STATUS_OK ) {
+		return status;
+	}
+
+	embx_ir_tx_evsys_in_progress = true;
+	embx_ir_tx_evsys_route(action);
+	tc_set_compare_value(&tc_instance_ir_tx_evsys, TC_COMPARE_CAPTURE_CHANNEL_0, top);
+
+	system_interrupt_enter_critical_section();
+	if( type == mark ) {
+		EMBX_IR_TX_EVSYS_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER;
+	}
+	tc_start_counter(&tc_instance_ir_tx_evsys);
+	system_interrupt_leave_critical_section();
+
+	return STATUS_OK;
+}
+
+/** @brief Test bench, transmits the same pattern as embx_time_tb */
+void embx_ir_tx_evsys_tb(void)
+{
+	embx_ir_tx_evsys_init(38000);
+
+	while(1) {
+		if( embx_ir_tx_evsys_get_state() == false ) {
+			embx_ir_tx_phy_descriptor_fill(true, mark, 384, 0, 0);
+			embx_ir_tx_phy_descriptor_fill(false, space, 1192, 1, 2);
+			embx_ir_tx_evsys_send();
+		}
+		delay_ms(20);
+	}
+}
@@ -0,0 +1,62 @@
+/**
+ * @file embx_ir_tx_evsys.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Event gated IR transmission: the overflow event of the interval timer starts and stops the carrier.
+ * @details TC3 times the intervals and runs freely, its overflow event is routed by the EVSYS to the carrier.  The
+ * mark/space edges are aligned to the timer in hardware, the interrupt that follows an overflow only preloads the
+ * next period and routes the next event.  Use this module instead of embx_ir_tx_phy, both use TC3.
+ *
+ * A TC cannot be stopped by an event on the SAMD21, it can only be started.  The carrier is therefore generated by
+ * TCC1, whose event inputs can retrigger (MARK) and stop (SPACE) the counter.  A stopped TCC1 drives its output low.
+ */ 
+#ifndef EMBX_IR_TX_EVSYS_H_
+#define EMBX_IR_TX_EVSYS_H_
+
+/** The interval timer */
+#define EMBX_IR_TX_EVSYS_TC_MODULE			TC3
+#define EMBX_IR_TX_EVSYS_EVGEN				EVSYS_ID_GEN_TC3_OVF
+
+/** The carrier: TCC1 WO0 on PA06 driven by CC0 */
+#define EMBX_IR_TX_EVSYS_TCC_MODULE			TCC1
+#define EMBX_IR_TX_EVSYS_TCC_GCLK_ID		TCC1_GCLK_ID
+#define EMBX_IR_TX_EVSYS_TCC_APBCMASK		PM_APBCMASK_TCC1
+#define EMBX_IR_TX_EVSYS_TCC_USER_START		EVSYS_ID_USER_TCC1_EV_0
+#define EMBX_IR_TX_EVSYS_TCC_USER_STOP		EVSYS_ID_USER_TCC1_EV_1
+#define EMBX_IR_TX_EVSYS_TCC_PIN			PIN_PA06E_TCC1_WO0
+#define EMBX_IR_TX_EVSYS_TCC_MUX			MUX_PA06E_TCC1_WO0
+#define EMBX_IR_TX_EVSYS_TCC_CHANNEL		(0)
+
+/** The EVSYS channel, it uses the asynchronous path and needs no GCLK */
+#define EMBX_IR_TX_EVSYS_CHANNEL			(0)
+
+/** The duty cycle of the carrier during a MARK */
+#define EMBX_IR_TX_EVSYS_DUTY_PCT			(33)
+
+/**
+* @brief Initializes TC3, TCC1, the output pin, and the EVSYS.
+* @params carrier_hz - the carrier frequency, both timers are clocked by EMBX_IR_MODULATOR_GCLK.
+*/
+extern void embx_ir_tx_evsys_init(uint32_t carrier_hz);
+
+/**
+* @brief Returns true while a transmission is in progress.
+*/
+extern bool embx_ir_tx_evsys_get_state(void);
+
+/**
+* @brief Transmits the IR Tx PHY descriptor queue.
+* @details Every interval must be longer than the latency of the interrupt, EMBX_IR_TX_GATE_LATENCY_USEC, the top
+* value of a period is written after it has started.  A period of a stream that is programmed late is recovered by
+* the interrupt, its edge is switched in software and is late by the latency.
+* @returns STATUS_OK, STATUS_BUSY if a transmission is in progress, or STATUS_ERR_INVALID_ARG if an interval in the
+* queue is too short.
+*/
+extern enum status_code embx_ir_tx_evsys_send(void);
+
+/** @brief - Test bench for the module. */
+extern void embx_ir_tx_evsys_tb(void);
+
+#endif /* EMBX_IR_TX_EVSYS_H_ */
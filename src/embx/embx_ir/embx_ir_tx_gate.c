@@ -0,0 +1,68 @@
+/**
+ * @file embx_ir_tx_gate.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Plans the timer periods and the carrier gate actions of an event gated IR transmission.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_tx_gate.h"
+
+/**
+* @brief Fetches the period after the next overflow from the descriptor queue.
+* @details A long interval continues with the same top value, a new interval switches the carrier.
+*/
+static void embx_ir_tx_gate_fetch(embx_ir_tx_gate_t *gate)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+
+	switch( embx_ir_tx_phy_descriptor_next(&pd) ) {
+		case STATUS_OK:
+			gate->top = pd->period;
+			gate->action = (pd->phy_interval_type == mark) ? EMBX_IR_TX_GATE_START : EMBX_IR_TX_GATE_STOP;
+		break;
+		case STATUS_NO_CHANGE:
+			gate->action = EMBX_IR_TX_GATE_NONE;
+		break;
+		default:
+			gate->action = EMBX_IR_TX_GATE_END;
+		break;
+	}
+}
+
+/**
+* @brief Plans the first period of a transmission.
+* @details The periods filled later by a stream cannot be checked, the interrupt has to recover one it programs late.
+*/
+enum status_code embx_ir_tx_gate_first(embx_ir_tx_gate_t *gate, embx_ir_tx_phy_interval_t *type, uint16_t *top, embx_ir_tx_gate_action_t *action)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+
+	if( embx_ir_tx_phy_descriptor_get_min_period() < EMBX_IR_TX_GATE_TOP_MIN ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_ir_tx_phy_descriptor_next(&pd) != STATUS_OK ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	*type = pd->phy_interval_type;
+	*top = pd->period;
+	gate->top = pd->period;
+	embx_ir_tx_gate_fetch(gate);
+	*action = gate->action;
+	return STATUS_OK;
+}
+
+/**
+* @brief Plans the period that has started with an overflow.
+*/
+enum status_code embx_ir_tx_gate_next(embx_ir_tx_gate_t *gate, uint16_t *top, embx_ir_tx_gate_action_t *action)
+{
+	if( gate->action == EMBX_IR_TX_GATE_END ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	*top = gate->top;
+	embx_ir_tx_gate_fetch(gate);
+	*action = gate->action;
+	return STATUS_OK;
+}
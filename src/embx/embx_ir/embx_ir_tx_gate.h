@@ -0,0 +1,60 @@
+/**
+ * @file embx_ir_tx_gate.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Plans the timer periods and the carrier gate actions of an event gated IR transmission.
+ * @details In an event gated transmission the interval timer runs freely and its overflow event switches the carrier
+ * in hardware.  The interrupt that follows an overflow has to program the top value of the period that has just
+ * started and the action of the next overflow.  The planner turns the IR Tx PHY descriptor queue into these steps,
+ * it looks one period ahead.  It is portable so the timeline can be replayed on the host.
+ */ 
+#ifndef EMBX_IR_TX_GATE_H_
+#define EMBX_IR_TX_GATE_H_
+
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+/** The longest latency of the interrupt that programs a period in usec, the top value is written after the period has started */
+#define EMBX_IR_TX_GATE_LATENCY_USEC		(40)
+/** The smallest top value of a period, the counter must not have passed it when the interrupt writes it */
+#define EMBX_IR_TX_GATE_TOP_MIN				((EMBX_IR_TX_GATE_LATENCY_USEC / EMBX_IR_TX_PHY_USEC_PER_TICK) + 1)
+
+/**
+* @brief Enumerates what the overflow event at the end of a period does to the carrier.
+*/
+typedef enum {
+	EMBX_IR_TX_GATE_NONE = 0, /** The interval continues, the event is not routed to the carrier */
+	EMBX_IR_TX_GATE_START, /** A MARK starts */
+	EMBX_IR_TX_GATE_STOP, /** A SPACE starts */
+	EMBX_IR_TX_GATE_END, /** The transmission ends, the carrier is stopped */
+} embx_ir_tx_gate_action_t;
+
+/**
+* @brief embx_ir_tx_gate_t holds the period after the next overflow.
+*/
+typedef struct {
+	uint16_t top; /** The top value of the period that starts with the next overflow */
+	embx_ir_tx_gate_action_t action; /** The action of the next overflow */
+} embx_ir_tx_gate_t;
+
+/**
+* @brief Plans the first period of a transmission.
+* @params type - receives the type of the first interval, the caller switches the carrier for it.
+* @params top - receives the top value of the first period.
+* @params action - receives the action of the first overflow.
+* @returns STATUS_OK, STATUS_ERR_BAD_DATA if the queue is empty, or STATUS_ERR_INVALID_ARG if a period in the queue is
+* shorter than EMBX_IR_TX_GATE_TOP_MIN.  The queue is left as it is on an error.
+*/
+extern enum status_code embx_ir_tx_gate_first(embx_ir_tx_gate_t *gate, embx_ir_tx_phy_interval_t *type, uint16_t *top, embx_ir_tx_gate_action_t *action);
+
+/**
+* @brief Plans the period that has started with an overflow.  Called from the interrupt of the overflow.
+* @params top - receives the top value of the period.
+* @params action - receives the action of the overflow at the end of the period.
+* @returns STATUS_OK or STATUS_ERR_BAD_DATA if the overflow has ended the transmission.
+*/
+extern enum status_code embx_ir_tx_gate_next(embx_ir_tx_gate_t *gate, uint16_t *top, embx_ir_tx_gate_action_t *action);
+
+#endif /* EMBX_IR_TX_GATE_H_ */
@@ -5,51 +5,128 @@
  * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
  *
  * @brief This module pulse width modulates the pin defined by TC_PWM_OUT_PIN at a frequency suitable for IR.
- * @details 
+ * @details The TC runs as a 16-bit match PWM clocked by the GCLK: the top value in CC0 sets the carrier frequency and
+ * CC1 sets the duty cycle on the channel 1 output.  A lower duty cycle lets the LED be pulsed harder for the same 
+ * average current.  While the carrier is stopped the pin is taken from the TC and driven low, so a SPACE never 
+ * leaves the LED on whatever the phase of the PWM.  Each MARK starts with a full carrier period, see 
+ * embx_ir_tx_modulator_start_ch.  The edges are checked against a model of the TC by host/test/test_tx_modulator.c.
+ *
+ * Several emitters share the carrier, each has a pin of the PWM output that is connected during its MARKs.
  */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx_ir_common.h"
 #include "embx/embx_ir/embx_ir_tx_modulator.h"
 
-static struct tc_module tc_instance_ir_mod;
-static struct tc_config config_tc_ir_mod;
+static embx_hal_tc_config_t config_tc_ir_mod;
+
+#if TC_IR_MODULATOR_CHANNEL != TC4_CHANNEL_1
+#error The match PWM output of the modulator must be channel 1, channel 0 holds the top value
+#endif
 
+/** The carrier period in GCLK ticks and the duty cycle in percent */
+static uint32_t carrier_ticks = EMBX_IR_TX_MODULATOR_TICKS(KHz_38);
+static uint8_t carrier_duty_pct = EMBX_IR_TX_MODULATOR_DUTY_PCT;
 
-static void embx_ir_tx_modulator_set_config( enum gclk_generator gclk, embx_ir_tx_mod_freq_t ir_freq )
+/**
+* @brief Returns the compare value of the duty cycle, at least one tick.
+*/
+static uint16_t embx_ir_tx_modulator_duty_ticks(void)
 {
-	tc_get_config_defaults(&config_tc_ir_mod);
+	uint32_t ticks = ((carrier_ticks * carrier_duty_pct) + 50) / 100;
+
+	return (ticks == 0) ? 1 : (uint16_t)ticks;
+}
+
+/** The pin and the multiplexer setting of each emitter */
+static const uint8_t emitter_pin[EMBX_IR_TX_CHANNELS] = TC_IR_MODULATOR_PINS;
+static const uint8_t emitter_mux[EMBX_IR_TX_CHANNELS] = TC_IR_MODULATOR_MUXES;
+
+/** The emitters whose pin is connected, and those waiting for the low part of a period to be connected */
+static volatile uint8_t connected = 0;
+static volatile uint8_t pending = 0;
+
+/**
+* @brief Connects the pin to the TC while the carrier runs, otherwise the pin is a GPIO output driven low.
+*/
+static inline void embx_ir_tx_modulator_connect(uint8_t channel, bool connect)
+{
+	embx_hal_pin_enable_mux(emitter_pin[channel], connect);
+	if( connect == true ) {
+		connected |= (uint8_t)(1 << channel);
+	} else {
+		connected &= (uint8_t)~(1 << channel);
+	}
+}
 
-	config_tc_ir_mod.clock_source = gclk;
-	config_tc_ir_mod.counter_size = TC_COUNTER_SIZE_8BIT;
+/**
+* @brief Called when the output goes low in a period of the running carrier, the waiting emitters are connected.
+* @details The next update starts their MARK with a full pulse.
+*/
+static void embx_ir_tx_modulator_cc1_callback(embx_hal_tc_t tc)
+{
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		if( (pending & (1 << channel)) != 0 ) {
+			embx_ir_tx_modulator_connect(channel, true);
+		}
+	}
+	pending = 0;
+	embx_hal_tc_disable_callback(tc, EMBX_HAL_TC_CALLBACK_CC1);
+}
+
+static void embx_ir_tx_modulator_set_config( enum gclk_generator gclk, uint32_t ir_freq )
+{
+	embx_hal_tc_get_config_defaults(&config_tc_ir_mod);
+
+	if( ir_freq < EMBX_IR_TX_MODULATOR_MIN_HZ ) {
+		ir_freq = EMBX_IR_TX_MODULATOR_MIN_HZ;
+	} else if( ir_freq > EMBX_IR_TX_MODULATOR_MAX_HZ ) {
+		ir_freq = EMBX_IR_TX_MODULATOR_MAX_HZ;
+	}
+	carrier_ticks = EMBX_IR_TX_MODULATOR_TICKS(ir_freq);
+	carrier_duty_pct = EMBX_IR_TX_MODULATOR_DUTY_PCT;
+
+	config_tc_ir_mod.gclk = gclk;
 	
-	/* For 8-bit counter, NORMAL_FREQ toggles GPIO output pin every time the counter == period value */
-	/* Modulation Frequency = 8000000 / x */
-	config_tc_ir_mod.wave_generation = TC_WAVE_GENERATION_NORMAL_FREQ;
-	config_tc_ir_mod.counter_8_bit.period = ir_freq;
-	config_tc_ir_mod.pwm_channel[TC_IR_MODULATOR_CHANNEL].enabled = true;
-	config_tc_ir_mod.pwm_channel[TC_IR_MODULATOR_CHANNEL].pin_out = TC_IR_MODULATOR_PIN;
-	config_tc_ir_mod.pwm_channel[TC_IR_MODULATOR_CHANNEL].pin_mux = TC_IR_MODULATOR_MUX;	
+	/* The counter counts from 0 to CC0, the output of channel 1 is high from 0 until it matches CC1 */
+	/* Modulation Frequency = 8000000 / (CC0 + 1) */
+	config_tc_ir_mod.wave = EMBX_HAL_TC_WAVE_MATCH_PWM;
+	config_tc_ir_mod.cc[TC4_CHANNEL_0] = (uint16_t)(carrier_ticks - 1);
+	config_tc_ir_mod.cc[TC_IR_MODULATOR_CHANNEL] = embx_ir_tx_modulator_duty_ticks();
 }
 
 /**
 * @brief Initializes and enables the IR modulator.
 * @param gclk - specifies the clock from conf_clocks.h that the modulator will use 
-* @param ir_freq - enumerated value used to set the timer's period.
+* @param ir_freq - the carrier frequency in Hz, limited to EMBX_IR_TX_MODULATOR_MIN_HZ to _MAX_HZ.  The duty cycle
+* is set to EMBX_IR_TX_MODULATOR_DUTY_PCT.
 * @param start_counting - true if this function should start the counter counting.
 */
-void embx_ir_tx_modulator_init(enum gclk_generator gclk, embx_ir_tx_mod_freq_t ir_freq, bool start_counting )
+void embx_ir_tx_modulator_init(enum gclk_generator gclk, uint32_t ir_freq, bool start_counting )
 {	
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		/* The level of the pin while it is not connected to the TC */
+		embx_hal_pin_config_output(emitter_pin[channel], false);
+
+		/* Select the TC output, it is only enabled by connect */
+		embx_hal_pin_select_mux(emitter_pin[channel], emitter_mux[channel]);
+		embx_ir_tx_modulator_connect(channel, false);
+	}
+	pending = 0;
+
 	/* Set the configuration */
 	embx_ir_tx_modulator_set_config( gclk, ir_freq );
 
 	/* Initialize the timer hardware with the configuration */
-	tc_init(&tc_instance_ir_mod, TC_IR_MODULATOR_MODULE, &config_tc_ir_mod);
-
-	/* This enables the counter and starts the timer counting */
-	tc_enable(&tc_instance_ir_mod);
+	/* This enables the TC with the counter stopped */
+	embx_hal_tc_init(TC_IR_MODULATOR_MODULE, &config_tc_ir_mod);
+	embx_hal_tc_register_callback(TC_IR_MODULATOR_MODULE, EMBX_HAL_TC_CALLBACK_CC1, embx_ir_tx_modulator_cc1_callback);
 	
-	if( start_counting == false ) {
-		tc_stop_counter(&tc_instance_ir_mod);		
+	if( start_counting == true ) {
+		embx_ir_tx_modulator_start();
 	}		
 }
 
@@ -58,7 +135,7 @@ void embx_ir_tx_modulator_init(enum gclk_generator gclk, embx_ir_tx_mod_freq_t i
 */
 void embx_ir_tx_modulator_reset(void)
 {
-	tc_reset(&tc_instance_ir_mod);	
+	embx_hal_tc_reset(TC_IR_MODULATOR_MODULE);	
 }
 
 /**
@@ -67,7 +144,7 @@ void embx_ir_tx_modulator_reset(void)
 */
 void embx_ir_tx_modulator_enable(void)
 {
-	tc_enable(&tc_instance_ir_mod);
+	embx_hal_tc_enable(TC_IR_MODULATOR_MODULE);
 }
 
 /**
@@ -75,55 +152,107 @@ void embx_ir_tx_modulator_enable(void)
 */
 void embx_ir_tx_modulator_disable(void)
 {
-	tc_disable(&tc_instance_ir_mod);	
+	embx_hal_tc_disable(TC_IR_MODULATOR_MODULE);	
+}
+
+/**  
+* @brief Drives the pin of an emitter low.  The timer is stopped once no emitter is in a MARK.  
+* @details The output of the TC may be left high, it is not connected.
+*/
+void embx_ir_tx_modulator_stop_ch(uint8_t channel)
+{
+	embx_hal_enter_critical_section();
+	embx_ir_tx_modulator_connect(channel, false);
+	pending &= (uint8_t)~(1 << channel);
+	if( (connected == 0) && (pending == 0) ) {
+		embx_hal_tc_disable_callback(TC_IR_MODULATOR_MODULE, EMBX_HAL_TC_CALLBACK_CC1);
+		embx_hal_tc_stop(TC_IR_MODULATOR_MODULE);
+	}
+	embx_hal_leave_critical_section();
+}
+
+/**
+* @brief Starts the carrier of an emitter, the timer must be enabled first.  
+* @details If the timer is stopped, the counter is loaded with the top value so the first tick wraps it and the 
+* update sets the output.  Every MARK starts with a full carrier period whatever the level the output was left at 
+* by the last stop.  If another emitter is in a MARK, the pin is connected once the output is low and the MARK 
+* starts with the next period, i.e. at most one period late.
+*/
+void embx_ir_tx_modulator_start_ch(uint8_t channel)
+{
+	embx_hal_enter_critical_section();
+	if( (connected == 0) && (pending == 0) ) {
+		embx_hal_tc_set_count(TC_IR_MODULATOR_MODULE, carrier_ticks - 1);
+		embx_hal_tc_start(TC_IR_MODULATOR_MODULE);
+		embx_ir_tx_modulator_connect(channel, true);
+	} else if( (connected & (1 << channel)) == 0 ) {
+		pending |= (uint8_t)(1 << channel);
+		embx_hal_tc_clear_match(TC_IR_MODULATOR_MODULE, TC_IR_MODULATOR_CHANNEL); /** Only a match from now on */
+		embx_hal_tc_enable_callback(TC_IR_MODULATOR_MODULE, EMBX_HAL_TC_CALLBACK_CC1);
+	}
+	embx_hal_leave_critical_section();
 }
 
-/**  @brief Stops the timer and resets it to 0.*/
+/**  @brief Drives the pin of emitter 0 low, see embx_ir_tx_modulator_stop_ch.*/
 void embx_ir_tx_modulator_stop(void)
 {
-	tc_stop_counter(&tc_instance_ir_mod);
+	embx_ir_tx_modulator_stop_ch(0);
 }
 
 /**
-* @brief Starts the timer, it must be enabled first.
+* @brief Starts the carrier of emitter 0, see embx_ir_tx_modulator_start_ch.
 */
 void embx_ir_tx_modulator_start(void)
 {
-	tc_start_counter(&tc_instance_ir_mod);
+	embx_ir_tx_modulator_start_ch(0);
 }
 
 /**
-* @brief Modify the modulation frequency.  
-* @param[in] ir_freq the new frequency selected from the enumerated common
-* IR modulation frequencies.
-* The Frequency can be modified on the fly.
+* @brief Modify the modulation frequency.  The duty cycle in percent is kept.
+* @param[in] ir_freq the new frequency in Hz, e.g. one of the enumerated common IR modulation frequencies or the
+* carrier measured from a remote.
+* The TC does not buffer the compare values, change the frequency between two MARKs.
+* @returns STATUS_ERR_BAD_FRQ if the frequency is outside EMBX_IR_TX_MODULATOR_MIN_HZ to _MAX_HZ, otherwise STATUS_OK.
 */
-void embx_ir_tx_modulator_set_freq(embx_ir_tx_mod_freq_t ir_freq )
+enum status_code embx_ir_tx_modulator_set_freq(uint32_t ir_freq )
 {
-	tc_set_top_value(&tc_instance_ir_mod, ir_freq);
+	if( (ir_freq < EMBX_IR_TX_MODULATOR_MIN_HZ) || (ir_freq > EMBX_IR_TX_MODULATOR_MAX_HZ) ) {
+		return STATUS_ERR_BAD_FRQ;
+	}
+	carrier_ticks = EMBX_IR_TX_MODULATOR_TICKS(ir_freq);
+
+	config_tc_ir_mod.cc[TC4_CHANNEL_0] = (uint16_t)(carrier_ticks - 1);
+	config_tc_ir_mod.cc[TC_IR_MODULATOR_CHANNEL] = embx_ir_tx_modulator_duty_ticks();
+
+	embx_hal_tc_set_top(TC_IR_MODULATOR_MODULE, carrier_ticks - 1);
+	embx_hal_tc_set_compare(TC_IR_MODULATOR_MODULE, 1, embx_ir_tx_modulator_duty_ticks());
+
+	return STATUS_OK;
 }
 
-#if 0
 /**
-* @brief GPIO pin toggles every time the 8-bit counter overflows.
-* @details - The GPIO pin period is 1/2 of the 8=bit counter overflow. 
-* The frequency can be modified on the fly while the timer is running.
+* @brief Modify the duty cycle, i.e. the high part of each carrier period.
+* @param[in] duty_pct the duty cycle in percent, typically 25 to 33.
+* @returns STATUS_ERR_INVALID_ARG if the duty cycle is outside EMBX_IR_TX_MODULATOR_MIN_DUTY_PCT to _MAX_DUTY_PCT, 
+* otherwise STATUS_OK.
 */
-enum status_code embx_ir_tx_modulator_compute_and_set_freq(uint32_t ir_freq )
+enum status_code embx_ir_tx_modulator_set_duty(uint8_t duty_pct)
 {
-	uint32_t period =  (EMBX_IR_MODULATOR_GCLK_FREQ >> 1) / ir_freq;
-	
-	if( period > EMBX_IR_TX_MODULATOR_MAX_PERIOD ) {
-		period = EMBX_IR_TX_MODULATOR_MAX_PERIOD;
-	}	else if( period < EMBX_IR_TX_MODULATOR_MIN_PERIOD ) {
-		period = EMBX_IR_TX_MODULATOR_MIN_PERIOD;
+	if( (duty_pct < EMBX_IR_TX_MODULATOR_MIN_DUTY_PCT) || (duty_pct > EMBX_IR_TX_MODULATOR_MAX_DUTY_PCT) ) {
+		return STATUS_ERR_INVALID_ARG;
 	}
-	
-	config_tc_ir_mod.counter_8_bit.period = period;		
-	
-	tc_set_top_value(&tc_instance_ir_mod, period);
-	
-	return STATUS_OK;	
+	carrier_duty_pct = duty_pct;
+
+	config_tc_ir_mod.cc[TC_IR_MODULATOR_CHANNEL] = embx_ir_tx_modulator_duty_ticks();
+	embx_hal_tc_set_compare(TC_IR_MODULATOR_MODULE, 1, embx_ir_tx_modulator_duty_ticks());
+
+	return STATUS_OK;
 }
-#endif
 
+/**
+* @brief Returns the carrier frequency in Hz that is generated.
+*/
+uint32_t embx_ir_tx_modulator_get_freq(void)
+{
+	return EMBX_IR_MODULATOR_GCLK_FREQ / carrier_ticks;
+}
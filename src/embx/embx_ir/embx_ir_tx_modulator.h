@@ -7,8 +7,17 @@
 #ifndef EMBX_IR_TX_H_
 #define EMBX_IR_TX_H_
 
-#define EMBX_IR_TX_MODULATOR_MAX_PERIOD (255)
-#define EMBX_IR_TX_MODULATOR_MIN_PERIOD (25)
+/** The range of carrier frequencies in Hz */
+#define EMBX_IR_TX_MODULATOR_MIN_HZ		(30000)
+#define EMBX_IR_TX_MODULATOR_MAX_HZ		(60000)
+
+/** The range of duty cycles in percent, and the duty cycle selected by the init function */
+#define EMBX_IR_TX_MODULATOR_MIN_DUTY_PCT	(10)
+#define EMBX_IR_TX_MODULATOR_MAX_DUTY_PCT	(50)
+#define EMBX_IR_TX_MODULATOR_DUTY_PCT		(33)
+
+/** The period of a carrier frequency in GCLK ticks, rounded to the nearest tick */
+#define EMBX_IR_TX_MODULATOR_TICKS(hz)	((EMBX_IR_MODULATOR_GCLK_FREQ + ((hz) / 2)) / (hz))
 
 #define TC4_BOARD_A1				PIN_PB08E_TC4_WO0	/* Alternatively PA22 */
 #define TC4_BOARD_A2				PIN_PB09E_TC4_WO1   /* PB09 is BOARD_A2 - Alternatively PA23, BOARD_A2 */
@@ -17,21 +26,38 @@
 #define TC4_CHANNEL_0				(0)
 #define TC4_CHANNEL_1				(1)
 
-#define TC_IR_MODULATOR_MODULE			TC4
+#define TC4_ALT_A2					PIN_PA23E_TC4_WO1	/* The alternative pin of WO1 */
+#define TC4_ALT_A2_MUX				MUX_PA23E_TC4_WO1
+
+/** The carrier is a match PWM: CC0 holds the top value, the output of channel 1 carries the duty cycle */
+#define TC_IR_MODULATOR_MODULE			EMBX_HAL_TC4
 #define TC_IR_MODULATOR_PIN				TC4_BOARD_A2
 #define TC_IR_MODULATOR_MUX				TC4_BOARD_A2_MUX
 #define TC_IR_MODULATOR_CHANNEL			TC4_CHANNEL_1
 
+/** 
+* The pin of each IR emitter, see EMBX_IR_TX_CHANNELS.  WO0 cannot carry the PWM as CC0 holds the top value, so every
+* emitter is on a pin of WO1 and they share the carrier.  The carrier of an emitter is switched by connecting its pin.
+*/
+#define TC_IR_MODULATOR_PINS			{ TC_IR_MODULATOR_PIN, TC4_ALT_A2 }
+#define TC_IR_MODULATOR_MUXES			{ TC_IR_MODULATOR_MUX, TC4_ALT_A2_MUX }
+
 
-/** @brief Call to initialize and enable the modulator. */
-extern void embx_ir_tx_modulator_init(enum gclk_generator gclk, embx_ir_tx_mod_freq_t ir_freq, bool start_counting);
+/** @brief Call to initialize and enable the modulator.  The carrier frequency is in Hz, e.g. KHz_38. */
+extern void embx_ir_tx_modulator_init(enum gclk_generator gclk, uint32_t ir_freq, bool start_counting);
 extern void embx_ir_tx_modulator_reset(void);
 extern void embx_ir_tx_modulator_enable(void);
 extern void embx_ir_tx_modulator_disable(void);
+/** @brief Start and stop the carrier of emitter 0. */
 extern void embx_ir_tx_modulator_start(void);
 extern void embx_ir_tx_modulator_stop(void);
-extern void embx_ir_tx_modulator_set_freq(embx_ir_tx_mod_freq_t ir_freq );
-#if 0
-extern enum status_code embx_ir_tx_modulator_compute_and_set_freq(uint32_t ir_freq );
-#endif
-#endif /* EMBX_IR_TX_H_ */
\ No newline at end of file
+/** @brief Start and stop the carrier of an emitter.  The counter runs while any emitter is in a MARK. */
+extern void embx_ir_tx_modulator_start_ch(uint8_t channel);
+extern void embx_ir_tx_modulator_stop_ch(uint8_t channel);
+/** @brief Sets the carrier frequency in Hz.  Returns STATUS_ERR_BAD_FRQ if it is out of range. */
+extern enum status_code embx_ir_tx_modulator_set_freq(uint32_t ir_freq);
+/** @brief Sets the duty cycle in percent.  Returns STATUS_ERR_INVALID_ARG if it is out of range. */
+extern enum status_code embx_ir_tx_modulator_set_duty(uint8_t duty_pct);
+/** @brief Returns the carrier frequency in Hz that is generated, which differs from the one set by the rounding to GCLK ticks. */
+extern uint32_t embx_ir_tx_modulator_get_freq(void);
+#endif /* EMBX_IR_TX_H_ */
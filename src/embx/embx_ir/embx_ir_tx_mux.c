@@ -0,0 +1,106 @@
+/**
+ * @file embx_ir_tx_mux.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Multiplexes the interval timing of several IR emitters onto one timer.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_tx_mux.h"
+
+/**
+* @brief Fetches the next timer period of an emitter.
+* @returns true if the carrier of the emitter has to be switched.
+*/
+static bool embx_ir_tx_mux_fetch(embx_ir_tx_mux_t *mux, uint8_t channel)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	embx_ir_tx_phy_interval_t type = mux->type[channel];
+
+	switch( embx_ir_tx_phy_descriptor_next_ch(channel, &pd) ) {
+		case STATUS_OK:
+			mux->type[channel] = pd->phy_interval_type;
+			mux->period[channel] = pd->period + 1UL;
+		break;
+		case STATUS_NO_CHANGE:
+		break;
+		default:
+			mux->active &= (uint8_t)~(1 << channel);
+			mux->type[channel] = space;
+			mux->period[channel] = 0;
+			embx_ir_tx_phy_descriptor_set_played(channel, false);
+			return true;
+	}
+	mux->left[channel] = mux->period[channel];
+	return mux->type[channel] != type;
+}
+
+/**
+* @brief Clears the state of every emitter.
+*/
+void embx_ir_tx_mux_init(embx_ir_tx_mux_t *mux)
+{
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		mux->left[channel] = 0;
+		mux->period[channel] = 0;
+		mux->type[channel] = space;
+	}
+	mux->active = 0;
+}
+
+/**
+* @brief Starts an emitter with the first interval of its descriptor queue.
+*/
+enum status_code embx_ir_tx_mux_start(embx_ir_tx_mux_t *mux, uint8_t channel)
+{
+	if( (mux->active & (1 << channel)) != 0 ) {
+		return STATUS_BUSY;
+	}
+	embx_ir_tx_phy_descriptor_set_played(channel, true);
+	mux->active |= (uint8_t)(1 << channel);
+	mux->type[channel] = space;
+	embx_ir_tx_mux_fetch(mux, channel);
+	if( (mux->active & (1 << channel)) == 0 ) {
+		return STATUS_ERR_BAD_DATA;
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Returns the ticks until the period of an emitter ends.
+*/
+uint32_t embx_ir_tx_mux_get_ticks(const embx_ir_tx_mux_t *mux)
+{
+	uint32_t ticks = 0;
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		if( ((mux->active & (1 << channel)) != 0) && ((ticks == 0) || (mux->left[channel] < ticks)) ) {
+			ticks = mux->left[channel];
+		}
+	}
+	return ticks;
+}
+
+/**
+* @brief Advances every active emitter by the ticks that have elapsed since the last call.
+*/
+uint8_t embx_ir_tx_mux_advance(embx_ir_tx_mux_t *mux, uint32_t elapsed)
+{
+	uint8_t changed = 0;
+	uint8_t channel;
+
+	for( channel = 0; channel < EMBX_IR_TX_CHANNELS; channel++ ) {
+		if( (mux->active & (1 << channel)) == 0 ) {
+			continue;
+		}
+		mux->left[channel] = (mux->left[channel] > elapsed) ? (mux->left[channel] - elapsed) : 0;
+		if( (mux->left[channel] == 0) && (embx_ir_tx_mux_fetch(mux, channel) == true) ) {
+			changed |= (uint8_t)(1 << channel);
+		}
+	}
+	return changed;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file embx_ir_tx_mux.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Multiplexes the interval timing of several IR emitters onto one timer.
+ * @details Each emitter plays its own descriptor queue, see embx_ir_tx_phy_descriptor_fill_ch.  The multiplexer 
+ * keeps the ticks left in the current timer period of every emitter and runs the timer until the next of them ends.
+ * Then the emitters whose period has ended fetch their next period.  It is portable so the schedule can be replayed
+ * on the host, the timer and the carrier are driven by embx_ir_tx_emitters.c.
+ */ 
+#ifndef EMBX_IR_TX_MUX_H_
+#define EMBX_IR_TX_MUX_H_
+
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+
+/**
+* @brief embx_ir_tx_mux_t holds the state of every emitter.
+*/
+typedef struct {
+	uint32_t left[EMBX_IR_TX_CHANNELS]; /** The ticks left in the current timer period */
+	uint32_t period[EMBX_IR_TX_CHANNELS]; /** The ticks of a timer period of the current interval */
+	embx_ir_tx_phy_interval_t type[EMBX_IR_TX_CHANNELS]; /** The current interval, a SPACE once the emitter is done */
+	uint8_t active; /** A bit per emitter in transmission */
+} embx_ir_tx_mux_t;
+
+/**
+* @brief Clears the state of every emitter.
+*/
+extern void embx_ir_tx_mux_init(embx_ir_tx_mux_t *mux);
+
+/**
+* @brief Starts an emitter with the first interval of its descriptor queue.  The queue is marked as played.
+* @returns STATUS_OK, STATUS_BUSY if the emitter is in transmission, or STATUS_ERR_BAD_DATA if its queue is empty.
+*/
+extern enum status_code embx_ir_tx_mux_start(embx_ir_tx_mux_t *mux, uint8_t channel);
+
+/**
+* @brief Returns the ticks until the period of an emitter ends, i.e. the next timer period.  0 if none is active.
+*/
+extern uint32_t embx_ir_tx_mux_get_ticks(const embx_ir_tx_mux_t *mux);
+
+/**
+* @brief Advances every active emitter by the ticks that have elapsed since the last call.
+* @details elapsed must not be more than embx_ir_tx_mux_get_ticks.  An emitter whose period has ended continues 
+* its interval or fetches the next one, an emitter at the end of its queue is stopped and its queue released.
+* @returns A bit per emitter whose interval type has changed or that has stopped, the carrier of these is switched.
+*/
+extern uint8_t embx_ir_tx_mux_advance(embx_ir_tx_mux_t *mux, uint32_t elapsed);
+
+#endif /* EMBX_IR_TX_MUX_H_ */
@@ -11,12 +11,13 @@
  * The PHY layer uses the descriptor information to control the ir tx modulator.
  * A timer is used to control the timing of when to turn the IR modulator on and off.
  */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
 #include "embx/embx_ir/embx_ir_common.h"
 #include "embx/embx_ir/embx_ir_tx_modulator.h"
 #include "embx/embx_digital_io/digital_output.h"
 #include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
 #include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_bench/embx_bench_isr.h"
 
 /** 
 * @brief State variable used to guard the descriptor queue while a transmission is in progress.  
@@ -24,44 +25,39 @@
 */
 static bool volatile embx_ir_tx_in_progress = false;
 
-/** @brief The TC used by the PHY. */
-static struct tc_module tc_instance_ir_tx_phy;
-
 /**
 * @brief The callback function occurs when the timer or TC times out.
 * @details The TC times out when transmission of a mark or a space should be completed.
 * When this occurs, the callback gets the next descriptor from the q and sets up the 
-* next mark or space. 
+* next mark or space.  A long mark or space spans several periods of the timer, the timer keeps running
+* until the last one.
 * If a descriptor is not available, then transmission has completed. 
 * Upon completion, this function clears the state variable.
 * Transmission is started by the SEND function.
 */
-static void tc_callback_ir_tx_phy( struct tc_module *const module_inst)
+static void tc_callback_ir_tx_phy(embx_hal_tc_t tc)
 {
-	embx_ir_tx_phy_descriptor_t *current_phy_descriptor;
+	EMBX_BENCH_ISR_ENTER();
+	const embx_ir_tx_phy_descriptor_t *current_phy_descriptor;
+	enum status_code status = embx_ir_tx_phy_descriptor_next(&current_phy_descriptor);
 
-	if( embx_ir_tx_phy_descriptor_get(&current_phy_descriptor) == STATUS_OK ) {
+	if( status == STATUS_NO_CHANGE ) {
+		/* The interval continues for another period */
+	} else if( status == STATUS_OK ) {
 		
-		tc_stop_counter(&tc_instance_ir_tx_phy);
-		tc_set_top_value(&tc_instance_ir_tx_phy, current_phy_descriptor->period);
-
-		if( current_phy_descriptor->repeat_cnt < current_phy_descriptor->max_repeat_cnt ) {
-			current_phy_descriptor->repeat_cnt++;
-			embx_ir_tx_phy_decrement_tx_index(current_phy_descriptor->decrement);
-		} else if( current_phy_descriptor->max_repeat_cnt == EMBX_IR_TX_PHY_REPEAT_FOREVER ) {
-			embx_ir_tx_phy_decrement_tx_index(current_phy_descriptor->decrement);
-		}
+		embx_hal_tc_stop(TC_IR_TX_PHY_MODULE);
+		embx_hal_tc_set_top(TC_IR_TX_PHY_MODULE, current_phy_descriptor->period);
 
 		switch( current_phy_descriptor->phy_interval_type ) {
 			case mark:
 #ifdef DEBUG_IR_TX_PHY				
-				port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, true);
+				embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, true);
 #endif				
 				embx_ir_tx_modulator_start();
 			break;
 			case space:
 #ifdef DEBUG_IR_TX_PHY				
-				port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, false);
+				embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, false);
 #endif				
 				embx_ir_tx_modulator_stop();
 			break;
@@ -69,55 +65,64 @@ static void tc_callback_ir_tx_phy( struct tc_module *const module_inst)
 			break;
 		}
 
-		tc_start_counter(&tc_instance_ir_tx_phy);
+		embx_hal_tc_start(TC_IR_TX_PHY_MODULE);
 		
 	} else {
 #ifdef DEBUG_IR_TX_PHY
-		port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, false);
+		embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, false);
 #endif		
 		embx_ir_tx_modulator_stop();
-		tc_stop_counter(&tc_instance_ir_tx_phy);
+		embx_hal_tc_stop(TC_IR_TX_PHY_MODULE);
 		embx_ir_tx_in_progress = false;
 	}
+	EMBX_BENCH_ISR_EXIT(EMBX_BENCH_ISR_TX_PHY);
 }
 
 /**
-* @brief register and enable the callback function for the TC OVERFLOW interrupt
+* @brief register and enable the callback function for the TC compare match on channel 0, i.e. the top value
 */
 static void embx_time_configure_tc_callbacks(void)
 {
-	tc_register_callback(&tc_instance_ir_tx_phy, tc_callback_ir_tx_phy, TC_CALLBACK_OVERFLOW);
-	tc_enable_callback(&tc_instance_ir_tx_phy, TC_CALLBACK_OVERFLOW);
+	embx_hal_tc_register_callback(TC_IR_TX_PHY_MODULE, EMBX_HAL_TC_CALLBACK_CC0, tc_callback_ir_tx_phy);
+	embx_hal_tc_enable_callback(TC_IR_TX_PHY_MODULE, EMBX_HAL_TC_CALLBACK_CC0);
 }
 
 /**
 * @brief Initializes the IR TX PHY module. 
-* @details The TC is configured to use an 8-bit counter clocked at 8 Mhz / EMBX_IR_TX_PHY_PRESCALER.  Currently, 
-* this results in 8 usec per tick.  This function initializes, enables, and stops the counter.
+* @details The TC is configured to use a 16-bit counter clocked at 8 Mhz / EMBX_IR_TX_PHY_DIV_FACTOR.  Currently, 
+* this results in 8 usec per tick and a period of up to 524 ms.  The top value is held in CC0 (match frequency).  This function initializes, enables, and stops the counter.
 * @param gclk which clock to use....See embx_ir_common.h
+* @param modulator_frequency the carrier frequency in Hz, e.g. KHz_38.
 * @returns void
 */
-static void embx_ir_tx_modulator_phy_init(enum gclk_generator gclk,  embx_ir_tx_mod_freq_t modulator_frequency)
+static void embx_ir_tx_modulator_phy_init(enum gclk_generator gclk, uint32_t modulator_frequency)
 {
-	struct tc_config config_tc;
+	embx_hal_tc_config_t config_tc;
 	
-	tc_get_config_defaults(&config_tc);
+	embx_hal_tc_get_config_defaults(&config_tc);
 	
-	config_tc.counter_size = TC_COUNTER_SIZE_8BIT;
-	config_tc.clock_source = gclk; /* 8 MHz */
-	config_tc.clock_prescaler = EMBX_IR_TX_PHY_PRESCALER;  /* 8 us per tick  */
+	config_tc.wave = EMBX_HAL_TC_WAVE_MATCH_FREQ;
+	config_tc.gclk = gclk; /* 8 MHz */
+	config_tc.prescaler = EMBX_IR_TX_PHY_DIV_FACTOR;  /* 8 us per tick  */
 	
-	tc_init(&tc_instance_ir_tx_phy, TC_IR_TX_PHY_MODULE, &config_tc);
-	tc_enable(&tc_instance_ir_tx_phy);	
-	tc_stop_counter(&tc_instance_ir_tx_phy);
+	embx_hal_tc_init(TC_IR_TX_PHY_MODULE, &config_tc);
 
 	embx_time_configure_tc_callbacks();	
 	embx_ir_tx_modulator_init(EMBX_IR_MODULATOR_GCLK, modulator_frequency, false);
 #ifdef DEBUG_IR_TX_PHY
-	digital_output_init(DEBUG_IR_TX_PHY_PIN, false);
+	embx_hal_pin_config_output(DEBUG_IR_TX_PHY_PIN, false);
 #endif	
 }
 
+/**
+* @brief Initializes the IR TX PHY module and the modulator.
+* @param carrier_hz the carrier frequency in Hz, e.g. KHz_38.
+*/
+void embx_ir_tx_phy_init(uint32_t carrier_hz)
+{
+	embx_ir_tx_modulator_phy_init(EMBX_IR_MODULATOR_GCLK, carrier_hz);
+}
+
 /**
 * @brief Returns the state of the PHY.
 * @details Set to true by the SEND function.  Cleared when the transmission has completed.
@@ -127,9 +132,9 @@ static void embx_ir_tx_modulator_phy_init(enum gclk_generator gclk,  embx_ir_tx_
 bool embx_ir_tx_phy_get_state(void)
 {
 	bool state;
-	system_interrupt_enter_critical_section();
+	embx_hal_enter_critical_section();
 	state = embx_ir_tx_in_progress;
-	system_interrupt_leave_critical_section();	
+	embx_hal_leave_critical_section();	
 	return state;
 }
 
@@ -144,35 +149,35 @@ bool embx_ir_tx_phy_get_state(void)
 enum status_code embx_ir_tx_phy_send(void)
 {
 	enum status_code status = STATUS_OK;
-	embx_ir_tx_phy_descriptor_t *current_phy_descriptor;
+	const embx_ir_tx_phy_descriptor_t *current_phy_descriptor;
 
 	if( embx_ir_tx_in_progress == true) return STATUS_BUSY;
 
-	tc_stop_counter(&tc_instance_ir_tx_phy);
+	embx_hal_tc_stop(TC_IR_TX_PHY_MODULE);
 
-	if( embx_ir_tx_phy_descriptor_get(&current_phy_descriptor) == STATUS_OK ) {
+	if( embx_ir_tx_phy_descriptor_next(&current_phy_descriptor) == STATUS_OK ) {
 
 		embx_ir_tx_in_progress = true;
 
-		tc_set_top_value(&tc_instance_ir_tx_phy, current_phy_descriptor->period);
+		embx_hal_tc_set_top(TC_IR_TX_PHY_MODULE, current_phy_descriptor->period);
 
 		if( current_phy_descriptor->phy_interval_type == mark ) {
 #ifdef DEBUG_IR_TX_PHY				
-			port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, true);
+			embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, true);
 #endif			
 			embx_ir_tx_modulator_start();
 		} else if ( current_phy_descriptor->phy_interval_type == space ) {
 #ifdef DEBUG_IR_TX_PHY
-			port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, false);
+			embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, false);
 #endif			
 			embx_ir_tx_modulator_stop();
 		}
 		
-		tc_start_counter(&tc_instance_ir_tx_phy);
+		embx_hal_tc_start(TC_IR_TX_PHY_MODULE);
 		
 	} else {
 #ifdef DEBUG_IR_TX_PHY
-port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, false);
+embx_hal_pin_set_level(DEBUG_IR_TX_PHY_PIN, false);
 #endif		
 		embx_ir_tx_in_progress = false;		
 		embx_ir_tx_modulator_stop();
@@ -180,6 +185,20 @@ port_pin_set_output_level(DEBUG_IR_TX_PHY_PIN, false);
 	return status;	
 }
 
+/**
+* @brief Call to transmit a const table of descriptors, e.g. a fixed remote code stored in flash.
+* @details The table is played directly, there is no copy and no conversion.  See EMBX_IR_TX_PHY_MARK.
+* @returns enum status_code STATUS_BUSY if there is already a transmission in progress.
+*                           STATUS_OK if not busy.
+*/
+enum status_code embx_ir_tx_phy_send_const(const embx_ir_tx_phy_descriptor_t *table, uint16_t size)
+{
+	if( embx_ir_tx_phy_descriptor_load_const(table, size) != STATUS_OK ) {
+		return STATUS_BUSY;
+	}
+	return embx_ir_tx_phy_send();
+}
+
 /** @brief Test bench */
 void embx_time_tb(void)
 {			
@@ -191,7 +210,7 @@ void embx_time_tb(void)
 			embx_ir_tx_phy_descriptor_fill(false, space, 1192, 1, 2);
 			embx_ir_tx_phy_send();
 		}
-		delay_ms(20);
+		embx_hal_delay_ms(20);
 	}
 	
 }
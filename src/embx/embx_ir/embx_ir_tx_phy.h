@@ -14,14 +14,21 @@
 #ifndef EMBX_IR_TX_PHY_H_
 #define EMBX_IR_TX_PHY_H_
 
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+
 /** The PHY TX Module uses TC3 */
-#define TC_IR_TX_PHY_MODULE			TC3
+#define TC_IR_TX_PHY_MODULE			EMBX_HAL_TC3
 
 /** @brief The prescaler is used to divide the 8 MHz GCLK by 64 resulting in an 8 us clk for the timer. */
 #define EMBX_IR_TX_PHY_PRESCALER TC_CLOCK_PRESCALER_DIV64
-#define EMBX_IR_TX_PHY_CLK_FREQ				(EMBX_IR_MODULATOR_GCLK / 64) /* 125 kHz */	
+#define EMBX_IR_TX_PHY_DIV_FACTOR			(64)
+#define EMBX_IR_TX_PHY_CLK_FREQ				(EMBX_IR_MODULATOR_GCLK / EMBX_IR_TX_PHY_DIV_FACTOR) /* 125 kHz */	
 #define EMBX_IR_TX_PHY_USEC_PER_TICK		(8)   /* 8 us = 8000000 / 64 */
+/** @brief The longest period of the 16-bit timer, 524 ms.  Longer intervals take several periods. */
+#define EMBX_IR_TX_PHY_MAX_TICKS			(UINT16_MAX + 1UL)
 
+/** @brief Initializes the Tx PHY and the modulator with the carrier frequency in Hz */
+extern void embx_ir_tx_phy_init(uint32_t carrier_hz);
 /** 
 * @brief Returns the current state of the Tx PHY. 
 * @returns - TRUE if a transmission is currently in progress; else false. 
@@ -29,6 +36,8 @@
 extern bool embx_ir_tx_phy_get_state(void);
 /** @brief Sends or transmits a queue of descriptors */
 extern enum status_code embx_ir_tx_phy_send(void);
+/** @brief Sends or transmits a const table of descriptors */
+extern enum status_code embx_ir_tx_phy_send_const(const embx_ir_tx_phy_descriptor_t *table, uint16_t size);
 /** @brief - Test bench for the module. */
 extern void embx_time_tb(void);
 
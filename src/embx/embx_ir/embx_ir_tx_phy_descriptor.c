@@ -6,57 +6,224 @@
  *
  * @brief An implementation of a IR phy layer transmission descriptor for use on the Atmel SamD21G embedded controller.
  */ 
-#include <asf.h>
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_common.h"
 #include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
 #include "embx/embx_ir/embx_ir_tx_phy.h"
 
 
-/** The descriptors are stored in an array.  This defines the size of the array of IR PHY transmission descriptors. */
-#define EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ (20)
-/** This declares the array of IR PHY transmission descriptors */
-embx_ir_tx_phy_descriptor_t phy_descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ];
+#if (EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ & (EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ - 1)) != 0
+#error EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ must be a power of 2
+#endif
+/** Maps a free running index onto the ring */
+#define EMBX_IR_TX_PHY_DESCRIPTOR_SLOT(index)	((index) & (EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ - 1))
 
-/** The fill index is used by the function to populate a descriptor within the array of descriptors. */
-static uint8_t fill_index = 0;
-/** The tx index is used by the timer call back function to manage the modulation of the IR device. */
-static uint8_t tx_index = 0;
+/** 
+* The indices run freely and wrap at 256, the slot is the index modulo the ring size.  
+* Descriptors from release_index up to fill_index are in use, those before tx_index have been transmitted but are
+* kept until no repeat can go back to them.
+*/
+typedef struct {
+	/** This declares the ring of IR PHY transmission descriptors */
+	embx_ir_tx_phy_descriptor_t descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ];
+	/** The fill index is used by the function to populate a descriptor within the array of descriptors. */
+	volatile uint8_t fill_index;
+	/** The tx index is used by the timer call back function to manage the modulation of the IR device. */
+	volatile uint8_t tx_index;
+	/** The oldest descriptor that may not be overwritten */
+	volatile uint8_t release_index;
+	/** While pinned, the descriptors from pin_index are kept until the repeats of the descriptor at pin_owner are done */
+	volatile bool pinned;
+	volatile uint8_t pin_index;
+	volatile uint8_t pin_owner;
+	/** The number of timer periods left in the current interval */
+	volatile uint8_t overflows_left;
+	/** Set while the ring is played by another player than the IR Tx PHY, see embx_ir_tx_phy_descriptor_set_played */
+	volatile bool played;
+} embx_ir_tx_phy_descriptor_ring_t;
+
+/** A ring per IR emitter, channel 0 is the ring of the IR Tx PHY */
+static embx_ir_tx_phy_descriptor_ring_t ring[EMBX_IR_TX_CHANNELS];
+
+/** A const table played instead of the ring of channel 0, NULL when the ring is played */
+static const embx_ir_tx_phy_descriptor_t *const_table = NULL;
+static uint16_t const_size = 0;
+static uint16_t const_index = 0;
+
+/** The stream state of channel 0, see embx_ir_tx_phy_descriptor_stream_open */
+static volatile bool stream_open = false;
+static embx_ir_tx_phy_descriptor_callback_t stream_callback = NULL;
+static void *stream_context = NULL;
+static uint8_t stream_low_watermark = 0;
+static volatile uint32_t stream_underruns = 0;
+
+/** Added to every interval filled into the ring of channel 0, see embx_ir_tx_phy_descriptor_set_correction */
+static int16_t correction_usec = 0;
+
+/**
+* @brief Returns true if the free running index a comes before the free running index b.
+*/
+static inline bool embx_ir_tx_phy_descriptor_before(uint8_t a, uint8_t b)
+{
+	return (int8_t)(a - b) < 0;
+}
 
 /**
 * @brief Call to convert the mark space intervals from units of time (usec) to tc clock ticks.
-* @details Expects that the usec field is populated.
+* @details Expects that the usec field is populated.  An interval longer than one period of the 16-bit timer
+* (524 ms) is split into overflows + 1 equal periods, the error is less than one tick per period.
 * @returns void
 */
 static inline void embx_ir_tx_phy_descriptor_tc_init(embx_ir_tx_phy_descriptor_t *pd)
 {
-	pd->period = pd->usec / EMBX_IR_TX_PHY_USEC_PER_TICK ;
-	if( pd->period > UINT8_MAX ) {
-		pd->overflows = pd->usec / (UINT8_MAX+1);
-		pd->period = pd->usec % (UINT8_MAX+1);
-	} else {
-		pd->overflows = 0;
+	uint32_t ticks = EMBX_IR_TX_PHY_TICKS(pd->usec);
+
+	if( ticks > (EMBX_IR_TX_PHY_MAX_TICKS * (UINT8_MAX + 1)) ) {
+		ticks = EMBX_IR_TX_PHY_MAX_TICKS * (UINT8_MAX + 1);
 	}
+	pd->overflows = (uint8_t)((ticks - 1) / EMBX_IR_TX_PHY_MAX_TICKS);
+	pd->period = (uint16_t)((ticks / (pd->overflows + 1)) - 1);
 }
 
 /**
 * @brief decrements the tx_index by the amount specified by the decrement parameter.
-* @details If the decrement parameter is greater than the tx_index, then the tx_index will be set to 0.
+* @details The tx_index will not be set before the oldest descriptor that is kept in the ring.
+* @param r the ring.
 * @param decrement the amount to decrement the tx_index.
 * @returns void
 */
+static void embx_ir_tx_phy_descriptor_decrement(embx_ir_tx_phy_descriptor_ring_t *r, uint8_t decrement) 
+{
+	if( (uint8_t)(r->tx_index - r->release_index) >= decrement ) {
+		r->tx_index -= decrement;
+	} else r->tx_index = r->release_index;
+}
+
+/**
+* @brief decrements the tx_index of channel 0.
+*/
 void embx_ir_tx_phy_decrement_tx_index(uint8_t decrement) 
 {
-	if( tx_index >= decrement ) {
-		tx_index -= decrement;
-	} else tx_index = 0;
+	embx_ir_tx_phy_descriptor_decrement(&ring[0], decrement);
+}
+
+/**
+* @brief Returns the number of descriptors that can be filled before the ring of a channel is full.
+*/
+uint8_t embx_ir_tx_phy_descriptor_get_free_ch(uint8_t channel)
+{
+	embx_ir_tx_phy_descriptor_ring_t *r = &ring[channel];
+	uint8_t n;
+	embx_hal_enter_critical_section();
+	n = EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ - (uint8_t)(r->fill_index - r->release_index);
+	embx_hal_leave_critical_section();
+	return n;
+}
+
+/**
+* @brief Returns the number of descriptors that can be filled before the ring is full.
+*/
+uint8_t embx_ir_tx_phy_descriptor_get_free(void)
+{
+	return embx_ir_tx_phy_descriptor_get_free_ch(0);
+}
+
+/**
+* @brief Returns the free running index of the next descriptor to fill.
+*/
+uint8_t embx_ir_tx_phy_descriptor_get_fill_index(void)
+{
+	return ring[0].fill_index;
+}
+
+/**
+* @brief Returns the free running index of the next descriptor to transmit.  The descriptors before it have been started.
+*/
+uint8_t embx_ir_tx_phy_descriptor_get_tx_index(void)
+{
+	return ring[0].tx_index;
+}
+
+/**
+* @brief Returns the shortest period of the descriptors of channel 0 that are left to transmit, UINT16_MAX if none.
+* @details The const table is searched instead of the ring while it is selected.  Descriptors filled later, e.g. by
+* the callback of a stream, are not known yet.
+*/
+uint16_t embx_ir_tx_phy_descriptor_get_min_period(void)
+{
+	embx_ir_tx_phy_descriptor_ring_t *r = &ring[0];
+	uint16_t min = UINT16_MAX;
+	uint16_t n;
+	uint8_t index;
+
+	if( const_table != NULL ) {
+		for( n = const_index; n < const_size; n++ ) {
+			min = (const_table[n].period < min) ? const_table[n].period : min;
+		}
+		return min;
+	}
+	embx_hal_enter_critical_section();
+	for( index = r->tx_index; index != r->fill_index; index++ ) {
+		if( r->descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_SLOT(index)].period < min ) {
+			min = r->descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_SLOT(index)].period;
+		}
+	}
+	embx_hal_leave_critical_section();
+	return min;
+}
+
+/**
+* @brief Empties the ring of a channel.  The const table and the stream of channel 0 are closed as well.
+* @returns STATUS_BUSY if an IR transmission is underway on the channel, otherwise STATUS_OK.
+*/
+enum status_code embx_ir_tx_phy_descriptor_reset_ch(uint8_t channel)
+{
+	embx_ir_tx_phy_descriptor_ring_t *r = &ring[channel];
+
+	if( (r->played == true) || ((channel == 0) && (embx_ir_tx_phy_get_state() == true)) ) {
+		return STATUS_BUSY;
+	}
+	r->fill_index = 0;
+	r->tx_index = 0;
+	r->release_index = 0;
+	r->pinned = false;
+	r->overflows_left = 0;
+	if( channel == 0 ) {
+		const_table = NULL;
+		stream_open = false;
+		stream_callback = NULL;
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Empties the ring and closes the stream.
+* @returns STATUS_BUSY if an IR transmission is underway, otherwise STATUS_OK.
+*/
+enum status_code embx_ir_tx_phy_descriptor_reset(void)
+{
+	return embx_ir_tx_phy_descriptor_reset_ch(0);
+}
+
+/**
+* @brief Marks the ring of a channel as played by another player than the IR Tx PHY, e.g. the emitter multiplexer.
+* @details The ring cannot be reset while it is played.
+*/
+void embx_ir_tx_phy_descriptor_set_played(uint8_t channel, bool played)
+{
+	ring[channel].played = played;
 }
 
 /**
 * @brief - Fills in an ir tx phy descriptor.
 *
 * Fill in an ir tx phy descriptor.  Each descriptor describes a mark or a space in units of time usec per mark or space.
-* The descriptors are maintained as list.  The list is populated by calling this function repeatedly.  
-* The reset_descriptor_list flag will cause the list to be reset and the parameters will be applied to the first 
-* list element which describes the first mark or space to be transmitted.
+* The descriptors are maintained as a ring.  The ring is populated by calling this function repeatedly.  
+* The reset_descriptor_list flag will cause the ring to be reset and the parameters will be applied to the first 
+* ring element which describes the first mark or space to be transmitted.
+*
+* Descriptors may be added while a transmission is in progress.  The PHY releases each descriptor once it has been
+* transmitted so a stream of any length can be sent through the ring, see embx_ir_tx_phy_descriptor_stream_open.
 * 
 * Each descriptor may cause the previous N descriptors to be be re-tranmitted multiple times.
 * 
@@ -68,61 +235,187 @@ void embx_ir_tx_phy_decrement_tx_index(uint8_t decrement)
 * The decrement value defines N or the number of descriptors that will be re-transmitted.  N includes the 
 * descriptor filled in by this function.  D0, D1, D2    D2 is the current descriptor.  If decrement == 3 and max_repeat_count == 2
 * you will see D0, D1, D2, D0, D1, D2, D0, D1, D1 on the wire.
+* The N descriptors are kept in the ring until the repeats are done.  When streaming, the repeat must be filled before 
+* the PHY has released D0, otherwise the decrement is set to 0.
 *
 * @param[in] bool reset_descriptor_list True if the descriptor describes the first mark or space in the transmission list.  
 *										False if the descriptor should be added to the end of the q
 * @param[in] phy_interval_t - either a mark or a space.
-* @param[in] uint16_t - the number of usec that the mark or space should be transmitted for ...
+* @param[in] uint32_t - the number of usec that the mark or space should be transmitted for ...
 * @param[in] max_repeat_count - the number of times the previous descriptors should be repeated.
 * @param[in] decrement - how far back on the list a repeat should go.
 *
-* @returns - STATUS_BUSY if there is an IR transmission underway.  Try again later ...
-*			 STATUS_ERR_OVERFLOW if there are not any free descriptors left.  Try increasing the q size and re-compiling.
+* @returns - STATUS_BUSY if the ring is reset while an IR transmission is underway.  Try again later ...
+*			 STATUS_ERR_OVERFLOW if there are not any free descriptors left.  Wait for the PHY to release descriptors.
 *            STATUS_OK if the descriptor has been populated and added to the transmission q.
 */
 enum status_code embx_ir_tx_phy_descriptor_fill(bool reset_descriptor_list, 
 												embx_ir_tx_phy_interval_t phy_interval_type, 
-												uint16_t usec, 
+												uint32_t usec, 
 												int16_t max_repeat_cnt, uint8_t decrement)
 {
+	return embx_ir_tx_phy_descriptor_fill_ch(0, reset_descriptor_list, phy_interval_type, usec, max_repeat_cnt, decrement);
+}
+
+/**
+* @brief Returns an interval of channel 0 corrected for the timing error of the IR Tx PHY.  At least 1 usec is left.
+*/
+static inline uint32_t embx_ir_tx_phy_descriptor_correct(uint32_t usec)
+{
+	int32_t corrected = (int32_t)usec + correction_usec;
+
+	return (corrected > 0) ? (uint32_t)corrected : 1;
+}
+
+/**
+* @brief Sets the correction added to every interval filled into the ring of channel 0.
+* @details The IR Tx PHY restarts the timer from its interrupt at the start of each interval, so each interval is 
+* longer than programmed by the interrupt latency.  embx_ir_calibrate measures it and sets the negative latency.
+* Descriptors already in the ring and const tables are not corrected.
+*/
+void embx_ir_tx_phy_descriptor_set_correction(int16_t usec)
+{
+	correction_usec = usec;
+}
+
+/**
+* @brief Returns the correction set by embx_ir_tx_phy_descriptor_set_correction.
+*/
+int16_t embx_ir_tx_phy_descriptor_get_correction(void)
+{
+	return correction_usec;
+}
+
+/**
+* @brief Fills in a descriptor of the ring of a channel, see embx_ir_tx_phy_descriptor_fill.
+*/
+enum status_code embx_ir_tx_phy_descriptor_fill_ch(uint8_t channel, bool reset_descriptor_list, 
+												   embx_ir_tx_phy_interval_t phy_interval_type, 
+												   uint32_t usec, 
+												   int16_t max_repeat_cnt, uint8_t decrement)
+{
+	embx_ir_tx_phy_descriptor_ring_t *r = &ring[channel];
 	enum status_code status = STATUS_OK;
+	embx_ir_tx_phy_descriptor_t *pd;
 
-	if ( embx_ir_tx_phy_get_state() == true ) {
+	if( (reset_descriptor_list == true) && (embx_ir_tx_phy_descriptor_reset_ch(channel) != STATUS_OK) ) {
 		return STATUS_BUSY;
 	}
+
+	embx_hal_enter_critical_section();
 	
-	if( reset_descriptor_list == true ) {
-		fill_index = 0;
-		tx_index = 0;
-	}
-	
-	if( fill_index < EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ ) {		
+	if( (uint8_t)(r->fill_index - r->release_index) < EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ ) {		
 		
 		/* Transfer the parameters to the descriptor */
-		phy_descriptor[fill_index].phy_interval_type = phy_interval_type;
-		phy_descriptor[fill_index].usec = usec;
-		embx_ir_tx_phy_descriptor_tc_init(&phy_descriptor[fill_index]);
+		pd = &r->descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_SLOT(r->fill_index)];
+		pd->phy_interval_type = phy_interval_type;
+		pd->usec = (channel == 0) ? embx_ir_tx_phy_descriptor_correct(usec) : usec;
+		embx_ir_tx_phy_descriptor_tc_init(pd);
 		
 		if( max_repeat_cnt >= 0 ) {
-			phy_descriptor[fill_index].max_repeat_cnt = max_repeat_cnt;
+			pd->max_repeat_cnt = max_repeat_cnt;
 		} else {
-			phy_descriptor[fill_index].max_repeat_cnt = EMBX_IR_TX_PHY_REPEAT_FOREVER;
+			pd->max_repeat_cnt = EMBX_IR_TX_PHY_REPEAT_FOREVER;
 		}		
-		phy_descriptor[fill_index].repeat_cnt = 0;		
+		pd->repeat_cnt = 0;		
 		
-		/* Ensure that the decrement value is will not result in a value out of bounds of the array */
-		if( decrement <= (fill_index + 1) ) {
-			phy_descriptor[fill_index].decrement = decrement;			
+		/* Ensure that the decrement value does not go back to a descriptor that has been released */
+		if( (decrement != 0) && (decrement <= (uint8_t)(r->fill_index - r->release_index + 1)) && (pd->max_repeat_cnt != 0) ) {
+			pd->decrement = decrement;
+			/* Keep the repeated descriptors until the repeats are done */
+			if( (r->pinned == false) || embx_ir_tx_phy_descriptor_before((uint8_t)(r->fill_index + 1 - decrement), r->pin_index) ) {
+				r->pin_index = (uint8_t)(r->fill_index + 1 - decrement);
+			}
+			r->pin_owner = r->fill_index;
+			r->pinned = true;
 		} else {
-			phy_descriptor[fill_index].decrement = 0;
+			pd->decrement = 0;
 		}		
 		
-		fill_index++;	
+		r->fill_index++;	
 				
 	} else {
 		status = STATUS_ERR_OVERFLOW;
 	}
 
+	embx_hal_leave_critical_section();
+
+	return status;
+}
+
+/**
+* @brief Opens a stream.
+* @details Call after the first descriptor has been filled with the reset flag.  While the stream is open, the PHY
+* calls the callback each time it consumes a descriptor and the ring holds no more than low_watermark descriptors.
+* The callback, or the main loop, refills the ring and closes the stream after the last descriptor.  If the ring
+* runs empty while the stream is open, the transmission ends and the underrun counter is incremented.
+*
+* The callback is kept until the ring has been drained, and it is called once more when the PHY finds the ring
+* empty.  A descriptor filled by it then continues the transmission, so a closed stream may be opened again to chain 
+* another transmission back to back.
+*/
+void embx_ir_tx_phy_descriptor_stream_open(embx_ir_tx_phy_descriptor_callback_t callback, void *context, uint8_t low_watermark)
+{
+	embx_hal_enter_critical_section();
+	stream_callback = callback;
+	stream_context = context;
+	stream_low_watermark = low_watermark;
+	stream_open = true;
+	embx_hal_leave_critical_section();
+}
+
+/**
+* @brief Closes the stream.  The transmission ends once the ring has been drained unless the callback fills it again.
+*/
+void embx_ir_tx_phy_descriptor_stream_close(void)
+{
+	stream_open = false;
+}
+
+/**
+* @brief Returns the number of streams that ran out of descriptors before they were closed.
+*/
+uint32_t embx_ir_tx_phy_descriptor_get_underruns(void)
+{
+	return stream_underruns;
+}
+
+/**
+* @brief Returns the current descriptor of a ring and increments its tx_index, see embx_ir_tx_phy_descriptor_get.
+* @details The stream callback is only called for the ring of channel 0.
+*/
+static enum status_code embx_ir_tx_phy_descriptor_ring_get(embx_ir_tx_phy_descriptor_ring_t *r, embx_ir_tx_phy_descriptor_t **pd)
+{
+	embx_ir_tx_phy_descriptor_callback_t callback = (r == &ring[0]) ? stream_callback : NULL;
+	enum status_code status = STATUS_OK;
+
+	/* The repeats of the pin owner are done once the PHY has moved past it */
+	if( (r->pinned == true) && embx_ir_tx_phy_descriptor_before(r->pin_owner, r->tx_index) ) {
+		r->pinned = false;
+	}
+	r->release_index = ((r->pinned == true) && embx_ir_tx_phy_descriptor_before(r->pin_index, r->tx_index)) ? r->pin_index : r->tx_index;
+
+	/* Last chance for the stream to continue the transmission */
+	if( (r->tx_index == r->fill_index) && (callback != NULL) ) {
+		callback(stream_context);
+	}
+
+	if( r->tx_index != r->fill_index ) {
+		*pd = &r->descriptor[EMBX_IR_TX_PHY_DESCRIPTOR_SLOT(r->tx_index)]; 
+		r->tx_index++;	
+		if( (callback != NULL) && ((uint8_t)(r->fill_index - r->tx_index) <= stream_low_watermark) ) {
+			callback(stream_context);
+		}
+	} else {
+		if( (callback != NULL) && (stream_open == true) ) {
+			stream_underruns++;
+			stream_open = false;
+		}
+		if( r == &ring[0] ) {
+			stream_callback = NULL;
+		}
+		status = STATUS_ERR_BAD_DATA;
+	}
 	return status;
 }
 
@@ -135,6 +428,9 @@ enum status_code embx_ir_tx_phy_descriptor_fill(bool reset_descriptor_list,
 * When this occurs, the index may be reset by calling the fill function
 * with the reset flag set to true or by calling the decrement function.
 *
+* The descriptor returned by the previous call has been transmitted and is released unless a repeat may still go
+* back to it.  Called from the interrupt of the PHY.
+*
 * @param[out] - sets pd to the descriptor referenced by the current value of tx_index.
 *
 * @returns STATUS_OK if the descriptor returned to the caller is valid.
@@ -142,12 +438,79 @@ enum status_code embx_ir_tx_phy_descriptor_fill(bool reset_descriptor_list,
 */
 enum status_code embx_ir_tx_phy_descriptor_get(embx_ir_tx_phy_descriptor_t **pd)
 {
-	enum status_code status = STATUS_OK;
-	if( tx_index < fill_index ) {
-		*pd = &phy_descriptor[tx_index]; 
-		tx_index++;	
-	} else {
-		status = STATUS_ERR_BAD_DATA;
+	return embx_ir_tx_phy_descriptor_ring_get(&ring[0], pd);
+}
+
+/**
+* @brief Advances the transmission by one period of the PHY timer.
+*
+* @details Called each time the PHY timer reaches its top value.  While the current interval has periods left, the 
+* timer keeps running with the same top value.  Otherwise the next descriptor is returned and its repeat is applied.
+*
+* @param[out] - sets pd to the next interval to transmit.
+*
+* @returns STATUS_OK if pd is the next interval, STATUS_NO_CHANGE if the current interval continues for another period,
+* or STATUS_ERR_BAD_DATA if the transmission is complete.
+*/
+enum status_code embx_ir_tx_phy_descriptor_next(const embx_ir_tx_phy_descriptor_t **pd)
+{
+	return embx_ir_tx_phy_descriptor_next_ch(0, pd);
+}
+
+/**
+* @brief Advances the transmission of a channel by one period of its timer, see embx_ir_tx_phy_descriptor_next.
+*/
+enum status_code embx_ir_tx_phy_descriptor_next_ch(uint8_t channel, const embx_ir_tx_phy_descriptor_t **pd)
+{
+	embx_ir_tx_phy_descriptor_ring_t *r = &ring[channel];
+	embx_ir_tx_phy_descriptor_t *rd;
+	enum status_code status;
+
+	if( r->overflows_left != 0 ) {
+		r->overflows_left--;
+		return STATUS_NO_CHANGE;
+	}
+
+	if( (channel == 0) && (const_table != NULL) ) {
+		if( const_index == const_size ) {
+			const_table = NULL; /* The table is sent once, the ring is the source of the next transmission */
+			return STATUS_ERR_BAD_DATA;
+		}
+		*pd = &const_table[const_index++];
+		r->overflows_left = (*pd)->overflows;
+		return STATUS_OK;
+	}
+
+	status = embx_ir_tx_phy_descriptor_ring_get(r, &rd);
+	if( status == STATUS_OK ) {
+		if( rd->repeat_cnt < rd->max_repeat_cnt ) {
+			rd->repeat_cnt++;
+			embx_ir_tx_phy_descriptor_decrement(r, rd->decrement);
+		} else if( rd->max_repeat_cnt == EMBX_IR_TX_PHY_REPEAT_FOREVER ) {
+			embx_ir_tx_phy_descriptor_decrement(r, rd->decrement);
+		}
+		r->overflows_left = rd->overflows;
+		*pd = rd;
 	}
 	return status;
-}
\ No newline at end of file
+}
+
+/**
+* @brief Selects a const table of descriptors as the source of the next transmission.
+*
+* @details The table is played as it is, nothing is copied or converted.  Build it with EMBX_IR_TX_PHY_MARK and 
+* EMBX_IR_TX_PHY_SPACE so the periods are computed by the compiler.  The repeat fields are ignored.  The table is sent once.
+*
+* @returns STATUS_BUSY if an IR transmission is underway, or STATUS_OK.
+*/
+enum status_code embx_ir_tx_phy_descriptor_load_const(const embx_ir_tx_phy_descriptor_t *table, uint16_t size)
+{
+	if ( (embx_ir_tx_phy_get_state() == true) || (ring[0].played == true) ) {
+		return STATUS_BUSY;
+	}
+	const_table = table;
+	const_size = size;
+	const_index = 0;
+	ring[0].overflows_left = 0;
+	return STATUS_OK;
+}
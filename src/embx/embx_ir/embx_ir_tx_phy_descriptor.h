@@ -16,6 +16,12 @@
 */
 #define EMBX_IR_TX_PHY_REPEAT_FOREVER		(-1)
 
+/** 
+*	The descriptors are stored in a ring.  This defines the number of descriptors in the ring, it must be a power of 2.
+*   Long transmissions are streamed through the ring, see embx_ir_tx_phy_descriptor_stream_open.
+*/
+#define EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ		(32)
+
 /**
 * Defines a enum representing a mark or a space.
 */
@@ -30,14 +36,62 @@ typedef enum {
 */
 typedef struct {
 	embx_ir_tx_phy_interval_t phy_interval_type; /** Indicates whether the time interval is a mark or a space. */
-	uint16_t usec; /** The number of usec in the mark or space */
-	uint16_t period;	 /** The value programmed into the top register: period = usec / EMBX_IR_TX_PHY_USEC_PER_TICK  */
-	uint8_t overflows; /** used if the period is > 256, */
+	uint32_t usec; /** The number of usec in the mark or space */
+	uint16_t period;	 /** The value programmed into the top register, the timer period is period + 1 ticks */
+	uint8_t overflows; /** The number of additional timer periods, used if the interval is longer than one period of the 16-bit timer */
 	int16_t repeat_cnt; /** The current value */
 	int16_t max_repeat_cnt; /** number of times to repeat the previous descriptors, -1 indicates forever (for debugging) */ 
 	uint8_t decrement; /** amount to go back for a repeat operation */
 } embx_ir_tx_phy_descriptor_t;
 
+/**
+*	Converts a mark or a space from usec to timer ticks at compile time.  The same conversion is used by the fill function.
+*   The timer constants are defined in embx_ir_tx_phy.h.
+*   An interval longer than one period of the 16-bit timer is split into overflows + 1 equal periods.
+*/
+#define EMBX_IR_TX_PHY_TICKS(usec)			(((((uint32_t)(usec)) + (EMBX_IR_TX_PHY_USEC_PER_TICK / 2)) / EMBX_IR_TX_PHY_USEC_PER_TICK) + \
+											 ((((uint32_t)(usec)) < (EMBX_IR_TX_PHY_USEC_PER_TICK / 2)) ? 1 : 0))
+#define EMBX_IR_TX_PHY_OVERFLOWS(usec)		((EMBX_IR_TX_PHY_TICKS(usec) - 1) / EMBX_IR_TX_PHY_MAX_TICKS)
+#define EMBX_IR_TX_PHY_PERIOD(usec)			((EMBX_IR_TX_PHY_TICKS(usec) / (EMBX_IR_TX_PHY_OVERFLOWS(usec) + 1)) - 1)
+
+/**
+*	Initializers of the descriptors of a const table.  The periods are computed by the compiler and the table is 
+*   stored in flash, e.g. 
+*   static const embx_ir_tx_phy_descriptor_t code[] = { EMBX_IR_TX_PHY_MARK(3400), EMBX_IR_TX_PHY_SPACE(1750), ... };
+*   A const table is played with embx_ir_tx_phy_send_const, it can not hold repeats.
+*/
+#define EMBX_IR_TX_PHY_INTERVAL(type, usec)	{ (type), (usec), EMBX_IR_TX_PHY_PERIOD(usec), EMBX_IR_TX_PHY_OVERFLOWS(usec), 0, 0, 0 }
+#define EMBX_IR_TX_PHY_MARK(usec)			EMBX_IR_TX_PHY_INTERVAL(mark, usec)
+#define EMBX_IR_TX_PHY_SPACE(usec)			EMBX_IR_TX_PHY_INTERVAL(space, usec)
+
+/**
+*	Initializers of a pulse distance bit and byte: a MARK followed by the SPACE of a 0 or a 1.  A byte is sent LSB first.
+*   A frame of a pulse distance protocol is written as its header, a list of bytes, and its trailer.
+*/
+#define EMBX_IR_TX_PHY_PD_BIT(value, bit, mark_usec, zero_usec, one_usec) \
+	EMBX_IR_TX_PHY_MARK(mark_usec), EMBX_IR_TX_PHY_SPACE((((value) >> (bit)) & 1) ? (one_usec) : (zero_usec))
+#define EMBX_IR_TX_PHY_PD_BYTE(value, mark_usec, zero_usec, one_usec) \
+	EMBX_IR_TX_PHY_PD_BIT(value, 0, mark_usec, zero_usec, one_usec), EMBX_IR_TX_PHY_PD_BIT(value, 1, mark_usec, zero_usec, one_usec), \
+	EMBX_IR_TX_PHY_PD_BIT(value, 2, mark_usec, zero_usec, one_usec), EMBX_IR_TX_PHY_PD_BIT(value, 3, mark_usec, zero_usec, one_usec), \
+	EMBX_IR_TX_PHY_PD_BIT(value, 4, mark_usec, zero_usec, one_usec), EMBX_IR_TX_PHY_PD_BIT(value, 5, mark_usec, zero_usec, one_usec), \
+	EMBX_IR_TX_PHY_PD_BIT(value, 6, mark_usec, zero_usec, one_usec), EMBX_IR_TX_PHY_PD_BIT(value, 7, mark_usec, zero_usec, one_usec)
+
+/** Returns the number of descriptors of a const table */
+#define EMBX_IR_TX_PHY_DESCRIPTOR_N(table)	((uint16_t)(sizeof(table) / sizeof((table)[0])))
+
+/**
+* @brief The low watermark callback of a stream.  Called from the IR Tx PHY interrupt, it may call the fill function.
+*/
+typedef void (*embx_ir_tx_phy_descriptor_callback_t)(void *context);
+
+/**
+* @brief Advances the transmission by one period of the PHY timer.  Called from the interrupt of the PHY.
+*/
+extern enum status_code embx_ir_tx_phy_descriptor_next(const embx_ir_tx_phy_descriptor_t **pd);
+/**
+* @brief Selects a const table of descriptors as the source of the next transmission.  The ring is the source again once it has been sent.
+*/
+extern enum status_code embx_ir_tx_phy_descriptor_load_const(const embx_ir_tx_phy_descriptor_t *table, uint16_t size);
 /**
 * @brief Decrements the tx_index.  Used by the phy tx callback during repeat operations.
 */
@@ -47,11 +101,66 @@ extern void embx_ir_tx_phy_decrement_tx_index(uint8_t decrement) ;
 */
 extern enum status_code embx_ir_tx_phy_descriptor_get(embx_ir_tx_phy_descriptor_t **pd);
 /**
-* @brief Called to populate a descriptor.
+* @brief Empties the ring and closes the stream.  Returns STATUS_BUSY while a transmission is in progress.
+*/
+extern enum status_code embx_ir_tx_phy_descriptor_reset(void);
+/**
+* @brief Called to populate a descriptor.  May be called while a transmission is in progress unless reset is true.
 */
 extern enum status_code embx_ir_tx_phy_descriptor_fill(bool reset, 
 													   embx_ir_tx_phy_interval_t phy_interval_type, 
-													   uint16_t usec, 
+													   uint32_t usec, 
 													   int16_t max_repeat_cnt, uint8_t decrement);
+/**
+* @brief Returns the number of descriptors that can be filled before the ring is full.
+*/
+extern uint8_t embx_ir_tx_phy_descriptor_get_free(void);
+/**
+* @brief The descriptor queues of the other IR emitters, see EMBX_IR_TX_CHANNELS.  The functions above use channel 0.
+* @details Streams and const tables are only available on channel 0.
+*/
+extern enum status_code embx_ir_tx_phy_descriptor_reset_ch(uint8_t channel);
+extern enum status_code embx_ir_tx_phy_descriptor_fill_ch(uint8_t channel, bool reset, 
+														  embx_ir_tx_phy_interval_t phy_interval_type, 
+														  uint32_t usec, 
+														  int16_t max_repeat_cnt, uint8_t decrement);
+extern uint8_t embx_ir_tx_phy_descriptor_get_free_ch(uint8_t channel);
+extern enum status_code embx_ir_tx_phy_descriptor_next_ch(uint8_t channel, const embx_ir_tx_phy_descriptor_t **pd);
+/**
+* @brief Marks the queue of a channel as played by a player other than the IR Tx PHY, it cannot be reset while it is played.
+*/
+extern void embx_ir_tx_phy_descriptor_set_played(uint8_t channel, bool played);
+/**
+* @brief Returns the free running indices of the next descriptor to fill and of the next descriptor to transmit.
+* @details The indices wrap at 256.  Once the tx index has passed the fill index returned after a descriptor was
+* filled, that descriptor has been started.
+*/
+extern uint8_t embx_ir_tx_phy_descriptor_get_fill_index(void);
+extern uint8_t embx_ir_tx_phy_descriptor_get_tx_index(void);
+/**
+* @brief Returns the shortest period of the descriptors left to transmit on channel 0, UINT16_MAX if there are none.
+*/
+extern uint16_t embx_ir_tx_phy_descriptor_get_min_period(void);
+/**
+* @brief Opens a stream.  The transmission continues until the stream is closed and the ring has been drained.
+* @params callback - called from the interrupt whenever a descriptor is consumed and no more than low_watermark
+*                    descriptors are left in the ring, may be NULL.
+* @params context - passed to the callback.
+*/
+extern void embx_ir_tx_phy_descriptor_stream_open(embx_ir_tx_phy_descriptor_callback_t callback, void *context, uint8_t low_watermark);
+/**
+* @brief Closes the stream after its last descriptor has been filled.  The callback is kept until the ring has been drained.
+*/
+extern void embx_ir_tx_phy_descriptor_stream_close(void);
+/**
+* @brief Sets the correction in usec added to every interval filled into the ring of channel 0, e.g. the negative
+* interrupt latency of the IR Tx PHY measured by embx_ir_calibrate.  Descriptors already filled are not corrected.
+*/
+extern void embx_ir_tx_phy_descriptor_set_correction(int16_t usec);
+extern int16_t embx_ir_tx_phy_descriptor_get_correction(void);
+/**
+* @brief Returns the number of streams that ran out of descriptors before they were closed.
+*/
+extern uint32_t embx_ir_tx_phy_descriptor_get_underruns(void);
 
 #endif /* EMBX_IR_TX_PHY_DESCRIPTOR_H_ */
\ No newline at end of file
@@ -0,0 +1,72 @@
+/**
+ * @file embx_ir_tx_program.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief A transmission compiled into carrier cycles for playback by hardware.
+ * @details Adjacent intervals of the same type are merged so a program has at most one entry per interval.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_ir/embx_ir_tx_program.h"
+
+/**
+* @brief Appends carrier cycles to the program, a run of the same type extends the last entry.
+*/
+static enum status_code embx_ir_tx_program_put(embx_ir_tx_program_t *program, uint16_t *entry, uint16_t max, bool is_mark, uint32_t cycles)
+{
+	uint16_t type = (is_mark == true) ? EMBX_IR_TX_PROGRAM_MARK : 0;
+	uint32_t room;
+
+	if( (program->size != 0) && ((entry[program->size - 1] & EMBX_IR_TX_PROGRAM_MARK) == type) ) {
+		room = EMBX_IR_TX_PROGRAM_MAX_CYCLES - EMBX_IR_TX_PROGRAM_CYCLES(entry[program->size - 1]);
+		room = (cycles < room) ? cycles : room;
+		entry[program->size - 1] += (uint16_t)room;
+		cycles -= room;
+	}
+	while( cycles != 0 ) {
+		if( program->size == max ) {
+			return STATUS_ERR_OVERFLOW;
+		}
+		room = (cycles < EMBX_IR_TX_PROGRAM_MAX_CYCLES) ? cycles : EMBX_IR_TX_PROGRAM_MAX_CYCLES;
+		entry[program->size++] = type | (uint16_t)room;
+		cycles -= room;
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Compiles the IR Tx PHY descriptor queue into a program.
+*/
+enum status_code embx_ir_tx_program_compile(embx_ir_tx_program_t *program, uint16_t *entry, uint16_t max, uint32_t carrier_hz)
+{
+	const embx_ir_tx_phy_descriptor_t *pd;
+	enum status_code status = STATUS_OK;
+	uint64_t usec = 0;
+	uint32_t cycles = 0;
+	uint32_t end;
+
+	if( embx_ir_tx_phy_get_state() == true ) {
+		return STATUS_BUSY;
+	}
+
+	program->carrier_hz = carrier_hz;
+	program->size = 0;
+	program->entry = entry;
+
+	while( status != STATUS_ERR_BAD_DATA ) {
+		status = embx_ir_tx_phy_descriptor_next(&pd);
+		if( status == STATUS_OK ) {
+			/** The periods of a long interval (STATUS_NO_CHANGE) are already included in usec */
+			usec += pd->usec;
+			end = (uint32_t)(((usec * carrier_hz) + 500000) / 1000000);
+			if( embx_ir_tx_program_put(program, entry, max, (pd->phy_interval_type == mark), end - cycles) != STATUS_OK ) {
+				return STATUS_ERR_OVERFLOW;
+			}
+			cycles = end;
+		}
+	}
+	return STATUS_OK;
+}
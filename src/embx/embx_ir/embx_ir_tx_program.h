@@ -0,0 +1,42 @@
+/**
+ * @file embx_ir_tx_program.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief A transmission compiled into carrier cycles for playback by hardware.
+ * @details A program is a table of MARKs and SPACEs whose durations are counted in periods of the carrier.  The table
+ * is played back without the CPU, e.g. by embx_ir_tx_tcc, so each interval is exact to the carrier cycle.
+ */ 
+#ifndef EMBX_IR_TX_PROGRAM_H_
+#define EMBX_IR_TX_PROGRAM_H_
+
+/** An entry with this bit set is a MARK, otherwise a SPACE */
+#define EMBX_IR_TX_PROGRAM_MARK			(0x8000)
+/** The remaining bits of an entry hold the number of carrier cycles, longer intervals take several entries */
+#define EMBX_IR_TX_PROGRAM_MAX_CYCLES	(0x7FFF)
+
+/** Returns the number of carrier cycles of an entry */
+#define EMBX_IR_TX_PROGRAM_CYCLES(entry)	((entry) & EMBX_IR_TX_PROGRAM_MAX_CYCLES)
+
+/**
+* @brief embx_ir_tx_program_t is a compiled transmission.
+*/
+typedef struct {
+	uint32_t carrier_hz; /** The carrier frequency the cycle counts were computed for */
+	uint16_t size; /** The number of entries */
+	const uint16_t *entry; /** The table of MARKs and SPACEs */
+} embx_ir_tx_program_t;
+
+/**
+* @brief Compiles the IR Tx PHY descriptor queue into a program.
+* @details The queue is drained as if it was transmitted, repeats are unrolled and an open stream is refilled.  The
+* cycle counts are rounded against the start of the transmission so rounding errors do not accumulate.
+* @params program - receives the program.
+* @params entry, max - the table of the program and its number of entries.
+* @params carrier_hz - the carrier frequency of the hardware that plays the program.
+* @returns STATUS_OK, STATUS_BUSY if the IR Tx PHY is transmitting the queue, or STATUS_ERR_OVERFLOW if the table is too small.
+*/
+extern enum status_code embx_ir_tx_program_compile(embx_ir_tx_program_t *program, uint16_t *entry, uint16_t max, uint32_t carrier_hz);
+
+#endif /* EMBX_IR_TX_PROGRAM_H_ */
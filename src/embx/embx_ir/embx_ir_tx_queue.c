@@ -0,0 +1,283 @@
+/**
+ * @file embx_ir_tx_queue.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief A queue of IR messages that are transmitted back to back without blocking the caller.
+ * @details The queue keeps the stream of the IR Tx PHY open while it has messages.  Its callback is called each time
+ * the PHY consumes a descriptor: it reports the messages that are done and encodes the next intervals into the ring.
+ * A message is done when the PHY starts the gap after its last frame, the fill index after the gap marks that point.
+ * A message that is done keeps its entry until its callback is called, which is never in a critical section.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_tx_queue.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+
+/**
+* @brief Enumerates the states of a queue entry.
+*/
+typedef enum {
+	EMBX_IR_TX_QUEUE_FREE = 0,
+	EMBX_IR_TX_QUEUE_WAITING, /** Queued, not started */
+	EMBX_IR_TX_QUEUE_ACTIVE, /** Being encoded into the ring */
+	EMBX_IR_TX_QUEUE_SENT, /** In the ring, done when the PHY reaches the marker */
+	EMBX_IR_TX_QUEUE_DONE, /** Done, its callback has not been called */
+} embx_ir_tx_queue_state_t;
+
+/**
+* @brief embx_ir_tx_queue_entry_t holds a message and its progress.
+*/
+typedef struct {
+	embx_ir_tx_msg_t msg;
+	embx_ir_tx_queue_state_t state;
+	uint16_t sequence; /** The order in which the messages were queued */
+	uint16_t frames_left; /** The frames that have not been encoded, including the current one */
+	bool gap; /** The frame has been encoded, its gap has not */
+	uint8_t marker; /** The fill index after the last gap */
+	enum status_code status; /** The status passed to the callback */
+} embx_ir_tx_queue_entry_t;
+
+static embx_ir_tx_queue_entry_t entry[EMBX_IR_TX_QUEUE_SZ];
+/** The entry being encoded, NULL if none */
+static embx_ir_tx_queue_entry_t *active = NULL;
+/** Encodes the current frame of the active entry */
+static embx_ir_protocol_stream_t stream;
+static uint16_t next_sequence = 0;
+/** Set while the queue starts the PHY */
+static bool starting = false;
+
+/**
+* @brief Marks an entry as done, its callback is called by embx_ir_tx_queue_report.
+*/
+static void embx_ir_tx_queue_done(embx_ir_tx_queue_entry_t *e, enum status_code status)
+{
+	e->status = status;
+	e->state = EMBX_IR_TX_QUEUE_DONE;
+}
+
+/**
+* @brief Frees the entries that are done and calls their callbacks.  Must not be called in a critical section.
+* @details Each entry is freed before its callback is called so the callback may queue another message.
+*/
+static void embx_ir_tx_queue_report(void)
+{
+	embx_ir_tx_queue_callback_t callback;
+	void *context;
+	enum status_code status;
+	uint8_t i;
+
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		embx_hal_enter_critical_section();
+		if( entry[i].state != EMBX_IR_TX_QUEUE_DONE ) {
+			embx_hal_leave_critical_section();
+			continue;
+		}
+		callback = entry[i].msg.callback;
+		context = entry[i].msg.context;
+		status = entry[i].status;
+		entry[i].state = EMBX_IR_TX_QUEUE_FREE;
+		embx_hal_leave_critical_section();
+		if( callback != NULL ) {
+			callback(status, context);
+		}
+	}
+}
+
+/**
+* @brief Returns the waiting entry with the highest priority, the oldest one if several have it.  NULL if none.
+*/
+static embx_ir_tx_queue_entry_t *embx_ir_tx_queue_select(void)
+{
+	embx_ir_tx_queue_entry_t *best = NULL;
+	uint8_t i;
+
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		if( entry[i].state != EMBX_IR_TX_QUEUE_WAITING ) {
+			continue;
+		}
+		if( (best == NULL) || (entry[i].msg.priority > best->msg.priority) ||
+			((entry[i].msg.priority == best->msg.priority) && ((int16_t)(entry[i].sequence - best->sequence) < 0)) ) {
+			best = &entry[i];
+		}
+	}
+	return best;
+}
+
+static void embx_ir_tx_queue_pump(void *context);
+
+/**
+* @brief Marks the messages that the PHY has finished as done and refills the ring.
+*/
+static void embx_ir_tx_queue_refill(void)
+{
+	uint8_t tx_index = embx_ir_tx_phy_descriptor_get_tx_index();
+	enum status_code status;
+	uint8_t i;
+
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		if( (entry[i].state == EMBX_IR_TX_QUEUE_SENT) && ((int8_t)(tx_index - entry[i].marker) >= 0) ) {
+			embx_ir_tx_queue_done(&entry[i], STATUS_OK);
+		}
+	}
+
+	while( true ) {
+		if( active == NULL ) {
+			active = embx_ir_tx_queue_select();
+			if( active == NULL ) {
+				embx_ir_tx_phy_descriptor_stream_close();
+				return;
+			}
+			active->state = EMBX_IR_TX_QUEUE_ACTIVE;
+			active->gap = false;
+			embx_ir_protocol_stream_append(&stream, active->msg.protocol, &active->msg.frame);
+			embx_ir_tx_phy_descriptor_stream_open(embx_ir_tx_queue_pump, NULL, EMBX_IR_TX_PHY_DESCRIPTOR_Q_SZ);
+		}
+
+		if( active->gap == false ) {
+			status = embx_ir_protocol_stream_fill(&stream);
+			if( status == STATUS_BUSY ) {
+				return;
+			}
+			if( status != STATUS_OK ) {
+				embx_ir_tx_queue_done(active, status);
+				active = NULL;
+				continue;
+			}
+			active->gap = true;
+		}
+
+		if( embx_ir_tx_phy_descriptor_fill(false, space, active->msg.gap_usec, 0, 0) != STATUS_OK ) {
+			return;
+		}
+		active->gap = false;
+		if( --active->frames_left != 0 ) {
+			embx_ir_protocol_stream_append(&stream, active->msg.protocol, &active->msg.frame);
+		} else {
+			active->marker = embx_ir_tx_phy_descriptor_get_fill_index();
+			active->state = EMBX_IR_TX_QUEUE_SENT;
+			active = NULL;
+		}
+	}
+}
+
+/**
+* @brief The stream callback of the IR Tx PHY.  Refills the ring and reports the messages that are done.
+* @details Called from the IR Tx PHY interrupt, or in the critical section of embx_ir_tx_queue_poll when the queue
+* starts the PHY.  The poll reports the messages itself once it has left its critical section.
+*/
+static void embx_ir_tx_queue_pump(void *context)
+{
+	(void)context; /** The queue has a single instance */
+
+	embx_ir_tx_queue_refill();
+	if( starting == false ) {
+		embx_ir_tx_queue_report();
+	}
+}
+
+/**
+* @brief Empties the queue.
+*/
+void embx_ir_tx_queue_init(void)
+{
+	uint8_t i;
+
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		entry[i].state = EMBX_IR_TX_QUEUE_FREE;
+	}
+	active = NULL;
+	starting = false;
+}
+
+/**
+* @brief Queues a copy of a message and starts the IR Tx PHY if it is idle.
+*/
+enum status_code embx_ir_tx_queue_enqueue(const embx_ir_tx_msg_t *msg)
+{
+	enum status_code status = STATUS_ERR_NO_MEMORY;
+	uint8_t i;
+
+	if( (msg->protocol == NULL) || (msg->frame.nbits == 0) || (msg->frame.nbits > (EMBX_IR_PROTOCOL_MAX_BYTES * 8)) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+
+	embx_hal_enter_critical_section();
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		if( entry[i].state == EMBX_IR_TX_QUEUE_FREE ) {
+			entry[i].msg = *msg;
+			if( entry[i].msg.gap_usec == 0 ) {
+				entry[i].msg.gap_usec = msg->protocol->gap_usec;
+			}
+			entry[i].sequence = next_sequence++;
+			entry[i].frames_left = msg->repeats + 1;
+			entry[i].state = EMBX_IR_TX_QUEUE_WAITING;
+			status = STATUS_OK;
+			break;
+		}
+	}
+	embx_hal_leave_critical_section();
+
+	if( status == STATUS_OK ) {
+		embx_ir_tx_queue_poll();
+	}
+	return status;
+}
+
+/**
+* @brief Starts the IR Tx PHY if it is idle and messages are waiting.
+* @details A message that is still in transmission while the PHY is idle was cut short by an underrun of the ring.
+*/
+void embx_ir_tx_queue_poll(void)
+{
+	uint8_t i;
+
+	embx_hal_enter_critical_section();
+	if( (starting == false) && (embx_ir_tx_phy_get_state() == false) && (embx_ir_tx_queue_select() != NULL) ) {
+		starting = true;
+		for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+			if( (entry[i].state == EMBX_IR_TX_QUEUE_ACTIVE) || (entry[i].state == EMBX_IR_TX_QUEUE_SENT) ) {
+				embx_ir_tx_queue_done(&entry[i], STATUS_ERR_IO);
+			}
+		}
+		active = NULL;
+		embx_ir_tx_phy_descriptor_reset();
+		embx_ir_tx_queue_refill();
+		embx_ir_tx_phy_send();
+		starting = false;
+	}
+	embx_hal_leave_critical_section();
+	embx_ir_tx_queue_report();
+}
+
+/**
+* @brief Removes the messages that have not been started.
+*/
+void embx_ir_tx_queue_flush(void)
+{
+	uint8_t i;
+
+	embx_hal_enter_critical_section();
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		if( entry[i].state == EMBX_IR_TX_QUEUE_WAITING ) {
+			embx_ir_tx_queue_done(&entry[i], STATUS_ERR_REQ_FLUSHED);
+		}
+	}
+	embx_hal_leave_critical_section();
+	embx_ir_tx_queue_report();
+}
+
+/**
+* @brief Returns the number of messages waiting or in transmission.
+*/
+uint8_t embx_ir_tx_queue_get_pending(void)
+{
+	uint8_t i, n = 0;
+
+	for( i = 0; i < EMBX_IR_TX_QUEUE_SZ; i++ ) {
+		if( entry[i].state != EMBX_IR_TX_QUEUE_FREE ) {
+			n++;
+		}
+	}
+	return n;
+}
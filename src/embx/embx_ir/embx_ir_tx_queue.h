@@ -0,0 +1,70 @@
+/**
+ * @file embx_ir_tx_queue.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief A queue of IR messages that are transmitted back to back without blocking the caller.
+ * @details A message is a frame of a protocol that is transmitted one or more times with a SPACE after each frame.
+ * The queue owns the IR Tx PHY.  The first message starts the PHY, the following messages are encoded into the 
+ * descriptor ring by the IR Tx PHY interrupt so there is no idle time between two messages other than the gap.
+ * Waiting messages are sent by priority, messages of the same priority in the order they were queued.
+ */ 
+#ifndef EMBX_IR_TX_QUEUE_H_
+#define EMBX_IR_TX_QUEUE_H_
+
+#include "embx/embx_ir/embx_ir_protocol.h"
+
+/** The maximum number of messages waiting or in transmission */
+#define EMBX_IR_TX_QUEUE_SZ			(8)
+
+/**
+* @brief Called from the IR Tx PHY interrupt, embx_ir_tx_queue_poll, or embx_ir_tx_queue_flush when a message is done,
+* never in a critical section of the queue.
+* @details status is STATUS_OK once the last frame of the message has been transmitted, STATUS_ERR_REQ_FLUSHED if it
+* was removed by embx_ir_tx_queue_flush, or STATUS_ERR_IO if the transmission was cut short.  The callback may queue
+* another message.
+*/
+typedef void (*embx_ir_tx_queue_callback_t)(enum status_code status, void *context);
+
+/**
+* @brief embx_ir_tx_msg_t describes a message.
+*/
+typedef struct {
+	const embx_ir_protocol_t *protocol;
+	embx_ir_protocol_frame_t frame;
+	uint8_t repeats; /** The frame is transmitted repeats + 1 times */
+	uint32_t gap_usec; /** The SPACE after each frame, 0 selects the gap of the protocol */
+	uint8_t priority; /** Messages with a higher priority are sent first */
+	embx_ir_tx_queue_callback_t callback; /** May be NULL */
+	void *context; /** Passed to the callback */
+} embx_ir_tx_msg_t;
+
+/**
+* @brief Empties the queue.  Call once before the other functions.
+*/
+extern void embx_ir_tx_queue_init(void);
+
+/**
+* @brief Queues a copy of a message and starts the IR Tx PHY if it is idle.  Does not wait for the transmission.
+* @returns STATUS_OK, STATUS_ERR_INVALID_ARG if the frame is empty or too long, or STATUS_ERR_NO_MEMORY if the queue is full.
+*/
+extern enum status_code embx_ir_tx_queue_enqueue(const embx_ir_tx_msg_t *msg);
+
+/**
+* @brief Starts the IR Tx PHY if it is idle and messages are waiting.
+* @details The enqueue function does this.  Call it from the main loop if the PHY is also used without the queue.
+*/
+extern void embx_ir_tx_queue_poll(void);
+
+/**
+* @brief Removes the messages that have not been started, their callbacks get STATUS_ERR_REQ_FLUSHED.
+*/
+extern void embx_ir_tx_queue_flush(void);
+
+/**
+* @brief Returns the number of messages waiting or in transmission.
+*/
+extern uint8_t embx_ir_tx_queue_get_pending(void);
+
+#endif /* EMBX_IR_TX_QUEUE_H_ */
@@ -0,0 +1,202 @@
+/**
+ * @file embx_ir_tx_tcc.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Hardware timed IR transmission: a TCC generates the carrier and the DMA plays a program into its compare buffer.
+ * @details The TCC runs in normal PWM mode, the output is high while the counter is below CC.  CC is double
+ * buffered: a value written to CCB by the DMA on an overflow is used from the following cycle on, so the whole
+ * program is delayed by one carrier cycle and every interval keeps its length.
+ * There are no ASF drivers for the TCC and the DMAC in the project, the registers are accessed directly.
+ */ 
+#include <asf.h>
+#include "embx/embx_ir/embx_ir_common.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_tcc.h"
+
+/** The DMA descriptors: one per program entry, and the final one that turns the carrier off */
+static DmacDescriptor dma_descriptor[EMBX_IR_TX_TCC_MAX_ENTRIES + 1] __attribute__ ((aligned (16)));
+/** The write back section of the DMAC, one descriptor per channel */
+static DmacDescriptor dma_writeback[EMBX_IR_TX_TCC_DMA_CHANNEL + 1] __attribute__ ((aligned (16)));
+
+/** The values the DMA copies into the compare buffer */
+static uint32_t duty_mark = 0;
+static const uint32_t duty_space = 0;
+
+/** The frequency of the carrier */
+static uint32_t tcc_carrier_hz = 0;
+
+/** Set by the send function and cleared by the DMA interrupt at the end of the program. */
+static volatile bool embx_ir_tx_tcc_in_progress = false;
+
+/**
+* @brief Waits until the registers of the TCC are synchronized.
+*/
+static inline void embx_ir_tx_tcc_sync(void)
+{
+	while( EMBX_IR_TX_TCC_MODULE->SYNCBUSY.reg != 0 ) {
+		/* Wait */
+	}
+}
+
+/**
+* @brief Fills in a DMA descriptor that writes the same value into the compare buffer for a number of carrier cycles.
+*/
+static void embx_ir_tx_tcc_set_descriptor(DmacDescriptor *dd, const uint32_t *duty, uint16_t cycles, DmacDescriptor *next)
+{
+	dd->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_WORD | 
+					 ((next == NULL) ? DMAC_BTCTRL_BLOCKACT_INT : DMAC_BTCTRL_BLOCKACT_NOACT);
+	dd->BTCNT.reg = cycles;
+	dd->SRCADDR.reg = (uint32_t)duty; /* The address is not incremented */
+	dd->DSTADDR.reg = (uint32_t)&EMBX_IR_TX_TCC_MODULE->CCB[EMBX_IR_TX_TCC_CHANNEL].reg;
+	dd->DESCADDR.reg = (uint32_t)next;
+}
+
+/**
+* @brief The DMA interrupt occurs once the final descriptor has turned the carrier off.
+*/
+void DMAC_Handler(void)
+{
+	DMAC->CHID.reg = DMAC_CHID_ID(EMBX_IR_TX_TCC_DMA_CHANNEL);
+	if( (DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL) != 0 ) {
+		DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+		EMBX_IR_TX_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+		embx_ir_tx_tcc_in_progress = false;
+	}
+}
+
+/**
+* @brief Initializes the TCC, the output pin, and the DMAC.
+* @details The period of the TCC is rounded to the nearest tick of the GCLK, e.g. 38 kHz becomes 37.91 kHz at 8 MHz.
+*/
+void embx_ir_tx_tcc_init(uint32_t carrier_hz)
+{
+	struct system_gclk_chan_config gclk_chan_conf;
+	struct system_pinmux_config pin_conf;
+	uint32_t period = (EMBX_IR_MODULATOR_GCLK_FREQ + (carrier_hz / 2)) / carrier_hz;
+
+	tcc_carrier_hz = EMBX_IR_MODULATOR_GCLK_FREQ / period;
+	duty_mark = (period * EMBX_IR_TX_TCC_DUTY_PCT) / 100;
+
+	/* The TCC is clocked by the modulator GCLK */
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, EMBX_IR_TX_TCC_APBCMASK);
+	system_gclk_chan_get_config_defaults(&gclk_chan_conf);
+	gclk_chan_conf.source_generator = EMBX_IR_MODULATOR_GCLK;
+	system_gclk_chan_set_config(EMBX_IR_TX_TCC_GCLK_ID, &gclk_chan_conf);
+	system_gclk_chan_enable(EMBX_IR_TX_TCC_GCLK_ID);
+
+	EMBX_IR_TX_TCC_MODULE->CTRLA.reg = TCC_CTRLA_SWRST;
+	while( (EMBX_IR_TX_TCC_MODULE->CTRLA.reg & TCC_CTRLA_SWRST) != 0 ) {
+		/* Wait */
+	}
+	EMBX_IR_TX_TCC_MODULE->CTRLA.reg = TCC_CTRLA_PRESCALER_DIV1;
+	EMBX_IR_TX_TCC_MODULE->WAVE.reg = TCC_WAVE_WAVEGEN_NPWM;
+	embx_ir_tx_tcc_sync();
+	EMBX_IR_TX_TCC_MODULE->PER.reg = TCC_PER_PER(period - 1);
+	embx_ir_tx_tcc_sync();
+	EMBX_IR_TX_TCC_MODULE->CC[EMBX_IR_TX_TCC_CHANNEL].reg = 0; /* The output is low */
+	embx_ir_tx_tcc_sync();
+	EMBX_IR_TX_TCC_MODULE->CTRLA.reg |= TCC_CTRLA_ENABLE;
+	embx_ir_tx_tcc_sync();
+	EMBX_IR_TX_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_STOP;
+	embx_ir_tx_tcc_sync();
+
+	system_pinmux_get_config_defaults(&pin_conf);
+	pin_conf.mux_position = EMBX_IR_TX_TCC_MUX;
+	pin_conf.direction = SYSTEM_PINMUX_PIN_DIR_OUTPUT;
+	system_pinmux_pin_set_config(EMBX_IR_TX_TCC_PIN, &pin_conf);
+
+	/* The DMAC */
+	system_ahb_clock_set_mask(PM_AHBMASK_DMAC);
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBB, PM_APBBMASK_DMAC);
+	DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+	DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+	DMAC->BASEADDR.reg = (uint32_t)dma_descriptor;
+	DMAC->WRBADDR.reg = (uint32_t)dma_writeback;
+	DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN0;
+
+	DMAC->CHID.reg = DMAC_CHID_ID(EMBX_IR_TX_TCC_DMA_CHANNEL);
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+	DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(EMBX_IR_TX_TCC_DMAC_ID_OVF) | DMAC_CHCTRLB_TRIGACT_BEAT;
+	DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;
+	system_interrupt_enable(SYSTEM_INTERRUPT_MODULE_DMA);
+}
+
+/**
+* @brief Returns the carrier frequency generated by the TCC.
+*/
+uint32_t embx_ir_tx_tcc_get_carrier_hz(void)
+{
+	return tcc_carrier_hz;
+}
+
+/**
+* @brief Returns true while a program is played.
+*/
+bool embx_ir_tx_tcc_get_state(void)
+{
+	return embx_ir_tx_tcc_in_progress;
+}
+
+/**
+* @brief Plays a program.
+* @details The descriptors are linked in the order of the program.  The final descriptor writes 0 twice: the first
+* write turns the carrier off with the next update, the second one completes the transfer after that update.
+* The retrigger command restarts the TCC and requests the first DMA beat.
+*/
+enum status_code embx_ir_tx_tcc_send(const embx_ir_tx_program_t *program)
+{
+	uint16_t i, n = 0;
+	uint16_t entry;
+
+	if( embx_ir_tx_tcc_in_progress == true ) {
+		return STATUS_BUSY;
+	}
+	if( program->size > EMBX_IR_TX_TCC_MAX_ENTRIES ) {
+		return STATUS_ERR_OVERFLOW;
+	}
+
+	for( i = 0; i < program->size; i++ ) {
+		entry = program->entry[i];
+		if( EMBX_IR_TX_PROGRAM_CYCLES(entry) != 0 ) {
+			embx_ir_tx_tcc_set_descriptor(&dma_descriptor[n], 
+										  ((entry & EMBX_IR_TX_PROGRAM_MARK) != 0) ? &duty_mark : &duty_space,
+										  EMBX_IR_TX_PROGRAM_CYCLES(entry), &dma_descriptor[n + 1]);
+			n++;
+		}
+	}
+	embx_ir_tx_tcc_set_descriptor(&dma_descriptor[n], &duty_space, 2, NULL);
+
+	embx_ir_tx_tcc_in_progress = true;
+
+	DMAC->CHID.reg = DMAC_CHID_ID(EMBX_IR_TX_TCC_DMA_CHANNEL);
+	DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR | DMAC_CHINTFLAG_SUSP;
+	DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+
+	EMBX_IR_TX_TCC_MODULE->CTRLBSET.reg = TCC_CTRLBSET_CMD_RETRIGGER;
+
+	return STATUS_OK;
+}
+
+/** The program of the test bench */
+static uint16_t tb_entry[4];
+
+/** @brief Test bench, transmits the same pattern as embx_time_tb */
+void embx_ir_tx_tcc_tb(void)
+{
+	embx_ir_tx_program_t program;
+
+	embx_ir_tx_tcc_init(38000);
+
+	embx_ir_tx_phy_descriptor_fill(true, mark, 384, 0, 0);
+	embx_ir_tx_phy_descriptor_fill(false, space, 1192, 1, 2);
+	embx_ir_tx_program_compile(&program, tb_entry, sizeof(tb_entry) / sizeof(tb_entry[0]), embx_ir_tx_tcc_get_carrier_hz());
+
+	while(1) {
+		if( embx_ir_tx_tcc_get_state() == false ) {
+			embx_ir_tx_tcc_send(&program);
+		}
+		delay_ms(20);
+	}
+}
@@ -0,0 +1,61 @@
+/**
+ * @file embx_ir_tx_tcc.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief Hardware timed IR transmission: a TCC generates the carrier and the DMA plays a program into its compare buffer.
+ * @details The TCC runs at the carrier frequency.  Each overflow triggers a DMA beat that writes the duty of the next
+ * carrier cycle, the duty of a MARK or 0 for a SPACE, into the compare buffer.  Every interval of the program is one
+ * DMA descriptor that repeats the same value for the number of cycles of the interval.  A frame costs one interrupt,
+ * at its end, and the mark/space edges are exact to the carrier cycle.
+ */ 
+#ifndef EMBX_IR_TX_TCC_H_
+#define EMBX_IR_TX_TCC_H_
+
+#include "embx/embx_ir/embx_ir_tx_program.h"
+
+/** The TCC, its output, and the compare channel that drives the output.  WO0 is CC0. */
+#define EMBX_IR_TX_TCC_MODULE				TCC0
+#define EMBX_IR_TX_TCC_GCLK_ID				TCC0_GCLK_ID
+#define EMBX_IR_TX_TCC_DMAC_ID_OVF			TCC0_DMAC_ID_OVF
+#define EMBX_IR_TX_TCC_APBCMASK				PM_APBCMASK_TCC0
+#define EMBX_IR_TX_TCC_PIN					PIN_PA08E_TCC0_WO0
+#define EMBX_IR_TX_TCC_MUX					MUX_PA08E_TCC0_WO0
+#define EMBX_IR_TX_TCC_CHANNEL				(0)
+
+/** The DMA channel.  The descriptor section of the DMAC is owned by this module, so it must be channel 0. */
+#define EMBX_IR_TX_TCC_DMA_CHANNEL			(0)
+
+/** The duty cycle of the carrier during a MARK */
+#define EMBX_IR_TX_TCC_DUTY_PCT				(33)
+
+/** The number of program entries that can be played, each entry takes a 16 byte DMA descriptor */
+#define EMBX_IR_TX_TCC_MAX_ENTRIES			(320)
+
+/**
+* @brief Initializes the TCC, the output pin, and the DMAC.
+* @params carrier_hz - the carrier frequency, the TCC is clocked by EMBX_IR_MODULATOR_GCLK.
+*/
+extern void embx_ir_tx_tcc_init(uint32_t carrier_hz);
+
+/**
+* @brief Returns the carrier frequency generated by the TCC.  Compile programs for this frequency.
+*/
+extern uint32_t embx_ir_tx_tcc_get_carrier_hz(void);
+
+/**
+* @brief Returns true while a program is played.
+*/
+extern bool embx_ir_tx_tcc_get_state(void);
+
+/**
+* @brief Plays a program.  The program must stay in scope until the transmission ends.
+* @returns STATUS_OK, STATUS_BUSY if a program is played, or STATUS_ERR_OVERFLOW if the program has too many entries.
+*/
+extern enum status_code embx_ir_tx_tcc_send(const embx_ir_tx_program_t *program);
+
+/** @brief - Test bench for the module. */
+extern void embx_ir_tx_tcc_tb(void);
+
+#endif /* EMBX_IR_TX_TCC_H_ */
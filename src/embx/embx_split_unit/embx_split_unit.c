@@ -0,0 +1,241 @@
+/**
+ * @file embx_split_unit.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_split_unit module models the state of a split unit and generates the IR commands that control it.
+ * @details The setters only schedule a transmission, embx_split_unit_poll sends it.  A setpoint change is held for
+ * EMBX_SPLIT_UNIT_COALESCE_MS and every further change restarts the hold, up to EMBX_SPLIT_UNIT_COALESCE_MAX_MS after the
+ * first change.  Any other change is sent on the next poll and carries the held setpoint with it.  When the scheduled
+ * transmission is due and the desired state equals the sent state (e.g. 22 -> 23 -> 22) nothing is transmitted.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_tx_phy_descriptor.h"
+#include "embx/embx_ir/embx_ir_tx_phy.h"
+#include "embx/embx_split_unit/embx_split_unit.h"
+
+/**
+* @brief Returns true if time a is later than or equal to time b, the millisecond time base may wrap.
+*/
+static inline bool embx_split_unit_time_reached(uint32_t a, uint32_t b)
+{
+	return ((int32_t)(a - b) >= 0);
+}
+
+/**
+* @brief Returns true if two states would produce the same frame.
+*/
+static bool embx_split_unit_state_equal(const embx_split_unit_state_t *a, const embx_split_unit_state_t *b)
+{
+	return (a->power == b->power) && (a->mode == b->mode) && (a->setpoint == b->setpoint) &&
+		   (a->fan == b->fan) && (a->swing == b->swing) &&
+		   (a->on_timer_min == b->on_timer_min) && (a->off_timer_min == b->off_timer_min);
+}
+
+/**
+* @brief Schedules a transmission of the desired state.
+* @param coalesce - true to hold the transmission waiting for further changes, false to send on the next poll.
+*/
+static void embx_split_unit_schedule(embx_split_unit_t *unit, bool coalesce, uint32_t now_ms)
+{
+	uint32_t due_ms;
+
+	if( unit->pending == true ) {
+		unit->stats.coalesced++;
+	} else {
+		unit->pending = true;
+		unit->first_ms = now_ms;
+		unit->due_ms = now_ms + EMBX_SPLIT_UNIT_COALESCE_MS;
+	}
+
+	if( coalesce == true ) {
+		/** Restart the hold unless an immediate transmission is already due, never hold past the limit */
+		if( embx_split_unit_time_reached(unit->due_ms, now_ms + 1) ) {
+			due_ms = now_ms + EMBX_SPLIT_UNIT_COALESCE_MS;
+			if( embx_split_unit_time_reached(due_ms, unit->first_ms + EMBX_SPLIT_UNIT_COALESCE_MAX_MS) ) {
+				due_ms = unit->first_ms + EMBX_SPLIT_UNIT_COALESCE_MAX_MS;
+			}
+			unit->due_ms = due_ms;
+		}
+	} else {
+		unit->due_ms = now_ms;
+	}
+}
+
+/**
+* @brief Common handling of a setter.
+* @returns true if the new value differs from the desired state and the caller should apply it.
+*/
+static bool embx_split_unit_request(embx_split_unit_t *unit, bool changed)
+{
+	unit->stats.requests++;
+	if( changed == false ) {
+		unit->stats.suppressed++;
+	}
+	return changed;
+}
+
+/**
+* @brief Initializes a unit.
+*/
+void embx_split_unit_init(embx_split_unit_t *unit, const embx_split_unit_codec_t *codec, const embx_split_unit_state_t *state)
+{
+	unit->codec = codec;
+	unit->desired = *state;
+	unit->sent = *state;
+	unit->sent_valid = false;
+	unit->pending = false;
+	unit->sent_ms = 0;
+	unit->due_ms = 0;
+	unit->first_ms = 0;
+	unit->stats.requests = 0;
+	unit->stats.coalesced = 0;
+	unit->stats.suppressed = 0;
+	unit->stats.transmissions = 0;
+	unit->stats.errors = 0;
+}
+
+enum status_code embx_split_unit_set_power(embx_split_unit_t *unit, bool power, uint32_t now_ms)
+{
+	if( embx_split_unit_request(unit, (unit->desired.power != power)) ) {
+		unit->desired.power = power;
+		embx_split_unit_schedule(unit, false, now_ms);
+	}
+	return STATUS_OK;
+}
+
+enum status_code embx_split_unit_set_mode(embx_split_unit_t *unit, embx_split_unit_mode_t mode, uint32_t now_ms)
+{
+	if( mode > EMBX_SPLIT_UNIT_MODE_FAN ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_split_unit_request(unit, (unit->desired.mode != mode)) ) {
+		unit->desired.mode = mode;
+		embx_split_unit_schedule(unit, false, now_ms);
+	}
+	return STATUS_OK;
+}
+
+enum status_code embx_split_unit_set_setpoint(embx_split_unit_t *unit, uint8_t setpoint, uint32_t now_ms)
+{
+	if( (setpoint < EMBX_SPLIT_UNIT_SETPOINT_MIN) || (setpoint > EMBX_SPLIT_UNIT_SETPOINT_MAX) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_split_unit_request(unit, (unit->desired.setpoint != setpoint)) ) {
+		unit->desired.setpoint = setpoint;
+		embx_split_unit_schedule(unit, true, now_ms);
+	}
+	return STATUS_OK;
+}
+
+enum status_code embx_split_unit_set_fan(embx_split_unit_t *unit, uint8_t fan, uint32_t now_ms)
+{
+	if( fan > EMBX_SPLIT_UNIT_FAN_MAX ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_split_unit_request(unit, (unit->desired.fan != fan)) ) {
+		unit->desired.fan = fan;
+		embx_split_unit_schedule(unit, false, now_ms);
+	}
+	return STATUS_OK;
+}
+
+enum status_code embx_split_unit_set_swing(embx_split_unit_t *unit, uint8_t swing, uint32_t now_ms)
+{
+	if( (swing > EMBX_SPLIT_UNIT_SWING_MAX) && (swing != EMBX_SPLIT_UNIT_SWING_MOVE) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_split_unit_request(unit, (unit->desired.swing != swing)) ) {
+		unit->desired.swing = swing;
+		embx_split_unit_schedule(unit, false, now_ms);
+	}
+	return STATUS_OK;
+}
+
+enum status_code embx_split_unit_set_timers(embx_split_unit_t *unit, uint16_t on_timer_min, uint16_t off_timer_min, uint32_t now_ms)
+{
+	if( (on_timer_min > EMBX_SPLIT_UNIT_TIMER_MAX_MIN) || ((on_timer_min % EMBX_SPLIT_UNIT_TIMER_STEP_MIN) != 0) ||
+		(off_timer_min > EMBX_SPLIT_UNIT_TIMER_MAX_MIN) || ((off_timer_min % EMBX_SPLIT_UNIT_TIMER_STEP_MIN) != 0) ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( embx_split_unit_request(unit, (unit->desired.on_timer_min != on_timer_min) || (unit->desired.off_timer_min != off_timer_min)) ) {
+		unit->desired.on_timer_min = on_timer_min;
+		unit->desired.off_timer_min = off_timer_min;
+		embx_split_unit_schedule(unit, false, now_ms);
+	}
+	return STATUS_OK;
+}
+
+/**
+* @brief Replaces the desired and the sent state with a state observed on the air.
+* @details The echo of the last transmission must not drop a change scheduled after it, e.g. 22 is sent, 23 is held
+* for coalescing, and the echo of 22 arrives.
+*/
+enum status_code embx_split_unit_sync(embx_split_unit_t *unit, const embx_split_unit_state_t *state, uint32_t now_ms)
+{
+	if( (unit->sent_valid == true) && embx_split_unit_state_equal(state, &unit->sent) &&
+		((unit->pending == true) || (embx_split_unit_time_reached(now_ms, unit->sent_ms + EMBX_SPLIT_UNIT_ECHO_MS) == false)) ) {
+		return STATUS_NO_CHANGE;
+	}
+	unit->desired = *state;
+	unit->sent = *state;
+	unit->sent_valid = true;
+	unit->pending = false;
+	return STATUS_OK;
+}
+
+/**
+* @brief Encodes a state into the IR Tx PHY descriptor queue without sending it.
+* @details The codec builds the frame, the check bytes are computed from the integrity table of the protocol.
+*/
+enum status_code embx_split_unit_encode(const embx_split_unit_codec_t *codec, const embx_split_unit_state_t *state, embx_ir_protocol_stream_t *stream)
+{
+	embx_ir_protocol_frame_t frame;
+	uint16_t n;
+
+	for( n = 0; n < EMBX_IR_PROTOCOL_MAX_BYTES; n++ ) {
+		frame.data[n] = 0;
+	}
+	frame.nbits = codec->protocol->nbits;
+	codec->encode(state, &frame);
+	if( codec->protocol->integrity != NULL ) {
+		embx_ir_integrity_fill(codec->protocol->integrity, codec->protocol->integrity_n, frame.data, (uint8_t)((frame.nbits + 7) >> 3));
+	}
+	return embx_ir_protocol_stream_start(stream, codec->protocol, &frame);
+}
+
+/**
+* @brief Transmits the scheduled frame once it is due and the IR Tx PHY is free.
+*/
+enum status_code embx_split_unit_poll(embx_split_unit_t *unit, uint32_t now_ms)
+{
+	enum status_code status;
+
+	if( (unit->pending == false) || (embx_split_unit_time_reached(now_ms, unit->due_ms) == false) ) {
+		return STATUS_NO_CHANGE;
+	}
+	if( (unit->sent_valid == true) && embx_split_unit_state_equal(&unit->desired, &unit->sent) ) {
+		unit->pending = false;
+		unit->stats.suppressed++;
+		return STATUS_NO_CHANGE;
+	}
+	if( embx_ir_tx_phy_get_state() == true ) {
+		return STATUS_BUSY;
+	}
+
+	status = embx_split_unit_encode(unit->codec, &unit->desired, &unit->stream);
+	if( status == STATUS_OK ) {
+		status = embx_ir_tx_phy_send();
+	}
+	if( status == STATUS_OK ) {
+		unit->pending = false; /** Otherwise the frame is retried on the next poll */
+		unit->sent = unit->desired;
+		unit->sent_valid = true;
+		unit->sent_ms = now_ms;
+		unit->stats.transmissions++;
+	} else {
+		unit->stats.errors++;
+	}
+	return status;
+}
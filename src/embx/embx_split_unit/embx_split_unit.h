@@ -0,0 +1,142 @@
+/**
+ * @file embx_split_unit.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_split_unit module models the state of a split unit and generates the IR commands that control it.
+ * @details AC remotes send the complete unit state in every frame.  The module keeps the state that the application
+ * wants (desired) and the state that was last transmitted (sent).  A frame is only transmitted when the two differ.
+ * Setpoint changes that are requested in quick succession are coalesced into one transmission.
+ * The frame is built by a per protocol codec, see embx_split_unit_mitsubishi.h.
+ */ 
+#ifndef EMBX_SPLIT_UNIT_H_
+#define EMBX_SPLIT_UNIT_H_
+
+#include "embx/embx_ir/embx_ir_protocol.h"
+
+/** A setpoint change is held this long waiting for further setpoint changes before it is transmitted */
+#define EMBX_SPLIT_UNIT_COALESCE_MS			(1000)
+/** A setpoint change is never held longer than this even if further changes keep arriving */
+#define EMBX_SPLIT_UNIT_COALESCE_MAX_MS		(3000)
+/** A frame of the last transmitted state observed this soon after the transmission is taken as its echo */
+#define EMBX_SPLIT_UNIT_ECHO_MS				(1000)
+
+/** The setpoint range in degrees Celsius */
+#define EMBX_SPLIT_UNIT_SETPOINT_MIN		(16)
+#define EMBX_SPLIT_UNIT_SETPOINT_MAX		(31)
+
+/** The fan speed, 0 is automatic */
+#define EMBX_SPLIT_UNIT_FAN_AUTO			(0)
+#define EMBX_SPLIT_UNIT_FAN_MAX				(5)
+
+/** The vane position, 0 is automatic */
+#define EMBX_SPLIT_UNIT_SWING_AUTO			(0)
+#define EMBX_SPLIT_UNIT_SWING_MAX			(5)
+#define EMBX_SPLIT_UNIT_SWING_MOVE			(7) /** The vane swings continuously */
+
+/** The on and off timers in minutes, a multiple of the step up to the maximum, 0 is off */
+#define EMBX_SPLIT_UNIT_TIMER_STEP_MIN		(10)
+#define EMBX_SPLIT_UNIT_TIMER_MAX_MIN		(2550)
+
+/** @brief Enumerates the operating modes of the unit. */
+typedef enum {
+	EMBX_SPLIT_UNIT_MODE_AUTO = 0,
+	EMBX_SPLIT_UNIT_MODE_COOL,
+	EMBX_SPLIT_UNIT_MODE_HEAT,
+	EMBX_SPLIT_UNIT_MODE_DRY,
+	EMBX_SPLIT_UNIT_MODE_FAN,
+} embx_split_unit_mode_t;
+
+/**
+* @brief embx_split_unit_state_t is the state carried by an AC remote frame.
+*/
+typedef struct {
+	bool power;
+	embx_split_unit_mode_t mode;
+	uint8_t setpoint; /** Degrees Celsius, EMBX_SPLIT_UNIT_SETPOINT_MIN to EMBX_SPLIT_UNIT_SETPOINT_MAX */
+	uint8_t fan; /** EMBX_SPLIT_UNIT_FAN_AUTO or 1 to EMBX_SPLIT_UNIT_FAN_MAX */
+	uint8_t swing; /** EMBX_SPLIT_UNIT_SWING_AUTO, 1 to EMBX_SPLIT_UNIT_SWING_MAX or EMBX_SPLIT_UNIT_SWING_MOVE */
+	uint16_t on_timer_min; /** Minutes until the unit turns on, 0 if the timer is off, see EMBX_SPLIT_UNIT_TIMER_STEP_MIN */
+	uint16_t off_timer_min; /** Minutes until the unit turns off, 0 if the timer is off */
+} embx_split_unit_state_t;
+
+/**
+* @brief embx_split_unit_codec_t converts between the unit state and the frame of a protocol.
+*/
+typedef struct {
+	const embx_ir_protocol_t *protocol; /** Timing, bit order, and integrity checks of the frame */
+	void (*encode)(const embx_split_unit_state_t *state, embx_ir_protocol_frame_t *frame); /** Builds the frame, the check bytes are filled by the caller */
+	enum status_code (*decode)(const embx_ir_protocol_frame_t *frame, embx_split_unit_state_t *state); /** Parses a frame that passed the integrity checks */
+} embx_split_unit_codec_t;
+
+/**
+* @brief Counts what the transmit policy did with the requests.
+*/
+typedef struct {
+	uint32_t requests; /** State changes requested by the application */
+	uint32_t coalesced; /** Requests absorbed by a transmission that was already scheduled */
+	uint32_t suppressed; /** Scheduled transmissions dropped because the desired state equals the sent state */
+	uint32_t transmissions; /** Frames transmitted */
+	uint32_t errors; /** Frames that could not be encoded or sent */
+} embx_split_unit_stats_t;
+
+/**
+* @brief embx_split_unit_t is one split unit.
+*/
+typedef struct {
+	const embx_split_unit_codec_t *codec;
+	embx_split_unit_state_t desired; /** The state requested by the application */
+	embx_split_unit_state_t sent; /** The state of the last transmission */
+	bool sent_valid; /** false until the first transmission */
+	bool pending; /** A transmission is scheduled */
+	uint32_t sent_ms; /** When the last transmission was sent */
+	uint32_t due_ms; /** When the scheduled transmission is sent */
+	uint32_t first_ms; /** When the oldest coalesced request was made */
+	embx_ir_protocol_stream_t stream; /** Feeds the frame to the IR Tx PHY while it is transmitted */
+	embx_split_unit_stats_t stats;
+} embx_split_unit_t;
+
+/**
+* @brief Initializes a unit.
+* @params codec - the protocol of the unit.
+* @params state - the initial desired state, e.g. the defaults of the remote.
+*/
+extern void embx_split_unit_init(embx_split_unit_t *unit, const embx_split_unit_codec_t *codec, const embx_split_unit_state_t *state);
+
+/**
+* @brief The setters change the desired state.  now_ms is a free running millisecond time base supplied by the caller.
+* @details The setpoint is coalesced, every other change schedules an immediate transmission.
+* @returns STATUS_OK or STATUS_ERR_INVALID_ARG if the value is out of range.
+*/
+extern enum status_code embx_split_unit_set_power(embx_split_unit_t *unit, bool power, uint32_t now_ms);
+extern enum status_code embx_split_unit_set_mode(embx_split_unit_t *unit, embx_split_unit_mode_t mode, uint32_t now_ms);
+extern enum status_code embx_split_unit_set_setpoint(embx_split_unit_t *unit, uint8_t setpoint, uint32_t now_ms);
+extern enum status_code embx_split_unit_set_fan(embx_split_unit_t *unit, uint8_t fan, uint32_t now_ms);
+extern enum status_code embx_split_unit_set_swing(embx_split_unit_t *unit, uint8_t swing, uint32_t now_ms);
+extern enum status_code embx_split_unit_set_timers(embx_split_unit_t *unit, uint16_t on_timer_min, uint16_t off_timer_min, uint32_t now_ms);
+
+/**
+* @brief Replaces the desired and the sent state with a state observed on the air, e.g. by embx_split_unit_monitor.
+* @details The unit was set by another remote so any scheduled transmission is dropped.  The receiver also captures
+* the frames of the unit itself, a state equal to the last transmission is its echo while a transmission is scheduled or
+* for EMBX_SPLIT_UNIT_ECHO_MS after it was sent, and it is ignored.
+* @params now_ms - the time base of the setters and of embx_split_unit_poll.
+* @returns STATUS_OK or STATUS_NO_CHANGE if the state was the echo of the last transmission.
+*/
+extern enum status_code embx_split_unit_sync(embx_split_unit_t *unit, const embx_split_unit_state_t *state, uint32_t now_ms);
+
+/**
+* @brief Transmits the scheduled frame once it is due and the IR Tx PHY is free.  Call from the main loop.
+* @returns STATUS_OK if a frame was transmitted, STATUS_NO_CHANGE if nothing was due, STATUS_BUSY if the PHY is busy,
+*          or the error of the encoder or the PHY.  Unless a frame was transmitted it stays scheduled for the next poll.
+*/
+extern enum status_code embx_split_unit_poll(embx_split_unit_t *unit, uint32_t now_ms);
+
+/**
+* @brief Encodes a state into the IR Tx PHY descriptor queue without sending it.
+* @details The frame is streamed, stream must stay in scope until the transmission ends.
+*/
+extern enum status_code embx_split_unit_encode(const embx_split_unit_codec_t *codec, const embx_split_unit_state_t *state, embx_ir_protocol_stream_t *stream);
+
+#endif /* EMBX_SPLIT_UNIT_H_ */
@@ -0,0 +1,134 @@
+/**
+ * @file embx_split_unit_mitsubishi.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The codec for the 144 bit Mitsubishi Electric split unit protocol.
+ * @details The frame is 18 bytes sent LSB first, pulse distance encoded:
+ *    0-4  - 0x23 0xCB 0x26 0x01 0x00 (signature)
+ *    5    - power, 0x20 is ON
+ *    6    - mode, bits 3-5
+ *    7    - setpoint - 16
+ *    8    - mode dependent constant
+ *    9    - fan (bits 0-2), vane (bits 3-5), manual vane (bit 6), automatic fan (bit 7)
+ *    10   - clock in units of 10 minutes (not used)
+ *    11   - off timer in units of 10 minutes
+ *    12   - on timer in units of 10 minutes
+ *    13   - timer flags
+ *    14-16 - 0
+ *    17   - sum of bytes 0-16
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_split_unit/embx_split_unit_mitsubishi.h"
+
+#define MITSUBISHI_POWER_ON			(0x20)
+#define MITSUBISHI_FAN_AUTO			(0x80)
+#define MITSUBISHI_VANE_MANUAL		(0x40)
+#define MITSUBISHI_TIMER_OFF		(0x03)
+#define MITSUBISHI_TIMER_ON			(0x05)
+#define MITSUBISHI_TIMER_MIN		(EMBX_SPLIT_UNIT_TIMER_STEP_MIN) /** Minutes per timer unit */
+
+#if (EMBX_SPLIT_UNIT_TIMER_MAX_MIN / MITSUBISHI_TIMER_MIN) > 0xFF
+#error The timers of the split unit do not fit the timer bytes of the Mitsubishi frame
+#endif
+#if EMBX_SPLIT_UNIT_MITSUBISHI_INTERVALS > EMBX_IR_RX_BUF_SZ
+#error A Mitsubishi frame does not fit an IR Rx buffer, the monitor could not capture it
+#endif
+
+/** @brief The checksum of the frame */
+static const embx_ir_integrity_cfg_t embx_split_unit_mitsubishi_integrity[] = {
+	{ EMBX_IR_INTEGRITY_BYTE_SUM, 0, EMBX_SPLIT_UNIT_MITSUBISHI_BYTES, 0, 0, 0, false, NULL },
+};
+
+const embx_ir_protocol_t embx_split_unit_mitsubishi_protocol = {
+	.encoding = EMBX_IR_PROTOCOL_ENCODING_PULSE_DISTANCE,
+	.bit_order = EMBX_IR_LITTLE_ENDIAN,
+	.tolerance_pct = EMBX_IR_PROTOCOL_TOLERANCE_PCT,
+	.unit_usec = 430,
+	.header_mark_usec = 3400,
+	.header_space_usec = 1750,
+	.zero_mark_usec = 450,
+	.zero_space_usec = 420,
+	.one_mark_usec = 450,
+	.one_space_usec = 1300,
+	.trailer_mark_usec = 440,
+	.gap_usec = 17100,
+	.nbits = EMBX_SPLIT_UNIT_MITSUBISHI_BYTES * 8,
+	.integrity = embx_split_unit_mitsubishi_integrity,
+	.integrity_n = sizeof(embx_split_unit_mitsubishi_integrity) / sizeof(embx_split_unit_mitsubishi_integrity[0]),
+};
+
+/** @brief Byte 6 and byte 8 for each embx_split_unit_mode_t */
+static const uint8_t embx_split_unit_mitsubishi_mode[][2] = {
+	{ 0x20, 0x36 }, /* AUTO */
+	{ 0x18, 0x36 }, /* COOL */
+	{ 0x08, 0x30 }, /* HEAT */
+	{ 0x10, 0x32 }, /* DRY */
+	{ 0x38, 0x36 }, /* FAN */
+};
+
+/**
+* @brief Builds the Mitsubishi frame from the state.  The checksum is filled by the caller.
+*/
+static void embx_split_unit_mitsubishi_encode(const embx_split_unit_state_t *state, embx_ir_protocol_frame_t *frame)
+{
+	uint8_t *d = frame->data;
+
+	d[0] = 0x23;
+	d[1] = 0xCB;
+	d[2] = 0x26;
+	d[3] = 0x01;
+	d[4] = 0x00;
+	d[5] = (state->power == true) ? MITSUBISHI_POWER_ON : 0x00;
+	d[6] = embx_split_unit_mitsubishi_mode[state->mode][0];
+	d[7] = (uint8_t)(state->setpoint - EMBX_SPLIT_UNIT_SETPOINT_MIN);
+	d[8] = embx_split_unit_mitsubishi_mode[state->mode][1];
+	d[9] = (state->fan == EMBX_SPLIT_UNIT_FAN_AUTO) ? MITSUBISHI_FAN_AUTO : state->fan;
+	if( state->swing != EMBX_SPLIT_UNIT_SWING_AUTO ) {
+		d[9] |= (uint8_t)(MITSUBISHI_VANE_MANUAL | ((state->swing & 0x07) << 3));
+	}
+	d[11] = (uint8_t)(state->off_timer_min / MITSUBISHI_TIMER_MIN);
+	d[12] = (uint8_t)(state->on_timer_min / MITSUBISHI_TIMER_MIN);
+	d[13] = ((d[11] != 0) ? MITSUBISHI_TIMER_OFF : 0) | ((d[12] != 0) ? MITSUBISHI_TIMER_ON : 0);
+	frame->nbits = EMBX_SPLIT_UNIT_MITSUBISHI_BYTES * 8;
+}
+
+/**
+* @brief Parses a Mitsubishi frame into the state.
+* @returns STATUS_OK or STATUS_ERR_BAD_FORMAT if the frame is not a Mitsubishi split unit frame.
+*/
+static enum status_code embx_split_unit_mitsubishi_decode(const embx_ir_protocol_frame_t *frame, embx_split_unit_state_t *state)
+{
+	const uint8_t *d = frame->data;
+	uint8_t mode, vane;
+
+	if( (frame->nbits != (EMBX_SPLIT_UNIT_MITSUBISHI_BYTES * 8)) ||
+		(d[0] != 0x23) || (d[1] != 0xCB) || (d[2] != 0x26) || (d[3] != 0x01) || (d[4] != 0x00) ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+	for( mode = 0; mode <= EMBX_SPLIT_UNIT_MODE_FAN; mode++ ) {
+		if( embx_split_unit_mitsubishi_mode[mode][0] == d[6] ) {
+			break;
+		}
+	}
+	if( (mode > EMBX_SPLIT_UNIT_MODE_FAN) || ((d[7] & 0x0F) != d[7]) ) {
+		return STATUS_ERR_BAD_FORMAT;
+	}
+
+	state->power = ((d[5] & MITSUBISHI_POWER_ON) != 0);
+	state->mode = (embx_split_unit_mode_t)mode;
+	state->setpoint = (uint8_t)(d[7] + EMBX_SPLIT_UNIT_SETPOINT_MIN);
+	state->fan = ((d[9] & MITSUBISHI_FAN_AUTO) != 0) ? EMBX_SPLIT_UNIT_FAN_AUTO : (d[9] & 0x07);
+	vane = (d[9] >> 3) & 0x07;
+	state->swing = ((d[9] & MITSUBISHI_VANE_MANUAL) != 0) ? vane : EMBX_SPLIT_UNIT_SWING_AUTO;
+	state->off_timer_min = (uint16_t)(((d[13] & MITSUBISHI_TIMER_OFF) == MITSUBISHI_TIMER_OFF) ? (d[11] * MITSUBISHI_TIMER_MIN) : 0);
+	state->on_timer_min = (uint16_t)(((d[13] & MITSUBISHI_TIMER_ON) == MITSUBISHI_TIMER_ON) ? (d[12] * MITSUBISHI_TIMER_MIN) : 0);
+	return STATUS_OK;
+}
+
+const embx_split_unit_codec_t embx_split_unit_mitsubishi_codec = {
+	.protocol = &embx_split_unit_mitsubishi_protocol,
+	.encode = embx_split_unit_mitsubishi_encode,
+	.decode = embx_split_unit_mitsubishi_decode,
+};
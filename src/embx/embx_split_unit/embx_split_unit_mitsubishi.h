@@ -0,0 +1,24 @@
+/**
+ * @file embx_split_unit_mitsubishi.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The codec for the 144 bit Mitsubishi Electric split unit protocol.
+ */ 
+#ifndef EMBX_SPLIT_UNIT_MITSUBISHI_H_
+#define EMBX_SPLIT_UNIT_MITSUBISHI_H_
+
+#include "embx/embx_split_unit/embx_split_unit.h"
+
+/** The number of bytes in a Mitsubishi frame, the last byte is the sum of the others */
+#define EMBX_SPLIT_UNIT_MITSUBISHI_BYTES		(18)
+/** The number of marks and spaces of a frame: the header, a mark and a space per bit, and the trailer */
+#define EMBX_SPLIT_UNIT_MITSUBISHI_INTERVALS	(2 + (EMBX_SPLIT_UNIT_MITSUBISHI_BYTES * 8 * 2) + 1)
+
+/** @brief The timing of the Mitsubishi frame */
+extern const embx_ir_protocol_t embx_split_unit_mitsubishi_protocol;
+/** @brief The codec of the Mitsubishi frame */
+extern const embx_split_unit_codec_t embx_split_unit_mitsubishi_codec;
+
+#endif /* EMBX_SPLIT_UNIT_MITSUBISHI_H_ */
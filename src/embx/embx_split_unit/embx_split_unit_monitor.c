@@ -0,0 +1,137 @@
+/**
+ * @file embx_split_unit_monitor.c
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_split_unit_monitor module mirrors the state of a split unit from the frames of its remote.
+ * @details The IR Rx PHY captures in the background.  The poll function only does work when the PHY has completed a
+ * buffer, a capture may hold several frames (remotes often repeat the frame) and the first valid frame is used.
+ */ 
+#include "embx/embx_hal/embx_hal.h"
+#include "embx/embx_ir/embx_ir_rx_buffer.h"
+#include "embx/embx_split_unit/embx_split_unit_monitor.h"
+
+/**
+* @brief Initializes the monitor.
+*/
+void embx_split_unit_monitor_init(embx_split_unit_monitor_t *monitor, const embx_split_unit_codec_t *codec, embx_split_unit_t *unit)
+{
+	uint8_t k;
+
+	monitor->codec = codec;
+	monitor->unit = unit;
+	monitor->valid = false;
+	monitor->updated_ms = 0;
+	for( k = 0; k < EMBX_SPLIT_UNIT_FIELD_N; k++ ) {
+		monitor->changed_ms[k] = 0;
+	}
+	monitor->stats.captures = 0;
+	monitor->stats.frames = 0;
+	monitor->stats.rejected = 0;
+	monitor->stats.changes = 0;
+}
+
+/**
+* @brief Decodes the first valid frame of a capture.
+* @returns STATUS_OK if state holds the decoded state.
+*/
+static enum status_code embx_split_unit_monitor_decode(const embx_split_unit_monitor_t *monitor, const embx_ir_rx_buf_t *buf, embx_split_unit_state_t *state)
+{
+	embx_ir_protocol_frame_t frame;
+	uint16_t idx = 0;
+	enum status_code status;
+
+	do {
+		status = embx_ir_protocol_decode(monitor->codec->protocol, buf->elem, buf->size, &idx, &frame);
+		if( status == STATUS_OK ) {
+			*state = monitor->state; /** Fields the codec does not carry keep their value */
+			status = monitor->codec->decode(&frame, state);
+			if( status == STATUS_OK ) {
+				break;
+			}
+		}
+	} while( status != STATUS_ERR_BAD_DATA );
+	return status;
+}
+
+/**
+* @brief Applies a decoded state to the mirror and time stamps the fields that changed.
+* @returns true if a field changed.
+*/
+static bool embx_split_unit_monitor_apply(embx_split_unit_monitor_t *monitor, const embx_split_unit_state_t *state, uint32_t now_ms)
+{
+	const embx_split_unit_state_t *old = &monitor->state;
+	bool changed[EMBX_SPLIT_UNIT_FIELD_N];
+	bool any = false;
+	uint8_t k;
+
+	changed[EMBX_SPLIT_UNIT_FIELD_POWER] = (old->power != state->power);
+	changed[EMBX_SPLIT_UNIT_FIELD_MODE] = (old->mode != state->mode);
+	changed[EMBX_SPLIT_UNIT_FIELD_SETPOINT] = (old->setpoint != state->setpoint);
+	changed[EMBX_SPLIT_UNIT_FIELD_FAN] = (old->fan != state->fan);
+	changed[EMBX_SPLIT_UNIT_FIELD_SWING] = (old->swing != state->swing);
+	changed[EMBX_SPLIT_UNIT_FIELD_TIMERS] = (old->on_timer_min != state->on_timer_min) || (old->off_timer_min != state->off_timer_min);
+
+	for( k = 0; k < EMBX_SPLIT_UNIT_FIELD_N; k++ ) {
+		if( (changed[k] == true) || (monitor->valid == false) ) {
+			monitor->changed_ms[k] = now_ms;
+			any = true;
+		}
+	}
+	monitor->state = *state;
+	monitor->valid = true;
+	monitor->updated_ms = now_ms;
+	return any;
+}
+
+/**
+* @brief Processes the captures completed by the IR Rx PHY.
+*/
+bool embx_split_unit_monitor_poll(embx_split_unit_monitor_t *monitor, uint32_t now_ms)
+{
+	embx_ir_rx_buf_t *buf;
+	embx_split_unit_state_t state;
+	bool changed = false;
+
+	while( embx_ir_rx_buf_get_full(&buf) == STATUS_OK ) {
+		monitor->stats.captures++;
+		if( embx_split_unit_monitor_decode(monitor, buf, &state) == STATUS_OK ) {
+			monitor->stats.frames++;
+			if( embx_split_unit_monitor_apply(monitor, &state, now_ms) == true ) {
+				monitor->stats.changes++;
+				changed = true;
+			}
+			if( monitor->unit != NULL ) {
+				embx_split_unit_sync(monitor->unit, &state, now_ms);
+			}
+		} else {
+			monitor->stats.rejected++;
+		}
+		embx_ir_rx_buf_release();
+	}
+	return changed;
+}
+
+/**
+* @brief Returns the mirrored state or NULL if no frame has been received yet.
+*/
+const embx_split_unit_state_t *embx_split_unit_monitor_get_state(const embx_split_unit_monitor_t *monitor)
+{
+	return (monitor->valid == true) ? &monitor->state : NULL;
+}
+
+/**
+* @brief Returns the time of the last change of a field.
+*/
+enum status_code embx_split_unit_monitor_get_changed(const embx_split_unit_monitor_t *monitor, embx_split_unit_field_t field, uint32_t *changed_ms)
+{
+	if( field >= EMBX_SPLIT_UNIT_FIELD_N ) {
+		return STATUS_ERR_INVALID_ARG;
+	}
+	if( monitor->valid == false ) {
+		return STATUS_ERR_NOT_INITIALIZED;
+	}
+	*changed_ms = monitor->changed_ms[field];
+	return STATUS_OK;
+}
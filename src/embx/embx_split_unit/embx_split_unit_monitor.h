@@ -0,0 +1,77 @@
+/**
+ * @file embx_split_unit_monitor.h
+ * @date 10/18/2026
+ * @author bbernath
+ * @copyright Copyright (C) 2018 Brett Bernath. All Rights Reserved.
+ *
+ * @brief The embx_split_unit_monitor module mirrors the state of a split unit from the frames of its remote.
+ * @details Every frame captured by the IR Rx PHY is decoded with the codec of the unit.  A frame that decodes and passes
+ * its integrity checks is the new state of the unit, the time of the change is recorded for each field that changed.
+ * The mirror is read in O(1) so the application never has to capture and decode a frame on demand.
+ */ 
+#ifndef EMBX_SPLIT_UNIT_MONITOR_H_
+#define EMBX_SPLIT_UNIT_MONITOR_H_
+
+#include "embx/embx_split_unit/embx_split_unit.h"
+
+/** @brief Enumerates the fields of the state for which the time of the last change is recorded. */
+typedef enum {
+	EMBX_SPLIT_UNIT_FIELD_POWER = 0,
+	EMBX_SPLIT_UNIT_FIELD_MODE,
+	EMBX_SPLIT_UNIT_FIELD_SETPOINT,
+	EMBX_SPLIT_UNIT_FIELD_FAN,
+	EMBX_SPLIT_UNIT_FIELD_SWING,
+	EMBX_SPLIT_UNIT_FIELD_TIMERS,
+	EMBX_SPLIT_UNIT_FIELD_N, /** The number of fields */
+} embx_split_unit_field_t;
+
+/**
+* @brief Counts the captures processed by the monitor.
+*/
+typedef struct {
+	uint32_t captures; /** Buffers completed by the IR Rx PHY */
+	uint32_t frames; /** Frames that decoded and passed the integrity checks */
+	uint32_t rejected; /** Captures without a valid frame, e.g. another remote or a corrupted frame */
+	uint32_t changes; /** Frames that changed the mirrored state */
+} embx_split_unit_monitor_stats_t;
+
+/**
+* @brief embx_split_unit_monitor_t is the mirror of one unit.
+*/
+typedef struct {
+	const embx_split_unit_codec_t *codec;
+	embx_split_unit_t *unit; /** If not NULL, the unit model is synchronized with every observed state but its own echo */
+	embx_split_unit_state_t state; /** The mirrored state */
+	bool valid; /** false until the first frame has been received */
+	uint32_t updated_ms; /** When the last valid frame was received */
+	uint32_t changed_ms[EMBX_SPLIT_UNIT_FIELD_N]; /** When each field last changed */
+	embx_split_unit_monitor_stats_t stats;
+} embx_split_unit_monitor_t;
+
+/**
+* @brief Initializes the monitor.
+* @params codec - the protocol of the household remote.
+* @params unit - optional unit model to keep synchronized with the observed state, may be NULL.
+*/
+extern void embx_split_unit_monitor_init(embx_split_unit_monitor_t *monitor, const embx_split_unit_codec_t *codec, embx_split_unit_t *unit);
+
+/**
+* @brief Processes the captures completed by the IR Rx PHY.  Call from the main loop.
+* @details When no capture is waiting this is a single check of the rx buffer state.
+* @params now_ms - a free running millisecond time base used to time stamp the changes, the time base of the unit model.
+* @returns true if the mirrored state changed.
+*/
+extern bool embx_split_unit_monitor_poll(embx_split_unit_monitor_t *monitor, uint32_t now_ms);
+
+/**
+* @brief Returns the mirrored state or NULL if no frame has been received yet.
+*/
+extern const embx_split_unit_state_t *embx_split_unit_monitor_get_state(const embx_split_unit_monitor_t *monitor);
+
+/**
+* @brief Returns the time of the last change of a field.
+* @returns STATUS_OK, STATUS_ERR_NOT_INITIALIZED if no frame has been received, or STATUS_ERR_INVALID_ARG.
+*/
+extern enum status_code embx_split_unit_monitor_get_changed(const embx_split_unit_monitor_t *monitor, embx_split_unit_field_t field, uint32_t *changed_ms);
+
+#endif /* EMBX_SPLIT_UNIT_MONITOR_H_ */